@@ -37,6 +37,10 @@ android {
             assets.srcDir("../../webview_ui")
         }
     }
+    androidResources {
+        // 网页资源不压缩打包，WebView 请求直接读取 APK 中的描述符区间（见 AndroidBackend::HandleWebResourceRequest）
+        noCompress += listOf("html", "css", "js", "json", "svg", "veritnote")
+    }
     compileOptions {
         sourceCompatibility = JavaVersion.VERSION_11
         targetCompatibility = JavaVersion.VERSION_11
@@ -5,7 +5,9 @@ import android.content.ContentResolver
 import android.net.Uri
 import android.os.Bundle
 import android.os.Environment
+import android.os.ParcelFileDescriptor
 import android.provider.DocumentsContract
+import android.provider.DocumentsContract.Document
 import android.webkit.JavascriptInterface
 import android.webkit.WebResourceRequest
 import android.webkit.WebResourceResponse
@@ -29,11 +31,17 @@ import java.io.File
 
 import androidx.documentfile.provider.DocumentFile // <-- 新增 import
 import java.io.BufferedReader // <-- 新增 import
+import java.io.ByteArrayInputStream
+import java.io.InputStream
 import java.io.FileOutputStream // <-- 新增 import
 import java.io.InputStreamReader // <-- 新增 import
 import java.nio.charset.StandardCharsets
 import org.json.JSONArray // <-- 新增 import
 import org.json.JSONObject // <-- 新增 import
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.Executors
+import java.util.concurrent.RejectedExecutionException
+import java.util.concurrent.atomic.AtomicInteger
 
 
 class MainActivity : AppCompatActivity() {
@@ -69,6 +77,8 @@ class MainActivity : AppCompatActivity() {
 
     override fun onDestroy() {
         super.onDestroy()
+        listingExecutor.shutdownNow()
+        serviceExecutor.shutdownNow()
         nativeDestroy()
     }
 
@@ -79,6 +89,7 @@ class MainActivity : AppCompatActivity() {
     private external fun nativeOnUiReady()
     private external fun nativeOnPlatformServiceResult(resultJson: String)
     private external fun nativeOnWebMessage(message: String)
+    private external fun nativeInterceptRequest(url: String, range: String?): String?
     private external fun nativeGetPendingWorkspacePath(): String?
     private external fun nativeClearPendingWorkspacePath()
 
@@ -136,6 +147,13 @@ class MainActivity : AppCompatActivity() {
             ): WebResourceResponse? {
                 val url = request.url
 
+                // 内嵌资源与 local-file 优先由 C++ 以描述符直接响应（支持 Range，媒体可以边读边播），
+                // C++ 不处理时（压缩存储的 asset 等）沿用下面的加载方式
+                val range = request.requestHeaders.entries.firstOrNull { it.key.equals("Range", ignoreCase = true) }?.value
+                nativeInterceptRequest(url.toString(), range)?.let { responseJson ->
+                    toWebResourceResponse(responseJson)?.let { return it }
+                }
+
                 // [NEW] Handle our special local-file URIs for images
                 val localFilePrefix = "http://veritnote.localhost/local-file/"
                 if (url.toString().startsWith(localFilePrefix)) {
@@ -225,6 +243,58 @@ class MainActivity : AppCompatActivity() {
         webView.addJavascriptInterface(WebAppInterface(), "AndroidBridge")
     }
 
+    // nativeInterceptRequest 的结果 -> WebResourceResponse，数据流直接读取 C++ 交出的描述符
+    private fun toWebResourceResponse(responseJson: String): WebResourceResponse? {
+        return try {
+            val response = JSONObject(responseJson)
+            val headers = HashMap<String, String>()
+            response.optJSONObject("headers")?.let { h ->
+                for (key in h.keys()) headers[key] = h.getString(key)
+            }
+            val fd = response.optInt("fd", -1)
+            val data: InputStream = if (fd >= 0) {
+                val input = ParcelFileDescriptor.AutoCloseInputStream(ParcelFileDescriptor.adoptFd(fd))
+                val length = response.optLong("length", -1)
+                if (length >= 0) BoundedInputStream(input, length) else input
+            } else {
+                ByteArrayInputStream(ByteArray(0))
+            }
+            val mimeType = response.optString("mimeType", "application/octet-stream")
+            WebResourceResponse(
+                mimeType.substringBefore(';').trim(),
+                if (mimeType.contains("charset=")) mimeType.substringAfter("charset=").trim() else null,
+                response.optInt("status", 200),
+                response.optString("reason", "OK"),
+                headers,
+                data
+            )
+        } catch (e: Exception) {
+            Log.e("VeritNoteWebView", "Invalid native response: $responseJson", e)
+            null
+        }
+    }
+
+    // 只读取描述符中 [当前位置, 当前位置 + remaining) 的内容（APK 中的 asset 或 Range 区间）
+    private class BoundedInputStream(private val source: InputStream, private var remaining: Long) : InputStream() {
+        override fun read(): Int {
+            if (remaining <= 0) return -1
+            val value = source.read()
+            if (value >= 0) remaining--
+            return value
+        }
+
+        override fun read(buffer: ByteArray, offset: Int, length: Int): Int {
+            if (remaining <= 0) return -1
+            val count = source.read(buffer, offset, minOf(length.toLong(), remaining).toInt())
+            if (count > 0) remaining -= count
+            return count
+        }
+
+        override fun available(): Int = minOf(source.available().toLong(), remaining).toInt()
+
+        override fun close() = source.close()
+    }
+
     // [新增] JS Bridge 类
     inner class WebAppInterface {
         @JavascriptInterface
@@ -267,113 +337,163 @@ class MainActivity : AppCompatActivity() {
      * [NEW] C++ 调用此通用函数来请求任何 Android 平台服务
      */
     fun requestPlatformService(requestJson: String) {
-        runOnUiThread {
-            try {
-                val request = JSONObject(requestJson)
-                val action = request.getString("action")
-                val callbackId = request.getInt("callbackId")
-                val payload = request.optJSONObject("payload") ?: JSONObject()
-
-                when (action) {
-                    "openWorkspaceDialog" -> {
-                        pendingServiceRequest[action] = callbackId
-                        openFolderPicker()
-                    }
-                    "listDirectory" -> {
-                        val uriString = request.getJSONObject("payload").getString("uri")
-                        val fileList = listDirectory(uriString)
-                        val data = JSONObject().put("files", fileList)
+        val request = try {
+            JSONObject(requestJson)
+        } catch (e: org.json.JSONException) {
+            Log.e("VeritNoteService", "JSON Error in requestPlatformService", e)
+            return
+        }
+
+        // 需要 Activity / UI 的服务在 UI 线程上执行；文件服务交给线程池，
+        // 多个请求可以同时在途，也不会因 UI 线程繁忙而排队
+        if (request.optString("action") in uiServiceActions) {
+            runOnUiThread { handlePlatformService(request) }
+            return
+        }
+        try {
+            serviceExecutor.execute { handlePlatformService(request) }
+        } catch (e: RejectedExecutionException) {
+            // Activity 正在销毁
+            sendErrorResult(request.optInt("callbackId", -1), "Platform service is shutting down.")
+        }
+    }
+
+    private val uiServiceActions = setOf("openWorkspaceDialog", "openImagePicker", "openExternalLink")
+    private val serviceExecutor = Executors.newFixedThreadPool(4)
+
+    private fun handlePlatformService(request: JSONObject) {
+        try {
+            val action = request.getString("action")
+            val callbackId = request.getInt("callbackId")
+            val payload = request.optJSONObject("payload") ?: JSONObject()
+
+            when (action) {
+                "openWorkspaceDialog" -> {
+                    pendingServiceRequest[action] = callbackId
+                    openFolderPicker()
+                }
+                "listDirectory" -> {
+                    val uriString = request.getJSONObject("payload").getString("uri")
+                    val fileList = listDirectory(uriString)
+                    val data = JSONObject().put("files", fileList)
+                    sendSuccessResult(callbackId, data)
+                }
+                "readFile" -> {
+                    val uriString = request.getJSONObject("payload").getString("uri")
+                    val childFilename = payload.optString("childFilename", null)
+                    val content = readFile(uriString, childFilename)
+                    if (content != null) {
+                        val data = JSONObject().put("content", content)
                         sendSuccessResult(callbackId, data)
+                    } else {
+                        sendErrorResult(callbackId, "Failed to read file.")
                     }
-                    "readFile" -> {
-                        val uriString = request.getJSONObject("payload").getString("uri")
-                        val childFilename = payload.optString("childFilename", null)
-                        val content = readFile(uriString)
-                        if (content != null) {
-                            val data = JSONObject().put("content", content)
-                            sendSuccessResult(callbackId, data)
-                        } else {
-                            sendErrorResult(callbackId, "Failed to read file.")
-                        }
-                    }
-                    "writeFile" -> {
-                        val uriString = payload.getString("uri")
-                        val content = payload.getString("content")
-                        val childFilename = payload.optString("childFilename", null)
-                        val success = writeFile(uriString, content, childFilename)
-                        if (success) {
-                            sendSuccessResult(callbackId, JSONObject())
-                        } else {
-                            sendErrorResult(callbackId, "Failed to write file.")
-                        }
+                }
+                "writeFile" -> {
+                    val uriString = payload.getString("uri")
+                    val content = payload.getString("content")
+                    val childFilename = payload.optString("childFilename", null)
+                    val success = writeFile(uriString, content, childFilename)
+                    if (success) {
+                        sendSuccessResult(callbackId, JSONObject())
+                    } else {
+                        sendErrorResult(callbackId, "Failed to write file.")
                     }
-                    "createItem" -> {
-                        val parentUriString = payload.getString("parentUri")
-                        val name = payload.getString("name")
-                        val isDirectory = payload.getBoolean("isDirectory")
-                        val newUri = createItem(parentUriString, name, isDirectory)
-                        if (newUri != null) {
-                            val data = JSONObject().put("uri", newUri)
-                            sendSuccessResult(callbackId, data)
-                        } else {
-                            sendErrorResult(callbackId, "Failed to create item.")
-                        }
+                }
+                "createItem" -> {
+                    val parentUriString = payload.getString("parentUri")
+                    val name = payload.getString("name")
+                    val isDirectory = payload.getBoolean("isDirectory")
+                    val newUri = createItem(parentUriString, name, isDirectory)
+                    if (newUri != null) {
+                        val data = JSONObject().put("uri", newUri)
+                        sendSuccessResult(callbackId, data)
+                    } else {
+                        sendErrorResult(callbackId, "Failed to create item.")
                     }
-                    "deleteItem" -> {
-                        val uriString = payload.getString("uri")
-                        val success = deleteItem(uriString)
-                        if (success) {
-                            sendSuccessResult(callbackId, JSONObject())
-                        } else {
-                            sendErrorResult(callbackId, "Failed to delete item.")
-                        }
+                }
+                "deleteItem" -> {
+                    val uriString = payload.getString("uri")
+                    val success = deleteItem(uriString)
+                    if (success) {
+                        sendSuccessResult(callbackId, JSONObject())
+                    } else {
+                        sendErrorResult(callbackId, "Failed to delete item.")
                     }
-                    "listAllSubdirectories" -> {
-                        val rootUriString = payload.getString("rootUri")
-                        val subdirectories = listAllSubdirectories(rootUriString)
-                        val data = JSONObject().put("directories", subdirectories)
-                        sendSuccessResult(callbackId, data)
+                }
+                "listTree" -> {
+                    val rootUriString = payload.getString("rootUri")
+                    val exclude = HashSet<String>()
+                    payload.optJSONArray("exclude")?.let { names ->
+                        for (i in 0 until names.length()) exclude.add(names.getString(i))
                     }
-                    "openImagePicker" -> {
-                        pendingServiceRequest[action] = callbackId
-                        val intent = Intent(Intent.ACTION_OPEN_DOCUMENT).apply {
-                            addCategory(Intent.CATEGORY_OPENABLE)
-                            type = "image/*" // We only want images
-                        }
-                        imagePickerLauncher.launch(intent)
+                    listTree(callbackId, rootUriString, exclude)
+                }
+                "listAllSubdirectories" -> {
+                    val rootUriString = payload.getString("rootUri")
+                    val subdirectories = listAllSubdirectories(rootUriString)
+                    val data = JSONObject().put("directories", subdirectories)
+                    sendSuccessResult(callbackId, data)
+                }
+                "openImagePicker" -> {
+                    pendingServiceRequest[action] = callbackId
+                    val intent = Intent(Intent.ACTION_OPEN_DOCUMENT).apply {
+                        addCategory(Intent.CATEGORY_OPENABLE)
+                        type = "image/*" // We only want images
                     }
-                    "openExternalLink" -> {
-                        try {
-                            val url = payload.getString("url")
-                            val intent = Intent(Intent.ACTION_VIEW, Uri.parse(url))
-                            startActivity(intent)
-                            // This is fire-and-forget, so we can succeed immediately
-                            sendSuccessResult(callbackId, JSONObject())
-                        } catch (e: Exception) {
-                            sendErrorResult(callbackId, "Failed to open external link.")
-                        }
+                    imagePickerLauncher.launch(intent)
+                }
+                "openExternalLink" -> {
+                    try {
+                        val url = payload.getString("url")
+                        val intent = Intent(Intent.ACTION_VIEW, Uri.parse(url))
+                        startActivity(intent)
+                        // This is fire-and-forget, so we can succeed immediately
+                        sendSuccessResult(callbackId, JSONObject())
+                    } catch (e: Exception) {
+                        sendErrorResult(callbackId, "Failed to open external link.")
                     }
-                    "doesItemExist" -> {
-                        val parentUriString = payload.getString("parentUri")
-                        val name = payload.getString("name")
-                        val exists = doesItemExist(parentUriString, name)
-                        val data = JSONObject().put("exists", exists)
+                }
+                "doesItemExist" -> {
+                    val parentUriString = payload.getString("parentUri")
+                    val name = payload.getString("name")
+                    val exists = doesItemExist(parentUriString, name)
+                    val data = JSONObject().put("exists", exists)
+                    sendSuccessResult(callbackId, data)
+                }
+                "getParentUri" -> {
+                    val uriString = payload.getString("uri")
+                    val parentUri = getParentUri(uriString)
+                    if (parentUri != null) {
+                        val data = JSONObject().put("parentUri", parentUri)
                         sendSuccessResult(callbackId, data)
+                    } else {
+                        sendErrorResult(callbackId, "Could not find parent URI.")
                     }
-                    "getParentUri" -> {
-                        val uriString = payload.getString("uri")
-                        val parentUri = getParentUri(uriString)
-                        if (parentUri != null) {
-                            val data = JSONObject().put("parentUri", parentUri)
-                            sendSuccessResult(callbackId, data)
-                        } else {
-                            sendErrorResult(callbackId, "Could not find parent URI.")
-                        }
+                }
+                "openFileDescriptor" -> {
+                    // 交出描述符，由 C++ 端直接读写并负责关闭，文件内容不经过 JSON
+                    val uriString = payload.getString("uri")
+                    val mode = payload.optString("mode", "r")
+                    val fd = openDetachedDescriptor(uriString, mode)
+                    if (fd >= 0) {
+                        // mimeType 供 WebView 请求使用，content URI 通常没有扩展名
+                        val mimeType = try { contentResolver.getType(Uri.parse(uriString)) } catch (e: Exception) { null }
+                        sendSuccessResult(callbackId, JSONObject().put("fd", fd).put("mimeType", mimeType ?: ""))
+                    } else {
+                        sendErrorResult(callbackId, "Failed to open file descriptor.")
                     }
                 }
-            } catch (e: org.json.JSONException) {
-                Log.e("VeritNoteService", "JSON Error in requestPlatformService", e)
+                "batch" -> {
+                    val operations = payload.optJSONArray("operations") ?: JSONArray()
+                    val data = JSONObject().put("results", runBatch(operations))
+                    sendSuccessResult(callbackId, data)
+                }
             }
+        } catch (e: org.json.JSONException) {
+            Log.e("VeritNoteService", "JSON Error in requestPlatformService", e)
+            // C++ 端可能正在等待这个结果
+            sendErrorResult(request.optInt("callbackId", -1), "Malformed platform service request.")
         }
     }
 
@@ -664,6 +784,132 @@ class MainActivity : AppCompatActivity() {
         return directoryList
     }
 
+    // --- [NEW] 递归工作区列表 (listTree) ---
+    // 各目录在线程池上并发查询 (DocumentsContract 子文档查询，一次查询取回名称、类型和修改时间)，
+    // 已列出的目录攒成批次作为部分结果 ("partial": true) 发回 C++，最后一批是最终结果。
+    private class ListedEntry(val documentId: String, val name: String, val isDirectory: Boolean, val lastModified: Long)
+    private class CachedListing(val lastModified: Long, val entries: List<ListedEntry>)
+
+    // documentId -> 子项。增删改名都会改变目录的 lastModified，未变化的目录直接复用缓存
+    private val listingCache = ConcurrentHashMap<String, CachedListing>()
+    private val listingExecutor = Executors.newFixedThreadPool(4)
+    private val listingProjection = arrayOf(
+        Document.COLUMN_DOCUMENT_ID,
+        Document.COLUMN_DISPLAY_NAME,
+        Document.COLUMN_MIME_TYPE,
+        Document.COLUMN_LAST_MODIFIED
+    )
+
+    // 达到任一条件即发送一批部分结果
+    private val listingChunkDirectories = 64
+    private val listingChunkIntervalMs = 100L
+
+    private fun listTree(callbackId: Int, rootUriString: String, exclude: Set<String>) {
+        val treeUri = Uri.parse(rootUriString)
+        val rootId = try {
+            DocumentsContract.getTreeDocumentId(treeUri)
+        } catch (e: Exception) {
+            null
+        }
+        if (rootId == null) {
+            sendErrorResult(callbackId, "Not a document tree URI.")
+            return
+        }
+
+        val lock = Object()
+        var pendingChunk = JSONArray()
+        var lastFlush = System.currentTimeMillis()
+        val outstanding = AtomicInteger(1)
+
+        // 在锁内投递到 UI 线程，保证各批按列出顺序（父目录先于子目录）到达
+        fun flush(partial: Boolean) {
+            val response = JSONObject()
+            response.put("callbackId", callbackId)
+            response.put("success", true)
+            response.put("partial", partial)
+            response.put("data", JSONObject().put("directories", pendingChunk))
+            pendingChunk = JSONArray()
+            lastFlush = System.currentTimeMillis()
+            val message = response.toString()
+            runOnUiThread { nativeOnPlatformServiceResult(message) }
+        }
+
+        fun listDirectory(documentId: String, uriString: String, knownLastModified: Long?) {
+            listingExecutor.execute {
+                val entriesJson = JSONArray()
+                val subdirectories = ArrayList<Pair<ListedEntry, String>>()
+                try {
+                    val lastModified = knownLastModified ?: queryLastModified(treeUri, documentId)
+                    for (entry in queryChildren(treeUri, documentId, lastModified)) {
+                        val childUri = DocumentsContract.buildDocumentUriUsingTree(treeUri, entry.documentId).toString()
+                        entriesJson.put(
+                            JSONObject()
+                                .put("name", entry.name)
+                                .put("uri", childUri)
+                                .put("isDirectory", entry.isDirectory)
+                        )
+                        if (entry.isDirectory && entry.name !in exclude) {
+                            subdirectories.add(Pair(entry, childUri))
+                        }
+                    }
+                } catch (e: Exception) {
+                    Log.e("VeritNoteFileOps", "Error listing directory $uriString", e)
+                }
+
+                synchronized(lock) {
+                    pendingChunk.put(JSONObject().put("uri", uriString).put("entries", entriesJson))
+                    // 子目录在父目录进入批次之后才开始列出
+                    outstanding.addAndGet(subdirectories.size)
+                    for ((entry, childUri) in subdirectories) {
+                        listDirectory(entry.documentId, childUri, entry.lastModified)
+                    }
+                    if (outstanding.decrementAndGet() == 0) {
+                        flush(false)
+                    } else if (pendingChunk.length() >= listingChunkDirectories ||
+                        System.currentTimeMillis() - lastFlush >= listingChunkIntervalMs) {
+                        flush(true)
+                    }
+                }
+            }
+        }
+
+        listDirectory(rootId, rootUriString, null)
+    }
+
+    private fun queryChildren(treeUri: Uri, documentId: String, lastModified: Long): List<ListedEntry> {
+        // 修改时间未知 (0) 的目录不缓存
+        if (lastModified > 0) {
+            listingCache[documentId]?.let { cached ->
+                if (cached.lastModified == lastModified) return cached.entries
+            }
+        }
+
+        val entries = ArrayList<ListedEntry>()
+        val childrenUri = DocumentsContract.buildChildDocumentsUriUsingTree(treeUri, documentId)
+        contentResolver.query(childrenUri, listingProjection, null, null, null)?.use { cursor ->
+            while (cursor.moveToNext()) {
+                val id = cursor.getString(0) ?: continue
+                val name = cursor.getString(1) ?: continue
+                val isDirectory = cursor.getString(2) == Document.MIME_TYPE_DIR
+                val modified = if (cursor.isNull(3)) 0L else cursor.getLong(3)
+                entries.add(ListedEntry(id, name, isDirectory, modified))
+            }
+        }
+
+        if (lastModified > 0) {
+            listingCache[documentId] = CachedListing(lastModified, entries)
+        }
+        return entries
+    }
+
+    private fun queryLastModified(treeUri: Uri, documentId: String): Long {
+        val documentUri = DocumentsContract.buildDocumentUriUsingTree(treeUri, documentId)
+        contentResolver.query(documentUri, arrayOf(Document.COLUMN_LAST_MODIFIED), null, null, null)?.use { cursor ->
+            if (cursor.moveToFirst() && !cursor.isNull(0)) return cursor.getLong(0)
+        }
+        return 0L
+    }
+
     private fun doesItemExist(parentUriString: String, name: String): Boolean {
         return try {
             val parentUri = Uri.parse(parentUriString)
@@ -675,6 +921,90 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    // --- 批量平台服务 ---
+    // 一次 JNI 往返执行多个操作，结果与 operations 一一对应: [{ success, data | error }]。
+    // 每个操作独立捕获异常，一个失败不影响其余操作
+    private fun runBatch(operations: JSONArray): JSONArray {
+        val results = JSONArray()
+        for (i in 0 until operations.length()) {
+            val result = JSONObject()
+            try {
+                val data = runBatchOperation(operations.getJSONObject(i))
+                result.put("success", true)
+                result.put("data", data)
+            } catch (e: Exception) {
+                result.put("success", false)
+                result.put("error", e.message ?: "Operation failed.")
+            }
+            results.put(result)
+        }
+        return results
+    }
+
+    private fun runBatchOperation(operation: JSONObject): JSONObject {
+        val childFilename = if (operation.has("childFilename")) operation.getString("childFilename") else null
+        return when (val op = operation.getString("op")) {
+            "read" -> {
+                val content = readFile(operation.getString("uri"), childFilename)
+                    ?: throw IllegalStateException("Failed to read file.")
+                JSONObject().put("content", content)
+            }
+            "write" -> {
+                if (!writeFile(operation.getString("uri"), operation.getString("content"), childFilename)) {
+                    throw IllegalStateException("Failed to write file.")
+                }
+                JSONObject()
+            }
+            "create" -> {
+                val newUri = createItem(
+                    operation.getString("parentUri"),
+                    operation.getString("name"),
+                    operation.optBoolean("isDirectory", false)
+                ) ?: throw IllegalStateException("Failed to create item.")
+                // 可选的初始内容：新建文件后立即写入，省去一次往返
+                if (operation.has("content") && !writeFile(newUri, operation.getString("content"))) {
+                    throw IllegalStateException("Created item but failed to write its content.")
+                }
+                JSONObject().put("uri", newUri)
+            }
+            "stat" -> statItem(operation.getString("uri"), childFilename)
+            "getParent" -> {
+                val parentUri = getParentUri(operation.getString("uri"))
+                    ?: throw IllegalStateException("Could not find parent URI.")
+                JSONObject().put("parentUri", parentUri)
+            }
+            else -> throw IllegalArgumentException("Unknown batch operation: $op")
+        }
+    }
+
+    private fun statItem(uriString: String, childFilename: String?): JSONObject {
+        val uri = Uri.parse(uriString)
+        val file = if (childFilename != null) {
+            DocumentFile.fromTreeUri(this, uri)?.findFile(childFilename)
+        } else {
+            DocumentFile.fromSingleUri(this, uri)
+        }
+        val info = JSONObject()
+        val exists = file?.exists() == true
+        info.put("exists", exists)
+        if (file != null && exists) {
+            info.put("uri", file.uri.toString())
+            info.put("isDirectory", file.isDirectory)
+            info.put("size", file.length())
+            info.put("lastModified", file.lastModified())
+        }
+        return info
+    }
+
+    private fun openDetachedDescriptor(uriString: String, mode: String): Int {
+        return try {
+            contentResolver.openFileDescriptor(Uri.parse(uriString), mode)?.detachFd() ?: -1
+        } catch (e: Exception) {
+            Log.e("VeritNoteFileOps", "Error opening file descriptor: $uriString ($mode)", e)
+            -1
+        }
+    }
+
     private fun getParentUri(uriString: String): String? {
         return try {
             val uri = Uri.parse(uriString)
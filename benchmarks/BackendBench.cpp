@@ -0,0 +1,342 @@
+﻿// benchmarks/BackendBench.cpp
+// 通过 HandleWebMessage 驱动 Backend 的热点路径：消息分发、页面读写、File Config 解析、块引用、
+// 工作区列表与导出。平台层为 BenchBackend（消息留在内存中，文件读写走真实文件系统），
+// 所有输入在临时目录中生成，结束后删除。
+//   ./backend_bench [--quick] [--filter=<子串>] [--stats]
+// --stats 在最后额外输出一行 {"name": "backend_stats", ...}，即 getBackendStats 的内容（各 span 的分位数）
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchBackend.h"
+#include "BenchHarness.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr size_t KiB = 1024;
+    constexpr size_t MiB = 1024 * 1024;
+
+    std::string SizeLabel(size_t bytes) {
+        return bytes >= MiB ? std::to_string(bytes / MiB) + "m" : std::to_string(bytes / KiB) + "k";
+    }
+
+    void WriteText(const fs::path& path, const std::string& content) {
+        fs::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+
+    json Block(const std::string& id, const std::string& text) {
+        return { {"id", id}, {"type", "paragraph"}, {"content", text}, {"properties", { {"customCSS", json::array()} }}, {"children", json::array()} };
+    }
+
+    // 由段落块组成、序列化后约为 bytes 字节的页面（英文与中文混排）
+    json MakePage(size_t bytes) {
+        json blocks = json::array();
+        size_t size = 0;
+        for (size_t i = 0; size < bytes; ++i) {
+            json block = Block("block-" + std::to_string(i), i % 3 == 2
+                ? u8"敏捷的棕色狐狸跳过了懒狗，这是一段用于基准测试的中文内容。"
+                : "The quick brown fox jumps over the lazy dog. <b>Benchmark</b> paragraph text.");
+            size += block.dump().size() + 1;
+            blocks.push_back(std::move(block));
+        }
+        return { {"config", { {"page", json::object()} }}, {"content", { {"blocks", std::move(blocks)} }} };
+    }
+
+    // width 个顶层块，每个下面是一条 depth 层的子块链；返回最后一条链最深处的块 ID
+    json MakeDeepPage(size_t width, size_t depth, std::string& deepestId) {
+        json blocks = json::array();
+        for (size_t w = 0; w < width; ++w) {
+            json node = Block("b" + std::to_string(w) + "-" + std::to_string(depth), "leaf");
+            for (size_t d = depth; d-- > 0;) {
+                json parent = Block("b" + std::to_string(w) + "-" + std::to_string(d), "level " + std::to_string(d));
+                parent["children"].push_back(std::move(node));
+                node = std::move(parent);
+            }
+            blocks.push_back(std::move(node));
+        }
+        deepestId = "b" + std::to_string(width - 1) + "-" + std::to_string(depth);
+        return { {"config", json::object()}, {"content", { {"blocks", std::move(blocks)} }} };
+    }
+
+    // 最后一条消息的 payload；计时之外调用
+    json LastPayload(const BenchBackend& backend) {
+        return json::parse(backend.LastMessage()).value("payload", json::object());
+    }
+
+    void ResetWorkspace(BenchBackend& backend, const fs::path& root) {
+        backend.Send("setWorkspace", { {"path", root.string()} });
+    }
+
+    // --- 消息分发 ---
+    void BenchDispatch(BenchBackend& backend) {
+        // 后端内部处理、不触及平台层的最小消息：JSON 解析 + 分发 + 计时本身的开销
+        std::string small = json{ {"action", "closeQuery"}, {"payload", { {"cursorId", 0} }} }.dump();
+        BenchHarness::Run("dispatch/closeQuery", small.size(), [&] {
+            backend.HandleWebMessage(small);
+        });
+
+        // 带大块无关字段的同一消息，衡量消息解析与 payload 复制
+        json large = { {"action", "closeQuery"}, {"payload", { {"cursorId", 0}, {"padding", MakePage(256 * KiB)} }} };
+        std::string largeText = large.dump();
+        BenchHarness::Run("dispatch/closeQuery_256k", largeText.size(), [&] {
+            backend.HandleWebMessage(largeText);
+        });
+    }
+
+    // --- 页面读写 ---
+    void BenchFiles(BenchBackend& backend, const fs::path& root) {
+        std::vector<size_t> sizes = { 1 * KiB, 64 * KiB, 1 * MiB, 10 * MiB, 50 * MiB };
+        if (BenchHarness::Config().quick) sizes.resize(3);
+
+        for (size_t bytes : sizes) {
+            const std::string label = SizeLabel(bytes);
+            const std::string names[] = { "file/load/" + label, "file/load_binary/" + label, "file/save/" + label,
+                "file/save_journal/" + label, "file/patch/" + label };
+            bool any = false;
+            for (const auto& name : names) any = any || BenchHarness::Enabled(name);
+            if (!any) continue;
+
+            fs::path path = root / ("page-" + label + ".veritnote");
+            json page = MakePage(bytes);
+            std::string text = page.dump();
+            WriteText(path, text);
+            json loadMessage = { {"path", path.string()} };
+
+            BenchHarness::Run("file/load/" + label, text.size(), [&] {
+                backend.Send("loadFile", loadMessage);
+            });
+
+            json saveMessage = { {"path", path.string()}, {"config", page["config"]}, {"content", page["content"]} };
+            std::string saveText = json{ {"action", "saveFile"}, {"payload", saveMessage} }.dump();
+            BenchHarness::Run("file/save/" + label, text.size(), [&] {
+                backend.HandleWebMessage(saveText);
+            });
+
+            json journalMessage = saveMessage;
+            journalMessage["journal"] = true;
+            std::string journalText = json{ {"action", "saveFile"}, {"payload", journalMessage} }.dump();
+            BenchHarness::Run("file/save_journal/" + label, text.size(), [&] {
+                backend.HandleWebMessage(journalText);
+            });
+
+            // 大页面上的一次小编辑：只发送 JSON Patch，版本号取自上一次的回复
+            if (BenchHarness::Enabled("file/patch/" + label)) {
+                backend.Send("loadFile", loadMessage);
+                uint64_t version = LastPayload(backend).value("version", static_cast<uint64_t>(0));
+                size_t edit = 0;
+                BenchHarness::Run("file/patch/" + label, 0, [&] {
+                    json ops = json::array({ { {"op", "replace"}, {"path", "/content/blocks/0/content"}, {"value", "edit " + std::to_string(++edit)} } });
+                    backend.Send("patchFile", { {"path", path.string()}, {"baseVersion", version}, {"ops", std::move(ops)} });
+                    version = LastPayload(backend).value("version", static_cast<uint64_t>(0));
+                });
+            }
+
+            if (BenchHarness::Enabled("file/load_binary/" + label)) {
+                backend.Send("saveFile", saveMessage); // 把日志压缩回原文件
+                backend.Send("convertFileFormat", { {"path", path.string()}, {"format", "binary"} });
+                size_t binarySize = fs::file_size(path);
+                BenchHarness::Run("file/load_binary/" + label, binarySize, [&] {
+                    backend.Send("loadFile", loadMessage);
+                });
+            }
+            fs::remove(path);
+            fs::remove(SaveJournal::JournalPathFor(path));
+        }
+    }
+
+    // --- File Config 继承解析 ---
+    void BenchConfig(BenchBackend& backend, const fs::path& root) {
+        for (size_t depth : { 1, 4, 16, 64 }) {
+            const std::string prefix = "config/resolve/depth_" + std::to_string(depth);
+            if (!BenchHarness::Enabled(prefix + "/cold") && !BenchHarness::Enabled(prefix + "/warm")) continue;
+
+            fs::path workspace = root / ("config-" + std::to_string(depth));
+            fs::path dir = workspace;
+            for (size_t d = 0; d < depth; ++d) {
+                WriteText(dir / "veritnoteconfig", json{ {"page", { {"fontSize", d % 2 == 0 ? "inherit" : "16px"}, {"level" + std::to_string(d), d} }} }.dump());
+                dir /= "dir" + std::to_string(d);
+            }
+            fs::path page = dir / "page.veritnote";
+            WriteText(page, json{ {"config", { {"page", { {"width", "inherit"} }} }}, {"content", { {"blocks", json::array()} }} }.dump());
+            json message = { {"path", page.string()} };
+
+            // cold：每次都从切换工作区（清空全部缓存）开始
+            BenchHarness::Run(prefix + "/cold", 0, [&] {
+                ResetWorkspace(backend, workspace);
+                backend.Send("resolveFileConfiguration", message);
+            });
+            ResetWorkspace(backend, workspace);
+            BenchHarness::Run(prefix + "/warm", 0, [&] {
+                backend.Send("resolveFileConfiguration", message);
+            });
+        }
+    }
+
+    // --- 块引用 ---
+    void BenchQuote(BenchBackend& backend, const fs::path& root) {
+        for (size_t depth : { 8, 64, 256 }) {
+            const std::string prefix = "quote/depth_" + std::to_string(depth);
+            if (!BenchHarness::Enabled(prefix + "/json") && !BenchHarness::Enabled(prefix + "/binary")) continue;
+
+            std::string deepestId;
+            json page = MakeDeepPage(32, depth, deepestId);
+            fs::path path = root / ("quote-" + std::to_string(depth) + ".veritnote");
+            WriteText(path, page.dump());
+            json message = { {"quoteBlockId", "q"}, {"referenceLink", path.string() + "#" + deepestId} };
+
+            BenchHarness::Run(prefix + "/json", fs::file_size(path), [&] {
+                backend.Send("fetchQuoteContent", message);
+            });
+            if (BenchHarness::Enabled(prefix + "/binary")) {
+                backend.Send("convertFileFormat", { {"path", path.string()}, {"format", "binary"} });
+                BenchHarness::Run(prefix + "/binary", fs::file_size(path), [&] {
+                    backend.Send("fetchQuoteContent", message);
+                });
+            }
+        }
+    }
+
+    // --- 工作区列表 ---
+    void BenchListing(BenchBackend& backend, const fs::path& root) {
+        std::vector<size_t> counts = { 10000, 100000 };
+        if (BenchHarness::Config().quick) counts = { 1000 };
+
+        for (size_t count : counts) {
+            const std::string name = "list/files_" + std::to_string(count);
+            if (!BenchHarness::Enabled(name)) continue;
+
+            // 每个目录 100 个文件，目录分两层
+            fs::path workspace = root / ("list-" + std::to_string(count));
+            for (size_t i = 0; i < count; ++i) {
+                fs::path dir = workspace / ("group" + std::to_string(i / 10000)) / ("folder" + std::to_string(i / 100));
+                if (i % 100 == 0) fs::create_directories(dir);
+                std::ofstream(dir / ("page" + std::to_string(i) + ".veritnote"));
+            }
+            ResetWorkspace(backend, workspace);
+            BenchHarness::Result result = BenchHarness::Measure(name, 0, [&] {
+                backend.Send("listWorkspace");
+            }, std::chrono::milliseconds(1000), 3);
+            BenchHarness::SetItems(result, count);
+            result.counters.push_back({ "message_bytes", static_cast<double>(backend.LastMessage().size()) });
+            BenchHarness::Print(result);
+            fs::remove_all(workspace);
+        }
+    }
+
+    // --- 导出 ---
+    void BenchExport(BenchBackend& backend, const fs::path& root) {
+        fs::path workspace = root / "export";
+        fs::create_directories(workspace);
+        ResetWorkspace(backend, workspace);
+
+        BenchHarness::Run("export/prepare_libs", 0, [&] {
+            backend.Send("prepareExportLibs");
+        });
+
+        // 每个页面一条 exportPageAsHtml
+        constexpr size_t kPages = 50;
+        std::string html = "<html><body>" + MakePage(64 * KiB).dump() + "</body></html>";
+        std::vector<std::string> pageMessages;
+        for (size_t i = 0; i < kPages; ++i) {
+            fs::path page = workspace / ("section" + std::to_string(i % 5)) / ("page" + std::to_string(i) + ".veritnote");
+            pageMessages.push_back(json{ {"action", "exportPageAsHtml"}, {"payload", { {"path", page.string()}, {"html", html} }} }.dump());
+        }
+        if (BenchHarness::Enabled("export/pages_" + std::to_string(kPages))) {
+            BenchHarness::Result result = BenchHarness::Measure("export/pages_" + std::to_string(kPages), html.size() * kPages, [&] {
+                for (const auto& message : pageMessages) backend.HandleWebMessage(message);
+            });
+            BenchHarness::Print(BenchHarness::SetItems(result, kPages));
+        }
+
+        // 本地图片复制到各页面的 src 目录
+        constexpr size_t kImages = 200;
+        if (BenchHarness::Enabled("export/images_" + std::to_string(kImages))) {
+            json tasks = json::array();
+            std::string pixels(16 * KiB, '\x5a');
+            for (size_t i = 0; i < kImages; ++i) {
+                fs::path image = workspace / "assets" / ("image" + std::to_string(i) + ".png");
+                WriteText(image, pixels);
+                fs::path page = workspace / ("section" + std::to_string(i % 5)) / ("page" + std::to_string(i % kPages) + ".veritnote");
+                tasks.push_back({ {"originalSrc", image.string()}, {"pagePath", page.string()} });
+            }
+            json message = { {"tasks", tasks} };
+            BenchHarness::Result result = BenchHarness::Measure("export/images_" + std::to_string(kImages), pixels.size() * kImages, [&] {
+                backend.Send("processExportImages", message);
+            });
+            BenchHarness::Print(BenchHarness::SetItems(result, kImages));
+        }
+
+        // 数据库包：每次从切换工作区开始，包含加载、查询与分块写出
+        for (size_t rows : { 10000, 100000 }) {
+            const std::string name = "export/database_" + std::to_string(rows);
+            if (!BenchHarness::Enabled(name) || (BenchHarness::Config().quick && rows > 10000)) continue;
+
+            json embedded = json::array({ json::array({ "name", "category", "score", "note" }) });
+            for (size_t r = 0; r < rows; ++r) {
+                embedded.push_back({ "item " + std::to_string(r), "cat" + std::to_string(r % 17), static_cast<double>((r * 7919) % 1000), r % 5 == 0 ? u8"备注" : "" });
+            }
+            json presets = json::array({
+                { {"id", "all"}, {"config", json::object()} },
+                { {"id", "top"}, {"config", { {"filters", json::array({ { {"column", "score"}, {"op", "gte"}, {"value", 500} } })},
+                    {"sorts", json::array({ { {"column", "score"}, {"direction", "desc"} } })} }} },
+                { {"id", "byCategory"}, {"config", { {"groupBy", "category"} }} },
+            });
+            json database = { {"config", json::object()}, {"content", { {"data", { {"mode", "embedded"}, {"embeddedData", std::move(embedded)} }}, {"presets", std::move(presets)} }} };
+            fs::path path = workspace / "data" / ("table" + std::to_string(rows) + ".veritnotedb");
+            WriteText(path, database.dump());
+
+            json message = { {"requestId", "bench"}, {"databases", json::array({ { {"path", path.string()}, {"key", "table"} } })} };
+            BenchHarness::Result result = BenchHarness::Measure(name, 0, [&] {
+                ResetWorkspace(backend, workspace);
+                backend.Send("exportDatabaseBundles", message);
+            });
+            BenchHarness::Print(BenchHarness::SetItems(result, rows));
+        }
+
+        backend.Send("cancelExport");
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchHarness::ParseArgs(argc, argv);
+    bool printStats = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) printStats = true;
+    }
+
+    // Linux 上的 LOG_DEBUG 写到 std::cout，丢弃它以免混入结果；结果经由 stdio 输出
+    std::cout.setstate(std::ios::badbit);
+
+    fs::path root = fs::temp_directory_path() / ("veritnote-bench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(root);
+
+    {
+        BenchBackend backend;
+        ResetWorkspace(backend, root);
+
+        BenchDispatch(backend);
+        BenchFiles(backend, root);
+        BenchConfig(backend, root);
+        BenchQuote(backend, root);
+        BenchListing(backend, root);
+        BenchExport(backend, root);
+
+        if (printStats) {
+            json stats = Telemetry::Stats();
+            stats["name"] = "backend_stats";
+            std::printf("%s\n", stats.dump().c_str());
+        }
+    }
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    return 0;
+}
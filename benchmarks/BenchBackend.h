@@ -0,0 +1,185 @@
+﻿// benchmarks/BenchBackend.h
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+#include "include/Backend.h"
+#include "include/DurableStorage.h"
+#include "include/FileAccess.h"
+#include "include/PageFormat.h"
+#include "include/Telemetry.h"
+#include "include/Utf.h"
+#include <resources.h>
+
+// 基准测试用的平台后端。
+// 发往前端的消息照常序列化并计数，但只保留最后一条，不离开进程；
+// 文件读写与 WinBackend 一样走真实文件系统（DurableStorage / FileAccess / SaveJournal 在 POSIX 上同样可用）；
+// 窗口、对话框与网络下载为空实现。内置资源从源码中的 webview_ui 目录读取（VERITNOTE_WEB_ASSETS_DIR）
+class BenchBackend : public Backend {
+public:
+    void Send(const std::string& action, const json& payload = json::object()) {
+        HandleWebMessage(json{ {"action", action}, {"payload", payload} }.dump());
+    }
+
+    size_t MessagesSent() const { return m_messagesSent; }
+    size_t BytesSent() const { return m_bytesSent; }
+    // 最后一条发往前端的消息（原始 JSON 文本），用于在计时之外检查结果
+    const std::string& LastMessage() const { return m_lastMessage; }
+
+protected:
+    void SendMessageToJS(const json& message) override {
+        std::string json_str;
+        {
+            Telemetry::Span span("dumpMessage", "json");
+            json_str = message.dump();
+        }
+        Telemetry::RecordMessageOut(json_str.size());
+        ++m_messagesSent;
+        m_bytesSent += json_str.size();
+        m_lastMessage = std::move(json_str);
+    }
+
+    void OpenFileDialog(const json& /*payload*/) override {}
+    void OpenWorkspaceDialog() override {}
+    void NavigateTo(const std::wstring& /*url*/) override {}
+    void ToggleFullscreen() override {}
+    void MinimizeWindow() override {}
+    void MaximizeWindow() override {}
+    void CloseWindow() override {}
+    void StartWindowDrag() override {}
+    void CheckWindowState() override {}
+    bool IsFullscreen() const override { return false; }
+    bool DownloadFile(const std::wstring& /*url*/, const std::filesystem::path& /*destination*/, std::function<void(int)> /*onProgress*/) override { return false; }
+
+    bool LoadResourceData(int resource_id, void*& pData, DWORD& dwSize) override {
+        int index = resource_id - RESOURCE_ID_BASE;
+        if (index < 0 || index >= RESOURCE_COUNT) return false;
+        auto it = m_resources.find(resource_id);
+        if (it == m_resources.end()) {
+            std::ifstream file(std::filesystem::path(VERITNOTE_WEB_ASSETS_DIR) / std::filesystem::path(g_resource_paths[index]).relative_path(), std::ios::binary);
+            if (!file) return false;
+            it = m_resources.emplace(resource_id, std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>())).first;
+        }
+        pData = it->second.data();
+        dwSize = static_cast<DWORD>(it->second.size());
+        return true;
+    }
+
+    std::wstring string_to_wstring(const std::string& str) const override { return Utf::ToWide(str); }
+    std::string wstring_to_string(const std::wstring& wstr) const override { return Utf::ToUtf8(wstr); }
+
+    bool UrlDecode(const std::string& encoded, std::string& decoded) const override {
+        decoded.clear();
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            if (encoded[i] != '%') {
+                decoded.push_back(encoded[i] == '+' ? ' ' : encoded[i]);
+                continue;
+            }
+            if (i + 2 >= encoded.size()) return false;
+            decoded.push_back(static_cast<char>(std::stoi(encoded.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        }
+        return true;
+    }
+
+    std::string ReadFileContent(const std::wstring& path) override {
+        Telemetry::Span span("readFile", "io");
+        std::string content;
+        if (m_saveJournal.HasJournal(path) && m_saveJournal.Recover(path, content)) {
+            return content;
+        }
+        return DurableStorage::ReadWholeFile(path, content) ? content : std::string();
+    }
+
+    bool WriteFileContent(const std::wstring& path, const std::string& content) override {
+        Telemetry::Span span("writeFile", "io");
+        if (m_saveJournal.HasJournal(path)) {
+            m_saveJournal.Append(path, content);
+            if (!DurableStorage::AtomicWriteFile(path, content)) return false;
+            m_saveJournal.Discard(path);
+            return true;
+        }
+        return DurableStorage::AtomicWriteFile(path, content);
+    }
+
+    bool WriteFileContentJournaled(const std::wstring& path, const std::string& content) override {
+        Telemetry::Span span("writeJournal", "io");
+        return m_saveJournal.Append(path, content);
+    }
+
+    bool WriteFilePatch(const std::wstring& path, const std::string& patch, const std::function<std::string()>& snapshot) override {
+        Telemetry::Span span("writePatch", "io");
+        return m_saveJournal.AppendPatch(path, patch, snapshot);
+    }
+
+    bool SupportsBinaryFiles() const override { return true; }
+
+    bool GetFileStat(const std::wstring& path, FileAccess::FileStat& stat) override {
+        return FileAccess::StatFile(path, stat);
+    }
+
+    bool ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) override {
+        Telemetry::Span span("readFileChunks", "io");
+        constexpr size_t kChunkSize = 4 * 1024 * 1024;
+        FileAccess::MappedFile file;
+        if (!file.Open(path)) return false;
+        std::string_view view = file.View();
+        for (size_t offset = 0; offset < view.size(); offset += kChunkSize) {
+            if (!sink(view.substr(offset, kChunkSize))) break;
+        }
+        return true;
+    }
+
+    bool WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) override {
+        Telemetry::Span span("writeFileStreamed", "io");
+        return DurableStorage::AtomicWriteFileStreamed(path, produce);
+    }
+
+    void CreateItem(const json& /*payload*/) override {}
+    void DeleteItem(const json& /*payload*/) override {}
+    void EnsureWorkspaceConfigs(const json& /*payload*/) override {}
+
+    json ReadJsonFile(const std::wstring& identifier) override {
+        try {
+            if (m_saveJournal.HasJournal(identifier)) {
+                std::string content = ReadFileContent(identifier);
+                return content.empty() ? json::object() : PageFormat::Parse(content);
+            }
+            FileAccess::MappedFile file;
+            if (!file.Open(identifier) || file.View().empty()) return json::object();
+            return PageFormat::Parse(file.View());
+        }
+        catch (...) {
+            return json::object();
+        }
+    }
+
+    void WriteJsonFile(const std::wstring& identifier, const json& data) override {
+        bool binary = false;
+        {
+            FileAccess::MappedFile existing;
+            binary = existing.Open(identifier) && PageFormat::IsBinary(existing.View());
+        }
+        WriteFileContent(identifier, PageFormat::Serialize(data, binary));
+    }
+
+    std::wstring GetParentIdentifier(const std::wstring& identifier) override {
+        return std::filesystem::path(identifier).parent_path().wstring();
+    }
+
+    std::wstring CombineIdentifier(const std::wstring& parent, const std::wstring& childFilename) override {
+        return (std::filesystem::path(parent) / childFilename).wstring();
+    }
+
+private:
+    size_t m_messagesSent = 0;
+    size_t m_bytesSent = 0;
+    std::string m_lastMessage;
+    std::unordered_map<int, std::string> m_resources;
+    SaveJournal m_saveJournal;
+};
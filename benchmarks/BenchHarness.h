@@ -0,0 +1,124 @@
+﻿// benchmarks/BenchHarness.h
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 基准测试的计时与输出：每个用例先预热一次，再重复运行直到累计时间超过 minTime（至少 minIterations 次），
+// 结果以一行一个 JSON 对象输出到 stdout，便于脚本收集和回归对比。
+// 命令行参数（ParseArgs）：
+//   --filter=<子串>  只运行名称包含该子串的用例（也可以直接写子串）
+//   --quick          缩短计时并跳过最大的输入，用于快速确认改动前后的趋势
+namespace BenchHarness {
+    struct Options {
+        std::string filter;
+        bool quick = false;
+    };
+
+    inline Options& Config() {
+        static Options options;
+        return options;
+    }
+
+    inline void ParseArgs(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--quick") == 0) {
+                Config().quick = true;
+            }
+            else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+                Config().filter = argv[i] + 9;
+            }
+            else if (argv[i][0] != '-') {
+                Config().filter = argv[i];
+            }
+        }
+    }
+
+    // 用例是否需要运行；代价高的准备工作（生成文件等）应在其所有用例都不运行时跳过
+    inline bool Enabled(const std::string& name) {
+        const std::string& filter = Config().filter;
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    struct Result {
+        std::string name;
+        size_t iterations = 0;
+        double meanNs = 0;
+        double minNs = 0;
+        double bytesPerSecond = 0; // bytes 为 0 时不输出
+        double itemsPerSecond = 0; // 见 SetItems
+        std::vector<std::pair<std::string, double>> counters; // 附加的数值字段，原样输出
+    };
+
+    template <typename Fn>
+    Result Measure(const std::string& name, size_t bytes, Fn&& fn,
+        std::chrono::milliseconds minTime = std::chrono::milliseconds(300), size_t minIterations = 5) {
+        using Clock = std::chrono::steady_clock;
+        if (Config().quick) {
+            minTime = std::min(minTime, std::chrono::milliseconds(50));
+            minIterations = std::min<size_t>(minIterations, 2);
+        }
+        fn(); // 预热
+
+        Result result;
+        result.name = name;
+        double total = 0;
+        double best = 0;
+        while (result.iterations < minIterations || total < std::chrono::duration<double, std::nano>(minTime).count()) {
+            auto start = Clock::now();
+            fn();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            total += ns;
+            best = result.iterations == 0 ? ns : std::min(best, ns);
+            ++result.iterations;
+        }
+        result.meanNs = total / static_cast<double>(result.iterations);
+        result.minNs = best;
+        if (bytes > 0 && result.meanNs > 0) {
+            result.bytesPerSecond = static_cast<double>(bytes) * 1e9 / result.meanNs;
+        }
+        return result;
+    }
+
+    // 每次迭代处理的条目数（文件、行、块等），输出为 items_per_s
+    inline Result& SetItems(Result& result, size_t items) {
+        if (result.meanNs > 0) {
+            result.itemsPerSecond = static_cast<double>(items) * 1e9 / result.meanNs;
+        }
+        return result;
+    }
+
+    inline void Print(const Result& result) {
+        std::printf("{\"name\": \"%s\", \"iterations\": %zu, \"mean_ns\": %.0f, \"min_ns\": %.0f",
+            result.name.c_str(), result.iterations, result.meanNs, result.minNs);
+        if (result.bytesPerSecond > 0) {
+            std::printf(", \"mb_per_s\": %.1f", result.bytesPerSecond / (1024.0 * 1024.0));
+        }
+        if (result.itemsPerSecond > 0) {
+            std::printf(", \"items_per_s\": %.1f", result.itemsPerSecond);
+        }
+        for (const auto& [key, value] : result.counters) {
+            std::printf(", \"%s\": %.17g", key.c_str(), value);
+        }
+        std::printf("}\n");
+        std::fflush(stdout);
+    }
+
+    // 用例需要运行时测量并输出
+    template <typename Fn>
+    void Run(const std::string& name, size_t bytes, Fn&& fn) {
+        if (Enabled(name)) Print(Measure(name, bytes, std::forward<Fn>(fn)));
+    }
+
+    // 防止被测结果被优化掉
+    template <typename T>
+    void Consume(const T& value) {
+        static volatile size_t sink;
+        sink = sink + value.size();
+    }
+}
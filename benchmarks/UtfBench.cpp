@@ -0,0 +1,79 @@
+﻿// benchmarks/UtfBench.cpp
+// Utf::ToWide / Utf::ToUtf8 对比此前 AndroidBackend 使用的 std::wstring_convert<std::codecvt_utf8<wchar_t>>
+
+#include <codecvt>
+#include <locale>
+#include <string>
+
+#include "BenchHarness.h"
+#include "include/Utf.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#elif defined(_MSC_VER)
+#pragma warning(disable : 4996)
+#endif
+
+namespace {
+    std::string Repeat(const std::string& unit, size_t bytes) {
+        std::string out;
+        out.reserve(bytes + unit.size());
+        while (out.size() < bytes) out += unit;
+        return out;
+    }
+
+    struct Payload {
+        const char* name;
+        std::string utf8;
+    };
+
+    // 每次调用都构造转换器，与原实现一致
+    std::wstring CodecvtToWide(const std::string& str) {
+        std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
+        return converter.from_bytes(str);
+    }
+
+    std::string CodecvtToUtf8(const std::wstring& wstr) {
+        std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
+        return converter.to_bytes(wstr);
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchHarness::ParseArgs(argc, argv);
+
+    const Payload payloads[] = {
+        // 典型的工作区路径 / 标识符
+        { "path", "content://com.android.externalstorage.documents/tree/primary%3ANotes/document/primary%3ANotes%2Fpage.veritnote" },
+        // 英文为主的页面 JSON
+        { "ascii_64k", Repeat("{\"type\":\"paragraph\",\"content\":\"The quick brown fox jumps over the lazy dog.\"},", 64 * 1024) },
+        // 中文页面
+        { "cjk_64k", Repeat(u8"{\"type\":\"paragraph\",\"content\":\"敏捷的棕色狐狸跳过了懒狗。\"},", 64 * 1024) },
+        // 含补充平面字符 (emoji) 的大页面
+        { "mixed_4m", Repeat(u8"Notes 笔记 \U0001F4DD mixed text with emoji \U0001F600 and accents é ü. ", 4 * 1024 * 1024) },
+    };
+
+    for (const Payload& payload : payloads) {
+        const std::string& utf8 = payload.utf8;
+        const std::wstring wide = Utf::ToWide(utf8);
+        const std::string prefix = std::string("utf/") + payload.name;
+
+        BenchHarness::Run(prefix + "/to_wide/codecvt", utf8.size(), [&] {
+            BenchHarness::Consume(CodecvtToWide(utf8));
+        });
+        BenchHarness::Run(prefix + "/to_wide/utf", utf8.size(), [&] {
+            BenchHarness::Consume(Utf::ToWide(utf8));
+        });
+        BenchHarness::Run(prefix + "/to_utf8/codecvt", utf8.size(), [&] {
+            BenchHarness::Consume(CodecvtToUtf8(wide));
+        });
+        BenchHarness::Run(prefix + "/to_utf8/utf", utf8.size(), [&] {
+            BenchHarness::Consume(Utf::ToUtf8(wide));
+        });
+        // JNI 边界上的 UTF-16 转换
+        BenchHarness::Run(prefix + "/to_utf16/utf", utf8.size(), [&] {
+            BenchHarness::Consume(Utf::ToUtf16(utf8));
+        });
+    }
+    return 0;
+}
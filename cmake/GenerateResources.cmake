@@ -12,8 +12,11 @@ if(TARGET_IS_WINDOWS)
 endif()
 
 # 3. 遍历每个资源文件
-set(RESOURCE_ID_COUNTER 1000)
+set(RESOURCE_ID_BASE 1000)
+set(RESOURCE_ID_COUNTER ${RESOURCE_ID_BASE})
 set(RESOURCE_MAP_CONTENT "static std::map<std::wstring, int> g_resource_map = {\n")
+# ID -> 路径的顺序表，下标为 ID - RESOURCE_ID_BASE，用于按 ID 直接查找路径 (Android 的 asset 路径)
+set(RESOURCE_PATHS_CONTENT "static const char* const g_resource_paths[] = {\n")
 
 foreach(ASSET_PATH ${ASSET_PATHS_PROCESSED})
     # 计算相对于处理后目录的相对路径
@@ -28,6 +31,7 @@ foreach(ASSET_PATH ${ASSET_PATHS_PROCESSED})
     # 准备map内容 (所有平台都需要)
     string(REPLACE "\\" "\\\\" URL_PATH_ESCAPED ${URL_PATH})
     set(RESOURCE_MAP_CONTENT "${RESOURCE_MAP_CONTENT}    {L\"${URL_PATH_ESCAPED}\", ${ID_NAME}},\n")
+    set(RESOURCE_PATHS_CONTENT "${RESOURCE_PATHS_CONTENT}    \"${URL_PATH_ESCAPED}\",\n")
 
     # --- 只在目标是 Windows 时才生成 RC 文件内容 ---
     if(TARGET_IS_WINDOWS)
@@ -44,6 +48,12 @@ endforeach()
 set(RESOURCE_MAP_CONTENT "${RESOURCE_MAP_CONTENT}};\n")
 file(APPEND ${RESOURCE_H} "\n${RESOURCE_MAP_CONTENT}")
 
+# 5. 写入 ID -> 路径表；末尾的 nullptr 保证资源为空时数组仍然合法
+math(EXPR RESOURCE_COUNT "${RESOURCE_ID_COUNTER} - ${RESOURCE_ID_BASE}")
+set(RESOURCE_PATHS_CONTENT "${RESOURCE_PATHS_CONTENT}    nullptr\n};\n")
+file(APPEND ${RESOURCE_H} "\n#define RESOURCE_ID_BASE ${RESOURCE_ID_BASE}\n#define RESOURCE_COUNT ${RESOURCE_COUNT}\n")
+file(APPEND ${RESOURCE_H} "${RESOURCE_PATHS_CONTENT}")
+
 if(TARGET_IS_WINDOWS)
     message(STATUS "Generated Windows resource files: ${RESOURCE_H} and ${RESOURCE_RC}")
 else()
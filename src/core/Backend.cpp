@@ -9,6 +9,13 @@
 
 #include "include/Backend.h"
 #include "include/Platform.h"
+#include "include/PageFormat.h"
+#include "include/CsvParser.h"
+#include "include/ColumnIndex.h"
+#include "include/ColumnStore.h"
+#include "include/DatabaseExport.h"
+#include "include/QueryEngine.h"
+#include "include/Telemetry.h"
 #include <resources.h>
 
 #ifdef _WIN32
@@ -60,16 +67,29 @@ std::wstring g_nextWorkspacePath = L"";
 void Backend::HandleWebMessage(const std::string& message) {
     try {
         // WebView2 发来的是 JSON 字符串，先解析
-        auto json_msg = json::parse(message);
+        json json_msg;
+        {
+            Telemetry::Span span("parseMessage", "json");
+            json_msg = json::parse(message);
+        }
         std::string action = json_msg.value("action", "");
         json payload = json_msg.value("payload", json::object());
+        // 析构时记录本次处理的耗时，期间发出的消息计入该 action
+        Telemetry::ActionScope scope(action, message.size());
 
-        std::string log_msg = "C++ [Backend]: Received action '" + message + "'";
+        // 只记录 action 与大小，消息本身可能是整个页面
+        std::string log_msg = "C++ [Backend]: Received action '" + action + "' (" + std::to_string(message.size()) + " bytes)";
         LOG_DEBUG(log_msg.c_str());
 
         if (action == "setWorkspace") {
             std::string path_str = payload.value("path", "");
             m_workspaceRoot = this->string_to_wstring(path_str);
+            m_paths.Reset(m_workspaceRoot);
+            m_configCache.Clear();
+            m_documentCache.clear();
+            m_tableStore.Clear();
+            m_queryCursors.Clear();
+            m_queryResults.Clear();
         }
         else if (action == "jsReady") {
             // JS in index.html is ready and has already sent its workspace path.
@@ -92,6 +112,15 @@ void Backend::HandleWebMessage(const std::string& message) {
         else if (action == "saveFile") {
             SaveFile(payload);
 		}
+        else if (action == "patchFile") {
+            PatchFile(payload);
+        }
+        else if (action == "convertFileFormat") {
+            ConvertFileFormat(payload);
+        }
+        else if (action == "convertDatabaseStorage") {
+            ConvertDatabaseStorage(payload);
+        }
 		else if (action == "readFileConfig") {
             ReadFileConfig(payload);
         }
@@ -102,13 +131,19 @@ void Backend::HandleWebMessage(const std::string& message) {
         else if (action == "exportPageAsHtml") {
             ExportPageAsHtml(payload);
         }
-        else if (action == "exportDatabaseAsJs") {
-            ExportDatabaseAsJs(payload);
+        else if (action == "exportDatabaseBundles") {
+            ExportDatabaseBundles(payload);
         }
         else if (action == "createItem") {
             CreateItem(payload);
         }
         else if (action == "deleteItem") {
+            // 被删除的目录可能以同名重建，整体丢弃目录配置缓存
+            m_configCache.Clear();
+            m_documentCache.clear();
+            m_tableStore.Clear();
+            m_queryCursors.Clear();
+            m_queryResults.Clear();
             DeleteItem(payload);
         }
         else if (action == "openFileDialog") {
@@ -156,7 +191,23 @@ void Backend::HandleWebMessage(const std::string& message) {
         else if (action == "fetchDataContent") {
             FetchDataContent(payload);
         }
+        else if (action == "parseCsv") {
+            ParseCsv(payload);
+        }
+        else if (action == "queryData") {
+            QueryData(payload);
+        }
+        else if (action == "openQuery") {
+            OpenQuery(payload);
+        }
+        else if (action == "fetchRows") {
+            FetchRows(payload);
+        }
+        else if (action == "closeQuery") {
+            m_queryCursors.Close(payload.value("cursorId", static_cast<uint64_t>(0)));
+        }
         else if (action == "ensureWorkspaceConfigs") {
+            m_configCache.Clear();
             EnsureWorkspaceConfigs(payload);
         }
         else if (action == "readConfigFile") {
@@ -168,30 +219,47 @@ void Backend::HandleWebMessage(const std::string& message) {
         else if (action == "resolveFileConfiguration") {
             ResolveFileConfiguration(payload);
         }
+        else if (action == "resolveFileConfigurations") {
+            ResolveFileConfigurations(payload);
+        }
+        else if (action == "getBackendStats") {
+            GetBackendStats(payload);
+        }
         else {
             std::cout << "Unknown Action: " + action << std::endl;
         }
     }
     catch (const json::parse_error& e) {
         // JSON 解析失败
+        Telemetry::RecordAction("<invalid>", 0, message.size());
+    }
+}
+
+void Backend::GetBackendStats(const json& payload) {
+    if (payload.contains("tracing") && payload["tracing"].is_boolean()) {
+        Telemetry::SetTracing(payload["tracing"].get<bool>());
+    }
+
+    json response;
+    response["action"] = "backendStats";
+    response["payload"] = Telemetry::Stats();
+    response["payload"]["requestId"] = payload.value("requestId", "");
+    if (payload.value("trace", false)) {
+        response["payload"]["trace"] = Telemetry::Trace();
     }
+    if (payload.value("reset", false)) {
+        Telemetry::Reset();
+    }
+    SendMessageToJS(response);
 }
 
 void Backend::ExportPageAsHtml(const json& payload) {
+    Telemetry::Span span("exportPage", "export");
     try {
-        std::string sourcePathStr = payload.value("path", "");
         std::string htmlContent = payload.value("html", "");
 
-        std::filesystem::path sourcePath(sourcePathStr);
-        std::filesystem::path workspacePath(m_workspaceRoot);
-        std::filesystem::path buildPath = workspacePath / "build";
-
-        // 计算相对路径
-        std::filesystem::path relativePath = std::filesystem::relative(sourcePath, workspacePath);
-
-        // 构建目标路径
-        std::filesystem::path targetPath = buildPath / relativePath;
-        targetPath.replace_extension(".html");
+        // 构建目标路径（相对路径在页面第一次导出时计算并驻留，图片处理时直接复用）
+        std::filesystem::path targetPath = m_paths.BuildTarget(m_paths.Intern(payload.value("path", "")), L".html");
 
         // 如果需要，创建父目录
         if (targetPath.has_parent_path()) {
@@ -208,42 +276,87 @@ void Backend::ExportPageAsHtml(const json& payload) {
     }
 }
 
-void Backend::ExportDatabaseAsJs(const json& payload) {
-    try {
-        std::string sourcePathStr = payload.value("path", "");
-        std::string jsContent = payload.value("js", "");
-
-        std::filesystem::path sourcePath(sourcePathStr);
-        std::filesystem::path workspacePath(m_workspaceRoot);
-        std::filesystem::path buildPath = workspacePath / "build";
+void Backend::ExportDatabaseBundles(const json& payload) {
+    Telemetry::Span span("exportDatabaseBundles", "export");
+    size_t chunkRows = payload.value("chunkRows", DatabaseExport::kDefaultChunkRows);
 
-        // 计算相对路径
-        std::filesystem::path relativePath = std::filesystem::relative(sourcePath, workspacePath);
-
-        // 构建目标路径
-        std::filesystem::path targetPath = buildPath / relativePath;
-        targetPath.replace_extension(".js");
-
-        // 如果需要，创建父目录
-        if (targetPath.has_parent_path()) {
-            std::filesystem::create_directories(targetPath.parent_path());
+    json response;
+    response["action"] = "databaseBundlesExported";
+    response["payload"]["requestId"] = payload.value("requestId", "");
+    response["payload"]["results"] = json::array();
+
+    // 在当前线程上加载数据库、解析 preset 并取出已物化的结果，其余工作交给工作线程
+    struct Pending {
+        std::wstring path;
+        uint64_t dataVersion = 0;
+        size_t result = 0; // 在 response.results 中的下标
+    };
+    std::vector<DatabaseExport::Job> jobs;
+    std::vector<Pending> pending;
+    json& results = response["payload"]["results"];
+    for (const auto& item : payload.value("databases", json::array())) {
+        std::string pathStr = item.value("path", "");
+        json result = { {"path", pathStr}, {"success", false} };
+        try {
+            WorkspacePath file = m_paths.Intern(pathStr);
+            const std::wstring& path = file.Identifier();
+            std::shared_ptr<const TableStore::Entry> database = LoadDatabase(path);
+
+            DatabaseExport::Job job;
+            job.key = item.value("key", "");
+            job.target = m_paths.BuildTarget(file, L".js");
+            job.data = database->data;
+            job.presets = database->presets.is_array() ? database->presets : json::array();
+            job.source = ActiveSource(*database);
+            job.indexes = database->indexes;
+            bool hasRows = job.source.table || job.source.stored;
+            for (const auto& preset : job.presets) {
+                DatabaseExport::View view;
+                view.config = preset.is_object() ? preset.value("config", json::object()) : json::object();
+                if (hasRows) {
+                    view.spec = Query::FromPresetConfig(view.config, job.source);
+                    view.specKey = Query::SpecKey(view.spec);
+                    view.result = m_queryResults.Find(path, database->dataVersion, view.specKey);
+                }
+                job.views.push_back(std::move(view));
+            }
+            jobs.push_back(std::move(job));
+            pending.push_back({ path, database->dataVersion, results.size() });
         }
-
-        // 写入文件
-        std::ofstream file(targetPath);
-        file << jsContent;
-        file.close();
+        catch (const std::exception& e) {
+            result["error"] = e.what();
+        }
+        results.push_back(std::move(result));
     }
-    catch (const std::exception& e) {
-        LOG_DEBUG(std::string("Error exporting database as JS: " + std::string(e.what())).c_str());
+
+    std::vector<DatabaseExport::Outcome> outcomes = DatabaseExport::WriteAll(jobs, chunkRows);
+
+    bool success = true;
+    for (size_t i = 0; i < outcomes.size(); ++i) {
+        json& result = results[pending[i].result];
+        result["success"] = outcomes[i].success;
+        result["files"] = outcomes[i].files;
+        if (!outcomes[i].success) result["error"] = outcomes[i].error;
+        // 导出时执行的查询同时成为物化结果，之后在编辑器中打开这些页面不必重新计算
+        for (size_t v = 0; v < jobs[i].views.size(); ++v) {
+            const DatabaseExport::View& view = jobs[i].views[v];
+            if (!view.result && outcomes[i].results[v]) {
+                m_queryResults.Store(pending[i].path, pending[i].dataVersion, view.specKey, view.spec, outcomes[i].results[v]);
+            }
+        }
     }
+    for (const auto& result : results) success = success && result.value("success", false);
+    response["payload"]["success"] = success;
+
+    SendMessageToJS(response);
 }
 
 
 
 void Backend::PrepareExportLibs(const json& payload) {
+    Telemetry::Span span("exportLibs", "export");
     try {
-        std::filesystem::path buildPath = std::filesystem::path(m_workspaceRoot).append(L"build");
+        const std::filesystem::path& buildPath = m_paths.BuildDirectory();
 
         if (std::filesystem::exists(buildPath)) {
             std::filesystem::remove_all(buildPath);
@@ -329,6 +442,7 @@ void Backend::PrepareExportLibs(const json& payload) {
 
 // --- Implementation of the image processing function ---
 void Backend::ProcessExportImages(const json& payload) {
+    Telemetry::Span span("exportImages", "export");
     json response;
     response["action"] = "exportImagesProcessed";
     json srcMap = json::object();
@@ -339,22 +453,22 @@ void Backend::ProcessExportImages(const json& payload) {
             throw std::runtime_error("Image processing tasks must be an array.");
         }
 
-        std::filesystem::path buildPath = std::filesystem::path(m_workspaceRoot).append(L"build");
-        std::filesystem::path workspacePath(m_workspaceRoot);
+        // 同一页面的图片共用一个 src 目录，每个页面只计算并创建一次
+        std::unordered_map<WorkspacePath, std::filesystem::path> pageSrcDirs;
 
         for (const auto& task : tasks) {
             std::string originalSrc = task.at("originalSrc").get<std::string>();
-            std::string pagePathStr = task.at("pagePath").get<std::string>();
-            std::filesystem::path pagePath(pagePathStr);
+            WorkspacePath page = m_paths.Intern(task.at("pagePath").get<std::string>());
 
-            std::filesystem::path relativePagePath = std::filesystem::relative(pagePath, workspacePath);
-            std::filesystem::path targetHtmlPath = buildPath / relativePagePath;
-            targetHtmlPath.replace_extension(".html");
-            std::filesystem::path targetSrcDir = targetHtmlPath.parent_path() / "src";
-
-            if (!std::filesystem::exists(targetSrcDir)) {
-                std::filesystem::create_directories(targetSrcDir);
+            auto srcDir = pageSrcDirs.find(page);
+            if (srcDir == pageSrcDirs.end()) {
+                std::filesystem::path dir = m_paths.BuildTarget(page, L".html").parent_path() / "src";
+                if (!std::filesystem::exists(dir)) {
+                    std::filesystem::create_directories(dir);
+                }
+                srcDir = pageSrcDirs.emplace(page, std::move(dir)).first;
             }
+            const std::filesystem::path& targetSrcDir = srcDir->second;
 
             std::wstring newRelativePathStr;
             std::filesystem::path sourcePath;
@@ -393,7 +507,12 @@ void Backend::ProcessExportImages(const json& payload) {
                         });
                     };
 
-                if (DownloadFile(originalSrcW, destPath, onProgressCallback)) {
+                bool downloaded = false;
+                {
+                    Telemetry::Span download("downloadImage", "export");
+                    downloaded = DownloadFile(originalSrcW, destPath, onProgressCallback);
+                }
+                if (downloaded) {
                     newRelativePathStr = L"src/" + uniqueFilename;
                 }
                 else {
@@ -413,6 +532,7 @@ void Backend::ProcessExportImages(const json& payload) {
             else if (std::filesystem::exists(sourcePath)) {
                 std::wstring filename = sourcePath.filename().wstring();
                 std::filesystem::path destPath = targetSrcDir / filename;
+                Telemetry::Span copy("copyImage", "export");
                 std::filesystem::copy_file(sourcePath, destPath, std::filesystem::copy_options::overwrite_existing);
                 newRelativePathStr = L"src/" + filename;
             }
@@ -437,7 +557,7 @@ void Backend::ProcessExportImages(const json& payload) {
 
 void Backend::CancelExport() {
     try {
-        std::filesystem::path buildPath = std::filesystem::path(m_workspaceRoot).append(L"build");
+        const std::filesystem::path& buildPath = m_paths.BuildDirectory();
         if (std::filesystem::exists(buildPath)) {
             std::filesystem::remove_all(buildPath);
         }
@@ -451,7 +571,8 @@ void Backend::CancelExport() {
 
 void Backend::LoadFile(const json& payload) {
     std::string path_str = payload.value("path", "");
-    std::wstring path = this->string_to_wstring(path_str);
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
 
     // 通用透传上下文（解耦前端的特殊需求，如 blockIdToFocus）
     json context = payload.value("context", json::object());
@@ -461,16 +582,29 @@ void Backend::LoadFile(const json& payload) {
     response["payload"]["path"] = path_str;
     response["payload"]["context"] = context;
 
-    std::string contentStr = ReadFileContent(path);
+    std::string contentStr;
+    if (!TryReadFileContent(path, contentStr)) {
+        // 内容没有读到，不能当作空文件交给编辑器（之后的保存会覆盖原文件）
+        response["error"] = "Failed to read file.";
+        SendMessageToJS(response);
+        return;
+    }
     if (!contentStr.empty()) {
         try {
-            json fileJson = json::parse(contentStr);
+            json fileJson = ParseDocument(path, contentStr);
             response["payload"]["config"] = fileJson.value("config", json::object());
 
             // 格式统一化
             if (fileJson.contains("content")) {
                 response["payload"]["content"] = fileJson["content"];
             }
+            response["payload"]["format"] = m_binaryFiles.count(path) > 0 ? "binary" : "json";
+
+            // 记住磁盘上的版本，前端之后可以只发送相对它的增量
+            json cached;
+            cached["config"] = response["payload"]["config"];
+            cached["content"] = response["payload"].value("content", json::object());
+            response["payload"]["version"] = CacheDocument(path, std::move(cached));
         }
         catch (const std::exception& e) {
             response["error"] = std::string("JSON Parse Error: ") + e.what();
@@ -480,13 +614,15 @@ void Backend::LoadFile(const json& payload) {
         // 空文件默认结构
         response["payload"]["config"] = json::object();
         response["payload"]["content"] = json::object(); // 前端再根据具体编辑器自行决定空状态
+        ForgetDocument(path);
     }
     SendMessageToJS(response);
 }
 
 void Backend::SaveFile(const json& payload) {
     std::string path_str = payload.value("path", "");
-    std::wstring path = this->string_to_wstring(path_str);
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
 
     // 格式统一化
     json config = payload.value("config", json::object());
@@ -496,20 +632,186 @@ void Backend::SaveFile(const json& payload) {
     fileContent["config"] = config;
     fileContent["content"] = content;
 
-    bool success = WriteFileContent(path, fileContent.dump(2));
+    // journal: 前端的高频自动保存可以只追加日志，由后端择机压缩回原文件
+    bool journal = payload.value("journal", false);
+    std::string serialized = SerializeDocument(path, fileContent);
+    bool success = journal ? WriteFileContentJournaled(path, serialized) : WriteFileContent(path, serialized);
+    m_tableStore.Invalidate(path);
+    m_queryCursors.CloseForPath(path);
+    m_queryResults.InvalidatePath(path);
 
     json response;
     response["action"] = "fileSaved";
     response["payload"]["path"] = path_str;
     response["payload"]["success"] = success;
-    if (!success) response["error"] = "Failed to write file.";
+    if (success) {
+        response["payload"]["version"] = CacheDocument(path, std::move(fileContent));
+    }
+    else {
+        ForgetDocument(path);
+        response["error"] = "Failed to write file.";
+    }
+
+    SendMessageToJS(response);
+}
+
+void Backend::PatchFile(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
+    uint64_t baseVersion = payload.value("baseVersion", static_cast<uint64_t>(0));
+
+    json response;
+    response["action"] = "fileSaved";
+    response["payload"]["path"] = path_str;
+
+    auto it = m_documentCache.find(path);
+    if (it != m_documentCache.end() && it->second.hasStat) {
+        // 文件在外部被改写后，增量记录的基准已不可信
+        FileAccess::FileStat current;
+        if (!GetFileStat(path, current) || current != it->second.stat) {
+            m_documentCache.erase(it);
+            it = m_documentCache.end();
+        }
+    }
+    if (it == m_documentCache.end() || it->second.version != baseVersion) {
+        // 后端没有与前端一致的基准，要求前端退回到完整保存
+        response["payload"]["success"] = false;
+        response["payload"]["needsFullSave"] = true;
+        SendMessageToJS(response);
+        return;
+    }
+
+    bool success = false;
+    try {
+        const json& ops = payload.at("ops");
+        if (!ops.is_array()) {
+            throw std::runtime_error("Patch ops must be an array.");
+        }
+        if (ops.empty()) {
+            success = true;
+        }
+        else {
+            json patched = it->second.document.patch(ops);
+            const json& document = patched;
+            success = WriteFilePatch(path, ops.dump(), [this, &path, &document] { return SerializeDocument(path, document); });
+            // 只改动 presets 或个别行时沿用已加载的数据库，物化的查询结果随之增量更新
+            if (!success || !it->second.hasStat || !RefreshDatabase(path, ops, document, it->second.stat)) {
+                m_tableStore.Invalidate(path);
+                m_queryResults.InvalidatePath(path);
+            }
+            m_queryCursors.CloseForPath(path);
+            if (success) {
+                it->second.document = std::move(patched);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_DEBUG(std::string("Error applying file patch: " + std::string(e.what())).c_str());
+    }
+
+    if (success) {
+        it->second.version = ++m_documentClock;
+        it->second.lastUsed = m_documentClock;
+        it->second.hasStat = GetFileStat(path, it->second.stat);
+        response["payload"]["success"] = true;
+        response["payload"]["version"] = it->second.version;
+    }
+    else {
+        // 增量无法应用（或写入失败）时丢弃缓存，让前端发送完整内容
+        m_documentCache.erase(it);
+        response["payload"]["success"] = false;
+        response["payload"]["needsFullSave"] = true;
+    }
+    SendMessageToJS(response);
+}
+
+uint64_t Backend::CacheDocument(const std::wstring& path, json document) {
+    if (m_documentCache.size() >= kMaxCachedDocuments && m_documentCache.find(path) == m_documentCache.end()) {
+        // 淘汰最久未使用的文档
+        auto oldest = m_documentCache.begin();
+        for (auto it = m_documentCache.begin(); it != m_documentCache.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) oldest = it;
+        }
+        m_documentCache.erase(oldest);
+    }
+
+    CachedDocument& cached = m_documentCache[path];
+    cached.document = std::move(document);
+    cached.version = ++m_documentClock;
+    cached.lastUsed = m_documentClock;
+    cached.hasStat = GetFileStat(path, cached.stat);
+    return cached.version;
+}
+
+void Backend::ForgetDocument(const std::wstring& path) {
+    m_documentCache.erase(path);
+}
+
+json Backend::ParseDocument(const std::wstring& path, std::string_view bytes) {
+    Telemetry::Span span("parseDocument", "json");
+    if (PageFormat::IsBinary(bytes)) {
+        m_binaryFiles.insert(path);
+        return PageFormat::DecodeBinary(bytes);
+    }
+    m_binaryFiles.erase(path);
+    return json::parse(bytes);
+}
+
+std::string Backend::SerializeDocument(const std::wstring& path, const json& document) const {
+    Telemetry::Span span("serializeDocument", "json");
+    bool binary = SupportsBinaryFiles() && m_binaryFiles.count(path) > 0;
+    return PageFormat::Serialize(document, binary);
+}
+
+void Backend::ConvertFileFormat(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    std::string format = payload.value("format", "json");
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
+
+    json response;
+    response["action"] = "fileFormatConverted";
+    response["payload"]["path"] = path_str;
+    response["payload"]["format"] = format;
+    response["payload"]["requestId"] = payload.value("requestId", "");
+
+    try {
+        bool toBinary = (format == "binary");
+        if (!toBinary && format != "json") {
+            throw std::runtime_error("Unknown file format: " + format);
+        }
+        if (toBinary && !SupportsBinaryFiles()) {
+            throw std::runtime_error("Binary page format is not supported on this platform.");
+        }
+
+        std::string contentStr = ReadFileContent(path);
+        json document = contentStr.empty() ? json::object() : ParseDocument(path, contentStr);
+
+        // 转换是无损的：两种格式承载同一个 JSON 值
+        if (!WriteFileContent(path, PageFormat::Serialize(document, toBinary))) {
+            throw std::runtime_error("Failed to write file.");
+        }
+        if (toBinary) {
+            m_binaryFiles.insert(path);
+        }
+        else {
+            m_binaryFiles.erase(path);
+        }
+        response["payload"]["success"] = true;
+    }
+    catch (const std::exception& e) {
+        response["payload"]["success"] = false;
+        response["payload"]["error"] = e.what();
+    }
 
     SendMessageToJS(response);
 }
 
 void Backend::ReadFileConfig(const json& payload) {
     std::string path_str = payload.value("path", "");
-    std::wstring path = this->string_to_wstring(path_str);
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
 
     json response;
     response["action"] = "fileConfigRead";
@@ -518,7 +820,7 @@ void Backend::ReadFileConfig(const json& payload) {
     std::string contentStr = ReadFileContent(path);
     if (!contentStr.empty()) {
         try {
-            json fileJson = json::parse(contentStr);
+            json fileJson = ParseDocument(path, contentStr);
             response["payload"]["config"] = fileJson.value("config", json::object());
         }
         catch (const std::exception& e) {
@@ -534,7 +836,8 @@ void Backend::ReadFileConfig(const json& payload) {
 
 void Backend::WriteFileConfig(const json& payload) {
     std::string path_str = payload.value("path", "");
-    std::wstring path = this->string_to_wstring(path_str);
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
     json newConfig = payload.value("config", json::object());
 
     json fileContent = json::object();
@@ -543,7 +846,7 @@ void Backend::WriteFileConfig(const json& payload) {
     // 1. 读取并保留原有文件内容（尤其是 content）
     if (!contentStr.empty()) {
         try {
-            fileContent = json::parse(contentStr);
+            fileContent = ParseDocument(path, contentStr);
         }
         catch (...) {
             // 如果文件损坏，依然初始化为一个对象
@@ -554,7 +857,9 @@ void Backend::WriteFileConfig(const json& payload) {
     fileContent["config"] = newConfig;
 
     // 3. 写入文件
-    bool success = WriteFileContent(path, fileContent.dump(2));
+    bool success = WriteFileContent(path, SerializeDocument(path, fileContent));
+    // 文件在前端编辑器之外被修改，已缓存的增量基准失效
+    ForgetDocument(path);
 
     json response;
     response["action"] = "fileConfigWritten";
@@ -586,9 +891,34 @@ void Backend::FetchQuoteContent(const json& payload) {
             filePathStr = referenceLink;
         }
 
-        std::string content = ReadFileContent(this->string_to_wstring(filePathStr));
+        WorkspacePath file = m_paths.Intern(filePathStr);
+        const std::wstring& filePath = file.Identifier();
+        std::string content = ReadFileContent(filePath);
+
+        // 二进制页面引用单个块时，借助偏移表逐个解码顶层块，找到即停
+        PageFormat::BinaryReader reader;
+        if (!blockId.empty() && reader.Open(content)) {
+            json foundBlock = nullptr;
+            std::function<void(const json&)> find_in =
+                [&](const json& block) {
+                if (foundBlock != nullptr) return;
+                if (block.value("id", "") == blockId) {
+                    foundBlock = block;
+                    return;
+                }
+                if (block.contains("children") && block["children"].is_array()) {
+                    for (const auto& child : block["children"]) find_in(child);
+                }
+                };
+            for (size_t i = 0; i < reader.BlockCount() && foundBlock == nullptr; ++i) {
+                find_in(reader.Block(i));
+            }
+            response["payload"]["content"] = foundBlock != nullptr ? json::array({ foundBlock }) : json::array();
+            SendMessageToJS(response);
+            return;
+        }
 
-        json pageJson = json::parse(content); // This can be an array (old) or an object (new)
+        json pageJson = ParseDocument(filePath, content); // This can be an array (old) or an object (new)
 
         // --- START OF FIX ---
 
@@ -652,6 +982,10 @@ void Backend::FetchQuoteContent(const json& payload) {
 void Backend::FetchDataContent(const json& payload) {
     std::string path_str = payload.value("path", "");
     std::string dataBlockId = payload.value("dataBlockId", "");
+    // headerOnly: 行数据留在后端（由 openQuery / fetchRows 分页获取），只下发首行和行数
+    bool headerOnly = payload.value("headerOnly", false);
+    // knownHandle: 前端共享缓存中已有内容的 handle，与当前版本一致时不再重复下发
+    std::string knownHandle = payload.value("knownHandle", "");
 
     json response;
     response["action"] = "dataContentFetched";
@@ -659,52 +993,830 @@ void Backend::FetchDataContent(const json& payload) {
     response["payload"]["dataBlockId"] = dataBlockId;
 
     // 读取前端传来的绝对路径文件
-    std::string file_content = ReadFileContent(this->string_to_wstring(path_str));
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
 
     try {
-        json fullJson = json::parse(file_content);
+        // 同一数据库只解析一次，多个 DataBlock 共用列式缓存
+        std::shared_ptr<const TableStore::Entry> database = LoadDatabase(path);
+
+        std::string handle = std::to_string(database->version) + (headerOnly ? "h" : "f");
+        response["payload"]["handle"] = handle;
+        if (!knownHandle.empty() && knownHandle == handle) {
+            response["payload"]["unchanged"] = true;
+            SendMessageToJS(response);
+            return;
+        }
+
         json filteredJson;
+        filteredJson["data"] = database->data;
+        Query::Source source = ActiveSource(*database);
+        if (headerOnly && (source.table || source.stored)) {
+            filteredJson["firstRow"] = source.FirstRow().is_null() ? json::array() : source.FirstRow();
+            filteredJson["rowCount"] = source.RowCount();
+            filteredJson["columns"] = source.DescribeColumns();
+        }
+        else if (database->stored) {
+            // 列式存储的完整行只在导出等需要全部数据的场合才还原
+            filteredJson["data"]["embeddedData"] = database->stored->ToRows();
+            filteredJson["columns"] = database->stored->DescribeColumns();
+        }
+        else if (database->table) {
+            filteredJson["data"]["embeddedData"] = database->table->ToRows();
+            filteredJson["columns"] = database->table->DescribeColumns();
+        }
+        filteredJson["presets"] = database->presets;
+
+        // 作为 JSON Object 下发给前端
+        response["payload"]["content"] = filteredJson;
+    }
+    catch (const std::exception& e) {
+        // 如果文件不存在或解析失败，发送空骨架防止前端崩溃
+        response["payload"]["error"] = "Failed to parse database file: " + std::string(e.what());
+        response["payload"]["content"] = json::object({ {"data", json::object()}, {"presets", json::array()} });
+    }
+
+    SendMessageToJS(response);
+}
+
+std::shared_ptr<const TableStore::Entry> Backend::LoadDatabase(const std::wstring& path) {
+    FileAccess::FileStat stat;
+    bool hasStat = GetFileStat(path, stat);
+
+    std::shared_ptr<const TableStore::Entry> cached = m_tableStore.Find(path);
+    if (cached && cached->hasStat && !hasStat) {
+        // 缓存时能获取状态、现在却不能：文件已被删除或重命名，不能再返回旧的行数据
+        m_tableStore.Invalidate(path);
+        throw std::runtime_error("Database file no longer exists.");
+    }
+    // 无法获取文件状态的平台依赖保存时的显式失效
+    if (cached && (!cached->hasStat || cached->stat == stat)) {
+        FileAccess::FileStat sourceStat;
+        bool sourceFresh = cached->sourcePath.empty() || !cached->hasSourceStat ||
+            (GetFileStat(cached->sourcePath, sourceStat) && sourceStat == cached->sourceStat);
+        if (sourceFresh) {
+            return cached;
+        }
+        // 数据源（.columns / 外部 CSV）已变化或不存在，下面重新载入时会报告错误
+        m_tableStore.Invalidate(path);
+    }
+
+    json fullJson = ParseDocument(path, ReadFileContent(path));
+
+    auto entry = std::make_shared<TableStore::Entry>();
+    entry->version = ++m_databaseVersion;
+    entry->dataVersion = entry->version;
+    entry->stat = stat;
+    entry->hasStat = hasStat;
+    entry->data = json::object();
+    entry->presets = json::array();
+
+    // 仅提取 data / presets 节点
+    if (fullJson.contains("content")) {
+        json& content = fullJson["content"];
+        if (content.contains("data") && content["data"].is_object()) {
+            entry->data = std::move(content["data"]);
+        }
+        if (content.contains("presets")) {
+            entry->presets = std::move(content["presets"]);
+        }
+    }
+
+    // 行数据转为列式存储，JSON 形式的行随 fullJson 一起释放
+    if (entry->data.contains("embeddedData")) {
+        entry->table = ColumnTable::FromRows(entry->data["embeddedData"]);
+        entry->data.erase("embeddedData");
+    }
+
+    // external 模式：工作区内的 CSV 同样载入列式表（网络地址仍由前端获取）
+    std::string externalUrl = entry->data.value("externalUrl", "");
+    if (entry->data.value("mode", "") == "external" && !externalUrl.empty() &&
+        externalUrl.rfind("http://", 0) != 0 && externalUrl.rfind("https://", 0) != 0) {
+        entry->sourcePath = ResolveWorkspacePath(externalUrl);
+        entry->hasSourceStat = GetFileStat(entry->sourcePath, entry->sourceStat);
+        const std::wstring& sourcePath = entry->sourcePath;
+        entry->externalTable = ColumnTable::FromCsv([this, &sourcePath](const std::function<bool(std::string_view)>& sink) {
+            return ReadFileChunks(sourcePath, sink);
+        });
+    }
+
+    // 列式存储：行数据在 "<file>.columns" 中，只映射文件、解析 footer，行组在查询时才解码
+    if (entry->data.value("mode", "embedded") != "external" && entry->data.value("storage", "") == "columnar") {
+        if (!SupportsBinaryFiles()) {
+            throw std::runtime_error("Columnar storage is not supported on this platform.");
+        }
+        entry->sourcePath = ColumnStore::PathFor(path).wstring();
+        entry->hasSourceStat = GetFileStat(entry->sourcePath, entry->sourceStat);
+        entry->stored = ColumnStore::StoredTable::Open(LocalFilePath(entry->sourcePath));
+        if (!entry->stored) {
+            throw std::runtime_error("Failed to open columnar storage file.");
+        }
+    }
+
+    LoadIndexes(path, *entry);
+
+    m_tableStore.Store(path, entry);
+    return entry;
+}
+
+void Backend::LoadIndexes(const std::wstring& path, TableStore::Entry& entry) {
+    std::shared_ptr<const ColumnTable> table = ActiveTable(entry);
+    if (!table || !entry.data.contains("indexes") || !entry.data["indexes"].is_array()) {
+        return;
+    }
+
+    // 索引文件是二进制的，只在能保存二进制文件的平台上持久化，其他平台每次加载时在内存中建立
+    bool persist = SupportsBinaryFiles();
+    std::wstring indexPath = ColumnIndex::IndexPathFor(path).wstring();
+    std::vector<std::shared_ptr<const ColumnIndex>> persisted;
+    if (persist) {
+        persisted = ColumnIndex::DecodeFile(ReadFileContent(indexPath));
+    }
+
+    // 数据库保存后只有内容变化的列需要重建，其余列直接沿用索引文件中的索引
+    bool changed = false;
+    for (const auto& declared : entry.data["indexes"]) {
+        ColumnIndex::Type type;
+        if (!declared.is_object() || !declared.contains("column") || !declared["column"].is_number_unsigned()) continue;
+        if (!ColumnIndex::ParseType(declared.value("type", ""), type)) continue;
+        size_t column = declared["column"].get<size_t>();
+        if (column >= table->ColumnCount()) continue;
+
+        const ColumnTable::Column& data = table->GetColumn(column);
+        auto reusable = std::find_if(persisted.begin(), persisted.end(), [&](const std::shared_ptr<const ColumnIndex>& index) {
+            return index->ColumnIndexInTable() == column && index->GetType() == type && index->Matches(data);
+        });
+        if (reusable != persisted.end()) {
+            entry.indexes.push_back(*reusable);
+            continue;
+        }
+        std::shared_ptr<const ColumnIndex> built = ColumnIndex::Build(data, column, type);
+        if (built) {
+            entry.indexes.push_back(std::move(built));
+            changed = true;
+        }
+    }
+
+    if (persist && (changed || persisted.size() != entry.indexes.size())) {
+        WriteFileContent(indexPath, ColumnIndex::EncodeFile(entry.indexes));
+    }
+}
+
+void Backend::UpdateIndexes(const std::wstring& path, const ColumnTable& before, TableStore::Entry& entry, const std::vector<uint32_t>& changedRows) {
+    const ColumnTable& after = *entry.table;
+    std::vector<uint32_t> dataRows;
+    for (uint32_t row : changedRows) {
+        if (after.HasFirstRow() && row == 0) continue;
+        dataRows.push_back(row - (after.HasFirstRow() ? 1 : 0));
+    }
+
+    bool changed = false;
+    std::vector<std::shared_ptr<const ColumnIndex>> updated;
+    for (const auto& index : entry.indexes) {
+        size_t column = index->ColumnIndexInTable();
+        if (column >= after.ColumnCount()) {
+            // 最宽的行被改窄，这一列已不存在
+            changed = true;
+            continue;
+        }
+        const ColumnTable::Column& data = after.GetColumn(column);
+        const ColumnTable::Column& old = before.GetColumn(column);
+        bool affected = data.GetKind() != old.GetKind() || std::any_of(dataRows.begin(), dataRows.end(), [&](uint32_t row) {
+            return row >= old.Size() || old.ValueAt(row) != data.ValueAt(row);
+        });
+        if (!affected) {
+            updated.push_back(index);
+            continue;
+        }
+        std::shared_ptr<const ColumnIndex> next = index->Update(data, dataRows);
+        if (!next) next = ColumnIndex::Build(data, column, index->GetType());
+        if (next) updated.push_back(std::move(next));
+        changed = true;
+    }
 
-        // 仅提取 data 节点
-        if (fullJson.contains("content")) {
-            if (fullJson["content"].contains("data")) {
-                filteredJson["data"] = fullJson["content"]["data"];
+    // 声明的索引中有此前无法建立、现在可能可以建立的（或反之），交给 LoadIndexes 按声明重新核对
+    size_t declared = 0;
+    for (const auto& item : entry.data["indexes"]) {
+        ColumnIndex::Type type;
+        if (!item.is_object() || !item.contains("column") || !item["column"].is_number_unsigned()) continue;
+        if (!ColumnIndex::ParseType(item.value("type", ""), type)) continue;
+        size_t column = item["column"].get<size_t>();
+        if (column < after.ColumnCount() && ColumnIndex::Supports(after.GetColumn(column), type)) ++declared;
+    }
+    if (declared != updated.size()) {
+        entry.indexes.clear();
+        LoadIndexes(path, entry);
+        return;
+    }
+
+    entry.indexes = std::move(updated);
+    if (changed && SupportsBinaryFiles()) {
+        WriteFileContent(ColumnIndex::IndexPathFor(path).wstring(), ColumnIndex::EncodeFile(entry.indexes));
+    }
+}
+
+std::wstring Backend::ResolveWorkspacePath(const std::string& path) {
+    return m_paths.Resolve(path).Identifier();
+}
+
+std::shared_ptr<const ColumnTable> Backend::ActiveTable(const TableStore::Entry& database) {
+    return database.data.value("mode", "") == "external" ? database.externalTable : database.table;
+}
+
+Query::Source Backend::ActiveSource(const TableStore::Entry& database) {
+    Query::Source source;
+    source.stored = database.stored;
+    if (!source.stored) {
+        source.table = ActiveTable(database);
+    }
+    return source;
+}
+
+std::shared_ptr<const Query::Result> Backend::RunPresetQuery(const json& payload, Query::Source& source) {
+    std::string presetId = payload.value("presetId", "");
+    WorkspacePath file = m_paths.Intern(payload.value("path", ""));
+    const std::wstring& path = file.Identifier();
+    std::shared_ptr<const TableStore::Entry> database = LoadDatabase(path);
+
+    // 前端可以直接传入（尚未保存的）preset 配置，否则按 presetId 查找
+    json config;
+    if (payload.contains("config") && payload["config"].is_object()) {
+        config = payload["config"];
+    }
+    else {
+        for (const auto& preset : database->presets) {
+            if (preset.is_object() && preset.value("id", "") == presetId) {
+                config = preset.value("config", json::object());
+                break;
             }
-            else {
-                filteredJson["data"] = json::object();
+        }
+        if (config.is_null()) {
+            throw std::runtime_error("Preset not found in DB.");
+        }
+    }
+
+    source = ActiveSource(*database);
+    if (!source.table && !source.stored) {
+        source.table = ColumnTable::FromRows(json::array());
+    }
+
+    Query::Spec spec = Query::FromPresetConfig(config, source);
+    std::string specKey = Query::SpecKey(spec);
+    std::shared_ptr<const Query::Result> result = m_queryResults.Find(path, database->dataVersion, specKey);
+    if (!result) {
+        result = std::make_shared<const Query::Result>(Query::Execute(source, spec, database->indexes));
+        m_queryResults.Store(path, database->dataVersion, specKey, spec, result);
+    }
+    return result;
+}
+
+bool Backend::RefreshDatabase(const std::wstring& path, const json& ops, const json& document, const FileAccess::FileStat& baseStat) {
+    // 已加载的数据库必须对应增量修改前的文件
+    std::shared_ptr<const TableStore::Entry> cached = m_tableStore.Find(path);
+    if (!cached || !cached->hasStat || cached->stat != baseStat) {
+        return false;
+    }
+    if (!document.contains("content") || !document["content"].is_object()) {
+        return false;
+    }
+    const json& content = document["content"];
+    if (!content.contains("data") || !content["data"].is_object()) {
+        return false;
+    }
+
+    // 按路径归类修改：presets / config 不影响行数据；embeddedData 下只接受对个别行的修改和在末尾追加行
+    auto under = [](const std::string& path, const std::string& prefix) {
+        return path.compare(0, prefix.size(), prefix) == 0 && (path.size() == prefix.size() || path[prefix.size()] == '/');
+    };
+    const std::string rowsPrefix = "/content/data/embeddedData";
+    size_t rowCount = cached->table ? cached->table->RowCount() : 0;
+    size_t nextAppend = rowCount;
+    bool indexesChanged = false;
+    std::vector<uint32_t> changed;
+    for (const auto& op : ops) {
+        std::string name = op.value("op", "");
+        std::string target = op.value("path", "");
+        if (name != "add" && name != "remove" && name != "replace") return false;
+        if (under(target, "/config") || under(target, "/content/presets")) continue;
+        if (under(target, "/content/data/indexes")) {
+            indexesChanged = true;
+            continue;
+        }
+        if (!under(target, rowsPrefix) || target.size() == rowsPrefix.size()) return false;
+
+        std::string rest = target.substr(rowsPrefix.size() + 1);
+        size_t slash = rest.find('/');
+        std::string segment = rest.substr(0, slash);
+        if (segment.empty() || segment.find_first_not_of("0123456789") != std::string::npos) {
+            if (segment == "-" && slash == std::string::npos && name == "add") segment = std::to_string(nextAppend);
+            else return false;
+        }
+        size_t row = std::stoull(segment);
+        if (slash == std::string::npos) {
+            // 整行：替换已有的行，或在末尾追加；插入 / 删除会移动其后所有行的行号
+            if (name == "replace" && row < rowCount) {}
+            else if (name == "add" && row == nextAppend) ++nextAppend;
+            else return false;
+        }
+        else if (row >= nextAppend) {
+            return false;
+        }
+        changed.push_back(static_cast<uint32_t>(row));
+    }
+
+    auto entry = std::make_shared<TableStore::Entry>(*cached);
+    entry->data = content["data"];
+    entry->data.erase("embeddedData");
+    entry->presets = content.contains("presets") ? content["presets"] : json::array();
+    entry->version = ++m_databaseVersion;
+    entry->hasStat = GetFileStat(path, entry->stat);
+
+    if (!changed.empty()) {
+        // 列式存储的行不在文档中；没有已加载的表时无从增量
+        if (entry->stored || !cached->table || !content["data"].contains("embeddedData")) {
+            return false;
+        }
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        // 只把改动的行写入现有列的副本，不再从全部行重建
+        const json& rows = content["data"]["embeddedData"];
+        entry->table = ColumnTable::WithRows(*cached->table, rows, changed);
+        if (!entry->table) {
+            entry->table = ColumnTable::FromRows(rows);
+        }
+        if (entry->data.value("mode", "") != "external") {
+            entry->dataVersion = entry->version;
+            m_queryResults.Advance(path, cached->dataVersion, entry->dataVersion, *cached->table, *entry->table, changed);
+            if (!indexesChanged && entry->data.contains("indexes") && entry->data["indexes"].is_array()) {
+                UpdateIndexes(path, *cached->table, *entry, changed);
             }
+        }
+    }
+    if (indexesChanged) {
+        // 内容未变化的列沿用索引文件中的索引
+        entry->indexes.clear();
+        LoadIndexes(path, *entry);
+    }
+
+    m_tableStore.Store(path, entry);
+    return true;
+}
 
-            // 仅提取 presets 节点
-            if (fullJson["content"].contains("presets")) {
-                filteredJson["presets"] = fullJson["content"]["presets"];
+void Backend::QueryData(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    size_t offset = payload.value("offset", static_cast<size_t>(0));
+    size_t limit = payload.value("limit", static_cast<size_t>(200));
+
+    json response;
+    response["action"] = "dataQueried";
+    response["payload"]["path"] = path_str;
+    response["payload"]["presetId"] = payload.value("presetId", "");
+    response["payload"]["requestId"] = payload.value("requestId", "");
+
+    try {
+        Query::Source source;
+        std::shared_ptr<const Query::Result> result = RunPresetQuery(payload, source);
+
+        response["payload"]["success"] = true;
+        response["payload"]["firstRow"] = source.FirstRow().is_null() ? json::array() : source.FirstRow();
+        response["payload"]["columns"] = source.DescribeColumns();
+        response["payload"]["rowCount"] = source.RowCount();
+        response["payload"]["totalRows"] = result->rows.size();
+        response["payload"]["offset"] = offset;
+        response["payload"]["rows"] = Query::Page(source, *result, offset, limit);
+        // 只下发与当前页相交的分组
+        response["payload"]["groups"] = Query::GroupsInWindow(*result, offset, limit);
+        response["payload"]["totals"] = result->totals;
+    }
+    catch (const std::exception& e) {
+        response["payload"]["success"] = false;
+        response["payload"]["error"] = e.what();
+        response["payload"]["rows"] = json::array();
+    }
+
+    SendMessageToJS(response);
+}
+
+void Backend::OpenQuery(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    size_t limit = payload.value("limit", static_cast<size_t>(200));
+
+    json response;
+    response["action"] = "queryOpened";
+    response["payload"]["path"] = path_str;
+    response["payload"]["presetId"] = payload.value("presetId", "");
+    response["payload"]["requestId"] = payload.value("requestId", "");
+
+    try {
+        Query::Source source;
+        std::shared_ptr<const Query::Result> result = RunPresetQuery(payload, source);
+
+        json firstRow = source.FirstRow().is_null() ? json::array() : source.FirstRow();
+        json totals = result->totals;
+        uint64_t cursorId = m_queryCursors.Open(m_paths.Intern(path_str).Identifier(), source, std::move(result));
+
+        // 第一个窗口随 openQuery 一起返回，同时开始预取第二个窗口
+        Query::CursorRegistry::Window window;
+        size_t totalRows = 0;
+        m_queryCursors.Fetch(cursorId, 0, limit, window, totalRows);
+
+        response["payload"]["success"] = true;
+        response["payload"]["cursorId"] = cursorId;
+        response["payload"]["firstRow"] = std::move(firstRow);
+        response["payload"]["columns"] = source.DescribeColumns();
+        response["payload"]["rowCount"] = source.RowCount();
+        response["payload"]["totalRows"] = totalRows;
+        response["payload"]["offset"] = 0;
+        response["payload"]["rows"] = std::move(window.rows);
+        response["payload"]["groups"] = std::move(window.groups);
+        response["payload"]["totals"] = std::move(totals);
+    }
+    catch (const std::exception& e) {
+        response["payload"]["success"] = false;
+        response["payload"]["error"] = e.what();
+        response["payload"]["rows"] = json::array();
+    }
+
+    SendMessageToJS(response);
+}
+
+void Backend::FetchRows(const json& payload) {
+    uint64_t cursorId = payload.value("cursorId", static_cast<uint64_t>(0));
+    size_t offset = payload.value("offset", static_cast<size_t>(0));
+    size_t limit = payload.value("limit", static_cast<size_t>(200));
+
+    json response;
+    response["action"] = "rowsFetched";
+    response["payload"]["requestId"] = payload.value("requestId", "");
+    response["payload"]["cursorId"] = cursorId;
+    response["payload"]["offset"] = offset;
+
+    Query::CursorRegistry::Window window;
+    size_t totalRows = 0;
+    if (m_queryCursors.Fetch(cursorId, offset, limit, window, totalRows)) {
+        response["payload"]["success"] = true;
+        response["payload"]["totalRows"] = totalRows;
+        response["payload"]["rows"] = std::move(window.rows);
+        response["payload"]["groups"] = std::move(window.groups);
+    }
+    else {
+        // 游标已关闭或因文件保存而失效，前端需要重新 openQuery
+        response["payload"]["success"] = false;
+        response["payload"]["expired"] = true;
+        response["payload"]["rows"] = json::array();
+    }
+
+    SendMessageToJS(response);
+}
+
+void Backend::ConvertDatabaseStorage(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    std::string storage = payload.value("storage", "columnar");
+    std::string csvPath = payload.value("csvPath", "");
+    std::string delimiter = payload.value("delimiter", ",");
+    WorkspacePath file = m_paths.Intern(path_str);
+    const std::wstring& path = file.Identifier();
+
+    json response;
+    response["action"] = "databaseStorageConverted";
+    response["payload"]["path"] = path_str;
+    response["payload"]["requestId"] = payload.value("requestId", "");
+    response["payload"]["storage"] = storage;
+
+    try {
+        if (storage != "columnar" && storage != "json") {
+            throw std::runtime_error("Unknown database storage: " + storage);
+        }
+        // 列式文件需要二进制写入和按路径内存映射
+        if (!SupportsBinaryFiles()) {
+            throw std::runtime_error("Columnar storage is not supported on this platform.");
+        }
+        if (delimiter.size() != 1) {
+            throw std::runtime_error("CSV delimiter must be a single character.");
+        }
+
+        json document;
+        {
+            std::string contentStr = ReadFileContent(path);
+            document = contentStr.empty() ? json::object() : ParseDocument(path, contentStr);
+        }
+        if (!document.is_object()) document = json::object();
+        json& content = document["content"];
+        if (!content.is_object()) content = json::object();
+        if (!content.contains("data") || !content["data"].is_object()) {
+            content["data"] = { {"mode", "embedded"}, {"embeddedData", json::array()}, {"externalUrl", ""} };
+        }
+        if (!content.contains("presets")) content["presets"] = json::array();
+        json& data = content["data"];
+        bool columnar = data.value("storage", "") == "columnar";
+        std::wstring columnsPath = ColumnStore::PathFor(path).wstring();
+
+        // 缓存的表和游标持有列式文件的映射（Windows 上会阻止替换），写入前先释放
+        m_tableStore.Invalidate(path);
+        m_queryCursors.CloseForPath(path);
+        m_queryResults.InvalidatePath(path);
+
+        if (storage == "columnar") {
+            uint64_t rowCount = 0;
+            auto writeRows = [&](const std::function<bool(ColumnStore::Writer&)>& appendRows) {
+                return WriteFileStreamed(columnsPath, [&](const std::function<bool(std::string_view)>& write) {
+                    ColumnStore::Writer writer(write);
+                    if (!appendRows(writer) || !writer.Finish()) return false;
+                    rowCount = writer.RowCount();
+                    return true;
+                });
+            };
+
+            bool written = true;
+            if (!csvPath.empty()) {
+                // CSV 直接流式写入列式文件：行数据既不进入 JSON 文档，也不在内存中建成完整的表
+                std::wstring csv = ResolveWorkspacePath(csvPath);
+                written = writeRows([&](ColumnStore::Writer& writer) {
+                    return ColumnTable::ReadCsvRows([this, &csv](const std::function<bool(std::string_view)>& sink) {
+                        return ReadFileChunks(csv, sink);
+                    }, [&writer](const json& row) { return writer.AppendRow(row); }, delimiter[0]);
+                });
+            }
+            else if (!columnar) {
+                const json rows = data.contains("embeddedData") && data["embeddedData"].is_array() ? std::move(data["embeddedData"]) : json::array();
+                written = writeRows([&rows](ColumnStore::Writer& writer) {
+                    for (const auto& row : rows) {
+                        if (!writer.AppendRow(row)) return false;
+                    }
+                    return true;
+                });
             }
             else {
-                filteredJson["presets"] = json::array();
+                rowCount = data.value("rowCount", static_cast<uint64_t>(0));
             }
+            if (!written) {
+                throw std::runtime_error("Failed to write columnar storage file.");
+            }
+
+            data.erase("embeddedData");
+            data["mode"] = "embedded";
+            data["storage"] = "columnar";
+            data["rowCount"] = rowCount;
         }
-        else {
-            filteredJson["data"] = json::object();
-            filteredJson["presets"] = json::array();
+        else if (columnar) {
+            std::shared_ptr<const ColumnStore::StoredTable> stored = ColumnStore::StoredTable::Open(LocalFilePath(columnsPath));
+            if (!stored) {
+                throw std::runtime_error("Failed to open columnar storage file.");
+            }
+            data["embeddedData"] = stored->ToRows();
+            data.erase("storage");
+            data.erase("rowCount");
         }
 
-        // 作为 JSON Object 下发给前端
-        response["payload"]["content"] = filteredJson;
+        // 先写入列式文件、再改写数据库文件：中途失败时数据库文件仍指向原有的数据
+        if (!WriteFileContent(path, SerializeDocument(path, document))) {
+            throw std::runtime_error("Failed to write database file.");
+        }
+        ForgetDocument(path);
+        if (storage == "json" && columnar) {
+            // 数据库文件已不再引用列式文件（映射在上面的作用域结束时已释放）；删除失败只留下一个无用的文件
+            std::error_code ec;
+            std::filesystem::remove(LocalFilePath(columnsPath), ec);
+            if (ec) {
+                LOG_DEBUG(std::string("Failed to remove columnar storage file: " + ec.message()).c_str());
+            }
+        }
+
+        response["payload"]["success"] = true;
+        response["payload"]["rowCount"] = data.value("rowCount", static_cast<uint64_t>(0));
     }
     catch (const std::exception& e) {
-        // 如果文件不存在或解析失败，发送空骨架防止前端崩溃
-        response["payload"]["error"] = "Failed to parse database file: " + std::string(e.what());
-        response["payload"]["content"] = json::object({ {"data", json::object()}, {"presets", json::array()} });
+        response["payload"]["success"] = false;
+        response["payload"]["error"] = e.what();
     }
 
     SendMessageToJS(response);
 }
 
+void Backend::ParseCsv(const json& payload) {
+    std::string path_str = payload.value("path", "");
+    std::string requestId = payload.value("requestId", "");
+    bool hasHeader = payload.value("header", true);
+    std::string delimiter = payload.value("delimiter", ",");
+
+    json response;
+    response["action"] = "csvParsed";
+    response["payload"]["path"] = path_str;
+    response["payload"]["requestId"] = requestId;
+
+    try {
+        if (delimiter.size() != 1) {
+            throw std::runtime_error("CSV delimiter must be a single character.");
+        }
+        std::wstring identifier = m_paths.Intern(path_str).Identifier();
+
+        // 第一遍：只推断类型并记下表头，内存占用与行数无关
+        Csv::TypeInference inference;
+        std::vector<std::string> headers;
+        size_t columnCount = 0;
+        {
+            bool first = true;
+            Csv::Parser parser([&](const std::vector<std::string>& fields) {
+                columnCount = std::max(columnCount, fields.size());
+                if (first && hasHeader) {
+                    headers = fields;
+                }
+                else {
+                    inference.Observe(fields);
+                }
+                first = false;
+            }, delimiter[0]);
+            if (!ReadFileChunks(identifier, [&parser](std::string_view chunk) { parser.Feed(chunk); return true; })) {
+                throw std::runtime_error("Failed to read CSV file.");
+            }
+            parser.Finish();
+        }
+
+        std::vector<Csv::ColumnType> types(columnCount);
+        json columnsInfo = json::array();
+        for (size_t c = 0; c < columnCount; ++c) {
+            types[c] = inference.TypeOf(c);
+            std::string name = c < headers.size() ? headers[c] : "Column " + std::to_string(c + 1);
+            columnsInfo.push_back({ {"name", name}, {"type", Csv::ColumnTypeName(types[c])} });
+        }
+
+        // 第二遍：每 kCsvChunkRows 行发送一个 csvChunk 消息，按列存放类型化的值。
+        // 行数据与 JS 端 rawData 的约定一致：表头（若有）保持为第一行字符串；
+        // rowWidths 记录每行原本的字段数，列数组中超出该行宽度的位置为 null
+        constexpr size_t kCsvChunkRows = 8192;
+        json chunk;
+        size_t rowCount = 0;
+        size_t chunkRows = 0;
+        auto resetChunk = [&]() {
+            chunk = json::object();
+            chunk["action"] = "csvChunk";
+            chunk["payload"]["path"] = path_str;
+            chunk["payload"]["requestId"] = requestId;
+            chunk["payload"]["rowStart"] = rowCount;
+            chunk["payload"]["rowWidths"] = json::array();
+            chunk["payload"]["columns"] = json::array();
+            for (size_t c = 0; c < columnCount; ++c) {
+                chunk["payload"]["columns"].push_back(json::array());
+            }
+            chunkRows = 0;
+        };
+        auto flushChunk = [&]() {
+            if (chunkRows > 0) {
+                SendMessageToJS(chunk);
+            }
+            resetChunk();
+        };
+        resetChunk();
+
+        Csv::Parser parser([&](const std::vector<std::string>& fields) {
+            bool isHeader = hasHeader && rowCount == 0;
+            json& columns = chunk["payload"]["columns"];
+            for (size_t c = 0; c < columnCount; ++c) {
+                if (c >= fields.size()) {
+                    columns[c].push_back(nullptr);
+                }
+                else {
+                    columns[c].push_back(isHeader ? json(fields[c]) : Csv::ToJsonValue(fields[c], types[c]));
+                }
+            }
+            chunk["payload"]["rowWidths"].push_back(fields.size());
+            ++rowCount;
+            if (++chunkRows >= kCsvChunkRows) {
+                flushChunk();
+            }
+        }, delimiter[0]);
+        if (!ReadFileChunks(identifier, [&parser](std::string_view data) { parser.Feed(data); return true; })) {
+            throw std::runtime_error("Failed to read CSV file.");
+        }
+        parser.Finish();
+        flushChunk();
+
+        response["payload"]["success"] = true;
+        response["payload"]["columns"] = std::move(columnsInfo);
+        response["payload"]["rowCount"] = rowCount;
+    }
+    catch (const std::exception& e) {
+        response["payload"]["success"] = false;
+        response["payload"]["error"] = e.what();
+    }
+
+    SendMessageToJS(response);
+}
+
+void Backend::ListWorkspace(const json& /*payload*/) {
+    Telemetry::Span span("listWorkspace", "io");
+    json response;
+    response["action"] = "workspaceListed";
+
+    // 递归函数 scan_dir 保持不变
+    std::function<json(const std::filesystem::path&)> scan_dir =
+        [&](const std::filesystem::path& dir_path) -> json {
+        json tree_node;
+        tree_node["name"] = dir_path.filename().string();
+        tree_node["path"] = dir_path.string();
+        tree_node["type"] = "folder";
+        tree_node["children"] = json::array();
+
+        for (const auto& entry : std::filesystem::directory_iterator(dir_path)) {
+            // --- 目录处理（保持不变）---
+            if (entry.is_directory()) {
+                if (entry.path().filename() == "build") { // 忽略 build 文件夹
+                    continue;
+                }
+                tree_node["children"].push_back(scan_dir(entry.path()));
+            }
+            // --- 文件处理 ---
+            else if (entry.is_regular_file()) {
+                // --- START OF MODIFICATION ---
+
+                // 1. 获取文件扩展名
+                std::string extension = entry.path().extension().string();
+
+                // 2. 根据不同的扩展名创建不同类型的节点
+                if (extension == ".veritnote") {
+                    json file_node;
+                    // 使用 filename() 获取带扩展名的全名，因为前端会处理它
+                    file_node["name"] = entry.path().filename().string();
+                    file_node["path"] = entry.path().string();
+                    file_node["type"] = "page";
+                    tree_node["children"].push_back(file_node);
+                }
+                else if (extension == ".veritnotegraph") {
+                    json file_node;
+                    file_node["name"] = entry.path().filename().string();
+                    file_node["path"] = entry.path().string();
+                    file_node["type"] = "graph";
+                    tree_node["children"].push_back(file_node);
+                }
+                else if (extension == ".veritnotedb") {
+                    json file_node;
+                    file_node["name"] = entry.path().filename().string();
+                    file_node["path"] = entry.path().string();
+                    file_node["type"] = "database";
+                    tree_node["children"].push_back(file_node);
+                }
+
+                // --- END OF MODIFICATION ---
+            }
+        }
+        return tree_node;
+    };
+
+    // --- 后续的 try-catch 块和发送消息的逻辑保持不变 ---
+    try {
+        if (!m_workspaceRoot.empty()) {
+            response["payload"] = scan_dir(m_workspaceRoot);
+
+            // 检查工作区是否为空并提取欢迎文件的逻辑保持不变
+            if (response["payload"]["children"].empty()) {
+                std::filesystem::path destFilePath = std::filesystem::path(m_workspaceRoot) / "welcome.veritnote";
+                if (ExtractResourceToFile(L"/welcome.veritnote", destFilePath)) {
+                    response["payload"] = scan_dir(m_workspaceRoot);
+                }
+            }
+        }
+        else {
+            response["error"] = "Workspace root not set.";
+        }
+    }
+    catch (const std::exception& e) {
+        response["error"] = e.what();
+    }
+
+    SendMessageToJS(response);
+}
+
+bool Backend::ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) {
+    std::string content = ReadFileContent(path);
+    sink(content);
+    return true;
+}
+
+bool Backend::WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) {
+    std::string content;
+    bool produced = produce([&content](std::string_view chunk) {
+        content.append(chunk.data(), chunk.size());
+        return true;
+    });
+    return produced && WriteFileContent(path, content);
+}
+
+json Backend::ReadJsonFileAndParent(const std::wstring& identifier, const std::wstring& parentOf, std::wstring& parent) {
+    parent = this->GetParentIdentifier(parentOf);
+    return this->ReadJsonFile(identifier);
+}
+
 
 void Backend::OpenWorkspace(const json& payload) {
     std::string path = payload.value("path", "");
     if (path.empty()) return;
 
     m_workspaceRoot = this->string_to_wstring(path); // 设置工作区路径
+    m_paths.Reset(m_workspaceRoot);
+    m_configCache.Clear();
+    m_tableStore.Clear();
+    m_queryCursors.Clear();
+    m_queryResults.Clear();
 
     // 告诉平台去导航
     NavigateTo(L"http://veritnote.localhost/index.html");
@@ -720,7 +1832,7 @@ void Backend::ReadConfigFile(const json& payload) {
 
     json response;
     response["action"] = "configFileRead";
-    std::wstring identifier = this->string_to_wstring(pathStr);
+    std::wstring identifier = m_paths.Intern(pathStr).Identifier();
     response["payload"]["path"] = pathStr;
     response["payload"]["data"] = ReadJsonFile(identifier);
 
@@ -730,67 +1842,134 @@ void Backend::ReadConfigFile(const json& payload) {
 void Backend::WriteConfigFile(const json& payload) {
     std::string pathStr = payload.value("path", "");
     json data = payload.value("data", json::object());
-    std::wstring identifier = this->string_to_wstring(pathStr);
+    std::wstring identifier = m_paths.Intern(pathStr).Identifier();
     WriteJsonFile(identifier, data);
+
+    // 只让被修改的目录及其子孙目录的缓存失效。
+    // 前端传来的是 "<folder>\\veritnoteconfig"（Android 上是拼接后的 URI），
+    // 去掉文件名和分隔符即可得到缓存中的目录 key，无需再走一次 GetParentIdentifier。
+    const std::wstring configName = L"veritnoteconfig";
+    std::wstring dirIdentifier = identifier;
+    if (dirIdentifier.size() > configName.size() &&
+        dirIdentifier.compare(dirIdentifier.size() - configName.size(), configName.size(), configName) == 0) {
+        dirIdentifier.erase(dirIdentifier.size() - configName.size());
+        wchar_t sep = dirIdentifier.back();
+        if (sep == L'\\' || sep == L'/' || sep == L'|') {
+            dirIdentifier.pop_back();
+        }
+        m_configCache.InvalidateDirectory(dirIdentifier);
+    }
+    else {
+        m_configCache.Clear();
+    }
     // Optionally send a success message
 }
 
-void Backend::ResolveFileConfiguration(const json& payload) {
-    std::string filePathStr = payload.value("path", "");
+std::wstring Backend::CachedParentIdentifier(const std::wstring& identifier) {
+    std::wstring parent;
+    if (!m_configCache.TryGetParent(identifier, parent)) {
+        parent = this->GetParentIdentifier(identifier);
+        m_configCache.StoreParent(identifier, parent);
+    }
+    return parent;
+}
+
+json Backend::ResolveDirectoryConfig(const std::wstring& dirIdentifier) {
+    json resolved;
+    if (m_configCache.TryGetResolved(dirIdentifier, resolved)) {
+        return resolved;
+    }
+
+    // Use a virtual method to correctly combine the parent identifier (a directory)
+    // with the config filename. This handles path separators vs. URI segments.
+    std::wstring configIdentifier = this->CombineIdentifier(dirIdentifier, L"veritnoteconfig");
+    std::wstring cachedParent;
+    if (dirIdentifier != m_workspaceRoot && !m_configCache.TryGetParent(dirIdentifier, cachedParent)) {
+        // 父级尚未记忆时，与配置文件一起取回，下面的 CachedParentIdentifier 直接命中缓存
+        resolved = this->ReadJsonFileAndParent(configIdentifier, dirIdentifier, cachedParent);
+        m_configCache.StoreParent(dirIdentifier, cachedParent);
+    }
+    else {
+        resolved = this->ReadJsonFile(configIdentifier);
+    }
+    if (!resolved.is_object()) {
+        resolved = json::object();
+    }
+
+    // Stop after processing the workspace root directory itself.
+    std::wstring parentIdentifier;
+    if (dirIdentifier != m_workspaceRoot) {
+        parentIdentifier = CachedParentIdentifier(dirIdentifier);
+        // The length check is a simple but effective way to stop traversal above the root.
+        if (!parentIdentifier.empty() && parentIdentifier.length() >= m_workspaceRoot.length()) {
+            ConfigCache::InheritFrom(resolved, ResolveDirectoryConfig(parentIdentifier));
+        }
+        else {
+            parentIdentifier.clear();
+        }
+    }
 
+    m_configCache.StoreResolved(dirIdentifier, parentIdentifier, resolved);
+    return resolved;
+}
+
+json Backend::ResolveConfigForFile(const std::wstring& fileIdentifier) {
     json finalConfig = json::object();
-    // 'identifier' can be a file path on Windows or a content URI on Android.
-    std::wstring currentFileIdentifier = this->string_to_wstring(filePathStr);
 
     // Step 1: Read the file's own embedded config using a virtual method.
-    json fileContent = this->ReadJsonFile(currentFileIdentifier);
+    // 文件自身的 config 随保存而变化，因此每次都重新读取，不进入缓存。
+    json fileContent;
+    std::wstring cachedParent;
+    if (m_configCache.TryGetParent(fileIdentifier, cachedParent)) {
+        fileContent = this->ReadJsonFile(fileIdentifier);
+    }
+    else {
+        fileContent = this->ReadJsonFileAndParent(fileIdentifier, fileIdentifier, cachedParent);
+        m_configCache.StoreParent(fileIdentifier, cachedParent);
+    }
     if (fileContent.is_object() && fileContent.contains("config")) {
         finalConfig = fileContent["config"];
     }
 
-    // Step 2: Walk up the directory tree, merging folder configs.
-    // Use the virtual method to get the first parent identifier.
-    std::wstring currentParentIdentifier = this->GetParentIdentifier(currentFileIdentifier);
+    // Step 2: Inherit from the (memoized) resolved config of the containing directory.
+    std::wstring parentIdentifier = CachedParentIdentifier(fileIdentifier);
+    if (!parentIdentifier.empty() && parentIdentifier.length() >= m_workspaceRoot.length()) {
+        ConfigCache::InheritFrom(finalConfig, ResolveDirectoryConfig(parentIdentifier));
+    }
 
-    // Loop until we can't get a parent or we are above the workspace root.
-    // The length check is a simple but effective way to stop traversal.
-    while (!currentParentIdentifier.empty() && currentParentIdentifier.length() >= m_workspaceRoot.length()) {
+    return finalConfig;
+}
 
-        // Use a virtual method to correctly combine the parent identifier (a directory)
-        // with the config filename. This handles path separators vs. URI segments.
-        std::wstring configIdentifier = this->CombineIdentifier(currentParentIdentifier, L"veritnoteconfig");
+void Backend::ResolveFileConfiguration(const json& payload) {
+    std::string filePathStr = payload.value("path", "");
 
-        // Read the folder's config file using the virtual method.
-        json folderConfig = this->ReadJsonFile(configIdentifier);
+    // 'identifier' can be a file path on Windows or a content URI on Android.
+    std::wstring currentFileIdentifier = m_paths.Intern(filePathStr).Identifier();
 
-        // Merge folderConfig into finalConfig, but only for keys that are "inherit" or missing in finalConfig.
-        // This merging logic is platform-agnostic.
-        for (auto const& [category, catConfig] : folderConfig.items()) {
-            if (!catConfig.is_object()) continue; // Ensure category config is an object
+    json response;
+    response["action"] = "fileConfigurationResolved";
+    response["payload"]["path"] = filePathStr;
+    response["payload"]["config"] = ResolveConfigForFile(currentFileIdentifier);
 
-            if (!finalConfig.contains(category)) {
-                finalConfig[category] = json::object();
-            }
-            for (auto const& [key, value] : catConfig.items()) {
-                if (!finalConfig[category].contains(key) || finalConfig[category][key] == "inherit") {
-                    finalConfig[category][key] = value;
-                }
-            }
-        }
+    SendMessageToJS(response);
+}
 
-        // Stop after processing the workspace root directory itself.
-        if (currentParentIdentifier == m_workspaceRoot) {
-            break;
-        }
+void Backend::ResolveFileConfigurations(const json& payload) {
+    json configs = json::object();
 
-        // Get the next parent up the chain for the next iteration.
-        currentParentIdentifier = this->GetParentIdentifier(currentParentIdentifier);
+    if (payload.contains("paths") && payload["paths"].is_array()) {
+        for (const auto& item : payload["paths"]) {
+            if (!item.is_string()) continue;
+            std::string filePathStr = item.get<std::string>();
+            // 同一目录下的文件共享同一个已解析的目录节点，只有文件自身需要读取
+            configs[filePathStr] = ResolveConfigForFile(m_paths.Intern(filePathStr).Identifier());
+        }
     }
 
     json response;
-    response["action"] = "fileConfigurationResolved";
-    response["payload"]["path"] = filePathStr;
-    response["payload"]["config"] = finalConfig;
+    response["action"] = "fileConfigurationsResolved";
+    response["payload"]["requestId"] = payload.value("requestId", "");
+    response["payload"]["configs"] = configs;
 
     SendMessageToJS(response);
 }
\ No newline at end of file
@@ -0,0 +1,577 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "include/ColumnIndex.h"
+
+
+namespace {
+    using Kind = ColumnTable::Kind;
+
+    const char kIndexMagic[4] = { 'V', 'N', 'X', '1' };
+
+    uint64_t MixBits(uint64_t x) {
+        // splitmix64 的混合步骤
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    uint64_t HashNumber(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return MixBits(bits);
+    }
+
+    uint64_t HashString(std::string_view value) {
+        return MixBits(std::hash<std::string_view>()(value));
+    }
+
+    // -0.0 与 0.0 视为同一个键
+    double NormalizeKey(double value) {
+        return value == 0.0 ? 0.0 : value;
+    }
+
+    size_t SlotCount(size_t keys) {
+        size_t slots = 16;
+        while (slots < keys * 2) slots <<= 1;
+        return slots;
+    }
+
+    char LowerAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    uint32_t Gram(const char* p) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(LowerAscii(p[0]))) << 16) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(LowerAscii(p[1]))) << 8) |
+            static_cast<uint32_t>(static_cast<unsigned char>(LowerAscii(p[2])));
+    }
+
+    // 字典中编码不小于 from 的字符串的 (三元组, 编码) 对，排序去重
+    std::vector<std::pair<uint32_t, uint32_t>> GramPairs(const std::vector<std::string>& dictionary, size_t from) {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (size_t d = from; d < dictionary.size(); ++d) {
+            const std::string& s = dictionary[d];
+            for (size_t i = 0; i + 3 <= s.size(); ++i) {
+                pairs.emplace_back(Gram(s.data() + i), static_cast<uint32_t>(d));
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        return pairs;
+    }
+
+    // --- 序列化辅助 ---
+    template <typename T>
+    void PutPod(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void PutVector(std::string& out, const std::vector<T>& values) {
+        PutPod(out, static_cast<uint64_t>(values.size()));
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool GetPod(std::string_view& in, T& value) {
+        if (in.size() < sizeof(T)) return false;
+        std::memcpy(&value, in.data(), sizeof(T));
+        in.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    bool GetVector(std::string_view& in, std::vector<T>& values) {
+        uint64_t count = 0;
+        if (!GetPod(in, count) || count > in.size() / sizeof(T)) return false;
+        values.resize(static_cast<size_t>(count));
+        if (count > 0) std::memcpy(values.data(), in.data(), values.size() * sizeof(T));
+        in.remove_prefix(values.size() * sizeof(T));
+        return true;
+    }
+}
+
+
+bool ColumnIndex::ParseType(const std::string& name, Type& type) {
+    if (name == "sorted") type = Type::Sorted;
+    else if (name == "hash") type = Type::Hash;
+    else if (name == "trigram") type = Type::Trigram;
+    else return false;
+    return true;
+}
+
+const char* ColumnIndex::TypeName(Type type) {
+    switch (type) {
+    case Type::Sorted: return "sorted";
+    case Type::Hash: return "hash";
+    case Type::Trigram: return "trigram";
+    }
+    return "unknown";
+}
+
+bool ColumnIndex::Supports(const ColumnTable::Column& column, Type type) {
+    Kind kind = column.GetKind();
+    if (kind == Kind::String) return true;
+    return (kind == Kind::Integer || kind == Kind::Number) && type != Type::Trigram;
+}
+
+std::shared_ptr<const ColumnIndex> ColumnIndex::Build(const ColumnTable::Column& column, size_t columnIndex, Type type) {
+    if (!Supports(column, type)) {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<ColumnIndex>();
+    index->m_type = type;
+    index->m_column = columnIndex;
+    index->m_fingerprint = column.Fingerprint();
+    index->m_string = column.GetKind() == Kind::String;
+    const size_t n = column.Size();
+
+    if (!index->m_string) {
+        std::vector<std::pair<double, uint32_t>> pairs;
+        pairs.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!column.IsNull(i)) pairs.emplace_back(NormalizeKey(column.NumberAt(i)), static_cast<uint32_t>(i));
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        if (type == Type::Sorted) {
+            index->m_order.reserve(pairs.size());
+            for (const auto& p : pairs) index->m_order.push_back(p.second);
+            return index;
+        }
+
+        index->FillNumberHash(pairs);
+        return index;
+    }
+
+    // 字符串列：按编码计数排序得到倒排表，每个编码下的行天然升序
+    const auto& dictionary = column.Dictionary();
+    index->m_offsets.assign(dictionary.size() + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (!column.IsNull(i)) ++index->m_offsets[column.CodeAt(i) + 1];
+    }
+    for (size_t d = 0; d < dictionary.size(); ++d) {
+        index->m_offsets[d + 1] += index->m_offsets[d];
+    }
+    index->m_rows.resize(index->m_offsets.back());
+    std::vector<uint32_t> cursor(index->m_offsets.begin(), index->m_offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        if (!column.IsNull(i)) index->m_rows[cursor[column.CodeAt(i)]++] = static_cast<uint32_t>(i);
+    }
+
+    switch (type) {
+    case Type::Sorted:
+        index->m_order.resize(dictionary.size());
+        for (uint32_t d = 0; d < index->m_order.size(); ++d) index->m_order[d] = d;
+        std::sort(index->m_order.begin(), index->m_order.end(),
+            [&dictionary](uint32_t a, uint32_t b) { return dictionary[a] < dictionary[b]; });
+        break;
+
+    case Type::Hash:
+        index->FillStringHash(dictionary);
+        break;
+
+    case Type::Trigram:
+        index->FillGrams(GramPairs(dictionary, 0));
+        break;
+    }
+    return index;
+}
+
+std::shared_ptr<const ColumnIndex> ColumnIndex::Update(const ColumnTable::Column& column, const std::vector<uint32_t>& changedRows) const {
+    if (!Supports(column, m_type) || m_string != (column.GetKind() == Kind::String)) {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<ColumnIndex>();
+    index->m_type = m_type;
+    index->m_column = m_column;
+    index->m_fingerprint = column.Fingerprint();
+    index->m_string = m_string;
+    const size_t n = column.Size();
+    auto changed = [&changedRows](uint32_t row) { return std::binary_search(changedRows.begin(), changedRows.end(), row); };
+
+    if (!m_string) {
+        std::vector<std::pair<double, uint32_t>> added;
+        for (uint32_t row : changedRows) {
+            if (row < n && !column.IsNull(row)) added.emplace_back(NormalizeKey(column.NumberAt(row)), row);
+        }
+        std::sort(added.begin(), added.end());
+
+        if (m_type == Type::Sorted) {
+            // 未改动的行值不变，仍按 (值, 行) 有序，与改动的行归并即可
+            index->m_order.reserve(m_order.size() + added.size());
+            size_t a = 0;
+            for (uint32_t row : m_order) {
+                if (changed(row)) continue;
+                std::pair<double, uint32_t> current(NormalizeKey(column.NumberAt(row)), row);
+                while (a < added.size() && added[a] < current) index->m_order.push_back(added[a++].second);
+                index->m_order.push_back(row);
+            }
+            while (a < added.size()) index->m_order.push_back(added[a++].second);
+            return index;
+        }
+
+        std::vector<std::pair<double, uint32_t>> kept;
+        kept.reserve(m_rows.size());
+        for (size_t k = 0; k < m_keys.size(); ++k) {
+            for (uint32_t i = m_offsets[k]; i < m_offsets[k + 1]; ++i) {
+                if (!changed(m_rows[i])) kept.emplace_back(m_keys[k], m_rows[i]);
+            }
+        }
+        if (!std::is_sorted(kept.begin(), kept.end())) {
+            std::sort(kept.begin(), kept.end());
+        }
+        std::vector<std::pair<double, uint32_t>> pairs;
+        pairs.reserve(kept.size() + added.size());
+        std::merge(kept.begin(), kept.end(), added.begin(), added.end(), std::back_inserter(pairs));
+        index->FillNumberHash(pairs);
+        return index;
+    }
+
+    // 字符串列：已有编码的含义不变，新字符串的编码在字典末尾
+    const auto& dictionary = column.Dictionary();
+    const size_t oldCodes = m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    if (dictionary.size() < oldCodes) {
+        return nullptr;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> added;
+    for (uint32_t row : changedRows) {
+        if (row < n && !column.IsNull(row)) added.emplace_back(column.CodeAt(row), row);
+    }
+    std::sort(added.begin(), added.end());
+
+    // 每个编码的行：未改动的旧行与改动的行按行号归并
+    index->m_offsets.assign(dictionary.size() + 1, 0);
+    index->m_rows.reserve(m_rows.size() + added.size());
+    size_t a = 0;
+    for (uint32_t code = 0; code < dictionary.size(); ++code) {
+        index->m_offsets[code] = static_cast<uint32_t>(index->m_rows.size());
+        if (code < oldCodes) {
+            for (uint32_t i = m_offsets[code]; i < m_offsets[code + 1]; ++i) {
+                uint32_t row = m_rows[i];
+                if (changed(row)) continue;
+                while (a < added.size() && added[a].first == code && added[a].second < row) index->m_rows.push_back(added[a++].second);
+                index->m_rows.push_back(row);
+            }
+        }
+        while (a < added.size() && added[a].first == code) index->m_rows.push_back(added[a++].second);
+    }
+    index->m_offsets[dictionary.size()] = static_cast<uint32_t>(index->m_rows.size());
+
+    // 字典层面的结构只需处理新增的字符串
+    switch (m_type) {
+    case Type::Sorted: {
+        std::vector<uint32_t> fresh;
+        for (size_t d = oldCodes; d < dictionary.size(); ++d) fresh.push_back(static_cast<uint32_t>(d));
+        auto less = [&dictionary](uint32_t x, uint32_t y) { return dictionary[x] < dictionary[y]; };
+        std::sort(fresh.begin(), fresh.end(), less);
+        index->m_order.reserve(m_order.size() + fresh.size());
+        std::merge(m_order.begin(), m_order.end(), fresh.begin(), fresh.end(), std::back_inserter(index->m_order), less);
+        break;
+    }
+
+    case Type::Hash:
+        if (dictionary.size() == oldCodes) index->m_slots = m_slots;
+        else index->FillStringHash(dictionary);
+        break;
+
+    case Type::Trigram: {
+        if (dictionary.size() == oldCodes) {
+            index->m_grams = m_grams;
+            index->m_gramOffsets = m_gramOffsets;
+            index->m_gramCodes = m_gramCodes;
+            break;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> kept;
+        kept.reserve(m_gramCodes.size());
+        for (size_t k = 0; k < m_grams.size(); ++k) {
+            for (uint32_t i = m_gramOffsets[k]; i < m_gramOffsets[k + 1]; ++i) kept.emplace_back(m_grams[k], m_gramCodes[i]);
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> fresh = GramPairs(dictionary, oldCodes);
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        pairs.reserve(kept.size() + fresh.size());
+        std::merge(kept.begin(), kept.end(), fresh.begin(), fresh.end(), std::back_inserter(pairs));
+        index->FillGrams(pairs);
+        break;
+    }
+    }
+    return index;
+}
+
+void ColumnIndex::FillNumberHash(const std::vector<std::pair<double, uint32_t>>& pairs) {
+    // 相同的值在排序后相邻，切分为倒排表
+    m_rows.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+            m_keys.push_back(pairs[i].first);
+            m_offsets.push_back(static_cast<uint32_t>(i));
+        }
+        m_rows.push_back(pairs[i].second);
+    }
+    m_offsets.push_back(static_cast<uint32_t>(pairs.size()));
+
+    m_slots.assign(SlotCount(m_keys.size()), 0);
+    size_t mask = m_slots.size() - 1;
+    for (uint32_t k = 0; k < m_keys.size(); ++k) {
+        size_t slot = HashNumber(m_keys[k]) & mask;
+        while (m_slots[slot] != 0) slot = (slot + 1) & mask;
+        m_slots[slot] = k + 1;
+    }
+}
+
+void ColumnIndex::FillStringHash(const std::vector<std::string>& dictionary) {
+    m_slots.assign(SlotCount(dictionary.size()), 0);
+    size_t mask = m_slots.size() - 1;
+    for (uint32_t d = 0; d < dictionary.size(); ++d) {
+        size_t slot = HashString(dictionary[d]) & mask;
+        while (m_slots[slot] != 0) slot = (slot + 1) & mask;
+        m_slots[slot] = d + 1;
+    }
+}
+
+void ColumnIndex::FillGrams(const std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+            m_grams.push_back(pairs[i].first);
+            m_gramOffsets.push_back(static_cast<uint32_t>(i));
+        }
+        m_gramCodes.push_back(pairs[i].second);
+    }
+    m_gramOffsets.push_back(static_cast<uint32_t>(pairs.size()));
+}
+
+
+bool ColumnIndex::Matches(const ColumnTable::Column& column) const {
+    if (m_fingerprint != column.Fingerprint() || m_string != (column.GetKind() == Kind::String)) {
+        return false;
+    }
+    if (!Supports(column, m_type)) {
+        return false;
+    }
+    // 指纹相同时内容来自同一列，这里只防御损坏的索引文件
+    const size_t n = column.Size();
+    const size_t keys = m_string ? column.Dictionary().size() : m_keys.size();
+    for (uint32_t row : m_rows) {
+        if (row >= n) return false;
+    }
+    if (m_string || m_type == Type::Hash) {
+        if (m_offsets.size() != keys + 1 || m_offsets.back() != m_rows.size()) return false;
+        for (size_t k = 0; k < keys; ++k) {
+            if (m_offsets[k] > m_offsets[k + 1]) return false;
+        }
+    }
+    for (uint32_t v : m_order) {
+        if (v >= (m_string ? keys : n)) return false;
+    }
+    // 开放寻址的查找依赖：槽数为 2 的幂，且至少有一个空槽，否则 FindCode / NumberEqual 会越界或无限探测
+    if (m_type == Type::Hash) {
+        if (m_slots.empty() || (m_slots.size() & (m_slots.size() - 1)) != 0 || m_slots.size() <= keys) return false;
+    }
+    else if (!m_slots.empty()) {
+        return false;
+    }
+    size_t occupied = 0;
+    for (uint32_t slot : m_slots) {
+        if (slot > keys) return false;
+        if (slot != 0) ++occupied;
+    }
+    if (occupied > keys) return false;
+    if (m_type == Type::Trigram) {
+        if (m_gramOffsets.size() != m_grams.size() + 1 || m_gramOffsets.back() != m_gramCodes.size()) return false;
+        for (size_t k = 0; k < m_grams.size(); ++k) {
+            if (m_gramOffsets[k] > m_gramOffsets[k + 1]) return false;
+        }
+        for (uint32_t code : m_gramCodes) {
+            if (code >= keys) return false;
+        }
+    }
+    return true;
+}
+
+
+// --- 查询 ---
+
+std::vector<uint32_t> ColumnIndex::NumberRange(const ColumnTable::Column& column, double lo, bool loInclusive, double hi, bool hiInclusive) const {
+    auto valueAt = [&](uint32_t row) { return column.NumberAt(row); };
+    auto begin = std::partition_point(m_order.begin(), m_order.end(), [&](uint32_t row) {
+        double v = valueAt(row);
+        return loInclusive ? v < lo : v <= lo;
+    });
+    auto end = std::partition_point(begin, m_order.end(), [&](uint32_t row) {
+        double v = valueAt(row);
+        return hiInclusive ? v <= hi : v < hi;
+    });
+    std::vector<uint32_t> rows(begin, end);
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+std::vector<uint32_t> ColumnIndex::NumberEqual(double value) const {
+    std::vector<uint32_t> rows;
+    if (m_slots.empty()) return rows;
+    value = NormalizeKey(value);
+    size_t mask = m_slots.size() - 1;
+    for (size_t slot = HashNumber(value) & mask; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+        uint32_t k = m_slots[slot] - 1;
+        if (m_keys[k] == value) {
+            rows.assign(m_rows.begin() + m_offsets[k], m_rows.begin() + m_offsets[k + 1]);
+            break;
+        }
+    }
+    return rows;
+}
+
+void ColumnIndex::AppendPostings(uint32_t code, std::vector<uint32_t>& rows) const {
+    if (code + 1 >= m_offsets.size()) return;
+    rows.insert(rows.end(), m_rows.begin() + m_offsets[code], m_rows.begin() + m_offsets[code + 1]);
+}
+
+bool ColumnIndex::FindCode(const ColumnTable::Column& column, std::string_view value, uint32_t& code) const {
+    const auto& dictionary = column.Dictionary();
+    if (m_type == Type::Hash) {
+        size_t mask = m_slots.size() - 1;
+        for (size_t slot = HashString(value) & mask; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+            uint32_t d = m_slots[slot] - 1;
+            if (dictionary[d] == value) {
+                code = d;
+                return true;
+            }
+        }
+        return false;
+    }
+    if (m_type == Type::Sorted) {
+        auto it = std::lower_bound(m_order.begin(), m_order.end(), value,
+            [&dictionary](uint32_t d, std::string_view v) { return std::string_view(dictionary[d]) < v; });
+        if (it != m_order.end() && dictionary[*it] == value) {
+            code = *it;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> ColumnIndex::CodeRange(const ColumnTable::Column& column, const std::string* lo, bool loInclusive, const std::string* hi, bool hiInclusive) const {
+    const auto& dictionary = column.Dictionary();
+    auto begin = m_order.begin();
+    if (lo) {
+        begin = std::partition_point(m_order.begin(), m_order.end(), [&](uint32_t d) {
+            return loInclusive ? dictionary[d] < *lo : !(*lo < dictionary[d]);
+        });
+    }
+    auto end = m_order.end();
+    if (hi) {
+        end = std::partition_point(begin, m_order.end(), [&](uint32_t d) {
+            return hiInclusive ? !(*hi < dictionary[d]) : dictionary[d] < *hi;
+        });
+    }
+    return std::vector<uint32_t>(begin, end);
+}
+
+bool ColumnIndex::CandidateCodes(std::string_view lowerNeedle, std::vector<uint32_t>& codes) const {
+    if (m_type != Type::Trigram || lowerNeedle.size() < 3) return false;
+
+    std::vector<uint32_t> grams;
+    for (size_t i = 0; i + 3 <= lowerNeedle.size(); ++i) grams.push_back(Gram(lowerNeedle.data() + i));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    // 从最短的倒排表开始求交集
+    std::vector<std::pair<uint32_t, uint32_t>> lists;
+    for (uint32_t gram : grams) {
+        auto it = std::lower_bound(m_grams.begin(), m_grams.end(), gram);
+        if (it == m_grams.end() || *it != gram) {
+            codes.clear();
+            return true;
+        }
+        size_t k = static_cast<size_t>(it - m_grams.begin());
+        lists.emplace_back(m_gramOffsets[k], m_gramOffsets[k + 1]);
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.second - a.first < b.second - b.first; });
+
+    codes.assign(m_gramCodes.begin() + lists[0].first, m_gramCodes.begin() + lists[0].second);
+    for (size_t l = 1; l < lists.size() && !codes.empty(); ++l) {
+        std::vector<uint32_t> next;
+        std::set_intersection(codes.begin(), codes.end(),
+            m_gramCodes.begin() + lists[l].first, m_gramCodes.begin() + lists[l].second, std::back_inserter(next));
+        codes = std::move(next);
+    }
+    return true;
+}
+
+size_t ColumnIndex::MemoryUsage() const {
+    return sizeof(ColumnIndex) +
+        (m_order.capacity() + m_offsets.capacity() + m_rows.capacity() + m_slots.capacity() +
+            m_grams.capacity() + m_gramOffsets.capacity() + m_gramCodes.capacity()) * sizeof(uint32_t) +
+        m_keys.capacity() * sizeof(double);
+}
+
+
+// --- 持久化 ---
+
+std::filesystem::path ColumnIndex::IndexPathFor(const std::filesystem::path& database) {
+    std::filesystem::path indexPath = database;
+    indexPath += L".index";
+    return indexPath;
+}
+
+void ColumnIndex::Serialize(std::string& out) const {
+    PutPod(out, static_cast<uint8_t>(m_type));
+    PutPod(out, static_cast<uint8_t>(m_string ? 1 : 0));
+    PutPod(out, static_cast<uint32_t>(m_column));
+    PutPod(out, m_fingerprint);
+    PutVector(out, m_order);
+    PutVector(out, m_offsets);
+    PutVector(out, m_rows);
+    PutVector(out, m_keys);
+    PutVector(out, m_slots);
+    PutVector(out, m_grams);
+    PutVector(out, m_gramOffsets);
+    PutVector(out, m_gramCodes);
+}
+
+std::shared_ptr<const ColumnIndex> ColumnIndex::Deserialize(std::string_view& in) {
+    auto index = std::make_shared<ColumnIndex>();
+    uint8_t type = 0, isString = 0;
+    uint32_t column = 0;
+    if (!GetPod(in, type) || type > static_cast<uint8_t>(Type::Trigram)) return nullptr;
+    if (!GetPod(in, isString) || !GetPod(in, column) || !GetPod(in, index->m_fingerprint)) return nullptr;
+    index->m_type = static_cast<Type>(type);
+    index->m_string = isString != 0;
+    index->m_column = column;
+    bool ok = GetVector(in, index->m_order) && GetVector(in, index->m_offsets) && GetVector(in, index->m_rows) &&
+        GetVector(in, index->m_keys) && GetVector(in, index->m_slots) && GetVector(in, index->m_grams) &&
+        GetVector(in, index->m_gramOffsets) && GetVector(in, index->m_gramCodes);
+    if (!ok) return nullptr;
+    // 槽位数必须是 2 的幂，否则探测会越界
+    if (!index->m_slots.empty() && (index->m_slots.size() & (index->m_slots.size() - 1)) != 0) return nullptr;
+    return index;
+}
+
+std::string ColumnIndex::EncodeFile(const std::vector<std::shared_ptr<const ColumnIndex>>& indexes) {
+    std::string out(kIndexMagic, 4);
+    PutPod(out, static_cast<uint32_t>(indexes.size()));
+    for (const auto& index : indexes) {
+        index->Serialize(out);
+    }
+    return out;
+}
+
+std::vector<std::shared_ptr<const ColumnIndex>> ColumnIndex::DecodeFile(std::string_view bytes) {
+    std::vector<std::shared_ptr<const ColumnIndex>> indexes;
+    uint32_t count = 0;
+    if (bytes.size() < 4 || std::memcmp(bytes.data(), kIndexMagic, 4) != 0) return indexes;
+    bytes.remove_prefix(4);
+    if (!GetPod(bytes, count)) return indexes;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::shared_ptr<const ColumnIndex> index = Deserialize(bytes);
+        if (!index) return {};
+        indexes.push_back(std::move(index));
+    }
+    return indexes;
+}
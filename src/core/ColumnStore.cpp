@@ -0,0 +1,371 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "include/ColumnStore.h"
+
+
+namespace {
+    using Kind = ColumnTable::Kind;
+
+    const char kMagic[4] = { 'V', 'N', 'T', '1' };
+    constexpr size_t kHeaderSize = 8;
+    constexpr size_t kTrailerSize = 20;
+
+    void PutU32(std::string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void PutU64(std::string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    uint64_t GetU64(const char* in) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+
+    // 一个行组内一列的统计信息，写入 footer
+    json ComputeStats(const ColumnTable::Column& column) {
+        const size_t n = column.Size();
+        uint64_t empties = 0;
+        json stats = { {"kind", static_cast<int>(column.GetKind())} };
+
+        switch (column.GetKind()) {
+        case Kind::Integer:
+        case Kind::Number: {
+            bool any = false;
+            double lo = 0.0, hi = 0.0;
+            for (size_t r = 0; r < n; ++r) {
+                if (column.IsNull(r)) { ++empties; continue; }
+                double v = column.NumberAt(r);
+                if (!any || v < lo) lo = v;
+                if (!any || v > hi) hi = v;
+                any = true;
+            }
+            if (any) {
+                stats["min"] = lo;
+                stats["max"] = hi;
+            }
+            break;
+        }
+        case Kind::String: {
+            // 行组内的字典只包含组内出现过的字符串，直接在字典上求范围
+            const auto& dictionary = column.Dictionary();
+            const std::string* lo = nullptr;
+            const std::string* hi = nullptr;
+            for (const auto& s : dictionary) {
+                if (s.empty()) continue;
+                if (!lo || s < *lo) lo = &s;
+                if (!hi || *hi < s) hi = &s;
+            }
+            for (size_t r = 0; r < n; ++r) {
+                if (column.IsNull(r) || column.StringAt(r).empty()) ++empties;
+            }
+            if (lo) {
+                stats["min"] = *lo;
+                stats["max"] = *hi;
+            }
+            break;
+        }
+        case Kind::Bool:
+            for (size_t r = 0; r < n; ++r) empties += column.IsNull(r) ? 1 : 0;
+            break;
+        case Kind::Mixed:
+            for (size_t r = 0; r < n; ++r) {
+                const json& value = column.MixedAt(r);
+                if (value.is_null() || (value.is_string() && value.get_ref<const std::string&>().empty())) ++empties;
+            }
+            break;
+        case Kind::Empty:
+            empties = n;
+            break;
+        }
+        stats["empties"] = empties;
+        return stats;
+    }
+
+    Kind MergeKinds(Kind a, Kind b) {
+        if (a == Kind::Empty) return b;
+        if (b == Kind::Empty || a == b) return a;
+        bool numeric = (a == Kind::Integer || a == Kind::Number) && (b == Kind::Integer || b == Kind::Number);
+        return numeric ? Kind::Number : Kind::Mixed;
+    }
+}
+
+
+std::filesystem::path ColumnStore::PathFor(const std::filesystem::path& database) {
+    std::filesystem::path path = database;
+    path += L".columns";
+    return path;
+}
+
+
+// --- Writer ---
+
+ColumnStore::Writer::Writer(Sink sink, size_t rowGroupRows)
+    : m_sink(std::move(sink)), m_rowGroupRows(rowGroupRows == 0 ? kDefaultRowGroupRows : rowGroupRows) {
+}
+
+bool ColumnStore::Writer::Write(std::string_view bytes) {
+    if (!m_ok) return false;
+    if (!m_started) {
+        m_started = true;
+        std::string header(kMagic, 4);
+        PutU32(header, 0);
+        if (!m_sink(header)) return m_ok = false;
+        m_offset = header.size();
+    }
+    if (!bytes.empty() && !m_sink(bytes)) return m_ok = false;
+    m_offset += bytes.size();
+    return true;
+}
+
+bool ColumnStore::Writer::AppendRow(const json& row) {
+    if (!m_ok) return false;
+    if (!m_hasFirstRow) {
+        m_firstRow = row;
+        m_hasFirstRow = true;
+        return true;
+    }
+    if (!m_builder) {
+        m_builder = std::make_unique<ColumnTable::Builder>(false);
+    }
+    m_builder->AppendRow(row);
+    ++m_dataRows;
+    if (m_builder->DataRows() >= m_rowGroupRows) {
+        return FlushGroup();
+    }
+    return true;
+}
+
+bool ColumnStore::Writer::FlushGroup() {
+    if (!m_builder || m_builder->DataRows() == 0) return m_ok;
+    std::shared_ptr<const ColumnTable> group = m_builder->Finish();
+
+    std::string encoded;
+    group->EncodeSegment(encoded);
+
+    json stats = json::array();
+    for (size_t c = 0; c < group->ColumnCount(); ++c) {
+        stats.push_back(ComputeStats(group->GetColumn(c)));
+    }
+    m_columns = std::max(m_columns, group->ColumnCount());
+
+    // 写入头部之后 m_offset 才是行组的起点
+    if (!Write(std::string_view())) return false;
+    m_groups.push_back({
+        {"offset", m_offset},
+        {"length", encoded.size()},
+        {"rows", group->RowCount()},
+        {"stats", std::move(stats)}
+    });
+    return Write(encoded);
+}
+
+bool ColumnStore::Writer::Finish() {
+    if (!FlushGroup()) return false;
+    if (!Write(std::string_view())) return false;
+
+    json footer = {
+        {"firstRow", m_firstRow},
+        {"hasFirstRow", m_hasFirstRow},
+        {"rows", m_dataRows},
+        {"columns", m_columns},
+        {"groups", std::move(m_groups)}
+    };
+    m_groups = json::array();
+    std::string encoded;
+    json::to_cbor(footer, encoded);
+
+    uint64_t footerOffset = m_offset;
+    std::string trailer;
+    PutU64(trailer, footerOffset);
+    PutU64(trailer, encoded.size());
+    trailer.append(kMagic, 4);
+    return Write(encoded) && Write(trailer);
+}
+
+
+// --- StoredTable ---
+
+std::shared_ptr<const ColumnStore::StoredTable> ColumnStore::StoredTable::Open(const std::filesystem::path& path) {
+    auto table = std::make_shared<StoredTable>();
+    if (!table->m_file.Open(path)) {
+        return nullptr;
+    }
+    std::string_view bytes = table->m_file.View();
+    if (bytes.size() < kHeaderSize + kTrailerSize ||
+        std::memcmp(bytes.data(), kMagic, 4) != 0 ||
+        std::memcmp(bytes.data() + bytes.size() - 4, kMagic, 4) != 0) {
+        return nullptr;
+    }
+
+    const char* trailer = bytes.data() + bytes.size() - kTrailerSize;
+    uint64_t footerOffset = GetU64(trailer);
+    uint64_t footerLength = GetU64(trailer + 8);
+    if (footerOffset < kHeaderSize || footerOffset > bytes.size() - kTrailerSize ||
+        footerLength != bytes.size() - kTrailerSize - footerOffset) {
+        return nullptr;
+    }
+
+    try {
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>(bytes.data()) + footerOffset;
+        json footer = json::from_cbor(begin, begin + footerLength);
+
+        table->m_firstRow = footer.at("firstRow");
+        table->m_hasFirstRow = footer.at("hasFirstRow").get<bool>();
+        table->m_dataRows = footer.at("rows").get<size_t>();
+        table->m_columns = footer.at("columns").get<size_t>();
+
+        size_t start = 0;
+        for (const auto& g : footer.at("groups")) {
+            Group group;
+            group.offset = g.at("offset").get<uint64_t>();
+            group.length = g.at("length").get<uint64_t>();
+            group.rows = g.at("rows").get<size_t>();
+            group.start = start;
+            if (group.offset < kHeaderSize || group.offset > footerOffset || group.length > footerOffset - group.offset) {
+                return nullptr;
+            }
+            for (const auto& s : g.at("stats")) {
+                ColumnStats stats;
+                int kind = s.at("kind").get<int>();
+                if (kind < static_cast<int>(Kind::Empty) || kind > static_cast<int>(Kind::Mixed)) return nullptr;
+                stats.kind = static_cast<Kind>(kind);
+                stats.empties = s.at("empties").get<uint64_t>();
+                if (s.contains("min") && s.contains("max")) {
+                    stats.hasRange = true;
+                    if (s["min"].is_number()) {
+                        stats.minNumber = s["min"].get<double>();
+                        stats.maxNumber = s["max"].get<double>();
+                    }
+                    else {
+                        stats.minText = s["min"].get<std::string>();
+                        stats.maxText = s["max"].get<std::string>();
+                    }
+                }
+                group.stats.push_back(std::move(stats));
+            }
+            start += group.rows;
+            table->m_groups.push_back(std::move(group));
+        }
+        if (start != table->m_dataRows) {
+            return nullptr;
+        }
+    }
+    catch (const std::exception&) {
+        return nullptr;
+    }
+    return table;
+}
+
+const ColumnStore::ColumnStats* ColumnStore::StoredTable::Stats(size_t group, size_t column) const {
+    const auto& stats = m_groups[group].stats;
+    return column < stats.size() ? &stats[column] : nullptr;
+}
+
+std::shared_ptr<const ColumnTable> ColumnStore::StoredTable::RowGroup(size_t group) const {
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+            if (it->first == group) {
+                m_cache.splice(m_cache.begin(), m_cache, it);
+                return m_cache.front().second;
+            }
+        }
+    }
+
+    // 在锁外解码，其他线程可以同时读取已缓存的行组
+    const Group& g = m_groups[group];
+    std::shared_ptr<const ColumnTable> decoded = ColumnTable::DecodeSegment(m_file.View().substr(g.offset, g.length));
+    if (decoded->RowCount() != g.rows) {
+        throw std::runtime_error("Malformed columnar storage file.");
+    }
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    m_cache.emplace_front(group, decoded);
+    if (m_cache.size() > kCachedGroups) {
+        m_cache.pop_back();
+    }
+    return decoded;
+}
+
+size_t ColumnStore::StoredTable::GroupOf(size_t dataRow) const {
+    auto it = std::upper_bound(m_groups.begin(), m_groups.end(), dataRow,
+        [](size_t row, const Group& group) { return row < group.start; });
+    return static_cast<size_t>(it - m_groups.begin()) - 1;
+}
+
+json ColumnStore::StoredTable::RowAt(size_t row) const {
+    if (m_hasFirstRow && row == 0) {
+        return m_firstRow;
+    }
+    size_t dataRow = row - (m_hasFirstRow ? 1 : 0);
+    size_t group = GroupOf(dataRow);
+    return RowGroup(group)->RowAt(dataRow - m_groups[group].start);
+}
+
+json ColumnStore::StoredTable::RowsAt(const std::vector<uint32_t>& rows, size_t begin, size_t end) const {
+    json out = json::array();
+    end = std::min(end, rows.size());
+    if (begin >= end) return out;
+
+    // (行组, 结果中的位置)：按行组分桶，每个行组只解码一次
+    std::vector<std::pair<size_t, size_t>> order;
+    order.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        out.push_back(nullptr);
+        if (m_hasFirstRow && rows[i] == 0) {
+            out[i - begin] = m_firstRow;
+            continue;
+        }
+        order.emplace_back(GroupOf(rows[i] - (m_hasFirstRow ? 1 : 0)), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::shared_ptr<const ColumnTable> decoded;
+    size_t current = SIZE_MAX;
+    for (const auto& [group, i] : order) {
+        if (group != current) {
+            decoded = RowGroup(group);
+            current = group;
+        }
+        size_t dataRow = rows[i] - (m_hasFirstRow ? 1 : 0);
+        out[i - begin] = decoded->RowAt(dataRow - m_groups[group].start);
+    }
+    return out;
+}
+
+json ColumnStore::StoredTable::ToRows() const {
+    json rows = json::array();
+    if (m_hasFirstRow) {
+        rows.push_back(m_firstRow);
+    }
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        std::shared_ptr<const ColumnTable> decoded = RowGroup(g);
+        for (size_t r = 0; r < decoded->RowCount(); ++r) {
+            rows.push_back(decoded->RowAt(r));
+        }
+    }
+    return rows;
+}
+
+json ColumnStore::StoredTable::DescribeColumns() const {
+    json columns = json::array();
+    for (size_t c = 0; c < m_columns; ++c) {
+        Kind kind = Kind::Empty;
+        for (const auto& group : m_groups) {
+            if (c < group.stats.size()) kind = MergeKinds(kind, group.stats[c].kind);
+        }
+        json header = (m_firstRow.is_array() && c < m_firstRow.size()) ? m_firstRow[c] : json(nullptr);
+        columns.push_back({
+            {"index", c},
+            {"header", header},
+            {"type", ColumnTable::KindName(kind)}
+        });
+    }
+    return columns;
+}
@@ -0,0 +1,689 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "include/ColumnTable.h"
+#include "include/CsvParser.h"
+
+
+namespace {
+    // 定长向量与 CBOR 二进制块互转（本机字节序，所有目标平台均为小端序）
+    template <typename T>
+    json ToBinary(const std::vector<T>& values) {
+        std::vector<uint8_t> bytes(values.size() * sizeof(T));
+        if (!bytes.empty()) std::memcpy(bytes.data(), values.data(), bytes.size());
+        return json::binary(std::move(bytes));
+    }
+
+    template <typename T>
+    void FromBinary(const json& value, std::vector<T>& out, size_t expected) {
+        if (!value.is_binary() || value.get_binary().size() != expected * sizeof(T)) {
+            throw std::runtime_error("Malformed column segment.");
+        }
+        out.resize(expected);
+        if (expected > 0) std::memcpy(out.data(), value.get_binary().data(), expected * sizeof(T));
+    }
+
+    // double 能精确表示的整数范围 [-2^53, 2^53]；超出范围的整数存为 double 会丢失精度
+    bool ExactInDouble(int64_t value) {
+        constexpr int64_t kLimit = int64_t(1) << 53;
+        return value >= -kLimit && value <= kLimit;
+    }
+}
+
+
+// --- Column ---
+
+json ColumnTable::Column::ValueAt(size_t row) const {
+    if (IsNull(row)) {
+        return m_kind == Kind::Mixed ? m_mixed[row] : json(nullptr);
+    }
+    switch (m_kind) {
+    case Kind::Integer: return m_integers[row];
+    case Kind::Number:
+        // 整数与浮点数混合的列中，原本是整数的值仍以整数返回
+        if (IsIntegral(row)) return static_cast<int64_t>(m_numbers[row]);
+        return m_numbers[row];
+    case Kind::Bool: return m_bools[row] != 0;
+    case Kind::String: return m_dictionary[m_codes[row]];
+    case Kind::Mixed: return m_mixed[row];
+    case Kind::Empty:
+    default: return nullptr;
+    }
+}
+
+bool ColumnTable::Column::IsIntegral(size_t row) const {
+    return (row >> 6) < m_integral.size() && ((m_integral[row >> 6] >> (row & 63)) & 1u);
+}
+
+void ColumnTable::Column::AppendNull() {
+    if ((m_size & 63) == 0) m_nulls.push_back(0);
+    m_nulls.back() |= uint64_t(1) << (m_size & 63);
+
+    switch (m_kind) {
+    case Kind::Integer: m_integers.push_back(0); break;
+    case Kind::Number:
+        if ((m_size & 63) == 0) m_integral.push_back(0);
+        m_numbers.push_back(0.0);
+        break;
+    case Kind::Bool: m_bools.push_back(0); break;
+    case Kind::String: m_codes.push_back(0); break;
+    case Kind::Mixed: m_mixed.push_back(nullptr); break;
+    case Kind::Empty: break;
+    }
+    ++m_size;
+}
+
+void ColumnTable::Column::Append(const json& value) {
+    if (value.is_null()) {
+        AppendNull();
+        return;
+    }
+    PrepareFor(value);
+
+    if ((m_size & 63) == 0) m_nulls.push_back(0);
+    switch (m_kind) {
+    case Kind::Integer: m_integers.push_back(value.get<int64_t>()); break;
+    case Kind::Number:
+        if ((m_size & 63) == 0) m_integral.push_back(0);
+        if (value.is_number_integer()) m_integral.back() |= uint64_t(1) << (m_size & 63);
+        else m_integral.back() &= ~(uint64_t(1) << (m_size & 63)); // 升级时整字填充过
+        m_numbers.push_back(value.get<double>());
+        break;
+    case Kind::Bool: m_bools.push_back(value.get<bool>() ? 1 : 0); break;
+    case Kind::String: m_codes.push_back(Intern(value.get_ref<const std::string&>())); break;
+    case Kind::Mixed: m_mixed.push_back(value); break;
+    case Kind::Empty: break;
+    }
+    ++m_size;
+}
+
+void ColumnTable::Column::Set(size_t row, const json& value) {
+    const uint64_t bit = uint64_t(1) << (row & 63);
+    if (m_kind == Kind::Number) {
+        m_integral.resize((m_size + 63) / 64, 0); // 早期的行组没有 integral
+    }
+    if (value.is_null()) {
+        m_nulls[row >> 6] |= bit;
+        switch (m_kind) {
+        case Kind::Integer: m_integers[row] = 0; break;
+        case Kind::Number:
+            m_numbers[row] = 0.0;
+            m_integral[row >> 6] &= ~bit;
+            break;
+        case Kind::Bool: m_bools[row] = 0; break;
+        case Kind::String: m_codes[row] = 0; break;
+        case Kind::Mixed: m_mixed[row] = nullptr; break;
+        case Kind::Empty: break;
+        }
+        return;
+    }
+    PrepareFor(value);
+
+    m_nulls[row >> 6] &= ~bit;
+    switch (m_kind) {
+    case Kind::Integer: m_integers[row] = value.get<int64_t>(); break;
+    case Kind::Number:
+        if (value.is_number_integer()) m_integral[row >> 6] |= bit;
+        else m_integral[row >> 6] &= ~bit;
+        m_numbers[row] = value.get<double>();
+        break;
+    case Kind::Bool: m_bools[row] = value.get<bool>() ? 1 : 0; break;
+    case Kind::String: m_codes[row] = Intern(value.get_ref<const std::string&>()); break;
+    case Kind::Mixed: m_mixed[row] = value; break;
+    case Kind::Empty: break;
+    }
+}
+
+uint32_t ColumnTable::Column::Intern(const std::string& value) {
+    // Finish 之后查找表已释放，再次写入时按字典重建；已有的编码保持不变
+    if (m_lookup.empty()) {
+        for (uint32_t d = 0; d < m_dictionary.size(); ++d) m_lookup.emplace(m_dictionary[d], d);
+    }
+    auto it = m_lookup.find(value);
+    if (it == m_lookup.end()) {
+        it = m_lookup.emplace(value, static_cast<uint32_t>(m_dictionary.size())).first;
+        m_dictionary.push_back(value);
+    }
+    return it->second;
+}
+
+void ColumnTable::Column::Narrow() {
+    if (m_kind == Kind::Empty) {
+        return;
+    }
+    if (m_kind == Kind::Mixed) {
+        // 逐个重新写入即可得到与从头构建相同的类型
+        Column rebuilt;
+        for (size_t row = 0; row < m_size; ++row) rebuilt.Append(m_mixed[row]);
+        *this = std::move(rebuilt);
+        return;
+    }
+
+    bool anyValue = false;
+    bool allIntegral = true;
+    for (size_t w = 0; w < m_nulls.size(); ++w) {
+        size_t bits = std::min<size_t>(64, m_size - w * 64);
+        uint64_t valid = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        uint64_t present = ~m_nulls[w] & valid;
+        anyValue = anyValue || present != 0;
+        if (m_kind == Kind::Number && (present & ~(w < m_integral.size() ? m_integral[w] : 0)) != 0) allIntegral = false;
+    }
+    if (!anyValue) {
+        // 只剩空值：从头构建时不会确定类型
+        std::vector<uint64_t> nulls = std::move(m_nulls);
+        size_t size = m_size;
+        *this = Column();
+        m_nulls = std::move(nulls);
+        m_size = size;
+        return;
+    }
+    if (m_kind == Kind::Number && allIntegral) {
+        // 引入浮点数的值已被覆盖，还原为整数列
+        m_integers.assign(m_size, 0);
+        for (size_t row = 0; row < m_size; ++row) {
+            if (!IsNull(row)) m_integers[row] = static_cast<int64_t>(m_numbers[row]);
+        }
+        m_numbers.clear();
+        m_integral.clear();
+        m_kind = Kind::Integer;
+    }
+}
+
+void ColumnTable::Column::PrepareFor(const json& value) {
+    // 根据新值决定列类型，不兼容时升级。升级不能改变已有的值：
+    // double 无法精确表示的整数（包括超出 int64 的 uint64）不进入 Number 列，而是整列转为 Mixed
+    Kind wanted;
+    if (value.is_number_unsigned() && value.get<uint64_t>() > static_cast<uint64_t>(INT64_MAX)) {
+        wanted = Kind::Mixed;
+    }
+    else if (value.is_number_integer()) {
+        if (m_kind != Kind::Number) {
+            wanted = Kind::Integer;
+        }
+        else {
+            wanted = ExactInDouble(value.get<int64_t>()) ? Kind::Number : Kind::Mixed;
+        }
+    }
+    else if (value.is_number()) {
+        bool exact = m_kind != Kind::Integer ||
+            std::all_of(m_integers.begin(), m_integers.end(), [](int64_t v) { return ExactInDouble(v); });
+        wanted = exact ? Kind::Number : Kind::Mixed;
+    }
+    else if (value.is_boolean()) {
+        wanted = Kind::Bool;
+    }
+    else if (value.is_string()) {
+        wanted = Kind::String;
+    }
+    else {
+        wanted = Kind::Mixed;
+    }
+    if (m_kind == Kind::Mixed) {
+        wanted = Kind::Mixed;
+    }
+    else if (m_kind != Kind::Empty && m_kind != wanted) {
+        bool numeric = (m_kind == Kind::Integer && wanted == Kind::Number);
+        wanted = numeric ? Kind::Number : Kind::Mixed;
+    }
+    if (wanted != m_kind) {
+        PromoteTo(wanted);
+    }
+}
+
+void ColumnTable::Column::PromoteTo(Kind kind) {
+    if (kind == Kind::Mixed) {
+        std::vector<json> values;
+        values.reserve(m_size + 1);
+        for (size_t row = 0; row < m_size; ++row) {
+            values.push_back(ValueAt(row));
+        }
+        m_integers.clear();
+        m_numbers.clear();
+        m_bools.clear();
+        m_codes.clear();
+        m_dictionary.clear();
+        m_lookup.clear();
+        m_integral.clear();
+        m_mixed = std::move(values);
+    }
+    else if (m_kind == Kind::Integer && kind == Kind::Number) {
+        // 调用方已确认所有整数都能被 double 精确表示；记下它们原本是整数
+        m_numbers.assign(m_integers.begin(), m_integers.end());
+        m_integers.clear();
+        m_integral.assign((m_size + 63) / 64, ~uint64_t(0));
+    }
+    else {
+        // 从 Empty 升级：此前的行都是空值，补上占位
+        switch (kind) {
+        case Kind::Integer: m_integers.assign(m_size, 0); break;
+        case Kind::Number:
+            m_numbers.assign(m_size, 0.0);
+            m_integral.assign((m_size + 63) / 64, 0);
+            break;
+        case Kind::Bool: m_bools.assign(m_size, 0); break;
+        case Kind::String: m_codes.assign(m_size, 0); break;
+        default: break;
+        }
+    }
+    m_kind = kind;
+}
+
+void ColumnTable::Column::Finish() {
+    std::unordered_map<std::string, uint32_t>().swap(m_lookup);
+    m_integers.shrink_to_fit();
+    m_numbers.shrink_to_fit();
+    m_bools.shrink_to_fit();
+    m_codes.shrink_to_fit();
+    m_dictionary.shrink_to_fit();
+    m_mixed.shrink_to_fit();
+    m_nulls.shrink_to_fit();
+    m_integral.shrink_to_fit();
+}
+
+size_t ColumnTable::Column::MemoryUsage() const {
+    size_t bytes = m_integers.capacity() * sizeof(int64_t) +
+        m_numbers.capacity() * sizeof(double) +
+        m_bools.capacity() +
+        m_codes.capacity() * sizeof(uint32_t) +
+        (m_nulls.capacity() + m_integral.capacity()) * sizeof(uint64_t) +
+        m_mixed.capacity() * sizeof(json);
+    for (const auto& s : m_dictionary) {
+        bytes += sizeof(std::string) + (s.capacity() > 15 ? s.capacity() : 0);
+    }
+    return bytes;
+}
+
+uint64_t ColumnTable::Column::Fingerprint() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    uint64_t header[2] = { static_cast<uint64_t>(m_kind), static_cast<uint64_t>(m_size) };
+    mix(header, sizeof(header));
+    mix(m_nulls.data(), m_nulls.size() * sizeof(uint64_t));
+    mix(m_integers.data(), m_integers.size() * sizeof(int64_t));
+    mix(m_numbers.data(), m_numbers.size() * sizeof(double));
+    mix(m_integral.data(), m_integral.size() * sizeof(uint64_t));
+    mix(m_bools.data(), m_bools.size());
+    mix(m_codes.data(), m_codes.size() * sizeof(uint32_t));
+    for (const auto& s : m_dictionary) {
+        uint64_t length = s.size();
+        mix(&length, sizeof(length));
+        mix(s.data(), s.size());
+    }
+    for (const auto& value : m_mixed) {
+        std::string dumped = value.dump();
+        mix(dumped.data(), dumped.size());
+    }
+    return hash;
+}
+
+// --- ColumnTable ---
+
+ColumnTable::Builder::Builder(bool withFirstRow) : m_table(std::make_shared<ColumnTable>()), m_withFirstRow(withFirstRow) {
+}
+
+void ColumnTable::Builder::AppendRow(const json& row) {
+    ColumnTable& table = *m_table;
+    if (m_withFirstRow && !table.m_hasFirstRow) {
+        table.m_firstRow = row;
+        table.m_hasFirstRow = true;
+        return;
+    }
+
+    size_t rowWidth = row.is_array() ? row.size() : 0;
+    if (rowWidth > table.m_columns.size()) {
+        // 新出现的列：之前的行在这一列上都是空值
+        size_t oldWidth = table.m_columns.size();
+        table.m_columns.resize(rowWidth);
+        for (size_t c = oldWidth; c < rowWidth; ++c) {
+            for (size_t r = 0; r < table.m_dataRows; ++r) table.m_columns[c].AppendNull();
+        }
+        m_ragged = m_ragged || table.m_dataRows > 0;
+    }
+
+    size_t width = table.m_columns.size();
+    for (size_t c = 0; c < width; ++c) {
+        if (c < rowWidth) {
+            table.m_columns[c].Append(row[c]);
+        }
+        else {
+            table.m_columns[c].AppendNull();
+        }
+    }
+    m_widths.push_back(static_cast<uint32_t>(rowWidth));
+    m_ragged = m_ragged || rowWidth != width;
+    ++table.m_dataRows;
+}
+
+std::shared_ptr<const ColumnTable> ColumnTable::Builder::Finish() {
+    if (m_ragged) {
+        m_table->m_rowWidths = std::move(m_widths);
+    }
+    for (auto& column : m_table->m_columns) {
+        column.Finish();
+    }
+    std::shared_ptr<const ColumnTable> table = std::move(m_table);
+    m_table = std::make_shared<ColumnTable>();
+    m_widths.clear();
+    m_ragged = false;
+    return table;
+}
+
+std::shared_ptr<const ColumnTable> ColumnTable::FromRows(const json& rows) {
+    Builder builder;
+    if (rows.is_array()) {
+        for (const auto& row : rows) {
+            builder.AppendRow(row);
+        }
+    }
+    return builder.Finish();
+}
+
+std::shared_ptr<const ColumnTable> ColumnTable::WithRows(const ColumnTable& base, const json& rows, const std::vector<uint32_t>& changedRows) {
+    if (!rows.is_array()) {
+        return nullptr;
+    }
+    auto table = std::make_shared<ColumnTable>(base);
+    for (uint32_t row : changedRows) {
+        if (row >= rows.size()) {
+            return nullptr;
+        }
+        // 空表的第 0 行成为第一行，与 Builder 一致
+        if (row == 0 && (table->m_hasFirstRow || table->m_dataRows == 0)) {
+            table->m_firstRow = rows[0];
+            table->m_hasFirstRow = true;
+            continue;
+        }
+        size_t dataRow = row - (table->m_hasFirstRow ? 1 : 0);
+        if (dataRow > table->m_dataRows) {
+            return nullptr;
+        }
+        table->PutRow(dataRow, rows[row]);
+    }
+    if (table->RowCount() != rows.size()) {
+        return nullptr;
+    }
+    // 覆盖可能去掉了当初使列升级的值（追加不会）
+    bool replaced = !changedRows.empty() && changedRows.front() < base.RowCount();
+    if (replaced && !table->m_rowWidths.empty()) {
+        // 最宽的行被改窄时，多出的列不再存在；行宽重新一致时不再保存行宽
+        uint32_t widest = *std::max_element(table->m_rowWidths.begin(), table->m_rowWidths.end());
+        table->m_columns.resize(std::min<size_t>(table->m_columns.size(), widest));
+        if (std::all_of(table->m_rowWidths.begin(), table->m_rowWidths.end(), [widest](uint32_t w) { return w == widest; })) {
+            table->m_rowWidths.clear();
+        }
+    }
+    for (auto& column : table->m_columns) {
+        if (replaced) column.Narrow();
+        column.Finish();
+    }
+    return table;
+}
+
+void ColumnTable::PutRow(size_t dataRow, const json& row) {
+    const bool append = dataRow == m_dataRows;
+    size_t rowWidth = row.is_array() ? row.size() : 0;
+    if (rowWidth > m_columns.size()) {
+        // 新出现的列：其他行在这一列上都是空值，这些行从此比表窄
+        size_t oldWidth = m_columns.size();
+        if (m_rowWidths.empty() && m_dataRows > 0) {
+            m_rowWidths.assign(m_dataRows, static_cast<uint32_t>(oldWidth));
+        }
+        m_columns.resize(rowWidth);
+        for (size_t c = oldWidth; c < rowWidth; ++c) {
+            for (size_t r = 0; r < m_dataRows; ++r) m_columns[c].AppendNull();
+        }
+    }
+
+    static const json missing;
+    size_t width = m_columns.size();
+    for (size_t c = 0; c < width; ++c) {
+        const json& value = c < rowWidth ? row[c] : missing;
+        if (append) m_columns[c].Append(value);
+        else m_columns[c].Set(dataRow, value);
+    }
+    if (append) {
+        ++m_dataRows;
+    }
+    if (!m_rowWidths.empty() || rowWidth != width) {
+        m_rowWidths.resize(m_dataRows, static_cast<uint32_t>(width));
+        m_rowWidths[dataRow] = static_cast<uint32_t>(rowWidth);
+    }
+}
+
+std::shared_ptr<const ColumnTable> ColumnTable::FromCsv(const ChunkReader& readChunks, char delimiter) {
+    Builder builder;
+    bool ok = ReadCsvRows(readChunks, [&builder](const json& row) {
+        builder.AppendRow(row);
+        return true;
+    }, delimiter);
+    return ok ? builder.Finish() : nullptr;
+}
+
+bool ColumnTable::ReadCsvRows(const ChunkReader& readChunks, const std::function<bool(const json& row)>& onRow, char delimiter) {
+    // 第一遍：只推断类型
+    Csv::TypeInference inference;
+    {
+        bool first = true;
+        Csv::Parser parser([&](const std::vector<std::string>& fields) {
+            if (first) {
+                first = false;
+                return;
+            }
+            inference.Observe(fields);
+        }, delimiter);
+        if (!readChunks([&parser](std::string_view chunk) { parser.Feed(chunk); return true; })) {
+            return false;
+        }
+        parser.Finish();
+    }
+
+    // 第二遍：转换为类型化的值（第一行保持为字符串）
+    bool first = true;
+    bool ok = true;
+    json row = json::array();
+    Csv::Parser parser([&](const std::vector<std::string>& fields) {
+        if (!ok) return;
+        row.clear();
+        for (size_t c = 0; c < fields.size(); ++c) {
+            row.push_back(first ? json(fields[c]) : Csv::ToJsonValue(fields[c], inference.TypeOf(c)));
+        }
+        first = false;
+        ok = onRow(row);
+    }, delimiter);
+    if (!readChunks([&parser, &ok](std::string_view chunk) { parser.Feed(chunk); return ok; })) {
+        return false;
+    }
+    parser.Finish();
+    return ok;
+}
+
+json ColumnTable::RowAt(size_t row) const {
+    if (m_hasFirstRow && row == 0) {
+        return m_firstRow;
+    }
+    size_t dataRow = row - (m_hasFirstRow ? 1 : 0);
+    size_t width = m_rowWidths.empty() ? m_columns.size() : m_rowWidths[dataRow];
+
+    json out = json::array();
+    for (size_t c = 0; c < width; ++c) {
+        out.push_back(m_columns[c].ValueAt(dataRow));
+    }
+    return out;
+}
+
+json ColumnTable::ToRows() const {
+    json rows = json::array();
+    for (size_t r = 0; r < RowCount(); ++r) {
+        rows.push_back(RowAt(r));
+    }
+    return rows;
+}
+
+const char* ColumnTable::KindName(Kind kind) {
+    switch (kind) {
+    case Kind::Integer:
+    case Kind::Number: return "number";
+    case Kind::Bool: return "bool";
+    case Kind::String: return "string";
+    case Kind::Mixed: return "mixed";
+    case Kind::Empty:
+    default: return "empty";
+    }
+}
+
+json ColumnTable::DescribeColumns() const {
+    json columns = json::array();
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        json header = (m_firstRow.is_array() && c < m_firstRow.size()) ? m_firstRow[c] : json(nullptr);
+        columns.push_back({
+            {"index", c},
+            {"header", header},
+            {"type", KindName(m_columns[c].GetKind())}
+        });
+    }
+    return columns;
+}
+
+size_t ColumnTable::MemoryUsage() const {
+    size_t bytes = sizeof(ColumnTable) + m_rowWidths.capacity() * sizeof(uint32_t);
+    for (const auto& column : m_columns) {
+        bytes += column.MemoryUsage();
+    }
+    return bytes;
+}
+
+void ColumnTable::EncodeSegment(std::string& out) const {
+    json columns = json::array();
+    for (const auto& column : m_columns) {
+        json encoded = {
+            {"kind", static_cast<int>(column.m_kind)},
+            {"size", column.m_size},
+            {"nulls", ToBinary(column.m_nulls)}
+        };
+        switch (column.m_kind) {
+        case Kind::Integer: encoded["values"] = ToBinary(column.m_integers); break;
+        case Kind::Number:
+            encoded["values"] = ToBinary(column.m_numbers);
+            encoded["integral"] = ToBinary(column.m_integral);
+            break;
+        case Kind::Bool: encoded["values"] = ToBinary(column.m_bools); break;
+        case Kind::String:
+            encoded["values"] = ToBinary(column.m_codes);
+            encoded["dictionary"] = column.m_dictionary;
+            break;
+        case Kind::Mixed: encoded["values"] = column.m_mixed; break;
+        case Kind::Empty: break;
+        }
+        columns.push_back(std::move(encoded));
+    }
+
+    json segment = { {"rows", m_dataRows}, {"columns", std::move(columns)} };
+    if (!m_rowWidths.empty()) {
+        segment["widths"] = ToBinary(m_rowWidths);
+    }
+    json::to_cbor(segment, out);
+}
+
+std::shared_ptr<const ColumnTable> ColumnTable::DecodeSegment(std::string_view bytes) {
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(bytes.data());
+    json segment = json::from_cbor(begin, begin + bytes.size());
+
+    auto table = std::make_shared<ColumnTable>();
+    table->m_dataRows = segment.at("rows").get<size_t>();
+    const size_t rows = table->m_dataRows;
+    if (segment.contains("widths")) {
+        FromBinary(segment["widths"], table->m_rowWidths, rows);
+    }
+
+    for (auto& encoded : segment.at("columns")) {
+        Column column;
+        int kind = encoded.at("kind").get<int>();
+        if (kind < static_cast<int>(Kind::Empty) || kind > static_cast<int>(Kind::Mixed) || encoded.at("size").get<size_t>() != rows) {
+            throw std::runtime_error("Malformed column segment.");
+        }
+        column.m_kind = static_cast<Kind>(kind);
+        column.m_size = rows;
+        FromBinary(encoded.at("nulls"), column.m_nulls, (rows + 63) / 64);
+
+        switch (column.m_kind) {
+        case Kind::Integer: FromBinary(encoded.at("values"), column.m_integers, rows); break;
+        case Kind::Number:
+            FromBinary(encoded.at("values"), column.m_numbers, rows);
+            // 早期写入的段没有 integral，所有值按浮点数返回
+            if (encoded.contains("integral")) {
+                FromBinary(encoded["integral"], column.m_integral, (rows + 63) / 64);
+            }
+            break;
+        case Kind::Bool: FromBinary(encoded.at("values"), column.m_bools, rows); break;
+        case Kind::String: {
+            FromBinary(encoded.at("values"), column.m_codes, rows);
+            column.m_dictionary = encoded.at("dictionary").get<std::vector<std::string>>();
+            const size_t entries = column.m_dictionary.size();
+            for (size_t r = 0; r < rows; ++r) {
+                // 空值行的编码为占位的 0，字典可能为空
+                if (column.m_codes[r] >= entries && !column.IsNull(r)) {
+                    throw std::runtime_error("Malformed column segment.");
+                }
+            }
+            break;
+        }
+        case Kind::Mixed: {
+            json& values = encoded.at("values");
+            if (!values.is_array() || values.size() != rows) {
+                throw std::runtime_error("Malformed column segment.");
+            }
+            column.m_mixed.reserve(rows);
+            for (auto& value : values) column.m_mixed.push_back(std::move(value));
+            break;
+        }
+        case Kind::Empty: break;
+        }
+        table->m_columns.push_back(std::move(column));
+    }
+    // RowAt 按行宽逐列取值，行宽不能超过列数
+    for (uint32_t width : table->m_rowWidths) {
+        if (width > table->m_columns.size()) {
+            throw std::runtime_error("Malformed column segment.");
+        }
+    }
+    return table;
+}
+
+// --- TableStore ---
+
+std::shared_ptr<const TableStore::Entry> TableStore::Find(const std::wstring& path) {
+    auto it = m_entries.find(path);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    it->second.lastUsed = ++m_clock;
+    return it->second.entry;
+}
+
+void TableStore::Store(const std::wstring& path, std::shared_ptr<const Entry> entry) {
+    if (m_entries.size() >= kMaxEntries && m_entries.find(path) == m_entries.end()) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) oldest = it;
+        }
+        m_entries.erase(oldest);
+    }
+    Slot& slot = m_entries[path];
+    slot.entry = std::move(entry);
+    slot.lastUsed = ++m_clock;
+}
+
+void TableStore::Invalidate(const std::wstring& path) {
+    m_entries.erase(path);
+}
+
+void TableStore::Clear() {
+    m_entries.clear();
+}
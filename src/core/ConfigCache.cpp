@@ -0,0 +1,101 @@
+﻿#include <vector>
+
+#include "include/ConfigCache.h"
+
+
+bool ConfigCache::TryGetResolved(const std::wstring& dir, json& out) const {
+    auto it = m_nodes.find(dir);
+    if (it == m_nodes.end() || !it->second.valid) {
+        return false;
+    }
+    out = it->second.resolved;
+    return true;
+}
+
+void ConfigCache::StoreResolved(const std::wstring& dir, const std::wstring& parentDir, const json& resolved) {
+    // 整表丢弃时父子关系一并丢弃，之后按需重新解析
+    if (m_nodes.size() >= kMaxEntries && m_nodes.find(dir) == m_nodes.end()) {
+        m_nodes.clear();
+    }
+    Node& node = m_nodes[dir];
+    node.resolved = resolved;
+    node.valid = true;
+
+    // 维护父子关系，失效时才能精确地向下传播
+    if (node.parent != parentDir) {
+        if (!node.parent.empty()) {
+            auto oldParent = m_nodes.find(node.parent);
+            if (oldParent != m_nodes.end()) {
+                oldParent->second.children.erase(dir);
+            }
+        }
+        node.parent = parentDir;
+    }
+    if (!parentDir.empty()) {
+        m_nodes[parentDir].children.insert(dir);
+    }
+}
+
+bool ConfigCache::TryGetParent(const std::wstring& identifier, std::wstring& out) const {
+    auto it = m_parents.find(identifier);
+    if (it == m_parents.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+void ConfigCache::StoreParent(const std::wstring& identifier, const std::wstring& parent) {
+    if (m_parents.size() >= kMaxEntries && m_parents.find(identifier) == m_parents.end()) {
+        m_parents.clear();
+    }
+    m_parents[identifier] = parent;
+}
+
+void ConfigCache::InvalidateDirectory(const std::wstring& dir) {
+    // 用显式栈代替递归，避免很深的目录树导致栈溢出
+    std::vector<std::wstring> pending = { dir };
+    while (!pending.empty()) {
+        std::wstring current = std::move(pending.back());
+        pending.pop_back();
+
+        // 无效节点也继续向下传播：整表重建后父节点可能只剩占位，而子节点已重新解析
+        auto it = m_nodes.find(current);
+        if (it == m_nodes.end()) {
+            continue;
+        }
+        it->second.valid = false;
+        it->second.resolved = json();
+        for (const auto& child : it->second.children) {
+            pending.push_back(child);
+        }
+    }
+}
+
+void ConfigCache::Clear() {
+    m_nodes.clear();
+    m_parents.clear();
+}
+
+void ConfigCache::InheritFrom(json& config, const json& parentConfig) {
+    if (!config.is_object()) {
+        config = json::object();
+    }
+    if (!parentConfig.is_object()) {
+        return;
+    }
+
+    for (auto const& [category, catConfig] : parentConfig.items()) {
+        if (!catConfig.is_object()) continue; // Ensure category config is an object
+
+        if (!config.contains(category) || !config[category].is_object()) {
+            config[category] = json::object();
+        }
+        json& target = config[category];
+        for (auto const& [key, value] : catConfig.items()) {
+            if (!target.contains(key) || target[key] == "inherit") {
+                target[key] = value;
+            }
+        }
+    }
+}
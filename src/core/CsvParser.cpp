@@ -0,0 +1,370 @@
+﻿#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "include/CsvParser.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VN_CSV_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define VN_CSV_NEON 1
+#endif
+
+
+namespace {
+    constexpr uint8_t kCandidateNumber = 1u << 0;
+    constexpr uint8_t kCandidateDate = 1u << 1;
+    constexpr uint8_t kCandidateBool = 1u << 2;
+    constexpr uint8_t kAllCandidates = kCandidateNumber | kCandidateDate | kCandidateBool;
+
+    // 返回 [p, p + n) 中第一个分隔符 / 引号 / CR / LF 的偏移，没有则返回 n
+    size_t FindUnquotedSpecial(const char* p, size_t n, char delimiter) {
+        size_t i = 0;
+#if defined(VN_CSV_SSE2)
+        const __m128i vDelim = _mm_set1_epi8(delimiter);
+        const __m128i vQuote = _mm_set1_epi8('"');
+        const __m128i vLf = _mm_set1_epi8('\n');
+        const __m128i vCr = _mm_set1_epi8('\r');
+        for (; i + 16 <= n; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, vDelim), _mm_cmpeq_epi8(chunk, vQuote)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, vLf), _mm_cmpeq_epi8(chunk, vCr)));
+            int mask = _mm_movemask_epi8(hits);
+            if (mask != 0) {
+#if defined(_MSC_VER)
+                unsigned long bit;
+                _BitScanForward(&bit, static_cast<unsigned long>(mask));
+                return i + bit;
+#else
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+            }
+        }
+#elif defined(VN_CSV_NEON)
+        const uint8x16_t vDelim = vdupq_n_u8(static_cast<uint8_t>(delimiter));
+        const uint8x16_t vQuote = vdupq_n_u8('"');
+        const uint8x16_t vLf = vdupq_n_u8('\n');
+        const uint8x16_t vCr = vdupq_n_u8('\r');
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+            uint8x16_t hits = vorrq_u8(
+                vorrq_u8(vceqq_u8(chunk, vDelim), vceqq_u8(chunk, vQuote)),
+                vorrq_u8(vceqq_u8(chunk, vLf), vceqq_u8(chunk, vCr)));
+            if (vmaxvq_u8(hits) != 0) {
+                break; // 命中位置交给下面的标量循环确定
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            char c = p[i];
+            if (c == delimiter || c == '"' || c == '\n' || c == '\r') return i;
+        }
+        return n;
+    }
+
+    bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // 读取恰好 count 位数字
+    bool ReadDigits(std::string_view s, size_t& pos, size_t count, int& out) {
+        if (pos + count > s.size()) return false;
+        out = 0;
+        for (size_t k = 0; k < count; ++k) {
+            char c = s[pos + k];
+            if (!IsDigit(c)) return false;
+            out = out * 10 + (c - '0');
+        }
+        pos += count;
+        return true;
+    }
+
+    // 整数的位数（不含符号）；不超过 18 位时一定在 int64 范围内
+    size_t IntegerDigits(std::string_view s) {
+        return s.size() - ((!s.empty() && (s[0] == '+' || s[0] == '-')) ? 1 : 0);
+    }
+
+    // 转换为数字后能否还原出原文：前导零（邮编、"007" 这样的编号）、超出 int64 的整数
+    // 以及超出 double 范围的值（"1e999" 会变成 inf，写入 JSON 后成为 null）都会丢失信息，这样的列保持为字符串
+    bool IsLosslessNumber(std::string_view s) {
+        size_t i = (!s.empty() && (s[0] == '+' || s[0] == '-')) ? 1 : 0;
+        if (i + 1 < s.size() && s[i] == '0' && IsDigit(s[i + 1])) return false;
+        bool integral = s.find_first_of(".eE") == std::string_view::npos;
+        if (integral) return IntegerDigits(s) <= 18;
+        return std::isfinite(std::strtod(std::string(s).c_str(), nullptr));
+    }
+
+    bool EqualsIgnoreCase(std::string_view a, const char* b) {
+        size_t len = std::strlen(b);
+        if (a.size() != len) return false;
+        for (size_t i = 0; i < len; ++i) {
+            char c = a[i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != b[i]) return false;
+        }
+        return true;
+    }
+}
+
+
+const char* Csv::ColumnTypeName(ColumnType type) {
+    switch (type) {
+    case ColumnType::Number: return "number";
+    case ColumnType::Date: return "date";
+    case ColumnType::Bool: return "bool";
+    case ColumnType::String:
+    default: return "string";
+    }
+}
+
+// --- Parser ---
+
+Csv::Parser::Parser(RowHandler onRow, char delimiter)
+    : m_onRow(std::move(onRow)), m_delimiter(delimiter) {
+}
+
+void Csv::Parser::Feed(std::string_view chunk) {
+    const char* p = chunk.data();
+    size_t n = chunk.size();
+    size_t i = 0;
+
+    // UTF-8 BOM 也可能被切分在两个块之间
+    static const char kBom[3] = { '\xEF', '\xBB', '\xBF' };
+    while (m_bomMatched < 3 && i < n) {
+        if (p[i] != kBom[m_bomMatched]) {
+            if (m_bomMatched > 0) {
+                // 只是以相同字节开头的普通字符
+                m_field.append(kBom, m_bomMatched);
+                m_state = State::Unquoted;
+            }
+            m_bomMatched = 3;
+            break;
+        }
+        ++m_bomMatched;
+        ++i;
+    }
+    if (m_skipLineFeed && i < n) {
+        if (p[i] == '\n') ++i;
+        m_skipLineFeed = false;
+    }
+
+    while (i < n) {
+        switch (m_state) {
+        case State::FieldStart:
+            if (p[i] == '"') {
+                m_state = State::Quoted;
+                m_rowQuoted = true;
+                ++i;
+                break;
+            }
+            m_state = State::Unquoted;
+            [[fallthrough]];
+
+        case State::Unquoted: {
+            size_t hit = i + FindUnquotedSpecial(p + i, n - i, m_delimiter);
+            m_field.append(p + i, hit - i);
+            i = hit;
+            if (i >= n) break;
+
+            char c = p[i++];
+            if (c == m_delimiter) {
+                EndField();
+            }
+            else if (c == '\n' || c == '\r') {
+                EndField();
+                EndRow();
+                if (c == '\r') {
+                    if (i < n) {
+                        if (p[i] == '\n') ++i;
+                    }
+                    else {
+                        m_skipLineFeed = true;
+                    }
+                }
+            }
+            else {
+                m_field.push_back(c); // 非字段开头的引号按普通字符处理
+            }
+            break;
+        }
+
+        case State::Quoted: {
+            const void* quote = std::memchr(p + i, '"', n - i);
+            size_t hit = quote ? static_cast<size_t>(static_cast<const char*>(quote) - p) : n;
+            m_field.append(p + i, hit - i);
+            i = hit;
+            if (i < n) {
+                ++i;
+                m_state = State::QuoteInQuoted;
+            }
+            break;
+        }
+
+        case State::QuoteInQuoted:
+            if (p[i] == '"') {
+                m_field.push_back('"'); // "" 转义
+                ++i;
+                m_state = State::Quoted;
+            }
+            else {
+                // 引号字段结束；其后直到分隔符的字符按普通字符追加
+                m_state = State::Unquoted;
+            }
+            break;
+        }
+    }
+}
+
+void Csv::Parser::Finish() {
+    if (m_state != State::FieldStart || m_fieldCount > 0) {
+        EndField();
+        EndRow();
+    }
+    m_state = State::FieldStart;
+    m_skipLineFeed = false;
+}
+
+void Csv::Parser::EndField() {
+    if (m_fieldCount < m_fields.size()) {
+        m_fields[m_fieldCount].swap(m_field);
+    }
+    else {
+        m_fields.push_back(std::move(m_field));
+    }
+    ++m_fieldCount;
+    m_field.clear();
+    m_state = State::FieldStart;
+}
+
+void Csv::Parser::EndRow() {
+    // 空行（只有一个空字段）被跳过；只有 "" 的一行是一个空字符串字段，不是空行
+    bool blank = (m_fieldCount == 1 && m_fields[0].empty() && !m_rowQuoted);
+    if (!blank) {
+        m_fields.resize(m_fieldCount);
+        m_onRow(m_fields);
+        ++m_rowCount;
+    }
+    m_fieldCount = 0;
+    m_rowQuoted = false;
+    m_state = State::FieldStart;
+}
+
+// --- TypeInference ---
+
+void Csv::TypeInference::Observe(const std::vector<std::string>& fields) {
+    if (fields.size() > m_candidates.size()) {
+        m_candidates.resize(fields.size(), kAllCandidates);
+        m_seenValue.resize(fields.size(), false);
+    }
+    for (size_t c = 0; c < fields.size(); ++c) {
+        uint8_t& candidates = m_candidates[c];
+        const std::string& value = fields[c];
+        if (candidates == 0 || value.empty()) continue;
+
+        m_seenValue[c] = true;
+        if ((candidates & kCandidateNumber) && (!IsNumber(value) || !IsLosslessNumber(value))) candidates &= ~kCandidateNumber;
+        if ((candidates & kCandidateDate) && !IsDate(value)) candidates &= ~kCandidateDate;
+        if ((candidates & kCandidateBool) && !IsBool(value)) candidates &= ~kCandidateBool;
+    }
+}
+
+Csv::ColumnType Csv::TypeInference::TypeOf(size_t column) const {
+    if (column >= m_candidates.size() || !m_seenValue[column]) return ColumnType::String;
+    uint8_t candidates = m_candidates[column];
+    if (candidates & kCandidateNumber) return ColumnType::Number;
+    if (candidates & kCandidateDate) return ColumnType::Date;
+    if (candidates & kCandidateBool) return ColumnType::Bool;
+    return ColumnType::String;
+}
+
+// --- 类型识别 ---
+
+bool Csv::IsNumber(std::string_view s) {
+    size_t i = 0;
+    if (i < s.size() && (s[i] == '+' || s[i] == '-')) ++i;
+
+    size_t intDigits = 0;
+    while (i < s.size() && IsDigit(s[i])) { ++i; ++intDigits; }
+    size_t fracDigits = 0;
+    if (i < s.size() && s[i] == '.') {
+        ++i;
+        while (i < s.size() && IsDigit(s[i])) { ++i; ++fracDigits; }
+    }
+    if (intDigits + fracDigits == 0) return false;
+
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+        ++i;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-')) ++i;
+        size_t expDigits = 0;
+        while (i < s.size() && IsDigit(s[i])) { ++i; ++expDigits; }
+        if (expDigits == 0) return false;
+    }
+    return i == s.size();
+}
+
+bool Csv::IsDate(std::string_view s) {
+    size_t pos = 0;
+    int year, month, day;
+    if (!ReadDigits(s, pos, 4, year)) return false;
+    if (pos >= s.size() || (s[pos] != '-' && s[pos] != '/')) return false;
+    char sep = s[pos++];
+    if (!ReadDigits(s, pos, 2, month) || pos >= s.size() || s[pos++] != sep || !ReadDigits(s, pos, 2, day)) return false;
+
+    static const int kDaysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1]) return false;
+    if (pos == s.size()) return true;
+
+    // 可选时间部分: [T ]HH:MM[:SS[.fff]][Z|±HH:MM]
+    if (s[pos] != 'T' && s[pos] != ' ') return false;
+    ++pos;
+    int hour, minute, second;
+    if (!ReadDigits(s, pos, 2, hour) || pos >= s.size() || s[pos++] != ':' || !ReadDigits(s, pos, 2, minute)) return false;
+    if (hour > 23 || minute > 59) return false;
+    if (pos < s.size() && s[pos] == ':') {
+        ++pos;
+        if (!ReadDigits(s, pos, 2, second) || second > 60) return false;
+        if (pos < s.size() && s[pos] == '.') {
+            ++pos;
+            size_t start = pos;
+            while (pos < s.size() && IsDigit(s[pos])) ++pos;
+            if (pos == start) return false;
+        }
+    }
+    if (pos == s.size()) return true;
+    if (s[pos] == 'Z') return pos + 1 == s.size();
+    if (s[pos] == '+' || s[pos] == '-') {
+        ++pos;
+        int tzHour, tzMinute;
+        if (!ReadDigits(s, pos, 2, tzHour)) return false;
+        if (pos < s.size() && s[pos] == ':') ++pos;
+        return ReadDigits(s, pos, 2, tzMinute) && pos == s.size();
+    }
+    return false;
+}
+
+bool Csv::IsBool(std::string_view s) {
+    return EqualsIgnoreCase(s, "true") || EqualsIgnoreCase(s, "false");
+}
+
+json Csv::ToJsonValue(const std::string& cell, ColumnType type) {
+    if (type == ColumnType::String) return cell;
+    if (cell.empty()) return nullptr;
+
+    switch (type) {
+    case ColumnType::Number: {
+        bool integral = cell.find_first_of(".eE") == std::string::npos;
+        if (integral && IntegerDigits(cell) <= 18) {
+            return static_cast<int64_t>(std::strtoll(cell.c_str(), nullptr, 10));
+        }
+        double value = std::strtod(cell.c_str(), nullptr);
+        if (!std::isfinite(value)) return cell; // 推断阶段已排除，这里只防御调用方直接指定类型
+        return value;
+    }
+    case ColumnType::Bool:
+        return EqualsIgnoreCase(cell, "true");
+    case ColumnType::Date:
+    default:
+        return cell; // 日期保持原始文本，便于前端按原样显示
+    }
+}
@@ -0,0 +1,148 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "include/DatabaseExport.h"
+#include "include/Telemetry.h"
+
+
+namespace {
+    std::string Assignment(const std::string& key, const json& value) {
+        // JSON 字符串本身就是合法的 JS 字符串字面量
+        return "window.__VN_DB__ = window.__VN_DB__ || {};\nwindow.__VN_DB__[" + json(key).dump() + "] = " +
+            value.dump(-1, ' ', false, json::error_handler_t::replace) + ";\n";
+    }
+
+    void WriteScript(const std::filesystem::path& path, const std::string& script) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(script.data(), static_cast<std::streamsize>(script.size()));
+        if (!file) {
+            throw std::runtime_error("Failed to write " + path.filename().string());
+        }
+    }
+
+    // firstRowMode 为 header 时 preset 按表头名称引用列，只保留 columns[].sourceHeader 中出现的列（同名列取第一列，与前端一致）
+    std::vector<size_t> ProjectedColumns(const json& config, const json& firstRow) {
+        std::vector<size_t> keep;
+        if (config.value("firstRowMode", "") != "header" || !firstRow.is_array() || !config.contains("columns") || !config["columns"].is_array()) {
+            return keep;
+        }
+        for (size_t c = 0; c < firstRow.size(); ++c) {
+            if (!firstRow[c].is_string()) continue;
+            auto first = std::find(firstRow.begin(), firstRow.end(), firstRow[c]);
+            if (static_cast<size_t>(first - firstRow.begin()) != c) continue;
+            for (const auto& column : config["columns"]) {
+                if (column.is_object() && column.contains("sourceHeader") && column["sourceHeader"] == firstRow[c]) {
+                    keep.push_back(c);
+                    break;
+                }
+            }
+        }
+        return keep;
+    }
+
+    json Project(const json& row, const std::vector<size_t>& keep) {
+        json out = json::array();
+        for (size_t c : keep) {
+            out.push_back(row.is_array() && c < row.size() ? row[c] : json(nullptr));
+        }
+        return out;
+    }
+}
+
+DatabaseExport::Outcome DatabaseExport::Write(const Job& job, size_t chunkRows) {
+    Telemetry::Span span("exportDatabase", "export");
+    Outcome outcome;
+    outcome.results.resize(job.views.size());
+    try {
+        std::filesystem::create_directories(job.target.parent_path());
+        std::filesystem::path chunkDir = job.target;
+        chunkDir.replace_extension(".data");
+
+        json bundle;
+        bundle["data"] = job.data;
+        bundle["presets"] = job.presets;
+        bundle["views"] = json::object();
+
+        bool hasRows = job.source.table || job.source.stored;
+        if (hasRows && !job.views.empty()) {
+            std::filesystem::create_directories(chunkDir);
+        }
+        for (size_t i = 0; i < job.views.size() && hasRows; ++i) {
+            const View& view = job.views[i];
+            const json& preset = job.presets[i];
+            if (!preset.is_object() || !preset.contains("id")) continue;
+
+            std::shared_ptr<const Query::Result> result = view.result;
+            if (!result) {
+                result = std::make_shared<const Query::Result>(Query::Execute(job.source, view.spec, job.indexes));
+            }
+            outcome.results[i] = result;
+
+            const json& sourceFirstRow = job.source.FirstRow();
+            json firstRow = sourceFirstRow.is_null() ? json::array() : sourceFirstRow;
+            std::vector<size_t> keep = ProjectedColumns(view.config, firstRow);
+            bool project = !keep.empty();
+
+            size_t total = result->rows.size();
+            size_t perChunk = chunkRows == 0 ? std::max<size_t>(total, 1) : chunkRows;
+            size_t chunks = std::max<size_t>(1, (total + perChunk - 1) / perChunk);
+            for (size_t k = 0; k < chunks; ++k) {
+                size_t offset = k * perChunk;
+                json rows = Query::Page(job.source, *result, offset, perChunk);
+                if (project) {
+                    for (auto& row : rows) row = Project(row, keep);
+                }
+                json chunk;
+                chunk["rows"] = std::move(rows);
+                chunk["groups"] = Query::GroupsInWindow(*result, offset, perChunk);
+                std::string key = job.key + "#" + std::to_string(i) + "#" + std::to_string(k);
+                WriteScript(chunkDir / (std::to_string(i) + "-" + std::to_string(k) + ".js"), Assignment(key, chunk));
+                ++outcome.files;
+            }
+
+            bundle["views"][preset["id"].is_string() ? preset["id"].get<std::string>() : preset["id"].dump()] = {
+                {"index", i},
+                {"chunks", chunks},
+                {"chunkRows", perChunk},
+                {"firstRow", project ? Project(firstRow, keep) : firstRow},
+                {"rowCount", job.source.RowCount()},
+                {"totalRows", total},
+                {"totals", result->totals}
+            };
+        }
+
+        WriteScript(job.target, Assignment(job.key, bundle));
+        ++outcome.files;
+        outcome.success = true;
+    }
+    catch (const std::exception& e) {
+        outcome.error = e.what();
+    }
+    return outcome;
+}
+
+std::vector<DatabaseExport::Outcome> DatabaseExport::WriteAll(const std::vector<Job>& jobs, size_t chunkRows) {
+    std::vector<Outcome> outcomes(jobs.size());
+    unsigned hw = std::thread::hardware_concurrency();
+    size_t threads = std::min<size_t>(std::max(hw, 1u), jobs.size());
+    if (threads <= 1) {
+        for (size_t i = 0; i < jobs.size(); ++i) outcomes[i] = Write(jobs[i], chunkRows);
+        return outcomes;
+    }
+
+    // 每个线程依次领取下一个数据库
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                outcomes[i] = Write(jobs[i], chunkRows);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    return outcomes;
+}
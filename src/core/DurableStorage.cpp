@@ -0,0 +1,441 @@
+﻿#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "include/DurableStorage.h"
+#include "include/FileAccess.h"
+#include "include/Platform.h"
+#include "include/PageFormat.h"
+#include "nlohmann/json.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+    // --- 平台相关的最小文件句柄封装 ---
+    class NativeFile {
+    public:
+        NativeFile() = default;
+        NativeFile(const NativeFile&) = delete;
+        NativeFile& operator=(const NativeFile&) = delete;
+        ~NativeFile() { Close(); }
+
+        bool Open(const std::filesystem::path& path, bool append) {
+#ifdef _WIN32
+            m_handle = CreateFileW(path.c_str(),
+                append ? FILE_APPEND_DATA : GENERIC_WRITE,
+                FILE_SHARE_READ, nullptr,
+                append ? OPEN_ALWAYS : CREATE_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL, nullptr);
+            return m_handle != INVALID_HANDLE_VALUE;
+#else
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+            m_fd = ::open(path.c_str(), flags, 0644);
+            return m_fd >= 0;
+#endif
+        }
+
+        bool Write(const char* data, size_t size) {
+            while (size > 0) {
+#ifdef _WIN32
+                DWORD chunk = static_cast<DWORD>(size > 0x40000000 ? 0x40000000 : size);
+                DWORD written = 0;
+                if (!WriteFile(m_handle, data, chunk, &written, nullptr) || written == 0) return false;
+#else
+                ssize_t written = ::write(m_fd, data, size);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+#endif
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        // 把内核缓冲区刷到磁盘，保证 rename 之前数据已经落盘
+        bool Sync() {
+#ifdef _WIN32
+            return FlushFileBuffers(m_handle) != 0;
+#else
+            return ::fsync(m_fd) == 0;
+#endif
+        }
+
+        bool Close() {
+            bool ok = true;
+#ifdef _WIN32
+            if (m_handle != INVALID_HANDLE_VALUE) {
+                ok = CloseHandle(m_handle) != 0;
+                m_handle = INVALID_HANDLE_VALUE;
+            }
+#else
+            if (m_fd >= 0) {
+                ok = ::close(m_fd) == 0;
+                m_fd = -1;
+            }
+#endif
+            return ok;
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+        int m_fd = -1;
+#endif
+    };
+
+    bool ReplaceWithTemp(const std::filesystem::path& tempPath, const std::filesystem::path& path) {
+#ifdef _WIN32
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            // ReplaceFileW 会保留原文件的属性/ACL，失败时（如跨卷）退回到 MoveFileExW
+            if (ReplaceFileW(path.c_str(), tempPath.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr)) {
+                return true;
+            }
+        }
+        return MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+            return false;
+        }
+        // rename 本身也需要落盘：同步父目录
+        std::filesystem::path dir = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+        int dirFd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        return true;
+#endif
+    }
+
+    uint32_t Crc32(const char* data, size_t size) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    const char kJournalMagic[4] = { 'V', 'N', 'J', '1' };
+    const char kPatchMagic[4] = { 'V', 'N', 'P', '1' };
+    constexpr size_t kJournalHeaderSize = 12;
+
+    void PutU32(char* out, uint32_t v) {
+        out[0] = static_cast<char>(v & 0xFF);
+        out[1] = static_cast<char>((v >> 8) & 0xFF);
+        out[2] = static_cast<char>((v >> 16) & 0xFF);
+        out[3] = static_cast<char>((v >> 24) & 0xFF);
+    }
+
+    uint32_t GetU32(const char* in) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+
+bool DurableStorage::AtomicWriteFile(const std::filesystem::path& path, const std::string& content) {
+    return AtomicWriteFileStreamed(path, [&content](const std::function<bool(std::string_view)>& write) {
+        return write(content);
+    });
+}
+
+bool DurableStorage::AtomicWriteFileStreamed(const std::filesystem::path& path, const Producer& produce) {
+    std::filesystem::path tempPath = path;
+    tempPath += L".tmp";
+
+    {
+        NativeFile file;
+        if (!file.Open(tempPath, false) ||
+            !produce([&file](std::string_view chunk) { return file.Write(chunk.data(), chunk.size()); }) ||
+            !file.Sync() ||
+            !file.Close()) {
+            std::error_code ec;
+            file.Close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    if (!ReplaceWithTemp(tempPath, path)) {
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        LOG_DEBUG("DurableStorage: failed to replace target file with temp file.");
+        return false;
+    }
+    return true;
+}
+
+bool DurableStorage::ReadWholeFile(const std::filesystem::path& path, std::string& content) {
+    FileAccess::MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    std::string_view view = file.View();
+    content.assign(view.data(), view.size());
+    return true;
+}
+
+
+std::filesystem::path SaveJournal::JournalPathFor(const std::filesystem::path& target) {
+    std::filesystem::path journalPath = target;
+    journalPath += L".journal";
+    return journalPath;
+}
+
+bool SaveJournal::Append(const std::filesystem::path& target, const std::string& content) {
+    if (content.size() > 0xFFFFFFFFu) {
+        // 超出单条记录上限，直接走原子写入
+        if (!DurableStorage::AtomicWriteFile(target, content)) return false;
+        Discard(target);
+        return true;
+    }
+    return AppendRecord(target, kJournalMagic, content, [&content] { return content; });
+}
+
+bool SaveJournal::AppendPatch(const std::filesystem::path& target, const std::string& patch, const std::function<std::string()>& snapshot) {
+    if (patch.size() > 0xFFFFFFFFu) {
+        std::string content = snapshot();
+        if (!DurableStorage::AtomicWriteFile(target, content)) return false;
+        Discard(target);
+        return true;
+    }
+    return AppendRecord(target, kPatchMagic, patch, snapshot);
+}
+
+bool SaveJournal::AppendRecord(const std::filesystem::path& target, const char* magic, const std::string& content, const std::function<std::string()>& snapshot) {
+
+    std::filesystem::path journalPath = JournalPathFor(target);
+    std::error_code ec;
+
+    // 上次运行遗留的日志可能以残缺记录结尾，新记录接在其后将无法被恢复。
+    // 本次会话第一次追加前先把它压缩掉。
+    if (m_pendingRecords.find(target.wstring()) == m_pendingRecords.end() && HasJournal(target)) {
+        // 无法压缩也无法移走的旧日志之后再追加的记录将无法恢复，本次保存按失败处理
+        if (!Compact(target) && HasJournal(target)) return false;
+    }
+    // 追加失败时截回的长度；无法确定时宁可留下残缺的尾部记录（恢复时会被忽略），也不能截掉已落盘的记录
+    std::uintmax_t previousSize = 0;
+    bool previousSizeKnown = true;
+    if (std::filesystem::exists(journalPath, ec)) {
+        previousSize = std::filesystem::file_size(journalPath, ec);
+        previousSizeKnown = !ec;
+    }
+    else if (ec) {
+        previousSizeKnown = false;
+    }
+
+    char header[kJournalHeaderSize];
+    std::memcpy(header, magic, 4);
+    PutU32(header + 4, static_cast<uint32_t>(content.size()));
+    PutU32(header + 8, Crc32(content.data(), content.size()));
+
+    {
+        NativeFile file;
+        if (!file.Open(journalPath, true) ||
+            !file.Write(header, kJournalHeaderSize) ||
+            !file.Write(content.data(), content.size()) ||
+            !file.Sync()) {
+            file.Close();
+            // 截掉写了一半的记录，保证后续追加仍然可恢复
+            if (previousSizeKnown) {
+                std::filesystem::resize_file(journalPath, previousSize, ec);
+            }
+            return false;
+        }
+    }
+
+    size_t& pending = m_pendingRecords[target.wstring()];
+    ++pending;
+
+    std::uintmax_t journalSize = std::filesystem::file_size(journalPath, ec);
+    if (pending >= kMaxPendingRecords || (!ec && journalSize >= kMaxJournalBytes)) {
+        // 压缩失败不影响本次保存：数据已经安全地在日志里
+        // 调用方手里已有最新内容时直接写回，省去重放整个日志
+        if (snapshot && DurableStorage::AtomicWriteFile(target, snapshot())) {
+            Discard(target);
+        }
+        else {
+            Compact(target);
+        }
+    }
+    return true;
+}
+
+bool SaveJournal::Recover(const std::filesystem::path& target, std::string& latest, bool* clean) const {
+    if (clean) *clean = true;
+    // 日志直接映射读取，记录体不再额外拷贝
+    FileAccess::MappedFile journalFile;
+    if (!journalFile.Open(JournalPathFor(target))) {
+        // 日志存在却打不开时，其中的记录一条也没有重放
+        if (clean && HasJournal(target)) *clean = false;
+        return false;
+    }
+    std::string_view journal = journalFile.View();
+
+    bool found = false;
+    // 增量无法应用后，直到下一条完整快照之前的状态都不可信
+    bool broken = false;
+    // 连续的增量记录在解析后的文档上依次应用，最后只序列化一次
+    nlohmann::json document;
+    bool documentIsLatest = false;
+    bool binary = false; // 增量应用后按基准内容的格式重新序列化
+
+    size_t offset = 0;
+    while (journal.size() - offset >= kJournalHeaderSize) {
+        const char* header = journal.data() + offset;
+        bool isSnapshot = std::memcmp(header, kJournalMagic, 4) == 0;
+        bool isPatch = std::memcmp(header, kPatchMagic, 4) == 0;
+        if (!isSnapshot && !isPatch) {
+            if (clean) *clean = false;
+            break;
+        }
+
+        uint32_t length = GetU32(header + 4);
+        uint32_t crc = GetU32(header + 8);
+        if (journal.size() - offset - kJournalHeaderSize < length) break; // 写入中途崩溃留下的残缺记录
+
+        const char* body = header + kJournalHeaderSize;
+        if (Crc32(body, length) != crc) {
+            // 文件末尾的记录校验失败同样是写入中途崩溃；中间的记录损坏则之后的记录无法定位
+            if (clean && offset + kJournalHeaderSize + length != journal.size()) *clean = false;
+            break;
+        }
+        offset += kJournalHeaderSize + length;
+
+        if (isSnapshot) {
+            latest.assign(body, length);
+            documentIsLatest = false;
+            broken = false;
+            found = true;
+            continue;
+        }
+        if (broken) continue;
+        try {
+            if (!documentIsLatest) {
+                // 日志中的第一条记录就是增量时，基准是页面文件本身
+                std::string base = latest;
+                if (!found && !DurableStorage::ReadWholeFile(target, base)) {
+                    throw std::runtime_error("Missing base document for journal patch.");
+                }
+                binary = PageFormat::IsBinary(base);
+                document = base.empty() ? nlohmann::json::object() : PageFormat::Parse(base);
+            }
+            document = document.patch(nlohmann::json::parse(body, body + length));
+            documentIsLatest = true;
+            found = true;
+        }
+        catch (const std::exception&) {
+            // 丢弃应用到一半的文档，从下一条完整快照继续
+            if (clean) *clean = false;
+            broken = true;
+            found = false;
+            documentIsLatest = false;
+            document = nlohmann::json();
+        }
+    }
+
+    if (found && documentIsLatest) {
+        latest = PageFormat::Serialize(document, binary);
+    }
+    return found;
+}
+
+bool SaveJournal::HasJournal(const std::filesystem::path& target) const {
+    std::error_code ec;
+    return std::filesystem::exists(JournalPathFor(target), ec);
+}
+
+bool SaveJournal::Compact(const std::filesystem::path& target) {
+    std::string latest;
+    bool clean = true;
+    if (Recover(target, latest, &clean)) {
+        // 先把最新内容原子写回，再删除日志；两步之间崩溃时二者内容一致
+        if (!DurableStorage::AtomicWriteFile(target, latest)) {
+            return false;
+        }
+    }
+    if (!clean) {
+        // 未能完整重放的日志不能删除：改名保留，之后的保存从新日志开始
+        LOG_DEBUG("SaveJournal: journal could not be replayed cleanly, keeping it for recovery.");
+        Quarantine(target);
+        return false;
+    }
+    Discard(target);
+    return true;
+}
+
+void SaveJournal::CompactAll() {
+    std::vector<std::wstring> targets;
+    targets.reserve(m_pendingRecords.size());
+    for (const auto& [target, pending] : m_pendingRecords) {
+        targets.push_back(target);
+    }
+    for (const auto& target : targets) {
+        Compact(target);
+    }
+}
+
+bool SaveJournal::Quarantine(const std::filesystem::path& target) {
+    m_pendingRecords.erase(target.wstring());
+    std::filesystem::path journalPath = JournalPathFor(target);
+    std::error_code ec;
+    for (int n = 0; n < 1000; ++n) {
+        std::filesystem::path quarantined = journalPath;
+        quarantined += n == 0 ? std::wstring(L".corrupt") : L".corrupt" + std::to_wstring(n);
+        if (std::filesystem::exists(quarantined, ec)) continue;
+        std::filesystem::rename(journalPath, quarantined, ec);
+        return !ec;
+    }
+    return false;
+}
+
+void SaveJournal::Discard(const std::filesystem::path& target) {
+    std::error_code ec;
+    std::filesystem::remove(JournalPathFor(target), ec);
+    m_pendingRecords.erase(target.wstring());
+}
+
+void SaveJournal::DiscardUnder(const std::filesystem::path& directory) {
+    std::wstring prefix = directory.lexically_normal().wstring();
+    while (!prefix.empty() && (prefix.back() == L'/' || prefix.back() == L'\\')) prefix.pop_back();
+    for (auto it = m_pendingRecords.begin(); it != m_pendingRecords.end();) {
+        std::wstring target = std::filesystem::path(it->first).lexically_normal().wstring();
+        bool inside = target.size() > prefix.size() && target.compare(0, prefix.size(), prefix) == 0 &&
+            (target[prefix.size()] == L'/' || target[prefix.size()] == L'\\');
+        if (inside) {
+            std::error_code ec;
+            std::filesystem::remove(JournalPathFor(it->first), ec);
+            it = m_pendingRecords.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
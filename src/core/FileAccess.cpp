@@ -0,0 +1,157 @@
+﻿#include <fstream>
+
+#include "include/FileAccess.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+#ifdef _WIN32
+    uint64_t ToTicks(const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    }
+#else
+    uint64_t ToTicks(const struct stat& st) {
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(st.st_mtimespec.tv_sec) * 1000000000ull + st.st_mtimespec.tv_nsec;
+#else
+        return static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+#endif
+    }
+#endif
+
+    bool ReadSized(const std::filesystem::path& path, std::string& out) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        std::streamoff size = file.tellg();
+        if (size < 0) return false;
+        out.resize(static_cast<size_t>(size));
+        file.seekg(0, std::ios::beg);
+        if (size > 0 && !file.read(&out[0], size)) {
+            out.clear();
+            return false;
+        }
+        return true;
+    }
+}
+
+
+bool FileAccess::StatFile(const std::filesystem::path& path, FileStat& stat) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+    stat.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    stat.mtime = ToTicks(data.ftLastWriteTime);
+    return true;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    stat.size = static_cast<uint64_t>(st.st_size);
+    stat.mtime = ToTicks(st);
+    return true;
+#endif
+}
+
+bool FileAccess::MappedFile::Open(const std::filesystem::path& path) {
+    Close();
+
+#ifdef _WIN32
+    // 共享写入与删除：映射存在期间 ReplaceFileW / MoveFileExW 仍可原子替换或改名目标文件，
+    // 映射继续看到打开时的旧内容
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    FILETIME writeTime;
+    if (!GetFileSizeEx(m_file, &size) || !GetFileTime(m_file, nullptr, nullptr, &writeTime)) {
+        Close();
+        return false;
+    }
+    m_stat.size = static_cast<uint64_t>(size.QuadPart);
+    m_stat.mtime = ToTicks(writeTime);
+
+    if (m_stat.size > 0 && m_stat.size <= SIZE_MAX) {
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr) {
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            m_mapped = (m_data != nullptr);
+        }
+    }
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        Close();
+        return false;
+    }
+    m_stat.size = static_cast<uint64_t>(st.st_size);
+    m_stat.mtime = ToTicks(st);
+
+    if (S_ISREG(st.st_mode) && m_stat.size > 0 && m_stat.size <= SIZE_MAX) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(m_stat.size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (addr != MAP_FAILED) {
+            ::madvise(addr, static_cast<size_t>(m_stat.size), MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(addr);
+            m_mapped = true;
+        }
+    }
+#endif
+
+    if (m_mapped) {
+        m_size = static_cast<size_t>(m_stat.size);
+        return true;
+    }
+
+    // 空文件无法映射，或映射失败：一次按大小读取
+    m_data = nullptr;
+    if (!ReadSized(path, m_fallback)) {
+        Close();
+        return false;
+    }
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+    return true;
+}
+
+void FileAccess::MappedFile::Close() {
+#ifdef _WIN32
+    if (m_mapped && m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_mapped && m_data != nullptr) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_stat = FileStat();
+    m_fallback.clear();
+}
@@ -0,0 +1,158 @@
+﻿#include <cstring>
+#include <stdexcept>
+
+#include "include/PageFormat.h"
+
+
+namespace {
+    const char kBinaryMagic[4] = { 'V', 'N', 'B', '1' };
+    constexpr size_t kHeaderSize = 16;
+    constexpr size_t kEntrySize = 8;
+
+    // flags
+    constexpr uint32_t kFlagHasBlocks = 1u << 0; // content.blocks 被拆分到 blocks 区
+
+    void PutU32(std::string& out, uint32_t v) {
+        char buf[4] = {
+            static_cast<char>(v & 0xFF),
+            static_cast<char>((v >> 8) & 0xFF),
+            static_cast<char>((v >> 16) & 0xFF),
+            static_cast<char>((v >> 24) & 0xFF),
+        };
+        out.append(buf, 4);
+    }
+
+    uint32_t GetU32(const char* in) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    json FromCbor(std::string_view bytes, size_t offset, size_t length) {
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>(bytes.data()) + offset;
+        return json::from_cbor(begin, begin + length);
+    }
+}
+
+
+bool PageFormat::IsBinary(std::string_view bytes) {
+    return bytes.size() >= kHeaderSize && std::memcmp(bytes.data(), kBinaryMagic, 4) == 0;
+}
+
+json PageFormat::Parse(std::string_view bytes) {
+    if (IsBinary(bytes)) {
+        return DecodeBinary(bytes);
+    }
+    return json::parse(bytes);
+}
+
+std::string PageFormat::Serialize(const json& document, bool binary) {
+    return binary ? EncodeBinary(document) : document.dump(2);
+}
+
+std::string PageFormat::EncodeBinary(const json& document) {
+    json envelope = document;
+    json blocks = json::array();
+    uint32_t flags = 0;
+
+    if (envelope.is_object() && envelope.contains("content") && envelope["content"].is_object()) {
+        json& content = envelope["content"];
+        if (content.contains("blocks") && content["blocks"].is_array()) {
+            blocks = std::move(content["blocks"]);
+            content.erase("blocks");
+            flags |= kFlagHasBlocks;
+        }
+    }
+
+    std::vector<uint8_t> envelopeBytes = json::to_cbor(envelope);
+
+    std::string blockRegion;
+    std::string offsetTable;
+    offsetTable.reserve(blocks.size() * kEntrySize);
+    for (const auto& block : blocks) {
+        std::vector<uint8_t> encoded = json::to_cbor(block);
+        if (blockRegion.size() + encoded.size() > 0xFFFFFFFFu) {
+            throw std::runtime_error("Page is too large for the binary format.");
+        }
+        PutU32(offsetTable, static_cast<uint32_t>(blockRegion.size()));
+        PutU32(offsetTable, static_cast<uint32_t>(encoded.size()));
+        blockRegion.append(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    }
+
+    std::string out;
+    out.reserve(kHeaderSize + envelopeBytes.size() + offsetTable.size() + blockRegion.size());
+    out.append(kBinaryMagic, 4);
+    PutU32(out, flags);
+    PutU32(out, static_cast<uint32_t>(blocks.size()));
+    PutU32(out, static_cast<uint32_t>(envelopeBytes.size()));
+    out.append(reinterpret_cast<const char*>(envelopeBytes.data()), envelopeBytes.size());
+    out += offsetTable;
+    out += blockRegion;
+    return out;
+}
+
+json PageFormat::DecodeBinary(std::string_view bytes) {
+    BinaryReader reader;
+    if (!reader.Open(bytes)) {
+        throw std::runtime_error("Malformed binary page file.");
+    }
+    return reader.Document();
+}
+
+
+bool PageFormat::BinaryReader::Open(std::string_view bytes) {
+    m_bytes = std::string_view();
+    m_blocks.clear();
+    if (!IsBinary(bytes)) return false;
+
+    const char* data = bytes.data();
+    uint32_t flags = GetU32(data + 4);
+    uint32_t blockCount = GetU32(data + 8);
+    uint32_t envelopeLength = GetU32(data + 12);
+
+    // 先比较再相加 / 相乘：长度字段来自文件，在 32 位 size_t 上直接计算可能溢出
+    if (envelopeLength > bytes.size() - kHeaderSize) return false;
+    size_t tableOffset = kHeaderSize + static_cast<size_t>(envelopeLength);
+    if (blockCount > (bytes.size() - tableOffset) / kEntrySize) return false;
+    size_t blocksOffset = tableOffset + static_cast<size_t>(blockCount) * kEntrySize;
+
+    size_t regionSize = bytes.size() - blocksOffset;
+    m_blocks.reserve(blockCount);
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        const char* entry = data + tableOffset + static_cast<size_t>(i) * kEntrySize;
+        Entry e{ GetU32(entry), GetU32(entry + 4) };
+        if (e.offset > regionSize || e.length > regionSize - e.offset) {
+            m_blocks.clear();
+            return false;
+        }
+        m_blocks.push_back(e);
+    }
+
+    m_bytes = bytes;
+    m_hasBlocks = (flags & kFlagHasBlocks) != 0;
+    m_envelopeOffset = kHeaderSize;
+    m_envelopeLength = envelopeLength;
+    m_blocksOffset = blocksOffset;
+    return true;
+}
+
+json PageFormat::BinaryReader::Block(size_t index) const {
+    const Entry& e = m_blocks.at(index);
+    return FromCbor(m_bytes, m_blocksOffset + e.offset, e.length);
+}
+
+json PageFormat::BinaryReader::Envelope() const {
+    return FromCbor(m_bytes, m_envelopeOffset, m_envelopeLength);
+}
+
+json PageFormat::BinaryReader::Document() const {
+    json document = Envelope();
+    if (m_hasBlocks) {
+        json blocks = json::array();
+        for (size_t i = 0; i < m_blocks.size(); ++i) {
+            blocks.push_back(Block(i));
+        }
+        document["content"]["blocks"] = std::move(blocks);
+    }
+    return document;
+}
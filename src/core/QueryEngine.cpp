@@ -0,0 +1,1249 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <thread>
+
+#include "include/QueryEngine.h"
+
+
+namespace {
+    using Query::FilterOp;
+    using Query::AggregateFn;
+    using Kind = ColumnTable::Kind;
+
+    // --- 单元格语义 (与前端 TableView 的显示一致) ---
+
+    bool IsEmptyCell(const json& cell) {
+        return cell.is_null() || (cell.is_string() && cell.get_ref<const std::string&>().empty());
+    }
+
+    bool ToNumber(const json& cell, double& out) {
+        if (cell.is_number()) {
+            out = cell.get<double>();
+            return true;
+        }
+        if (cell.is_string()) {
+            const std::string& s = cell.get_ref<const std::string&>();
+            if (s.empty()) return false;
+            char* end = nullptr;
+            out = std::strtod(s.c_str(), &end);
+            return end != nullptr && *end == '\0' && std::isfinite(out);
+        }
+        return false;
+    }
+
+    std::string ToText(const json& cell) {
+        if (cell.is_string()) return cell.get<std::string>();
+        if (cell.is_null()) return "";
+        if (cell.is_boolean()) return cell.get<bool>() ? "true" : "false";
+        return cell.dump();
+    }
+
+    std::string ToLower(std::string s) {
+        for (auto& c : s) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return s;
+    }
+
+    json CellAt(const ColumnTable& table, size_t row, size_t column) {
+        if (row == 0) {
+            const json& first = table.FirstRow();
+            return (first.is_array() && column < first.size()) ? first[column] : json(nullptr);
+        }
+        return table.GetColumn(column).ValueAt(row - 1);
+    }
+
+    // 预先解析好的筛选条件，避免每行重复转换筛选值
+    struct CompiledFilter {
+        const Query::Filter* filter;
+        bool numeric = false;
+        double number = 0.0;
+        std::string text;
+        std::string lowerText;
+
+        explicit CompiledFilter(const Query::Filter& f) : filter(&f) {
+            numeric = ToNumber(f.value, number);
+            text = ToText(f.value);
+            lowerText = ToLower(text);
+        }
+
+        template <typename T>
+        static bool Compare(FilterOp op, const T& a, const T& b) {
+            switch (op) {
+            case FilterOp::Equal: return a == b;
+            case FilterOp::NotEqual: return !(a == b);
+            case FilterOp::Less: return a < b;
+            case FilterOp::LessEqual: return !(b < a);
+            case FilterOp::Greater: return b < a;
+            case FilterOp::GreaterEqual: return !(a < b);
+            default: return false;
+            }
+        }
+
+        bool IsCompare() const {
+            FilterOp op = filter->op;
+            return op != FilterOp::Contains && op != FilterOp::StartsWith && op != FilterOp::Empty && op != FilterOp::NotEmpty;
+        }
+
+        // 数值比较的快速路径，要求 numeric 为 true
+        bool MatchNumber(double v) const {
+            return Compare(filter->op, v, number);
+        }
+
+        // 通用路径：任意 json 单元格
+        bool Match(const json& cell) const {
+            FilterOp op = filter->op;
+            bool empty = IsEmptyCell(cell);
+            if (op == FilterOp::Empty) return empty;
+            if (op == FilterOp::NotEmpty) return !empty;
+            if (empty) return op == FilterOp::NotEqual && !text.empty();
+
+            if (op == FilterOp::Contains || op == FilterOp::StartsWith) {
+                std::string hay = ToLower(ToText(cell));
+                size_t pos = hay.find(lowerText);
+                return op == FilterOp::Contains ? pos != std::string::npos : pos == 0;
+            }
+            double v;
+            if (numeric) {
+                if (ToNumber(cell, v)) return MatchNumber(v);
+                // 数值条件下无法转换为数字的单元格只参与相等判断
+                if (op != FilterOp::Equal && op != FilterOp::NotEqual) return false;
+            }
+            return Compare(op, ToText(cell), text);
+        }
+    };
+
+    // 对一列数据行做筛选，结果与 keep 按位与。按列类型选择向量化的路径
+    void ApplyFilter(const ColumnTable& table, const CompiledFilter& cf, std::vector<uint8_t>& keep) {
+        const ColumnTable::Column& column = table.GetColumn(cf.filter->column);
+        const size_t n = keep.size();
+        const uint8_t nullMatch = cf.Match(json(nullptr)) ? 1 : 0;
+
+        switch (column.GetKind()) {
+        case Kind::Integer:
+        case Kind::Number:
+            if (cf.numeric && cf.IsCompare()) {
+                for (size_t i = 0; i < n; ++i) {
+                    uint8_t m = column.IsNull(i) ? nullMatch : static_cast<uint8_t>(cf.MatchNumber(column.NumberAt(i)));
+                    keep[i] &= m;
+                }
+                return;
+            }
+            break;
+
+        case Kind::String: {
+            // 在字典上求值一次，逐行只做查表
+            const auto& dictionary = column.Dictionary();
+            std::vector<uint8_t> dictMatch(dictionary.size());
+            for (size_t d = 0; d < dictionary.size(); ++d) {
+                dictMatch[d] = cf.Match(json(dictionary[d])) ? 1 : 0;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                keep[i] &= column.IsNull(i) ? nullMatch : dictMatch[column.CodeAt(i)];
+            }
+            return;
+        }
+
+        case Kind::Bool: {
+            const uint8_t matchTrue = cf.Match(json(true)) ? 1 : 0;
+            const uint8_t matchFalse = cf.Match(json(false)) ? 1 : 0;
+            for (size_t i = 0; i < n; ++i) {
+                keep[i] &= column.IsNull(i) ? nullMatch : (column.BoolAt(i) ? matchTrue : matchFalse);
+            }
+            return;
+        }
+
+        case Kind::Empty:
+            for (size_t i = 0; i < n; ++i) keep[i] &= nullMatch;
+            return;
+
+        case Kind::Mixed:
+            break;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            if (keep[i]) keep[i] = cf.Match(column.ValueAt(i)) ? 1 : 0;
+        }
+    }
+
+    // 单行求值：索引给出候选行后，其余条件只在候选行上计算
+    bool MatchRow(const ColumnTable& table, const CompiledFilter& cf, size_t row) {
+        const ColumnTable::Column& column = table.GetColumn(cf.filter->column);
+        if (column.IsNull(row)) return cf.Match(json(nullptr));
+        Kind kind = column.GetKind();
+        if ((kind == Kind::Integer || kind == Kind::Number) && cf.numeric && cf.IsCompare()) {
+            return cf.MatchNumber(column.NumberAt(row));
+        }
+        return cf.Match(column.ValueAt(row));
+    }
+
+    // 行组的统计信息表明其中没有任何行能满足条件时返回 true（保守：无法确定时返回 false）
+    bool GroupCannotMatch(const ColumnStore::StoredTable& table, size_t group, const CompiledFilter& cf) {
+        FilterOp op = cf.filter->op;
+        const ColumnStore::ColumnStats* stats = table.Stats(group, cf.filter->column);
+        const uint64_t rows = table.RowGroupRows(group);
+        const uint64_t empties = stats ? stats->empties : rows;
+
+        if (op == FilterOp::Empty) return empties == 0;
+        if (op == FilterOp::NotEmpty) return empties == rows;
+        // 筛选值非空时空单元格满足 neq
+        if (op == FilterOp::NotEqual) return false;
+        // 其余条件空单元格都不满足
+        if (empties == rows) return true;
+        if (!stats->hasRange || op == FilterOp::Contains || op == FilterOp::StartsWith) return false;
+
+        Kind kind = stats->kind;
+        if ((kind == Kind::Integer || kind == Kind::Number) && cf.numeric) {
+            const double v = cf.number;
+            switch (op) {
+            case FilterOp::Equal: return v < stats->minNumber || v > stats->maxNumber;
+            case FilterOp::Less: return stats->minNumber >= v;
+            case FilterOp::LessEqual: return stats->minNumber > v;
+            case FilterOp::Greater: return stats->maxNumber <= v;
+            case FilterOp::GreaterEqual: return stats->maxNumber < v;
+            default: return false;
+            }
+        }
+        // 数值条件作用在字符串列上时按数值比较，字典序范围不适用
+        if (kind == Kind::String && !cf.numeric) {
+            const std::string& t = cf.text;
+            switch (op) {
+            case FilterOp::Equal: return t < stats->minText || stats->maxText < t;
+            case FilterOp::Less: return !(stats->minText < t);
+            case FilterOp::LessEqual: return t < stats->minText;
+            case FilterOp::Greater: return !(t < stats->maxText);
+            case FilterOp::GreaterEqual: return stats->maxText < t;
+            default: return false;
+            }
+        }
+        return false;
+    }
+
+    // 用索引求出满足条件的数据行（列内下标，升序）；没有可用的索引时返回 false，由调用方扫描整列
+    bool LookupWithIndex(const ColumnTable& table, const CompiledFilter& cf,
+        const std::vector<std::shared_ptr<const ColumnIndex>>& indexes, std::vector<uint32_t>& rows) {
+        FilterOp op = cf.filter->op;
+        // 空值满足 neq / empty，这类条件既没有选择性也无法从索引得到
+        if (op == FilterOp::NotEqual || op == FilterOp::Empty || op == FilterOp::NotEmpty) return false;
+
+        const ColumnTable::Column& column = table.GetColumn(cf.filter->column);
+        const ColumnIndex* sorted = nullptr;
+        const ColumnIndex* hash = nullptr;
+        const ColumnIndex* trigram = nullptr;
+        for (const auto& index : indexes) {
+            if (!index || index->ColumnIndexInTable() != cf.filter->column) continue;
+            switch (index->GetType()) {
+            case ColumnIndex::Type::Sorted: sorted = index.get(); break;
+            case ColumnIndex::Type::Hash: hash = index.get(); break;
+            case ColumnIndex::Type::Trigram: trigram = index.get(); break;
+            }
+        }
+        if (!sorted && !hash && !trigram) return false;
+
+        Kind kind = column.GetKind();
+        if (kind == Kind::Integer || kind == Kind::Number) {
+            if (!cf.numeric) return false;
+            const double v = cf.number;
+            const double inf = std::numeric_limits<double>::infinity();
+            if (op == FilterOp::Equal && hash) {
+                rows = hash->NumberEqual(v);
+                return true;
+            }
+            if (!sorted) return false;
+            switch (op) {
+            case FilterOp::Equal: rows = sorted->NumberRange(column, v, true, v, true); return true;
+            case FilterOp::Less: rows = sorted->NumberRange(column, -inf, true, v, false); return true;
+            case FilterOp::LessEqual: rows = sorted->NumberRange(column, -inf, true, v, true); return true;
+            case FilterOp::Greater: rows = sorted->NumberRange(column, v, false, inf, true); return true;
+            case FilterOp::GreaterEqual: rows = sorted->NumberRange(column, v, true, inf, true); return true;
+            default: return false;
+            }
+        }
+        if (kind != Kind::String) return false;
+
+        // 字符串列：先得到匹配的字典编码，再展开为行
+        const auto& dictionary = column.Dictionary();
+        const ColumnIndex* postings = sorted ? sorted : (hash ? hash : trigram);
+        std::vector<uint32_t> codes;
+        bool verify = false;
+        auto allCodes = [&]() {
+            codes.resize(dictionary.size());
+            for (uint32_t d = 0; d < codes.size(); ++d) codes[d] = d;
+            verify = true;
+        };
+
+        if (op == FilterOp::Contains || op == FilterOp::StartsWith) {
+            if (cf.lowerText.empty()) return false; // 匹配所有非空行
+            if (trigram && trigram->CandidateCodes(cf.lowerText, codes)) verify = true;
+            else allCodes();
+        }
+        else if (cf.numeric) {
+            // 数值条件作用在字符串列上：可转换为数字的字符串按数值比较，只能在字典上逐个求值
+            allCodes();
+        }
+        else if (op == FilterOp::Equal && (hash || sorted)) {
+            uint32_t code;
+            if ((hash ? hash : sorted)->FindCode(column, cf.text, code)) codes.push_back(code);
+        }
+        else if (sorted) {
+            const std::string& t = cf.text;
+            switch (op) {
+            case FilterOp::Less: codes = sorted->CodeRange(column, nullptr, true, &t, false); break;
+            case FilterOp::LessEqual: codes = sorted->CodeRange(column, nullptr, true, &t, true); break;
+            case FilterOp::Greater: codes = sorted->CodeRange(column, &t, false, nullptr, true); break;
+            case FilterOp::GreaterEqual: codes = sorted->CodeRange(column, &t, true, nullptr, true); break;
+            default: allCodes(); break;
+            }
+        }
+        else {
+            allCodes();
+        }
+
+        for (uint32_t code : codes) {
+            // 空字符串与空值等价，不满足这里的任何条件
+            if (dictionary[code].empty()) continue;
+            if (verify && !cf.Match(json(dictionary[code]))) continue;
+            postings->AppendPostings(code, rows);
+        }
+        if (codes.size() > 1) std::sort(rows.begin(), rows.end());
+        return true;
+    }
+
+    // 排序键：每行一个 double，字符串 / 混合类型列先按值排名。空值单独标记，总是排在最后
+    struct SortKey {
+        std::vector<double> values; // 按 rows 中的位置
+        std::vector<uint8_t> nulls;
+        bool descending = false;
+
+        // 把方向和空值折叠进键本身：比较时只需一次 double 比较（数据中不会出现无穷大）
+        void Normalize() {
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (nulls[i]) values[i] = std::numeric_limits<double>::infinity();
+                else if (descending) values[i] = -values[i];
+            }
+        }
+    };
+
+    SortKey BuildSortKey(const ColumnTable& table, const std::vector<uint32_t>& rows, size_t columnIndex, bool descending) {
+        const ColumnTable::Column& column = table.GetColumn(columnIndex);
+        SortKey key;
+        key.descending = descending;
+        key.values.resize(rows.size());
+        key.nulls.resize(rows.size());
+
+        Kind kind = column.GetKind();
+        if (kind == Kind::Integer || kind == Kind::Number || kind == Kind::Bool) {
+            for (size_t i = 0; i < rows.size(); ++i) {
+                uint32_t row = rows[i];
+                if (row == 0) {
+                    double v;
+                    json cell = CellAt(table, 0, columnIndex);
+                    bool ok = cell.is_boolean() ? (v = cell.get<bool>() ? 1.0 : 0.0, true) : ToNumber(cell, v);
+                    key.nulls[i] = ok ? 0 : 1;
+                    key.values[i] = ok ? v : 0.0;
+                    continue;
+                }
+                size_t d = row - 1;
+                key.nulls[i] = column.IsNull(d) ? 1 : 0;
+                key.values[i] = key.nulls[i] ? 0.0 : (kind == Kind::Bool ? (column.BoolAt(d) ? 1.0 : 0.0) : column.NumberAt(d));
+            }
+            return key;
+        }
+
+        if (kind == Kind::String) {
+            // 字典排序一次，得到每个编码的名次
+            const auto& dictionary = column.Dictionary();
+            std::vector<uint32_t> order(dictionary.size());
+            for (uint32_t d = 0; d < order.size(); ++d) order[d] = d;
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dictionary[a] < dictionary[b]; });
+            std::vector<uint32_t> rank(dictionary.size());
+            for (uint32_t r = 0; r < order.size(); ++r) rank[order[r]] = r;
+
+            for (size_t i = 0; i < rows.size(); ++i) {
+                uint32_t row = rows[i];
+                if (row == 0) {
+                    json cell = CellAt(table, 0, columnIndex);
+                    key.nulls[i] = cell.is_null() ? 1 : 0;
+                    std::string text = ToText(cell);
+                    auto it = std::lower_bound(order.begin(), order.end(), text,
+                        [&](uint32_t code, const std::string& value) { return dictionary[code] < value; });
+                    size_t pos = static_cast<size_t>(it - order.begin());
+                    bool exact = it != order.end() && dictionary[*it] == text;
+                    key.values[i] = exact ? static_cast<double>(pos) : static_cast<double>(pos) - 0.5;
+                    continue;
+                }
+                size_t d = row - 1;
+                key.nulls[i] = column.IsNull(d) ? 1 : 0;
+                key.values[i] = key.nulls[i] ? 0.0 : static_cast<double>(rank[column.CodeAt(d)]);
+            }
+            return key;
+        }
+
+        // 空列 / 混合类型：收集值后整体排名（json 自身定义了跨类型的全序）
+        std::vector<json> cells(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            cells[i] = CellAt(table, rows[i], columnIndex);
+            key.nulls[i] = cells[i].is_null() ? 1 : 0;
+        }
+        std::vector<uint32_t> order(rows.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return cells[a] < cells[b]; });
+        double rank = 0.0;
+        for (size_t r = 0; r < order.size(); ++r) {
+            if (r > 0 && cells[order[r - 1]] < cells[order[r]]) rank += 1.0;
+            key.values[order[r]] = rank;
+        }
+        return key;
+    }
+
+    // 多线程排序：分段并行排序后逐轮两两归并
+    template <typename Compare>
+    void ParallelSort(std::vector<uint32_t>& items, Compare comp) {
+        constexpr size_t kParallelThreshold = 1 << 16;
+        unsigned hw = std::thread::hardware_concurrency();
+        size_t threads = std::min<size_t>(hw == 0 ? 1 : hw, 8);
+        if (items.size() < kParallelThreshold || threads < 2) {
+            std::sort(items.begin(), items.end(), comp);
+            return;
+        }
+
+        size_t chunk = (items.size() + threads - 1) / threads;
+        std::vector<size_t> bounds;
+        for (size_t b = 0; b < items.size(); b += chunk) bounds.push_back(b);
+        bounds.push_back(items.size());
+
+        {
+            std::vector<std::thread> workers;
+            for (size_t s = 0; s + 1 < bounds.size(); ++s) {
+                workers.emplace_back([&, s] { std::sort(items.begin() + bounds[s], items.begin() + bounds[s + 1], comp); });
+            }
+            for (auto& w : workers) w.join();
+        }
+
+        while (bounds.size() > 2) {
+            std::vector<size_t> merged;
+            std::vector<std::thread> workers;
+            for (size_t s = 0; s + 1 < bounds.size(); s += 2) {
+                merged.push_back(bounds[s]);
+                if (s + 2 < bounds.size()) {
+                    size_t lo = bounds[s], mid = bounds[s + 1], hi = bounds[s + 2];
+                    workers.emplace_back([&, lo, mid, hi] { std::inplace_merge(items.begin() + lo, items.begin() + mid, items.begin() + hi, comp); });
+                }
+            }
+            merged.push_back(items.size());
+            for (auto& w : workers) w.join();
+            bounds = std::move(merged);
+        }
+    }
+
+    // --- 聚合 ---
+    struct Accumulator {
+        size_t count = 0;     // 非空单元格数
+        size_t numeric = 0;   // 可转换为数字的单元格数
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+
+        void Add(double v) {
+            if (numeric == 0 || v < min) min = v;
+            if (numeric == 0 || v > max) max = v;
+            sum += v;
+            ++numeric;
+        }
+
+        json Value(AggregateFn fn) const {
+            switch (fn) {
+            case AggregateFn::Count: return count;
+            case AggregateFn::Sum: return sum;
+            case AggregateFn::Avg: return numeric ? json(sum / static_cast<double>(numeric)) : json(nullptr);
+            case AggregateFn::Min: return numeric ? json(min) : json(nullptr);
+            case AggregateFn::Max: return numeric ? json(max) : json(nullptr);
+            }
+            return nullptr;
+        }
+    };
+
+    void Accumulate(const ColumnTable& table, size_t columnIndex, uint32_t row, Accumulator& acc) {
+        if (row != 0) {
+            const ColumnTable::Column& column = table.GetColumn(columnIndex);
+            size_t d = row - 1;
+            Kind kind = column.GetKind();
+            if (kind == Kind::Integer || kind == Kind::Number) {
+                if (!column.IsNull(d)) {
+                    ++acc.count;
+                    acc.Add(column.NumberAt(d));
+                }
+                return;
+            }
+        }
+        json cell = CellAt(table, row, columnIndex);
+        if (IsEmptyCell(cell)) return;
+        ++acc.count;
+        double v;
+        if (!cell.is_boolean() && ToNumber(cell, v)) acc.Add(v);
+    }
+
+    json Aggregates(const ColumnTable& table, const Query::Spec& spec, const std::vector<uint32_t>& rows, size_t begin, size_t end) {
+        json out = json::object();
+        for (const auto& aggregate : spec.aggregates) {
+            Accumulator acc;
+            for (size_t i = begin; i < end; ++i) {
+                Accumulate(table, aggregate.column, rows[i], acc);
+            }
+            out[aggregate.key] = acc.Value(aggregate.fn);
+        }
+        return out;
+    }
+
+    bool ParseFilterOp(const std::string& name, FilterOp& op) {
+        static const std::map<std::string, FilterOp> kOps = {
+            {"eq", FilterOp::Equal}, {"neq", FilterOp::NotEqual},
+            {"lt", FilterOp::Less}, {"lte", FilterOp::LessEqual},
+            {"gt", FilterOp::Greater}, {"gte", FilterOp::GreaterEqual},
+            {"contains", FilterOp::Contains}, {"startsWith", FilterOp::StartsWith},
+            {"empty", FilterOp::Empty}, {"notEmpty", FilterOp::NotEmpty},
+        };
+        auto it = kOps.find(name);
+        if (it == kOps.end()) return false;
+        op = it->second;
+        return true;
+    }
+
+    bool ParseAggregateFn(const std::string& name, AggregateFn& fn) {
+        static const std::map<std::string, AggregateFn> kFns = {
+            {"count", AggregateFn::Count}, {"sum", AggregateFn::Sum}, {"avg", AggregateFn::Avg},
+            {"min", AggregateFn::Min}, {"max", AggregateFn::Max},
+        };
+        auto it = kFns.find(name);
+        if (it == kFns.end()) return false;
+        fn = it->second;
+        return true;
+    }
+
+    Query::Spec ParseSpec(const json& config, const json& firstRow, size_t columnCount) {
+        Query::Spec spec;
+        std::string firstRowMode = config.value("firstRowMode", "header");
+        spec.firstRowIsData = (firstRowMode == "data");
+
+        // 与 TableViewBlock 相同的表头约定：header 模式用第一行，否则为 "Column N"
+        std::vector<std::string> headers(columnCount);
+        for (size_t c = 0; c < headers.size(); ++c) {
+            if (firstRowMode == "header") {
+                headers[c] = (firstRow.is_array() && c < firstRow.size()) ? ToText(firstRow[c]) : "";
+            }
+            else {
+                headers[c] = "Column " + std::to_string(c + 1);
+            }
+        }
+        auto resolve = [&headers](const json& name, size_t& index) {
+            if (!name.is_string()) return false;
+            auto it = std::find(headers.begin(), headers.end(), name.get<std::string>());
+            if (it == headers.end()) return false;
+            index = static_cast<size_t>(it - headers.begin());
+            return true;
+        };
+
+        if (config.contains("filters") && config["filters"].is_array()) {
+            for (const auto& f : config["filters"]) {
+                Query::Filter filter;
+                if (!f.is_object() || !resolve(f.value("column", json()), filter.column)) continue;
+                if (!ParseFilterOp(f.value("op", "eq"), filter.op)) continue;
+                filter.value = f.value("value", json(""));
+                spec.filters.push_back(std::move(filter));
+            }
+        }
+
+        if (config.contains("groupBy")) {
+            spec.grouped = resolve(config["groupBy"], spec.groupBy);
+        }
+
+        if (config.contains("sorts") && config["sorts"].is_array()) {
+            for (const auto& s : config["sorts"]) {
+                Query::Sort sort;
+                if (!s.is_object() || !resolve(s.value("column", json()), sort.column)) continue;
+                sort.descending = (s.value("direction", "asc") == "desc");
+                spec.sorts.push_back(sort);
+            }
+        }
+
+        if (config.contains("columns") && config["columns"].is_array()) {
+            const json& columns = config["columns"];
+            for (size_t i = 0; i < columns.size(); ++i) {
+                const json& col = columns[i];
+                if (!col.is_object() || !col.contains("aggregate")) continue;
+                Query::Aggregate aggregate;
+                if (!col["aggregate"].is_string() || !ParseAggregateFn(col["aggregate"].get<std::string>(), aggregate.fn)) continue;
+                if (!resolve(col.value("sourceHeader", json()), aggregate.column)) continue;
+                aggregate.key = std::to_string(i);
+                spec.aggregates.push_back(std::move(aggregate));
+            }
+        }
+        return spec;
+    }
+}
+
+
+Query::Spec Query::FromPresetConfig(const json& config, const ColumnTable& table) {
+    return ParseSpec(config, table.FirstRow(), table.ColumnCount());
+}
+
+Query::Spec Query::FromPresetConfig(const json& config, const Source& source) {
+    return ParseSpec(config, source.FirstRow(), source.ColumnCount());
+}
+
+Query::Result Query::Execute(const ColumnTable& table, const Spec& spec, const std::vector<std::shared_ptr<const ColumnIndex>>& indexes) {
+    Result result;
+    size_t dataRows = table.RowCount() > 0 ? table.RowCount() - 1 : 0;
+
+    std::vector<CompiledFilter> compiled;
+    compiled.reserve(spec.filters.size());
+    for (const auto& f : spec.filters) compiled.emplace_back(f);
+
+    if (spec.firstRowIsData && table.RowCount() > 0) {
+        bool match = true;
+        for (const auto& cf : compiled) {
+            if (!cf.Match(CellAt(table, 0, cf.filter->column))) { match = false; break; }
+        }
+        if (match) result.rows.push_back(0);
+    }
+
+    // 1. 筛选：能用索引的条件直接得到候选行并求交集
+    std::vector<uint32_t> candidates;
+    bool indexed = false;
+    std::vector<const CompiledFilter*> residual;
+    for (const auto& cf : compiled) {
+        std::vector<uint32_t> rows;
+        if (indexes.empty() || !LookupWithIndex(table, cf, indexes, rows)) {
+            residual.push_back(&cf);
+            continue;
+        }
+        if (!indexed) {
+            candidates = std::move(rows);
+            indexed = true;
+        }
+        else {
+            std::vector<uint32_t> both;
+            std::set_intersection(candidates.begin(), candidates.end(), rows.begin(), rows.end(), std::back_inserter(both));
+            candidates = std::move(both);
+        }
+    }
+
+    if (indexed) {
+        // 其余条件只在候选行上求值
+        for (uint32_t row : candidates) {
+            bool match = true;
+            for (const CompiledFilter* cf : residual) {
+                if (!MatchRow(table, *cf, row)) { match = false; break; }
+            }
+            if (match) result.rows.push_back(row + 1);
+        }
+    }
+    else {
+        // 没有可用的索引：在整列上生成保留位图
+        std::vector<uint8_t> keep(dataRows, 1);
+        for (const auto& cf : compiled) {
+            ApplyFilter(table, cf, keep);
+        }
+        for (size_t i = 0; i < dataRows; ++i) {
+            if (keep[i]) result.rows.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+
+    // 2. 排序：分组列作为第一排序键，使同组的行连续
+    std::vector<Sort> sorts;
+    if (spec.grouped) sorts.push_back({ spec.groupBy, false });
+    sorts.insert(sorts.end(), spec.sorts.begin(), spec.sorts.end());
+
+    std::vector<SortKey> keys;
+    for (const auto& s : sorts) {
+        keys.push_back(BuildSortKey(table, result.rows, s.column, s.descending));
+        keys.back().Normalize();
+    }
+
+    if (!keys.empty()) {
+        // 对 rows 中的位置排序，比较时直接读取预先计算的键
+        std::vector<uint32_t> positions(result.rows.size());
+        for (uint32_t i = 0; i < positions.size(); ++i) positions[i] = i;
+        if (keys.size() == 1) {
+            // 单键：键与位置放在一起排序，访问连续
+            std::vector<std::pair<double, uint32_t>> pairs(positions.size());
+            for (uint32_t i = 0; i < pairs.size(); ++i) pairs[i] = { keys[0].values[i], i };
+            std::sort(pairs.begin(), pairs.end());
+            for (size_t i = 0; i < pairs.size(); ++i) positions[i] = pairs[i].second;
+        }
+        else {
+            ParallelSort(positions, [&keys](uint32_t a, uint32_t b) {
+                for (const auto& key : keys) {
+                    double va = key.values[a], vb = key.values[b];
+                    if (va != vb) return va < vb;
+                }
+                return a < b; // 稳定
+            });
+        }
+
+        std::vector<uint32_t> sorted(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) sorted[i] = result.rows[positions[i]];
+
+        // 3. 分组：排序后同组的行相邻，按分组键切分
+        if (spec.grouped) {
+            const SortKey& groupKey = keys[0];
+            size_t start = 0;
+            for (size_t i = 1; i <= positions.size(); ++i) {
+                bool boundary = (i == positions.size());
+                if (!boundary) {
+                    uint32_t prev = positions[i - 1], cur = positions[i];
+                    boundary = groupKey.values[prev] != groupKey.values[cur];
+                }
+                if (boundary) {
+                    result.groups.push_back({
+                        {"key", CellAt(table, sorted[start], spec.groupBy)},
+                        {"start", start},
+                        {"count", i - start},
+                        {"aggregates", Aggregates(table, spec, sorted, start, i)}
+                    });
+                    start = i;
+                }
+            }
+        }
+        result.rows = std::move(sorted);
+    }
+
+    // 4. 全部结果行上的聚合
+    result.totals = Aggregates(table, spec, result.rows, 0, result.rows.size());
+    return result;
+}
+
+Query::Result Query::Execute(const ColumnStore::StoredTable& table, const Spec& spec) {
+    Result result;
+    const json& firstRow = table.FirstRow();
+
+    std::vector<CompiledFilter> compiled;
+    compiled.reserve(spec.filters.size());
+    for (const auto& f : spec.filters) compiled.emplace_back(f);
+
+    if (spec.firstRowIsData && table.RowCount() > 0) {
+        bool match = true;
+        for (const auto& cf : compiled) {
+            json cell = (firstRow.is_array() && cf.filter->column < firstRow.size()) ? firstRow[cf.filter->column] : json(nullptr);
+            if (!cf.Match(cell)) { match = false; break; }
+        }
+        if (match) result.rows.push_back(0);
+    }
+
+    // 排序 / 分组 / 聚合用到的列：筛选的同时把这些列投影到一张只含结果行的内存表上
+    const bool project = spec.grouped || !spec.sorts.empty() || !spec.aggregates.empty();
+    std::vector<size_t> projected;
+    auto projectColumn = [&projected](size_t column) {
+        auto it = std::find(projected.begin(), projected.end(), column);
+        if (it != projected.end()) return static_cast<size_t>(it - projected.begin());
+        projected.push_back(column);
+        return projected.size() - 1;
+    };
+    Spec inner;
+    if (project) {
+        if (spec.grouped) {
+            inner.grouped = true;
+            inner.groupBy = projectColumn(spec.groupBy);
+        }
+        for (const auto& sort : spec.sorts) inner.sorts.push_back({ projectColumn(sort.column), sort.descending });
+        for (const auto& aggregate : spec.aggregates) inner.aggregates.push_back({ projectColumn(aggregate.column), aggregate.fn, aggregate.key });
+    }
+    ColumnTable::Builder builder;
+    json cells = json::array();
+    if (project) {
+        for (size_t column : projected) {
+            cells.push_back((firstRow.is_array() && column < firstRow.size()) ? firstRow[column] : json(nullptr));
+        }
+        builder.AppendRow(cells);
+    }
+
+    // 1. 筛选：跳过统计信息排除的行组，其余行组解码后按列筛选
+    std::vector<uint32_t> matched;
+    for (size_t g = 0; g < table.RowGroupCount(); ++g) {
+        bool skip = false;
+        for (const auto& cf : compiled) {
+            if (GroupCannotMatch(table, g, cf)) { skip = true; break; }
+        }
+        if (skip) continue;
+
+        std::shared_ptr<const ColumnTable> group = table.RowGroup(g);
+        const size_t rows = group->RowCount();
+        std::vector<uint8_t> keep(rows, 1);
+        for (const auto& cf : compiled) {
+            if (cf.filter->column < group->ColumnCount()) {
+                ApplyFilter(*group, cf, keep);
+            }
+            else if (!cf.Match(json(nullptr))) {
+                std::fill(keep.begin(), keep.end(), 0);
+            }
+        }
+
+        const size_t start = table.RowGroupStart(g);
+        for (size_t i = 0; i < rows; ++i) {
+            if (!keep[i]) continue;
+            matched.push_back(static_cast<uint32_t>(start + i + 1));
+            if (project) {
+                cells.clear();
+                for (size_t column : projected) {
+                    cells.push_back(column < group->ColumnCount() ? group->GetColumn(column).ValueAt(i) : json(nullptr));
+                }
+                builder.AppendRow(cells);
+            }
+        }
+    }
+
+    if (!project) {
+        result.rows.insert(result.rows.end(), matched.begin(), matched.end());
+        return result;
+    }
+
+    // 2. 在投影表上排序 / 分组 / 聚合，再把行号换回存储中的行号
+    inner.firstRowIsData = !result.rows.empty();
+    std::shared_ptr<const ColumnTable> projection = builder.Finish();
+    if (matched.empty()) {
+        // 没有数据行满足条件时投影表没有列，结果最多只有第一行，直接在第一行上求值
+        result.totals = Aggregates(*projection, inner, result.rows, 0, result.rows.size());
+        if (inner.grouped && !result.rows.empty()) {
+            result.groups.push_back({
+                {"key", CellAt(*projection, 0, inner.groupBy)},
+                {"start", 0},
+                {"count", 1},
+                {"aggregates", result.totals}
+            });
+        }
+        return result;
+    }
+    Result projectedResult = Execute(*projection, inner);
+    for (auto& row : projectedResult.rows) {
+        row = row == 0 ? 0 : matched[row - 1];
+    }
+    return projectedResult;
+}
+
+Query::Result Query::Execute(const Source& source, const Spec& spec, const std::vector<std::shared_ptr<const ColumnIndex>>& indexes) {
+    if (source.stored) return Execute(*source.stored, spec);
+    if (source.table) return Execute(*source.table, spec, indexes);
+    return Result();
+}
+
+json Query::Page(const Source& source, const Result& result, size_t offset, size_t limit) {
+    size_t end = std::min(result.rows.size(), offset + std::min(limit, result.rows.size()));
+    if (source.stored) {
+        return source.stored->RowsAt(result.rows, offset, end);
+    }
+    json rows = json::array();
+    for (size_t i = offset; i < end && source.table; ++i) {
+        rows.push_back(source.table->RowAt(result.rows[i]));
+    }
+    return rows;
+}
+
+json Query::GroupsInWindow(const Result& result, size_t offset, size_t limit) {
+    json groups = json::array();
+    for (const auto& group : result.groups) {
+        size_t start = group["start"].get<size_t>();
+        size_t count = group["count"].get<size_t>();
+        if (start < offset + limit && start + count > offset) {
+            groups.push_back(group);
+        }
+    }
+    return groups;
+}
+
+
+// --- 增量维护 ---
+
+namespace {
+    // 两行在一个排序键上的比较，与 BuildSortKey + Normalize 的结果一致：空值总在最后，降序只翻转非空值
+    int CompareOnColumn(const ColumnTable& table, size_t columnIndex, bool descending, uint32_t a, uint32_t b) {
+        const ColumnTable::Column& column = table.GetColumn(columnIndex);
+        Kind kind = column.GetKind();
+        int order = 0;
+
+        if (kind == Kind::Integer || kind == Kind::Number || kind == Kind::Bool) {
+            auto value = [&](uint32_t row, double& v) {
+                if (row == 0) {
+                    json cell = CellAt(table, 0, columnIndex);
+                    if (cell.is_boolean()) { v = cell.get<bool>() ? 1.0 : 0.0; return true; }
+                    return ToNumber(cell, v);
+                }
+                size_t d = row - 1;
+                if (column.IsNull(d)) return false;
+                v = kind == Kind::Bool ? (column.BoolAt(d) ? 1.0 : 0.0) : column.NumberAt(d);
+                return true;
+            };
+            double va = 0.0, vb = 0.0;
+            bool ha = value(a, va), hb = value(b, vb);
+            if (!ha || !hb) return ha == hb ? 0 : (ha ? -1 : 1);
+            order = va < vb ? -1 : (vb < va ? 1 : 0);
+        }
+        else if (kind == Kind::String) {
+            // 第一行的单元格按文本参与比较，与 BuildSortKey 在字典上的插入位置一致
+            std::string ta, tb;
+            auto text = [&](uint32_t row, std::string& out) {
+                if (row == 0) {
+                    json cell = CellAt(table, 0, columnIndex);
+                    if (cell.is_null()) return false;
+                    out = ToText(cell);
+                    return true;
+                }
+                size_t d = row - 1;
+                if (column.IsNull(d)) return false;
+                out = column.Dictionary()[column.CodeAt(d)];
+                return true;
+            };
+            bool ha = text(a, ta), hb = text(b, tb);
+            if (!ha || !hb) return ha == hb ? 0 : (ha ? -1 : 1);
+            int c = ta.compare(tb);
+            order = c < 0 ? -1 : (c > 0 ? 1 : 0);
+        }
+        else {
+            json ca = CellAt(table, a, columnIndex), cb = CellAt(table, b, columnIndex);
+            if (ca.is_null() || cb.is_null()) return ca.is_null() == cb.is_null() ? 0 : (cb.is_null() ? -1 : 1);
+            order = ca < cb ? -1 : (cb < ca ? 1 : 0);
+        }
+        return descending ? -order : order;
+    }
+
+    // 结果中行的先后：依次比较排序键（分组列在最前），全部相同时按行号，与 Execute 的稳定排序一致
+    struct RowOrder {
+        const ColumnTable& table;
+        std::vector<Query::Sort> sorts;
+
+        bool operator()(uint32_t a, uint32_t b) const {
+            for (const auto& s : sorts) {
+                int c = CompareOnColumn(table, s.column, s.descending, a, b);
+                if (c != 0) return c < 0;
+            }
+            return a < b;
+        }
+    };
+}
+
+std::string Query::SpecKey(const Spec& spec) {
+    json key = json::array();
+    key.push_back(spec.firstRowIsData);
+    json filters = json::array();
+    for (const auto& f : spec.filters) filters.push_back({ f.column, static_cast<int>(f.op), f.value });
+    key.push_back(std::move(filters));
+    json sorts = json::array();
+    for (const auto& s : spec.sorts) sorts.push_back({ s.column, s.descending });
+    key.push_back(std::move(sorts));
+    key.push_back(spec.grouped ? json(spec.groupBy) : json(nullptr));
+    json aggregates = json::array();
+    for (const auto& a : spec.aggregates) aggregates.push_back({ a.column, static_cast<int>(a.fn), a.key });
+    key.push_back(std::move(aggregates));
+    return key.dump();
+}
+
+bool Query::Update(const ColumnTable& before, const ColumnTable& after, const Spec& spec, const std::vector<uint32_t>& changedRows, Result& result) {
+    if (before.RowCount() == 0 || after.RowCount() < before.RowCount() || after.ColumnCount() != before.ColumnCount()) {
+        return false;
+    }
+    if (!changedRows.empty() && changedRows.front() == 0) {
+        return false; // 第一行决定了表头与列的对应关系
+    }
+    size_t appended = static_cast<size_t>(changedRows.end() - std::lower_bound(changedRows.begin(), changedRows.end(), static_cast<uint32_t>(before.RowCount())));
+    if (appended != after.RowCount() - before.RowCount()) {
+        return false;
+    }
+
+    // 列类型决定了筛选 / 排序的求值方式，参与查询的列类型改变时未变化行的先后也可能改变
+    std::vector<Sort> sorts;
+    if (spec.grouped) sorts.push_back({ spec.groupBy, false });
+    sorts.insert(sorts.end(), spec.sorts.begin(), spec.sorts.end());
+    auto sameKind = [&](size_t column) {
+        return column < after.ColumnCount() && before.GetColumn(column).GetKind() == after.GetColumn(column).GetKind();
+    };
+    for (const auto& f : spec.filters) if (!sameKind(f.column)) return false;
+    for (const auto& s : sorts) if (!sameKind(s.column)) return false;
+    for (const auto& a : spec.aggregates) if (a.column >= after.ColumnCount()) return false;
+
+    std::vector<CompiledFilter> compiled;
+    compiled.reserve(spec.filters.size());
+    for (const auto& f : spec.filters) compiled.emplace_back(f);
+    RowOrder order{ after, sorts };
+
+    // 1. 去掉变化的行，剩余行的相对顺序不变；同时记下每个剩余行原来所在的分组
+    const size_t oldGroups = result.groups.size();
+    std::vector<size_t> groupStart(oldGroups), groupCount(oldGroups);
+    std::vector<uint8_t> groupDirty(oldGroups, 0);
+    for (size_t g = 0; g < oldGroups; ++g) {
+        groupStart[g] = result.groups[g]["start"].get<size_t>();
+        groupCount[g] = result.groups[g]["count"].get<size_t>();
+    }
+    std::vector<uint32_t> kept;
+    std::vector<size_t> keptGroup;
+    kept.reserve(result.rows.size());
+    size_t g = 0;
+    for (size_t i = 0; i < result.rows.size(); ++i) {
+        while (g < oldGroups && i >= groupStart[g] + groupCount[g]) ++g;
+        uint32_t row = result.rows[i];
+        if (std::binary_search(changedRows.begin(), changedRows.end(), row)) {
+            if (g < oldGroups) groupDirty[g] = 1;
+            continue;
+        }
+        kept.push_back(row);
+        keptGroup.push_back(g);
+    }
+
+    // 2. 变化的行重新筛选，按排序插入
+    std::vector<uint32_t> inserted;
+    for (uint32_t row : changedRows) {
+        if (row == 0 || row >= after.RowCount()) continue;
+        bool match = true;
+        for (const auto& cf : compiled) {
+            if (!MatchRow(after, cf, row - 1)) { match = false; break; }
+        }
+        if (match) inserted.push_back(row);
+    }
+    std::sort(inserted.begin(), inserted.end(), order);
+
+    std::vector<uint32_t> rows;
+    std::vector<uint8_t> fresh; // 插入的行
+    std::vector<size_t> origin; // 剩余行原来的分组
+    rows.reserve(kept.size() + inserted.size());
+    fresh.reserve(kept.size() + inserted.size());
+    origin.reserve(kept.size() + inserted.size());
+    size_t k = 0;
+    for (uint32_t row : inserted) {
+        size_t pos = static_cast<size_t>(std::lower_bound(kept.begin() + k, kept.end(), row, order) - kept.begin());
+        for (; k < pos; ++k) {
+            rows.push_back(kept[k]);
+            fresh.push_back(0);
+            origin.push_back(keptGroup[k]);
+        }
+        rows.push_back(row);
+        fresh.push_back(1);
+        origin.push_back(0);
+    }
+    for (; k < kept.size(); ++k) {
+        rows.push_back(kept[k]);
+        fresh.push_back(0);
+        origin.push_back(keptGroup[k]);
+    }
+
+    // 3. 分组：相邻的两个剩余行沿用原来的分组边界，与插入行相邻处比较分组键。
+    //    没有插入行、也没有行被移走的分组原样保留聚合值
+    if (spec.grouped) {
+        json groups = json::array();
+        size_t start = 0;
+        for (size_t i = 1; i <= rows.size(); ++i) {
+            bool boundary = (i == rows.size());
+            if (!boundary) {
+                if (!fresh[i - 1] && !fresh[i]) boundary = origin[i - 1] != origin[i];
+                else boundary = CompareOnColumn(after, spec.groupBy, false, rows[i - 1], rows[i]) != 0;
+            }
+            if (!boundary) continue;
+
+            bool clean = true;
+            for (size_t j = start; j < i && clean; ++j) {
+                clean = !fresh[j] && origin[j] == origin[start];
+            }
+            size_t source = clean ? origin[start] : 0;
+            clean = clean && source < oldGroups && !groupDirty[source] && groupCount[source] == i - start;
+            if (clean) {
+                json group = result.groups[source];
+                group["start"] = start;
+                groups.push_back(std::move(group));
+            }
+            else {
+                groups.push_back({
+                    {"key", CellAt(after, rows[start], spec.groupBy)},
+                    {"start", start},
+                    {"count", i - start},
+                    {"aggregates", Aggregates(after, spec, rows, start, i)}
+                });
+            }
+            start = i;
+        }
+        result.groups = std::move(groups);
+    }
+
+    // 4. 全部结果行上的聚合（线性扫描，不涉及排序）
+    result.totals = Aggregates(after, spec, rows, 0, rows.size());
+    result.rows = std::move(rows);
+    return true;
+}
+
+
+// --- Source ---
+
+size_t Query::Source::RowCount() const {
+    return stored ? stored->RowCount() : (table ? table->RowCount() : 0);
+}
+
+size_t Query::Source::ColumnCount() const {
+    return stored ? stored->ColumnCount() : (table ? table->ColumnCount() : 0);
+}
+
+const json& Query::Source::FirstRow() const {
+    static const json kNone;
+    return stored ? stored->FirstRow() : (table ? table->FirstRow() : kNone);
+}
+
+json Query::Source::DescribeColumns() const {
+    return stored ? stored->DescribeColumns() : (table ? table->DescribeColumns() : json::array());
+}
+
+
+// --- CursorRegistry ---
+
+namespace {
+    Query::CursorRegistry::Window BuildWindow(const Query::Source& source, const Query::Result& result, size_t offset, size_t limit) {
+        Query::CursorRegistry::Window window;
+        window.rows = Query::Page(source, result, offset, limit);
+        window.groups = Query::GroupsInWindow(result, offset, limit);
+        return window;
+    }
+}
+
+uint64_t Query::CursorRegistry::Open(const std::wstring& path, Source source, std::shared_ptr<const Result> result) {
+    if (m_cursors.size() >= kMaxCursors) {
+        Evict();
+    }
+    uint64_t id = m_nextId++;
+    Cursor& cursor = m_cursors[id];
+    cursor.path = path;
+    cursor.source = std::move(source);
+    cursor.result = std::move(result);
+    cursor.lastUsed = ++m_clock;
+    return id;
+}
+
+bool Query::CursorRegistry::Fetch(uint64_t id, size_t offset, size_t limit, Window& window, size_t& totalRows) {
+    auto it = m_cursors.find(id);
+    if (it == m_cursors.end()) {
+        return false;
+    }
+    Cursor& cursor = it->second;
+    cursor.lastUsed = ++m_clock;
+    totalRows = cursor.result->rows.size();
+
+    if (cursor.prefetch.valid() && cursor.prefetchOffset == offset && cursor.prefetchLimit == limit) {
+        window = cursor.prefetch.get();
+    }
+    else {
+        window = BuildWindow(cursor.source, *cursor.result, offset, limit);
+    }
+
+    // 预取下一个窗口；lambda 只持有表和结果，不引用游标本身
+    cursor.prefetch = std::shared_future<Window>();
+    size_t next = offset + limit;
+    if (limit > 0 && next < totalRows) {
+        Source source = cursor.source;
+        std::shared_ptr<const Result> result = cursor.result;
+        cursor.prefetchOffset = next;
+        cursor.prefetchLimit = limit;
+        cursor.prefetch = std::async(std::launch::async, [source, result, next, limit]() {
+            return BuildWindow(source, *result, next, limit);
+        }).share();
+    }
+    return true;
+}
+
+void Query::CursorRegistry::Close(uint64_t id) {
+    m_cursors.erase(id);
+}
+
+void Query::CursorRegistry::CloseForPath(const std::wstring& path) {
+    for (auto it = m_cursors.begin(); it != m_cursors.end();) {
+        if (it->second.path == path) {
+            it = m_cursors.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void Query::CursorRegistry::Clear() {
+    m_cursors.clear();
+}
+
+void Query::CursorRegistry::Evict() {
+    // 前端没有关闭的游标（例如页面被直接关闭）按最久未使用淘汰
+    auto oldest = m_cursors.end();
+    for (auto it = m_cursors.begin(); it != m_cursors.end(); ++it) {
+        if (oldest == m_cursors.end() || it->second.lastUsed < oldest->second.lastUsed) {
+            oldest = it;
+        }
+    }
+    if (oldest != m_cursors.end()) {
+        m_cursors.erase(oldest);
+    }
+}
+
+
+// --- ResultCache ---
+
+std::shared_ptr<const Query::Result> Query::ResultCache::Find(const std::wstring& path, uint64_t dataVersion, const std::string& specKey) {
+    for (auto& slot : m_slots) {
+        if (slot.dataVersion == dataVersion && slot.path == path && slot.specKey == specKey) {
+            slot.lastUsed = ++m_clock;
+            return slot.result;
+        }
+    }
+    return nullptr;
+}
+
+void Query::ResultCache::Store(const std::wstring& path, uint64_t dataVersion, const std::string& specKey, const Spec& spec, std::shared_ptr<const Result> result) {
+    if (!result || result->rows.size() > kMaxCachedRows) {
+        return;
+    }
+    Slot slot;
+    slot.path = path;
+    slot.dataVersion = dataVersion;
+    slot.specKey = specKey;
+    slot.spec = spec;
+    slot.result = std::move(result);
+    slot.lastUsed = ++m_clock;
+    m_slots.push_back(std::move(slot));
+    Evict();
+}
+
+void Query::ResultCache::Advance(const std::wstring& path, uint64_t fromVersion, uint64_t toVersion,
+    const ColumnTable& before, const ColumnTable& after, const std::vector<uint32_t>& changedRows) {
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        if (it->path != path) {
+            ++it;
+            continue;
+        }
+        if (it->dataVersion == fromVersion) {
+            // 游标可能仍持有旧结果，在副本上更新
+            Result updated = *it->result;
+            if (Update(before, after, it->spec, changedRows, updated)) {
+                it->result = std::make_shared<const Result>(std::move(updated));
+                it->dataVersion = toVersion;
+                ++it;
+                continue;
+            }
+        }
+        it = m_slots.erase(it);
+    }
+    Evict();
+}
+
+void Query::ResultCache::InvalidatePath(const std::wstring& path) {
+    m_slots.erase(std::remove_if(m_slots.begin(), m_slots.end(), [&path](const Slot& slot) { return slot.path == path; }), m_slots.end());
+}
+
+void Query::ResultCache::Clear() {
+    m_slots.clear();
+}
+
+void Query::ResultCache::Evict() {
+    auto totalRows = [this] {
+        size_t total = 0;
+        for (const auto& slot : m_slots) total += slot.result->rows.size();
+        return total;
+    };
+    while (!m_slots.empty() && (m_slots.size() > kMaxResults || totalRows() > kMaxCachedRows)) {
+        auto oldest = std::min_element(m_slots.begin(), m_slots.end(), [](const Slot& a, const Slot& b) { return a.lastUsed < b.lastUsed; });
+        m_slots.erase(oldest);
+    }
+}
@@ -0,0 +1,244 @@
+﻿#include "include/Telemetry.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 环形缓冲区的容量，满后覆盖最早的事件
+    constexpr size_t kMaxTraceEvents = 1 << 16;
+
+    struct ActionStats {
+        Telemetry::Histogram latency;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+    };
+
+    struct SpanStats {
+        Telemetry::Histogram latency;
+        const char* category = "";
+    };
+
+    struct TraceEvent {
+        std::string name; // span 名称都很短，不超出小字符串缓冲
+        const char* category;
+        uint64_t start; // 相对 g_origin 的微秒
+        uint64_t duration;
+        uint32_t thread;
+    };
+
+    const Clock::time_point g_origin = Clock::now();
+
+    std::mutex g_mutex;
+    std::map<std::string, ActionStats, std::less<>> g_actions;
+    std::map<std::string, SpanStats, std::less<>> g_spans;
+    uint64_t g_messagesIn = 0;
+    uint64_t g_bytesIn = 0;
+    uint64_t g_messagesOut = 0;
+    uint64_t g_bytesOut = 0;
+
+    bool g_tracing = false;
+    std::vector<TraceEvent> g_events;
+    size_t g_nextEvent = 0; // 缓冲区满后下一个被覆盖的位置
+    uint32_t g_nextThread = 1;
+
+    // 当前线程正在处理的 action（HandleWebMessage 可能在处理中重入）
+    thread_local const std::string* t_action = nullptr;
+    thread_local uint32_t t_thread = 0;
+
+    uint64_t Micros(Clock::duration duration) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    double Millis(uint64_t micros) {
+        return static_cast<double>(micros) / 1000.0;
+    }
+
+    // 调用方持有 g_mutex。trace 中的 tid 使用按首次出现顺序编号的小整数
+    uint32_t ThreadNumber() {
+        if (t_thread == 0) t_thread = g_nextThread++;
+        return t_thread;
+    }
+
+    void AppendEvent(TraceEvent event) {
+        if (g_events.size() < kMaxTraceEvents) {
+            g_events.push_back(std::move(event));
+            return;
+        }
+        g_events[g_nextEvent] = std::move(event);
+        g_nextEvent = (g_nextEvent + 1) % kMaxTraceEvents;
+    }
+
+    ActionStats& ActionEntry(std::string_view action) {
+        auto it = g_actions.find(action);
+        if (it == g_actions.end()) it = g_actions.emplace(std::string(action), ActionStats()).first;
+        return it->second;
+    }
+
+    void RecordActionLocked(std::string_view action, uint64_t micros, size_t bytesIn) {
+        ActionStats& stats = ActionEntry(action);
+        stats.latency.Record(micros);
+        stats.bytesIn += bytesIn;
+        ++g_messagesIn;
+        g_bytesIn += bytesIn;
+    }
+}
+
+
+void Telemetry::Histogram::Record(uint64_t micros) {
+    ++m_buckets[BucketOf(micros)];
+    ++m_count;
+    m_total += micros;
+    m_max = std::max(m_max, micros);
+}
+
+size_t Telemetry::Histogram::BucketOf(uint64_t micros) {
+    if (micros < kSubBuckets) return static_cast<size_t>(micros);
+    size_t exponent = 63;
+    while (!(micros >> exponent)) --exponent;
+    // 最高位之后的两位决定子桶
+    size_t sub = static_cast<size_t>(micros >> (exponent - 2)) & (kSubBuckets - 1);
+    return std::min(kSubBuckets + (exponent - 2) * kSubBuckets + sub, kBuckets - 1);
+}
+
+uint64_t Telemetry::Histogram::UpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    size_t exponent = (bucket - kSubBuckets) / kSubBuckets + 2;
+    uint64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << (exponent - 2)) - 1;
+}
+
+uint64_t Telemetry::Histogram::Percentile(double p) const {
+    if (m_count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(m_count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) return std::min(UpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+json Telemetry::Histogram::ToJson() const {
+    return {
+        {"count", m_count},
+        {"totalMs", Millis(m_total)},
+        {"meanMs", m_count ? Millis(m_total) / static_cast<double>(m_count) : 0.0},
+        {"p50Ms", Millis(Percentile(0.5))},
+        {"p90Ms", Millis(Percentile(0.9))},
+        {"p99Ms", Millis(Percentile(0.99))},
+        {"maxMs", Millis(m_max)}
+    };
+}
+
+
+void Telemetry::RecordAction(std::string_view action, uint64_t micros, size_t bytesIn) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    RecordActionLocked(action, micros, bytesIn);
+}
+
+void Telemetry::RecordMessageOut(size_t bytes) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ++g_messagesOut;
+    g_bytesOut += bytes;
+    if (t_action) {
+        ActionEntry(*t_action).bytesOut += bytes;
+    }
+}
+
+
+Telemetry::ActionScope::ActionScope(std::string_view action, size_t bytesIn)
+    : m_action(action), m_bytesIn(bytesIn), m_start(Clock::now()), m_outer(t_action) {
+    t_action = &m_action;
+}
+
+Telemetry::ActionScope::~ActionScope() {
+    t_action = m_outer;
+    Clock::time_point end = Clock::now();
+    uint64_t duration = Micros(end - m_start);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    RecordActionLocked(m_action, duration, m_bytesIn);
+    if (g_tracing) {
+        AppendEvent({ m_action, "action", Micros(m_start - g_origin), duration, ThreadNumber() });
+    }
+}
+
+
+Telemetry::Span::Span(const char* name, const char* category)
+    : m_name(name), m_category(category), m_start(Clock::now()) {
+}
+
+Telemetry::Span::~Span() {
+    Clock::time_point end = Clock::now();
+    uint64_t duration = Micros(end - m_start);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_spans.find(std::string_view(m_name));
+    if (it == g_spans.end()) it = g_spans.emplace(m_name, SpanStats()).first;
+    it->second.latency.Record(duration);
+    it->second.category = m_category;
+    if (g_tracing) {
+        AppendEvent({ m_name, m_category, Micros(m_start - g_origin), duration, ThreadNumber() });
+    }
+}
+
+
+void Telemetry::SetTracing(bool enabled) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_tracing = enabled;
+}
+
+json Telemetry::Stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    json stats;
+    stats["uptimeMs"] = Millis(Micros(Clock::now() - g_origin));
+    stats["tracing"] = g_tracing;
+    stats["ipc"] = { {"messagesIn", g_messagesIn}, {"bytesIn", g_bytesIn}, {"messagesOut", g_messagesOut}, {"bytesOut", g_bytesOut} };
+
+    json actions = json::object();
+    for (const auto& [name, action] : g_actions) {
+        json entry = action.latency.ToJson();
+        entry["bytesIn"] = action.bytesIn;
+        entry["bytesOut"] = action.bytesOut;
+        actions[name] = std::move(entry);
+    }
+    stats["actions"] = std::move(actions);
+
+    json spans = json::object();
+    for (const auto& [name, span] : g_spans) {
+        json entry = span.latency.ToJson();
+        entry["category"] = span.category;
+        spans[name] = std::move(entry);
+    }
+    stats["spans"] = std::move(spans);
+    return stats;
+}
+
+json Telemetry::Trace() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    json events = json::array();
+    // 从最早的事件开始输出
+    for (size_t i = 0; i < g_events.size(); ++i) {
+        const TraceEvent& event = g_events[(g_nextEvent + i) % g_events.size()];
+        events.push_back({
+            {"name", event.name}, {"cat", event.category}, {"ph", "X"},
+            {"ts", event.start}, {"dur", event.duration}, {"pid", 1}, {"tid", event.thread}
+        });
+    }
+    return { {"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"} };
+}
+
+void Telemetry::Reset() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_actions.clear();
+    g_spans.clear();
+    g_messagesIn = g_bytesIn = g_messagesOut = g_bytesOut = 0;
+    g_events.clear();
+    g_nextEvent = 0;
+}
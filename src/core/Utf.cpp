@@ -0,0 +1,260 @@
+﻿#include <cstdint>
+#include <cstring>
+
+#include "include/Utf.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VN_UTF_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define VN_UTF_NEON 1
+#endif
+
+
+namespace {
+    // DecodeOne 对非法序列给出的值，不是任何码点
+    constexpr char32_t kInvalidSequence = 0x110000;
+
+    // [p, p + n) 开头连续 ASCII 字节的个数（按 16 字节一组判断，余下的部分交给调用方逐字节处理）
+    size_t AsciiPrefix(const char* p, size_t n) {
+        size_t i = 0;
+#if defined(VN_UTF_SSE2)
+        for (; i + 16 <= n; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            if (_mm_movemask_epi8(chunk) != 0) break;
+        }
+#elif defined(VN_UTF_NEON)
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+            if (vmaxvq_u8(chunk) >= 0x80) break;
+        }
+#else
+        for (; i + 8 <= n; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, p + i, 8);
+            if (word & 0x8080808080808080ull) break;
+        }
+#endif
+        return i;
+    }
+
+    // 16 / 32 位码元版本：开头连续 < 0x80 的码元个数（一次判断 16 字节）
+    template <typename Unit>
+    size_t AsciiPrefixUnits(const Unit* p, size_t n) {
+        size_t i = 0;
+#if defined(VN_UTF_SSE2)
+        constexpr size_t kStep = 16 / sizeof(Unit);
+        const __m128i highBits = sizeof(Unit) == 2 ? _mm_set1_epi16(static_cast<short>(0xFF80)) : _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+        for (; i + kStep <= n; i += kStep) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(chunk, highBits), _mm_setzero_si128())) != 0xFFFF) break;
+        }
+#elif defined(VN_UTF_NEON)
+        if (sizeof(Unit) == 2) {
+            for (; i + 8 <= n; i += 8) {
+                uint16x8_t chunk = vld1q_u16(reinterpret_cast<const uint16_t*>(p + i));
+                if (vmaxvq_u16(chunk) >= 0x80) break;
+            }
+        }
+        else {
+            for (; i + 4 <= n; i += 4) {
+                uint32x4_t chunk = vld1q_u32(reinterpret_cast<const uint32_t*>(p + i));
+                if (vmaxvq_u32(chunk) >= 0x80) break;
+            }
+        }
+#else
+        for (; i < n && static_cast<char32_t>(p[i]) < 0x80; ++i) {}
+#endif
+        return i;
+    }
+
+    // 解码 [p, end) 开头的一个码点，返回消耗的字节数（至少为 1）。
+    // 非法时 cp 为 kInvalidSequence，消耗的是最大非法子序列（合法前缀），与 Unicode 推荐的替换方式一致
+    size_t DecodeOne(const unsigned char* p, const unsigned char* end, char32_t& cp) {
+        unsigned char lead = p[0];
+        size_t available = static_cast<size_t>(end - p);
+        size_t length;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+
+        if (lead < 0x80) {
+            cp = lead;
+            return 1;
+        }
+        else if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+            cp = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            cp = lead & 0x0F;
+            if (lead == 0xE0) low = 0xA0;       // 过长编码
+            else if (lead == 0xED) high = 0x9F; // 代理区 U+D800..U+DFFF
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            cp = lead & 0x07;
+            if (lead == 0xF0) low = 0x90;       // 过长编码
+            else if (lead == 0xF4) high = 0x8F; // 超出 U+10FFFF
+        }
+        else {
+            cp = kInvalidSequence;
+            return 1;
+        }
+
+        for (size_t k = 1; k < length; ++k) {
+            if (k >= available) {
+                cp = kInvalidSequence;
+                return k;
+            }
+            unsigned char c = p[k];
+            // 只有第二个字节有特殊范围
+            if (c < (k == 1 ? low : 0x80) || c > (k == 1 ? high : 0xBF)) {
+                cp = kInvalidSequence;
+                return k;
+            }
+            cp = (cp << 6) | (c & 0x3F);
+        }
+        return length;
+    }
+
+    // UTF-8 -> 16 位 (UTF-16) 或 32 位 (UTF-32) 码元，返回写入的码元数；out 至少要有 in.size() 个码元
+    template <typename Unit>
+    size_t DecodeUtf8(std::string_view in, Unit* out) {
+        const char* data = in.data();
+        const size_t n = in.size();
+        Unit* o = out;
+        size_t i = 0;
+        while (i < n) {
+            size_t ascii = AsciiPrefix(data + i, n - i);
+            for (size_t k = 0; k < ascii; ++k) {
+                o[k] = static_cast<Unit>(static_cast<unsigned char>(data[i + k]));
+            }
+            o += ascii;
+            i += ascii;
+
+            // 一组中出现非 ASCII 字节，逐个码点处理到下一组的边界
+            size_t groupEnd = i + 16 < n ? i + 16 : n;
+            while (i < groupEnd) {
+                char32_t cp;
+                i += DecodeOne(reinterpret_cast<const unsigned char*>(data + i), reinterpret_cast<const unsigned char*>(data + n), cp);
+                if (cp == kInvalidSequence) cp = Utf::kReplacementChar;
+                if (sizeof(Unit) == 2 && cp >= 0x10000) {
+                    cp -= 0x10000;
+                    *o++ = static_cast<Unit>(0xD800 + (cp >> 10));
+                    *o++ = static_cast<Unit>(0xDC00 + (cp & 0x3FF));
+                }
+                else {
+                    *o++ = static_cast<Unit>(cp);
+                }
+            }
+        }
+        return static_cast<size_t>(o - out);
+    }
+
+    // 读取 [i, n) 处的一个码点并前进；孤立代理项、超出范围的值为 U+FFFD
+    template <typename Unit>
+    char32_t NextCodePoint(const Unit* p, size_t n, size_t& i) {
+        char32_t u = static_cast<char32_t>(p[i++]);
+        if (sizeof(Unit) == 2) {
+            u &= 0xFFFF;
+            if (u >= 0xD800 && u <= 0xDBFF && i < n) {
+                char32_t next = static_cast<char32_t>(p[i]) & 0xFFFF;
+                if (next >= 0xDC00 && next <= 0xDFFF) {
+                    ++i;
+                    return 0x10000 + ((u - 0xD800) << 10) + (next - 0xDC00);
+                }
+            }
+        }
+        if ((u >= 0xD800 && u <= 0xDFFF) || u > 0x10FFFF) return Utf::kReplacementChar;
+        return u;
+    }
+
+    size_t EncodedLength(char32_t cp) {
+        return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+    }
+
+    template <typename Unit>
+    void EncodeUtf8(const Unit* p, size_t n, std::string& out) {
+        // 第一遍计算精确长度，只分配一次
+        size_t length = 0;
+        for (size_t i = 0; i < n;) {
+            size_t ascii = AsciiPrefixUnits(p + i, n - i);
+            length += ascii;
+            i += ascii;
+            if (i >= n) break;
+            length += EncodedLength(NextCodePoint(p, n, i));
+        }
+        out.resize(length);
+
+        char* o = &out[0];
+        for (size_t i = 0; i < n;) {
+            size_t ascii = AsciiPrefixUnits(p + i, n - i);
+            for (size_t k = 0; k < ascii; ++k) {
+                o[k] = static_cast<char>(p[i + k]);
+            }
+            o += ascii;
+            i += ascii;
+            if (i >= n) break;
+            char32_t cp = NextCodePoint(p, n, i);
+            if (cp < 0x80) {
+                *o++ = static_cast<char>(cp);
+            }
+            else if (cp < 0x800) {
+                *o++ = static_cast<char>(0xC0 | (cp >> 6));
+                *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000) {
+                *o++ = static_cast<char>(0xE0 | (cp >> 12));
+                *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else {
+                *o++ = static_cast<char>(0xF0 | (cp >> 18));
+                *o++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+    }
+
+    template <typename String>
+    void DecodeInto(std::string_view in, String& out) {
+        // 每个 UTF-8 字节最多产生一个码元（4 字节序列产生 2 个 UTF-16 码元或 1 个 UTF-32 码元）
+        out.resize(in.size());
+        if (in.empty()) return;
+        out.resize(DecodeUtf8(in, &out[0]));
+    }
+}
+
+
+void Utf::Utf8ToUtf16(std::string_view in, std::u16string& out) {
+    DecodeInto(in, out);
+}
+
+void Utf::Utf8ToWide(std::string_view in, std::wstring& out) {
+    static_assert(sizeof(wchar_t) == 2 || sizeof(wchar_t) == 4, "wchar_t must be UTF-16 or UTF-32");
+    DecodeInto(in, out);
+}
+
+void Utf::Utf16ToUtf8(std::u16string_view in, std::string& out) {
+    EncodeUtf8(in.data(), in.size(), out);
+}
+
+void Utf::WideToUtf8(std::wstring_view in, std::string& out) {
+    EncodeUtf8(in.data(), in.size(), out);
+}
+
+bool Utf::IsValidUtf8(std::string_view in) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in.data());
+    const unsigned char* end = p + in.size();
+    while (p < end) {
+        p += AsciiPrefix(reinterpret_cast<const char*>(p), static_cast<size_t>(end - p));
+        if (p >= end) break;
+        char32_t cp;
+        p += DecodeOne(p, end, cp);
+        if (cp == kInvalidSequence) return false;
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+﻿#include "include/WebResources.h"
+
+#include <cctype>
+
+
+namespace {
+    bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+        }
+        return true;
+    }
+
+    std::string_view Trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        return value;
+    }
+
+    // 十进制非负整数，空串或溢出时返回 false
+    bool ParseUnsigned(std::string_view text, uint64_t& value) {
+        if (text.empty()) return false;
+        value = 0;
+        for (char c : text) {
+            if (c < '0' || c > '9') return false;
+            uint64_t digit = static_cast<uint64_t>(c - '0');
+            if (value > (UINT64_MAX - digit) / 10) return false;
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    struct MimeEntry {
+        const char* extension;
+        const char* type;
+    };
+
+    const MimeEntry kMimeTypes[] = {
+        { ".html", "text/html; charset=utf-8" },
+        { ".css", "text/css; charset=utf-8" },
+        { ".js", "application/javascript; charset=utf-8" },
+        { ".json", "application/json; charset=utf-8" },
+        { ".txt", "text/plain; charset=utf-8" },
+        { ".png", "image/png" },
+        { ".jpg", "image/jpeg" },
+        { ".jpeg", "image/jpeg" },
+        { ".gif", "image/gif" },
+        { ".webp", "image/webp" },
+        { ".svg", "image/svg+xml" },
+        { ".ico", "image/x-icon" },
+        { ".woff", "font/woff" },
+        { ".woff2", "font/woff2" },
+        { ".ttf", "font/ttf" },
+        { ".mp4", "video/mp4" },
+        { ".webm", "video/webm" },
+        { ".mp3", "audio/mpeg" },
+        { ".wav", "audio/wav" },
+        { ".ogg", "audio/ogg" },
+    };
+}
+
+
+bool WebResources::RequestPath(std::string_view url, std::string_view expectedHost, std::string& path) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string_view::npos) return false;
+    std::string_view rest = url.substr(scheme + 3);
+
+    size_t hostEnd = rest.find_first_of("/?#");
+    if (!EqualsIgnoreCase(rest.substr(0, hostEnd), expectedHost)) return false;
+    if (hostEnd == std::string_view::npos || rest[hostEnd] != '/') {
+        path = "/";
+        return true;
+    }
+
+    std::string_view rawPath = rest.substr(hostEnd);
+    rawPath = rawPath.substr(0, rawPath.find_first_of("?#"));
+    path.assign(rawPath.data(), rawPath.size());
+    return true;
+}
+
+const char* WebResources::MimeType(std::string_view path) {
+    size_t dot = path.find_last_of("./\\");
+    if (dot == std::string_view::npos || path[dot] != '.') return "application/octet-stream";
+    std::string_view extension = path.substr(dot);
+    for (const MimeEntry& entry : kMimeTypes) {
+        if (EqualsIgnoreCase(extension, entry.extension)) return entry.type;
+    }
+    return "application/octet-stream";
+}
+
+WebResources::RangeResult WebResources::ParseRange(std::string_view header, uint64_t size, ByteRange& range) {
+    range.offset = 0;
+    range.length = size;
+
+    header = Trim(header);
+    constexpr std::string_view kBytes = "bytes=";
+    if (header.size() < kBytes.size() || !EqualsIgnoreCase(header.substr(0, kBytes.size()), kBytes)) return RangeResult::Full;
+    std::string_view spec = Trim(header.substr(kBytes.size()));
+    // 多区间需要 multipart/byteranges，媒体元素不会这样请求
+    if (spec.find(',') != std::string_view::npos) return RangeResult::Full;
+
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return RangeResult::Full;
+    std::string_view firstText = Trim(spec.substr(0, dash));
+    std::string_view lastText = Trim(spec.substr(dash + 1));
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+    if (firstText.empty()) {
+        // 后缀区间：最后 N 个字节
+        uint64_t suffix = 0;
+        if (!ParseUnsigned(lastText, suffix)) return RangeResult::Full;
+        if (suffix == 0 || size == 0) return RangeResult::Unsatisfiable;
+        first = suffix >= size ? 0 : size - suffix;
+        last = size - 1;
+    }
+    else {
+        if (!ParseUnsigned(firstText, first)) return RangeResult::Full;
+        if (lastText.empty()) {
+            last = size == 0 ? 0 : size - 1;
+        }
+        else if (!ParseUnsigned(lastText, last) || last < first) {
+            return RangeResult::Full;
+        }
+        if (first >= size) return RangeResult::Unsatisfiable;
+        if (last >= size) last = size - 1;
+    }
+
+    range.offset = first;
+    range.length = last - first + 1;
+    return RangeResult::Partial;
+}
+
+std::string WebResources::ContentRange(const ByteRange& range, uint64_t size) {
+    return "bytes " + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1) + "/" + std::to_string(size);
+}
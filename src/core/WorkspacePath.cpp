@@ -0,0 +1,110 @@
+﻿#include "include/WorkspacePath.h"
+
+#include <system_error>
+
+#include "include/Utf.h"
+
+
+namespace {
+    const std::string kEmptyUtf8;
+    const std::wstring kEmptyIdentifier;
+    const std::filesystem::path kEmptyPath;
+
+    // lexically_relative 的结果以 ".." 开头或为空时说明两者不在同一棵树下（或大小写、符号链接不同），
+    // 这时交给 std::filesystem::relative 按真实文件系统计算
+    bool IsContained(const std::filesystem::path& relative) {
+        if (relative.empty()) return false;
+        return *relative.begin() != "..";
+    }
+}
+
+
+const std::string& WorkspacePath::Utf8() const {
+    return m_entry ? m_entry->utf8 : kEmptyUtf8;
+}
+
+const std::wstring& WorkspacePath::Identifier() const {
+    return m_entry ? m_entry->identifier : kEmptyIdentifier;
+}
+
+const std::filesystem::path& WorkspacePath::Path() const {
+    return m_entry ? m_entry->path : kEmptyPath;
+}
+
+const std::filesystem::path& WorkspacePath::Relative() const {
+    if (!m_entry) return kEmptyPath;
+    const Entry& entry = *m_entry;
+    if (!entry.hasRelative) {
+        entry.relative = entry.path.lexically_relative(entry.root);
+        if (!IsContained(entry.relative)) {
+            std::error_code ec;
+            entry.relative = std::filesystem::relative(entry.path, entry.root, ec);
+            if (ec) entry.relative.clear();
+        }
+        entry.hasRelative = true;
+    }
+    return entry.relative;
+}
+
+bool WorkspacePath::operator==(const WorkspacePath& other) const {
+    if (m_entry == other.m_entry) return true;
+    // 整表重建前后发出的句柄可能指向不同的条目
+    return Hash() == other.Hash() && Identifier() == other.Identifier();
+}
+
+
+void WorkspacePaths::Reset(const std::wstring& root) {
+    // Android 的根目录是 content URI，规范化会把 "//" 合并，拼接路径时必须使用原文
+    m_root = std::filesystem::path(root).make_preferred();
+    m_normalRoot = m_root.lexically_normal();
+    m_buildDirectory = std::filesystem::path(m_root).append(L"build");
+    m_entries.clear();
+    m_resolved.clear();
+}
+
+WorkspacePath WorkspacePaths::Intern(std::string_view utf8) {
+    std::string key(utf8);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        return WorkspacePath(it->second);
+    }
+    if (m_entries.size() >= kMaxEntries) {
+        m_entries.clear();
+    }
+
+    auto entry = std::make_shared<WorkspacePath::Entry>();
+    entry->utf8 = key;
+    Utf::Utf8ToWide(utf8, entry->identifier);
+    entry->path = std::filesystem::path(entry->identifier).lexically_normal().make_preferred();
+    entry->root = m_normalRoot;
+    entry->hash = std::hash<std::wstring>{}(entry->identifier);
+
+    std::shared_ptr<const WorkspacePath::Entry> stored = std::move(entry);
+    m_entries.emplace(std::move(key), stored);
+    return WorkspacePath(std::move(stored));
+}
+
+WorkspacePath WorkspacePaths::Resolve(std::string_view utf8) {
+    std::string key(utf8);
+    auto it = m_resolved.find(key);
+    if (it != m_resolved.end()) {
+        return WorkspacePath(it->second);
+    }
+    if (m_resolved.size() >= kMaxEntries) {
+        m_resolved.clear();
+    }
+
+    WorkspacePath path = Intern(utf8);
+    std::filesystem::path given(path.Identifier());
+    if (!given.is_absolute() && key.rfind("\\\\", 0) != 0) {
+        path = Intern(Utf::ToUtf8((m_root / given).make_preferred().wstring()));
+    }
+    m_resolved.emplace(std::move(key), path.m_entry);
+    return path;
+}
+
+std::filesystem::path WorkspacePaths::BuildTarget(const WorkspacePath& source, const wchar_t* extension) const {
+    std::filesystem::path target = m_buildDirectory / source.Relative();
+    target.replace_extension(extension);
+    return target;
+}
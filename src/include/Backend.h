@@ -1,7 +1,15 @@
 ﻿#pragma once
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "nlohmann/json.hpp"
+#include "include/ConfigCache.h"
+#include "include/DurableStorage.h"
+#include "include/FileAccess.h"
+#include "include/ColumnTable.h"
+#include "include/QueryEngine.h"
+#include "include/WorkspacePath.h"
 
 #if defined(WIN32) || defined(_WIN32)
 #include <windows.h> // 在 Windows 上，直接包含 windows.h 来获取 DWORD
@@ -49,10 +57,29 @@ protected:
     virtual std::string wstring_to_string(const std::wstring& wstr) const = 0;
     virtual bool UrlDecode(const std::string& encoded, std::string& decoded) const = 0;
 
-    virtual void ListWorkspace(const json& payload) = 0;
+    // 默认实现直接遍历本地目录（桌面端）；标识符不是本地路径的平台（Android）自行实现
+    virtual void ListWorkspace(const json& payload);
 
     virtual std::string ReadFileContent(const std::wstring& path) = 0;
+    // 与 ReadFileContent 相同，但区分 "读取没有完成"（如平台服务超时）与空文件 / 不存在的文件：
+    // 返回 false 时 content 无意义，调用方必须报告错误而不是当作空文件。默认实现总是成功
+    virtual bool TryReadFileContent(const std::wstring& path, std::string& content) { content = ReadFileContent(path); return true; }
     virtual bool WriteFileContent(const std::wstring& path, const std::string& content) = 0;
+    // 频繁保存时的廉价写入（追加到预写日志，稍后压缩）。默认实现退化为普通写入。
+    virtual bool WriteFileContentJournaled(const std::wstring& path, const std::string& content) { return WriteFileContent(path, content); }
+    // 增量保存：只持久化 JSON Patch 文本。snapshot 返回完整内容，默认实现直接整体写入。
+    virtual bool WriteFilePatch(const std::wstring& path, const std::string& /*patch*/, const std::function<std::string()>& snapshot) { return WriteFileContent(path, snapshot()); }
+    // 读写通道能否原样传输任意字节（二进制页面格式需要）
+    virtual bool SupportsBinaryFiles() const { return false; }
+    // 标识符对应的本地文件路径，供按路径内存映射的存储（列式文件）使用，只在 SupportsBinaryFiles() 时调用。
+    // 默认标识符本身就是路径
+    virtual std::filesystem::path LocalFilePath(const std::wstring& identifier) const { return identifier; }
+    // 文件大小与修改时间，用于校验缓存；平台无法提供时返回 false
+    virtual bool GetFileStat(const std::wstring& /*path*/, FileAccess::FileStat& /*stat*/) { return false; }
+    // 分块读取大文件（CSV 等），sink 返回 false 时停止；默认整体读取后一次交给 sink
+    virtual bool ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink);
+    // 边生成边写入大文件（列式存储），默认实现先拼接出完整内容再整体写入
+    virtual bool WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce);
 
     virtual void CreateItem(const json& payload) = 0;
     virtual void DeleteItem(const json& payload) = 0;
@@ -63,11 +90,14 @@ protected:
     virtual void WriteJsonFile(const std::wstring& identifier, const json& data) = 0;
     virtual std::wstring GetParentIdentifier(const std::wstring& identifier) = 0;
     virtual std::wstring CombineIdentifier(const std::wstring& parent, const std::wstring& childFilename) = 0;
+    // 读取 identifier 处的 JSON，同时取得 parentOf 的父级标识符。
+    // 默认依次调用 ReadJsonFile / GetParentIdentifier；每次访问都是一次平台往返的平台（Android）把两者合并为一次
+    virtual json ReadJsonFileAndParent(const std::wstring& identifier, const std::wstring& parentOf, std::wstring& parent);
 
     // --- 业务逻辑处理函数 (平台无关) ---
     // 这些函数的实现放在 Backend.cpp 中，因为它们不直接依赖任何平台API。
     void ExportPageAsHtml(const json& payload);
-    void ExportDatabaseAsJs(const json& payload);
+    void ExportDatabaseBundles(const json& payload); // 原生生成发布站点的数据库包（按 preset 预先计算、分块），多个数据库并行
     void PrepareExportLibs(const json& payload);
     void ProcessExportImages(const json& payload);
     void GoToDashboard();
@@ -75,19 +105,77 @@ protected:
     void ReadConfigFile(const json& payload); // Config File！不是 File Config！
     void WriteConfigFile(const json& payload); // Config File！不是 File Config！
 	void ResolveFileConfiguration(const json& payload); // 读取同时循环解析推断 File Config
+    void ResolveFileConfigurations(const json& payload); // 批量版本，一次 IPC 解析多个文件
     // File IO
     // 仅读取单个文件内容
     void LoadFile(const json& payload);
     void SaveFile(const json& payload);
+    void PatchFile(const json& payload); // 增量保存 (JSON Patch)
+    void ConvertFileFormat(const json& payload); // JSON <-> 二进制页面格式
     void ReadFileConfig(const json& payload);
     void WriteFileConfig(const json& payload);
     // Page
     void FetchQuoteContent(const json& payload);
     void FetchDataContent(const json& payload);
+    void ParseCsv(const json& payload); // 原生 CSV 解析 + 列类型推断
+    void QueryData(const json& payload); // 在后端执行 preset 的筛选/排序/分组/聚合，只返回一页
+    void OpenQuery(const json& payload); // 打开查询游标并返回第一个窗口
+    void FetchRows(const json& payload); // 从游标读取 [offset, offset + limit) 的行
+    void ConvertDatabaseStorage(const json& payload); // embeddedData (JSON) <-> 磁盘列式存储
+    // 诊断
+    void GetBackendStats(const json& payload); // 各 action 的耗时直方图、IPC 字节数，可附带 Chrome trace
 
     bool ExtractResourceToFile(const std::wstring& resourceUrlPath, const std::filesystem::path& destinationPath);
 
+    // --- 页面格式 (JSON 文本 / 二进制容器)，写回时保持文件原有格式 ---
+    json ParseDocument(const std::wstring& path, std::string_view bytes);
+    std::string SerializeDocument(const std::wstring& path, const json& document) const;
+
+    // --- 已打开文档缓存 (增量保存的基准) ---
+    uint64_t CacheDocument(const std::wstring& path, json document);
+    void ForgetDocument(const std::wstring& path);
+
+    // --- File Config 解析 (带缓存) ---
+    json ResolveConfigForFile(const std::wstring& fileIdentifier);
+    json ResolveDirectoryConfig(const std::wstring& dirIdentifier);
+    std::wstring CachedParentIdentifier(const std::wstring& identifier);
+
 protected:
     // 工作区根目录是所有后端都需要维护的状态，所以放在基类里。
     std::wstring m_workspaceRoot;
+    // 前端路径的驻留表（标识符、规范化路径、相对工作区的路径），随工作区根目录一起重置
+    WorkspacePaths m_paths;
+    // 目录配置的继承结果缓存，WriteConfigFile 时精确失效
+    ConfigCache m_configCache;
+
+    // 后端持有的文档副本，与前端通过 version 对齐；PatchFile 在此基础上应用增量
+    struct CachedDocument {
+        json document;
+        uint64_t version = 0;
+        uint64_t lastUsed = 0;
+        FileAccess::FileStat stat; // 最后一次读写后的磁盘状态
+        bool hasStat = false;
+    };
+    std::unordered_map<std::wstring, CachedDocument> m_documentCache;
+    uint64_t m_documentClock = 0;
+    static constexpr size_t kMaxCachedDocuments = 32;
+    // 读取时识别为二进制格式的文件
+    std::unordered_set<std::wstring> m_binaryFiles;
+
+    // --- 数据库 (.veritnotedb) 列式缓存 ---
+    std::shared_ptr<const TableStore::Entry> LoadDatabase(const std::wstring& path);
+    std::wstring ResolveWorkspacePath(const std::string& path);
+    static std::shared_ptr<const ColumnTable> ActiveTable(const TableStore::Entry& database);
+    static Query::Source ActiveSource(const TableStore::Entry& database); // 列式存储优先，否则为 ActiveTable
+    void LoadIndexes(const std::wstring& path, TableStore::Entry& entry); // 建立 / 加载 content.data.indexes 中声明的索引
+    // embeddedData 中只有 changedRows 改变时，只更新受影响列上的索引（内容不变的列沿用原索引）
+    void UpdateIndexes(const std::wstring& path, const ColumnTable& before, TableStore::Entry& entry, const std::vector<uint32_t>& changedRows);
+    // 同一版本的行数据上相同的查询直接返回物化的结果
+    std::shared_ptr<const Query::Result> RunPresetQuery(const json& payload, Query::Source& source);
+    // 增量保存后就地更新已加载的数据库，无法就地更新时返回 false
+    bool RefreshDatabase(const std::wstring& path, const json& ops, const json& document, const FileAccess::FileStat& baseStat);
+    TableStore m_tableStore;
+    uint64_t m_databaseVersion = 0;
+    Query::CursorRegistry m_queryCursors;
+    Query::ResultCache m_queryResults;
 };
\ No newline at end of file
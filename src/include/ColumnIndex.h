@@ -0,0 +1,100 @@
+﻿// src/include/ColumnIndex.h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "include/ColumnTable.h"
+
+// 数据库列的二级索引，在 content.data.indexes 中按列声明：
+//   [{ "column": 0, "type": "sorted" | "hash" | "trigram" }]
+//   - sorted:  非空行按值排序，用于范围 / 相等条件
+//   - hash:    值 -> 行，用于相等条件
+//   - trigram: 字典中每个字符串的小写三元组 -> 字典编码，用于 contains / startsWith
+// 索引中的行号是列内下标（不含第一行），每个值对应的行都按升序保存。
+// 字符串列上的索引额外保存 "字典编码 -> 行" 的倒排表，查询时只需在字典上求值。
+// 只有整数 / 浮点 / 字符串列可以建立索引（trigram 仅限字符串列）。
+class ColumnIndex {
+public:
+    enum class Type : uint8_t {
+        Sorted = 0,
+        Hash = 1,
+        Trigram = 2,
+    };
+
+    static bool ParseType(const std::string& name, Type& type);
+    static const char* TypeName(Type type);
+    static bool Supports(const ColumnTable::Column& column, Type type);
+
+    // 不支持的列类型返回 nullptr
+    static std::shared_ptr<const ColumnIndex> Build(const ColumnTable::Column& column, size_t columnIndex, Type type);
+    // 列中只有 changedRows（列内下标，升序不重复）被改写或追加时，在本索引的基础上得到 column 的索引：
+    // 未改动的行直接沿用，只对改动的行排序后归并。字符串列的字典只允许在末尾追加（ColumnTable::WithRows 的行为）。
+    // 列类型已不适用时返回 nullptr，由调用方重新 Build
+    std::shared_ptr<const ColumnIndex> Update(const ColumnTable::Column& column, const std::vector<uint32_t>& changedRows) const;
+
+    // 持久化到数据库旁的 "<file>.index"："VNX1" | u32 count | count 条记录。
+    // 每条记录带有建立时的列指纹，加载后与当前列比对，不一致的记录重新建立。
+    // 数值按本机字节序原样写入（所有目标平台均为小端序）
+    static std::filesystem::path IndexPathFor(const std::filesystem::path& database);
+    static std::string EncodeFile(const std::vector<std::shared_ptr<const ColumnIndex>>& indexes);
+    // 格式错误时返回空列表
+    static std::vector<std::shared_ptr<const ColumnIndex>> DecodeFile(std::string_view bytes);
+
+    Type GetType() const { return m_type; }
+    size_t ColumnIndexInTable() const { return m_column; }
+    uint64_t Fingerprint() const { return m_fingerprint; }
+    bool IsString() const { return m_string; }
+    // 从索引文件读回的索引是否仍然对应 column：指纹一致且结构完整
+    bool Matches(const ColumnTable::Column& column) const;
+
+    // --- 数值列 ---
+    // sorted: 值落在 [lo, hi] 内的行（lo/hi 可开可闭），结果按行号升序
+    std::vector<uint32_t> NumberRange(const ColumnTable::Column& column, double lo, bool loInclusive, double hi, bool hiInclusive) const;
+    // hash: 等于 value 的行
+    std::vector<uint32_t> NumberEqual(double value) const;
+
+    // --- 字符串列 ---
+    // 一个字典编码对应的行
+    void AppendPostings(uint32_t code, std::vector<uint32_t>& rows) const;
+    // hash / sorted: 与 value 完全相等的字典编码
+    bool FindCode(const ColumnTable::Column& column, std::string_view value, uint32_t& code) const;
+    // sorted: 字典序落在范围内的编码（按字符串排序）
+    std::vector<uint32_t> CodeRange(const ColumnTable::Column& column, const std::string* lo, bool loInclusive, const std::string* hi, bool hiInclusive) const;
+    // trigram: 可能包含 lowerNeedle 的编码（needle 至少 3 字节），调用方仍需逐个验证
+    bool CandidateCodes(std::string_view lowerNeedle, std::vector<uint32_t>& codes) const;
+
+    size_t MemoryUsage() const;
+
+private:
+    // 由按 (值, 行) 排序的对生成 hash 数值列的倒排表与槽位
+    void FillNumberHash(const std::vector<std::pair<double, uint32_t>>& pairs);
+    void FillStringHash(const std::vector<std::string>& dictionary);
+    // 由按 (三元组, 编码) 排序且不重复的对生成 trigram 表
+    void FillGrams(const std::vector<std::pair<uint32_t, uint32_t>>& pairs);
+
+    void Serialize(std::string& out) const;
+    static std::shared_ptr<const ColumnIndex> Deserialize(std::string_view& in);
+
+    Type m_type = Type::Sorted;
+    size_t m_column = 0;
+    uint64_t m_fingerprint = 0;
+    bool m_string = false;
+
+    // sorted 数值列：按值排序的行；sorted 字符串列：按字符串排序的字典编码
+    std::vector<uint32_t> m_order;
+    // 倒排表 (CSR)：第 k 个键的行为 m_rows[m_offsets[k] .. m_offsets[k + 1])
+    // 字符串列的键是字典编码，hash 数值列的键是 m_keys 中的第 k 个不同值
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_rows;
+    // hash：开放寻址的槽位，存 "键下标 + 1"，0 表示空槽
+    std::vector<double> m_keys;
+    std::vector<uint32_t> m_slots;
+    // trigram：按三元组排序的 (三元组, 编码) 表
+    std::vector<uint32_t> m_grams;
+    std::vector<uint32_t> m_gramOffsets;
+    std::vector<uint32_t> m_gramCodes;
+};
@@ -0,0 +1,127 @@
+﻿// src/include/ColumnStore.h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "include/ColumnTable.h"
+#include "include/FileAccess.h"
+
+using json = nlohmann::json;
+
+// 数据库行数据的磁盘列式存储，content.data.storage 为 "columnar" 时使用，文件为 "<file>.columns"：
+//
+//   "VNT1" | u32 flags
+//   行组 × N (每组最多 rowGroupRows 行，编码见 ColumnTable::EncodeSegment)
+//   footer (CBOR)：{ firstRow, hasFirstRow, rows, columns, groups: [{ offset, length, rows, stats: [{ kind, empties, min, max }] }] }
+//   u64 footerOffset | u64 footerLength | "VNT1"
+//
+// 读取时整个文件被内存映射，只解析 footer；行组在被访问时才解码，并只在内存中保留最近使用的几个。
+// 每个行组按列记录空单元格数和最小 / 最大值（数值列为数值，字符串列为非空字符串的字典序），
+// 查询时据此跳过不可能满足筛选条件的行组，表的大小不受可用内存限制。
+// JSON (embeddedData) 仍是导入 / 导出格式，两种存储可以无损互相转换。所有整数均为小端序。
+namespace ColumnStore {
+    constexpr size_t kDefaultRowGroupRows = 16384;
+
+    std::filesystem::path PathFor(const std::filesystem::path& database);
+
+    // 一个行组内一列的统计信息
+    struct ColumnStats {
+        ColumnTable::Kind kind = ColumnTable::Kind::Empty;
+        uint64_t empties = 0; // 空值与空字符串
+        bool hasRange = false; // 数值列：[minNumber, maxNumber]；字符串列：[minText, maxText]
+        double minNumber = 0.0;
+        double maxNumber = 0.0;
+        std::string minText;
+        std::string maxText;
+    };
+
+    // 流式写入：第一次 AppendRow 的行作为第一行，之后每满 rowGroupRows 行编码一个行组交给 sink，
+    // 内存中最多只有一个行组。sink 返回 false 时写入失败，之后的调用都返回 false
+    class Writer {
+    public:
+        using Sink = std::function<bool(std::string_view)>;
+
+        explicit Writer(Sink sink, size_t rowGroupRows = kDefaultRowGroupRows);
+        bool AppendRow(const json& row);
+        bool Finish();
+
+        // 包含第一行在内的行数
+        uint64_t RowCount() const { return m_dataRows + (m_hasFirstRow ? 1 : 0); }
+
+    private:
+        bool Write(std::string_view bytes);
+        bool FlushGroup();
+
+        Sink m_sink;
+        size_t m_rowGroupRows;
+        bool m_ok = true;
+        bool m_started = false;
+        bool m_hasFirstRow = false;
+        json m_firstRow;
+        uint64_t m_offset = 0;
+        uint64_t m_dataRows = 0;
+        size_t m_columns = 0;
+        json m_groups = json::array();
+        std::unique_ptr<ColumnTable::Builder> m_builder;
+    };
+
+    // 只读的列式表。行号与 ColumnTable 一致：第一行为 0，数据行从 1 开始。
+    // 可以被多个线程同时读取（游标预取在后台线程上访问行组）
+    class StoredTable {
+    public:
+        // 映射文件并解析 footer，格式错误时返回 nullptr
+        static std::shared_ptr<const StoredTable> Open(const std::filesystem::path& path);
+
+        size_t RowCount() const { return m_dataRows + (m_hasFirstRow ? 1 : 0); }
+        size_t DataRows() const { return m_dataRows; }
+        size_t ColumnCount() const { return m_columns; }
+        const json& FirstRow() const { return m_firstRow; }
+
+        size_t RowGroupCount() const { return m_groups.size(); }
+        // 行组第一行在数据行中的下标（不含第一行）
+        size_t RowGroupStart(size_t group) const { return m_groups[group].start; }
+        size_t RowGroupRows(size_t group) const { return m_groups[group].rows; }
+        // 行组中不存在的列（该组所有行都短于这一列）返回 nullptr
+        const ColumnStats* Stats(size_t group, size_t column) const;
+        // 解码后的行组（不含第一行的 ColumnTable），解码失败时抛出异常
+        std::shared_ptr<const ColumnTable> RowGroup(size_t group) const;
+
+        json RowAt(size_t row) const;
+        // 按给定顺序取出多行；同一行组的行只解码一次
+        json RowsAt(const std::vector<uint32_t>& rows, size_t begin, size_t end) const;
+        json ToRows() const;
+        // 与 ColumnTable::DescribeColumns 一致，列类型由各行组的类型合并得到
+        json DescribeColumns() const;
+
+    private:
+        struct Group {
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            size_t start = 0;
+            size_t rows = 0;
+            std::vector<ColumnStats> stats;
+        };
+
+        size_t GroupOf(size_t dataRow) const;
+
+        FileAccess::MappedFile m_file;
+        json m_firstRow;
+        bool m_hasFirstRow = false;
+        size_t m_dataRows = 0;
+        size_t m_columns = 0;
+        std::vector<Group> m_groups;
+
+        // 最近解码的行组
+        mutable std::mutex m_cacheMutex;
+        mutable std::list<std::pair<size_t, std::shared_ptr<const ColumnTable>>> m_cache;
+        static constexpr size_t kCachedGroups = 8;
+    };
+}
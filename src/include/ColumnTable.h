@@ -0,0 +1,185 @@
+﻿// src/include/ColumnTable.h
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "include/FileAccess.h"
+
+using json = nlohmann::json;
+
+class ColumnIndex;
+namespace ColumnStore { class StoredTable; }
+
+// 数据库 (.veritnotedb) 行数据的列式内存表示。
+// embeddedData 是 "行数组的数组"，第一行可能是表头（由各个 preset 的 firstRowMode 决定），
+// 因此第一行原样保存，其余行按列存放：
+//   - 整数 / 浮点 / 布尔列使用定长向量
+//   - 字符串列做字典编码，每行只存一个 uint32 编号
+//   - 空值 (null / 短行缺失的单元格) 用位图记录
+//   - 同一列出现多种类型时退化为逐个保存 json 值，保证数据原样还原
+class ColumnTable {
+public:
+    enum class Kind {
+        Empty,   // 目前只有空值
+        Integer,
+        Number,
+        Bool,
+        String,
+        Mixed,
+    };
+
+    class Column {
+    public:
+        Kind GetKind() const { return m_kind; }
+        size_t Size() const { return m_size; }
+        bool IsNull(size_t row) const { return (m_nulls[row >> 6] >> (row & 63)) & 1u; }
+        json ValueAt(size_t row) const;
+        // Number 列中该行写入时是否为整数（ValueAt 据此还原整数形式）
+        bool IsIntegral(size_t row) const;
+
+        // 按类型直接访问（调用方需先检查 GetKind / IsNull）
+        int64_t IntegerAt(size_t row) const { return m_integers[row]; }
+        double NumberAt(size_t row) const { return m_kind == Kind::Integer ? static_cast<double>(m_integers[row]) : m_numbers[row]; }
+        bool BoolAt(size_t row) const { return m_bools[row] != 0; }
+        uint32_t CodeAt(size_t row) const { return m_codes[row]; }
+        const std::string& StringAt(size_t row) const { return m_dictionary[m_codes[row]]; }
+        const std::vector<std::string>& Dictionary() const { return m_dictionary; }
+        const json& MixedAt(size_t row) const { return m_mixed[row]; }
+
+        size_t MemoryUsage() const;
+        // 列内容的 64 位指纹 (FNV-1a)，用于判断持久化的索引是否仍然对应这一列
+        uint64_t Fingerprint() const;
+
+    private:
+        friend class ColumnTable;
+
+        void Append(const json& value);
+        void AppendNull();
+        // 覆盖已有的一行（ColumnTable::WithRows 使用），类型不兼容时与 Append 一样升级整列
+        void Set(size_t row, const json& value);
+        // 按即将写入的非空值决定是否升级列类型
+        void PrepareFor(const json& value);
+        uint32_t Intern(const std::string& value);
+        // 覆盖之后把类型收窄到从头构建时会得到的类型
+        void Narrow();
+        void PromoteTo(Kind kind);
+        void Finish();
+
+        Kind m_kind = Kind::Empty;
+        size_t m_size = 0;
+        std::vector<int64_t> m_integers;
+        std::vector<double> m_numbers;
+        std::vector<uint8_t> m_bools;
+        std::vector<uint32_t> m_codes;
+        std::vector<std::string> m_dictionary;
+        std::unordered_map<std::string, uint32_t> m_lookup; // 仅在构建期间使用
+        std::vector<json> m_mixed;
+        std::vector<uint64_t> m_nulls;
+        std::vector<uint64_t> m_integral; // 仅 Number 列：写入时为整数的行
+    };
+
+    // 逐行构建；行可以长短不一。withFirstRow 为 false 时所有行都是数据行（列式存储的行组）
+    class Builder {
+    public:
+        explicit Builder(bool withFirstRow = true);
+        void AppendRow(const json& row);
+        size_t DataRows() const { return m_table->m_dataRows; }
+        std::shared_ptr<const ColumnTable> Finish();
+
+    private:
+        std::shared_ptr<ColumnTable> m_table;
+        std::vector<uint32_t> m_widths;
+        bool m_withFirstRow = true;
+        bool m_ragged = false;
+    };
+
+    // 从 rawData 形式的二维数组构建
+    static std::shared_ptr<const ColumnTable> FromRows(const json& rows);
+    // 在 base 的副本上只写入 changedRows（升序、不重复的行号，含第一行）中的行，rows 是修改后的全部行。
+    // 行号不小于 base.RowCount() 的行必须是连续追加的；结果与 FromRows(rows) 不一致时返回 nullptr
+    static std::shared_ptr<const ColumnTable> WithRows(const ColumnTable& base, const json& rows, const std::vector<uint32_t>& changedRows);
+
+    // 从 CSV 构建：第一遍推断列类型，第二遍按类型转换后写入列（第一行保持为字符串）。
+    // readChunks 每次调用都应从头把文件内容分块交给 sink
+    using ChunkReader = std::function<bool(const std::function<bool(std::string_view)>& sink)>;
+    static std::shared_ptr<const ColumnTable> FromCsv(const ChunkReader& readChunks, char delimiter = ',');
+    // FromCsv 的两遍读取，但不建表：每行转换为 rawData 形式后交给 onRow，onRow 返回 false 时停止并返回 false
+    static bool ReadCsvRows(const ChunkReader& readChunks, const std::function<bool(const json& row)>& onRow, char delimiter = ',');
+
+    // 包含第一行在内的总行数
+    size_t RowCount() const { return m_dataRows + (m_hasFirstRow ? 1 : 0); }
+    bool HasFirstRow() const { return m_hasFirstRow; }
+    size_t ColumnCount() const { return m_columns.size(); }
+    const Column& GetColumn(size_t index) const { return m_columns[index]; }
+    const json& FirstRow() const { return m_firstRow; }
+
+    // 还原为 rawData 形式的一行 / 全部行，与构建时的输入一致
+    json RowAt(size_t row) const;
+    json ToRows() const;
+
+    // 每列的类型描述，供前端显示/查询使用
+    json DescribeColumns() const;
+    static const char* KindName(Kind kind);
+
+    size_t MemoryUsage() const;
+
+    // 列式存储文件中一个行组的编码（CBOR，定长向量以二进制块保存）。第一行不参与编码，
+    // 由 Builder(false) 构建的表可以原样还原。格式错误时 DecodeSegment 抛出异常
+    void EncodeSegment(std::string& out) const;
+    static std::shared_ptr<const ColumnTable> DecodeSegment(std::string_view bytes);
+
+private:
+    // 写入第 dataRow 个数据行；dataRow == 数据行数时追加
+    void PutRow(size_t dataRow, const json& row);
+
+    json m_firstRow;
+    bool m_hasFirstRow = false;
+    size_t m_dataRows = 0;
+    std::vector<Column> m_columns;
+    std::vector<uint32_t> m_rowWidths; // 仅当存在长度不一致的行时才保存
+};
+
+
+// 已加载数据库的共享缓存：同一个 .veritnotedb 只解析一次，所有引用它的 DataBlock 共用
+class TableStore {
+public:
+    struct Entry {
+        json data;    // content.data 中除 embeddedData 以外的字段
+        json presets;
+        std::shared_ptr<const ColumnTable> table; // embeddedData 中的行数据
+        std::shared_ptr<const ColumnTable> externalTable; // external 模式下工作区内 CSV 的行数据
+        std::wstring sourcePath;
+        FileAccess::FileStat sourceStat;
+        bool hasSourceStat = false;
+        FileAccess::FileStat stat;
+        bool hasStat = false;
+        // content.data.indexes 中声明的索引，建立在 embedded / external 中当前使用的那张表上
+        std::vector<std::shared_ptr<const ColumnIndex>> indexes;
+        // content.data.storage 为 "columnar" 时，行数据在内存映射的 "<file>.columns" 中，table 为空
+        std::shared_ptr<const ColumnStore::StoredTable> stored;
+        // 每次从磁盘重新加载时递增，前端据此判断已持有的内容是否仍然有效
+        uint64_t version = 0;
+        // 行数据的版本：只改动 presets / indexes 等字段的保存不改变它，物化的查询结果以此为键
+        uint64_t dataVersion = 0;
+    };
+
+    std::shared_ptr<const Entry> Find(const std::wstring& path);
+    void Store(const std::wstring& path, std::shared_ptr<const Entry> entry);
+    void Invalidate(const std::wstring& path);
+    void Clear();
+
+private:
+    struct Slot {
+        std::shared_ptr<const Entry> entry;
+        uint64_t lastUsed = 0;
+    };
+    std::unordered_map<std::wstring, Slot> m_entries;
+    uint64_t m_clock = 0;
+    static constexpr size_t kMaxEntries = 8;
+};
@@ -0,0 +1,46 @@
+﻿// src/include/ConfigCache.h
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// 目录级 veritnoteconfig 的解析缓存。
+// 每个节点保存“该目录向上继承到工作区根目录后”的完整配置，
+// 子目录的结果由父目录的结果 + 自身 veritnoteconfig 推导而来（记忆化继承）。
+// 标识符（identifier）可以是 Windows 路径，也可以是 Android 的 content URI，
+// 缓存本身不关心其格式，只把它当作不透明的 key。
+class ConfigCache {
+public:
+    // --- 已解析配置 ---
+    bool TryGetResolved(const std::wstring& dir, json& out) const;
+    void StoreResolved(const std::wstring& dir, const std::wstring& parentDir, const json& resolved);
+
+    // --- 父级标识符记忆 (Android 上每次 GetParentIdentifier 都是一次阻塞的 JNI 往返) ---
+    bool TryGetParent(const std::wstring& identifier, std::wstring& out) const;
+    void StoreParent(const std::wstring& identifier, const std::wstring& parent);
+
+    // 使某个目录及其所有已缓存的子孙目录失效（它们都继承自该目录）
+    void InvalidateDirectory(const std::wstring& dir);
+    void Clear();
+
+    // 继承规则：config 中缺失或值为 "inherit" 的键从 parentConfig 中补齐
+    static void InheritFrom(json& config, const json& parentConfig);
+
+private:
+    struct Node {
+        json resolved;
+        bool valid = false;
+        std::wstring parent;
+        std::unordered_set<std::wstring> children;
+    };
+
+    // 每张表的条目上限，超出后整表重建（父级记忆以文件为单位，浏览大工作区时会持续增长）
+    static constexpr size_t kMaxEntries = 16384;
+
+    std::unordered_map<std::wstring, Node> m_nodes;
+    std::unordered_map<std::wstring, std::wstring> m_parents;
+};
@@ -0,0 +1,82 @@
+﻿// src/include/CsvParser.h
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// 数据库 (.veritnotedb) 外部/导入 CSV 的原生解析器。
+// 符合 RFC 4180：引号字段、"" 转义、字段内换行、CRLF / LF / CR 行尾；对不规范的输入保持宽容。
+// 输入可以分块喂入 (Feed)，字段跨块时状态会被保留，因此大文件不必一次读入内存。
+// 非引号状态下用 SIMD (SSE2 / NEON) 一次扫描 16 字节寻找分隔符、引号和换行。
+namespace Csv {
+    enum class ColumnType {
+        String,
+        Number,
+        Date,
+        Bool,
+    };
+
+    const char* ColumnTypeName(ColumnType type);
+
+    class Parser {
+    public:
+        // 每解析出完整的一行调用一次，fields 在回调返回后会被复用
+        using RowHandler = std::function<void(const std::vector<std::string>& fields)>;
+
+        explicit Parser(RowHandler onRow, char delimiter = ',');
+
+        void Feed(std::string_view chunk);
+        // 输入结束：输出最后一行（若文件不以换行结尾）
+        void Finish();
+
+        size_t RowCount() const { return m_rowCount; }
+
+    private:
+        enum class State {
+            FieldStart,   // 新字段的第一个字符之前
+            Unquoted,
+            Quoted,
+            QuoteInQuoted // 引号字段中遇到 "，需要看下一个字符决定是转义还是结束
+        };
+
+        void EndField();
+        void EndRow();
+
+        RowHandler m_onRow;
+        char m_delimiter;
+        State m_state = State::FieldStart;
+        bool m_skipLineFeed = false; // 上一块以 CR 结尾，下一块开头的 LF 属于同一个换行
+        size_t m_bomMatched = 0;     // 已匹配的 UTF-8 BOM 字节数，3 表示检查结束
+        std::string m_field;
+        std::vector<std::string> m_fields;
+        size_t m_fieldCount = 0;     // m_fields 中当前行有效的字段数（其余为复用的缓冲）
+        bool m_rowQuoted = false;    // 当前行出现过引号字段
+        size_t m_rowCount = 0;
+    };
+
+    // 逐行观察数据并为每一列推断类型：所有非空值都满足某一类型时才采用该类型。
+    // 数字类型还要求转换无损，带前导零或超出 int64 的整数列保持为字符串
+    class TypeInference {
+    public:
+        void Observe(const std::vector<std::string>& fields);
+        ColumnType TypeOf(size_t column) const;
+        size_t ColumnCount() const { return m_candidates.size(); }
+
+    private:
+        std::vector<uint8_t> m_candidates; // 每列仍然可能的类型位集
+        std::vector<bool> m_seenValue;
+    };
+
+    bool IsNumber(std::string_view value);
+    bool IsDate(std::string_view value);  // YYYY-MM-DD 或 YYYY/MM/DD，可带时间和时区
+    bool IsBool(std::string_view value);  // true / false，不区分大小写
+
+    // 把单元格按列类型转换成 JSON 值；非字符串列的空单元格为 null
+    json ToJsonValue(const std::string& cell, ColumnType type);
+}
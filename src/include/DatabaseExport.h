@@ -0,0 +1,53 @@
+﻿// src/include/DatabaseExport.h
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "include/ColumnIndex.h"
+#include "include/QueryEngine.h"
+
+using json = nlohmann::json;
+
+// 发布站点的数据库包：每个 preset 的结果在导出时就已筛选 / 排序 / 分组 / 聚合，页面只下载需要的行。
+//
+//   <name>.js          window.__VN_DB__[key] = { data, presets, views: { presetId: { index, chunks, chunkRows, firstRow, rowCount, totalRows, totals } } }
+//   <name>.data/i-k.js window.__VN_DB__[key + '#' + i + '#' + k] = { rows, groups }
+//
+// i 为 preset 在 presets 中的下标，k 为块号，每块最多 chunkRows 行（为 0 时不分块）。
+// firstRowMode 为 "header" 时行只保留 preset 显示的列。没有行数据的数据库（网络地址）只写出 data / presets，
+// 由页面在浏览时获取。所有文件均为可以直接用 <script> 加载的 JS，离线打开的站点同样可用
+namespace DatabaseExport {
+    constexpr size_t kDefaultChunkRows = 500;
+
+    struct View {
+        json config;
+        Query::Spec spec;
+        std::string specKey;
+        std::shared_ptr<const Query::Result> result; // 已物化的结果；为空时导出时执行
+    };
+
+    struct Job {
+        std::string key;
+        std::filesystem::path target; // <build>/<相对工作区的路径>.js
+        json data;
+        json presets;
+        Query::Source source; // 没有行数据时 table / stored 均为空
+        std::vector<std::shared_ptr<const ColumnIndex>> indexes;
+        std::vector<View> views; // 与 presets 一一对应
+    };
+
+    struct Outcome {
+        bool success = false;
+        std::string error;
+        size_t files = 0;
+        // 与 Job::views 一一对应，导出时执行的结果可以由调用方保存为物化结果
+        std::vector<std::shared_ptr<const Query::Result>> results;
+    };
+
+    Outcome Write(const Job& job, size_t chunkRows);
+    // 多个数据库在工作线程上并行导出，结果与 jobs 一一对应
+    std::vector<Outcome> WriteAll(const std::vector<Job>& jobs, size_t chunkRows);
+}
@@ -0,0 +1,61 @@
+﻿// src/include/DurableStorage.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+
+// 崩溃安全的文件写入层。
+// AtomicWriteFile: 先写同目录下的临时文件并 fsync，再原子替换目标文件
+// (Windows 上使用 ReplaceFileW / MoveFileExW，POSIX 上使用 rename)。
+// 任何时刻崩溃，目标文件要么是旧内容，要么是新内容，不会出现截断的半个文件。
+namespace DurableStorage {
+    // produce 通过 write 分块写出内容，任一步失败时返回 false（临时文件被删除，目标文件不变）
+    using Producer = std::function<bool(const std::function<bool(std::string_view)>& write)>;
+
+    bool AtomicWriteFile(const std::filesystem::path& path, const std::string& content);
+    // 内容较大、无法一次放进内存时（如列式存储文件）使用：边生成边写入临时文件
+    bool AtomicWriteFileStreamed(const std::filesystem::path& path, const Producer& produce);
+    bool ReadWholeFile(const std::filesystem::path& path, std::string& content);
+}
+
+// 追加式预写日志 (write-ahead journal)。
+// 频繁的自动保存只需把完整内容追加到 "<file>.journal" 中（一次顺序写 + fsync），
+// 日志达到阈值后再压缩：把最新记录原子写回目标文件并删除日志。
+// 每条记录: 魔数 | uint32 长度 | uint32 CRC32 | 内容，尾部不完整或校验失败的记录在恢复时被忽略。
+// 魔数 "VNJ1" 表示完整快照，"VNP1" 表示作用于前一状态的 JSON Patch (RFC 6902)。
+class SaveJournal {
+public:
+    static std::filesystem::path JournalPathFor(const std::filesystem::path& target);
+
+    // 追加一条完整快照记录，超过阈值时自动压缩
+    bool Append(const std::filesystem::path& target, const std::string& content);
+    // 追加一条增量记录；snapshot 仅在需要压缩时才被调用，用于直接得到最新的完整内容
+    bool AppendPatch(const std::filesystem::path& target, const std::string& patch, const std::function<std::string()>& snapshot);
+    // 读取日志重放后的最新内容；没有日志或没有可恢复的状态时返回 false。
+    // 无法应用的增量之后跳到下一条完整快照继续；clean 为 false 表示有记录无法重放（或日志无法打开），
+    // 此时日志不能被删除。写入中途崩溃留下的尾部残缺记录不算损坏
+    bool Recover(const std::filesystem::path& target, std::string& latest, bool* clean = nullptr) const;
+    bool HasJournal(const std::filesystem::path& target) const;
+    // 把最新记录写回目标文件并删除日志。日志未能完整重放时，能恢复的内容照常写回，
+    // 日志改名为 "<file>.journal.corrupt[N]" 保留下来，并返回 false
+    bool Compact(const std::filesystem::path& target);
+    void CompactAll();
+    void Discard(const std::filesystem::path& target);
+    // 丢弃 directory 下所有目标的待压缩记录（目录被删除时使用，日志文件随目录一起删除）
+    void DiscardUnder(const std::filesystem::path& directory);
+
+private:
+    // 把日志改名为 "<file>.journal.corrupt[N]"，不再作为该文件的日志使用
+    bool Quarantine(const std::filesystem::path& target);
+    bool AppendRecord(const std::filesystem::path& target, const char* magic, const std::string& body, const std::function<std::string()>& snapshot);
+
+    // 每个目标文件自上次压缩以来追加的记录数
+    std::unordered_map<std::wstring, size_t> m_pendingRecords;
+
+    static constexpr size_t kMaxPendingRecords = 64;
+    static constexpr std::uintmax_t kMaxJournalBytes = 32 * 1024 * 1024;
+};
@@ -0,0 +1,55 @@
+﻿// src/include/FileAccess.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// 只读文件访问层：内存映射整个文件，把内容以 string_view 直接交给解析器，省去逐字节的 iostream 读取和拷贝。
+// 映射失败（空文件、特殊文件系统等）时退回到一次按大小分配的读取。
+namespace FileAccess {
+    // 用于缓存校验的文件元数据；mtime 是平台相关的刻度，只用于比较相等
+    struct FileStat {
+        uint64_t size = 0;
+        uint64_t mtime = 0;
+
+        bool operator==(const FileStat& other) const { return size == other.size && mtime == other.mtime; }
+        bool operator!=(const FileStat& other) const { return !(*this == other); }
+    };
+
+    bool StatFile(const std::filesystem::path& path, FileStat& stat);
+
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        // 映射只在对象存活期间有效。Windows 上被映射的文件不能被 ReplaceFileW 替换，用完应尽快释放
+        std::string_view View() const { return std::string_view(m_data, m_size); }
+        const FileStat& Stat() const { return m_stat; }
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        FileStat m_stat;
+        bool m_mapped = false;
+        std::string m_fallback; // 无法映射时的读取缓冲
+
+#ifdef _WIN32
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+        HANDLE m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+}
@@ -0,0 +1,54 @@
+﻿// src/include/PageFormat.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// .veritnote / .veritnotedb / veritnoteconfig 的磁盘格式。
+// 默认仍是可读、便于 git diff 的 JSON 文本；也可以选择紧凑的二进制容器：
+//
+//   "VNB1" | u32 flags | u32 blockCount | u32 envelopeLength
+//   envelope (CBOR，文档中除 content.blocks 以外的全部内容)
+//   offset table (blockCount × { u32 offset, u32 length }，相对 blocks 区起点)
+//   blocks 区 (每个顶层块单独编码为 CBOR)
+//
+// 顶层块独立编码，配合偏移表可以只解码需要的块（如引用块只需要找到一个 block）。
+// 两种格式可以无损互相转换，所有整数均为小端序。
+namespace PageFormat {
+    bool IsBinary(std::string_view bytes);
+
+    // 自动识别格式并解析，失败时抛出异常（与 json::parse 一致）
+    json Parse(std::string_view bytes);
+    // binary 为 false 时输出与以往一致的 dump(2) 文本
+    std::string Serialize(const json& document, bool binary);
+
+    std::string EncodeBinary(const json& document);
+    json DecodeBinary(std::string_view bytes);
+
+    // 二进制页面的惰性读取器：只校验头部和偏移表，块在访问时才解码；bytes 必须在读取器使用期间保持有效
+    class BinaryReader {
+    public:
+        bool Open(std::string_view bytes);
+        size_t BlockCount() const { return m_blocks.size(); }
+        json Block(size_t index) const;
+        json Envelope() const;
+        json Document() const;
+
+    private:
+        struct Entry {
+            uint32_t offset;
+            uint32_t length;
+        };
+        std::string_view m_bytes;
+        bool m_hasBlocks = false;
+        size_t m_envelopeOffset = 0;
+        size_t m_envelopeLength = 0;
+        size_t m_blocksOffset = 0;
+        std::vector<Entry> m_blocks;
+    };
+}
@@ -0,0 +1,182 @@
+﻿// src/include/QueryEngine.h
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "include/ColumnIndex.h"
+#include "include/ColumnStore.h"
+#include "include/ColumnTable.h"
+
+using json = nlohmann::json;
+
+// 数据库 preset 的查询执行：筛选 / 排序 / 分组 / 聚合都在后端的列式表上完成，前端只拿到当前页。
+// preset.config 中与查询相关的字段（均为可选）：
+//   firstRowMode: "header" | "ignore" | "data"
+//   filters:  [{ column, op, value }]   op: eq neq lt lte gt gte contains startsWith empty notEmpty
+//   sorts:    [{ column, direction }]   direction: asc | desc
+//   groupBy:  column
+//   columns[i].aggregate: count | sum | avg | min | max
+// column 使用与 columns[i].sourceHeader 相同的表头名称。
+namespace Query {
+    enum class FilterOp {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Contains,
+        StartsWith,
+        Empty,
+        NotEmpty,
+    };
+
+    enum class AggregateFn {
+        Count,
+        Sum,
+        Avg,
+        Min,
+        Max,
+    };
+
+    struct Filter {
+        size_t column = 0;
+        FilterOp op = FilterOp::Equal;
+        json value;
+    };
+
+    struct Sort {
+        size_t column = 0;
+        bool descending = false;
+    };
+
+    struct Aggregate {
+        size_t column = 0;
+        AggregateFn fn = AggregateFn::Count;
+        std::string key; // 结果中的键：preset.config.columns 中的下标
+    };
+
+    struct Spec {
+        bool firstRowIsData = false;
+        std::vector<Filter> filters;
+        std::vector<Sort> sorts;
+        bool grouped = false;
+        size_t groupBy = 0;
+        std::vector<Aggregate> aggregates;
+    };
+
+    struct Result {
+        std::vector<uint32_t> rows; // 表中的行号（与 ColumnTable::RowAt 一致），已按排序排列
+        json groups = json::array(); // [{ key, start, count, aggregates }]
+        json totals = json::object(); // 全部结果行上的聚合值
+    };
+
+    // 查询的数据：内存中的列式表，或磁盘上的列式存储（二者之一）
+    struct Source {
+        std::shared_ptr<const ColumnTable> table;
+        std::shared_ptr<const ColumnStore::StoredTable> stored;
+
+        size_t RowCount() const;
+        size_t ColumnCount() const;
+        const json& FirstRow() const; // 没有行时为 null
+        json DescribeColumns() const;
+    };
+
+    // 把 preset.config 解析为查询；引用不存在的列的条件会被忽略
+    Spec FromPresetConfig(const json& config, const ColumnTable& table);
+    Spec FromPresetConfig(const json& config, const Source& source);
+
+    // indexes 中的索引会被自动用于可以利用它们的筛选条件：候选行由索引直接给出，
+    // 其余条件只在候选行上求值，不再扫描整列
+    Result Execute(const ColumnTable& table, const Spec& spec, const std::vector<std::shared_ptr<const ColumnIndex>>& indexes = {});
+    // 磁盘上的列式表：按行组的最小 / 最大值跳过不可能满足筛选条件的行组，其余行组逐个解码筛选。
+    // 排序 / 分组 / 聚合只在筛选结果中用到的列上进行，内存占用与结果行数成正比而不是与表的大小
+    Result Execute(const ColumnStore::StoredTable& table, const Spec& spec);
+    Result Execute(const Source& source, const Spec& spec, const std::vector<std::shared_ptr<const ColumnIndex>>& indexes = {});
+
+    // 取出结果中 [offset, offset + limit) 的行，形式与 rawData 的行一致
+    json Page(const Source& source, const Result& result, size_t offset, size_t limit);
+    // 与 [offset, offset + limit) 相交的分组
+    json GroupsInWindow(const Result& result, size_t offset, size_t limit);
+
+    // 解析后查询的规范文本（只含列下标，与表头名称无关），两个 spec 的结果相同当且仅当键相同
+    std::string SpecKey(const Spec& spec);
+
+    // 增量维护：把 before 上得到的 result 更新为 after 上的结果。changedRows 为内容改变的行号（升序），
+    // after 比 before 多出的行视为追加并且必须包含在其中。只对变化的行重新筛选、按排序插入，
+    // 只重新计算包含变化行的分组的聚合。第一行变化、列数或相关列的类型改变时返回 false，由调用方重新执行
+    bool Update(const ColumnTable& before, const ColumnTable& after, const Spec& spec, const std::vector<uint32_t>& changedRows, Result& result);
+
+    // 物化的 preset 结果：按 (文件, 行数据版本, SpecKey) 保存，再次打开页面时直接复用，不再从原始行重新计算。
+    // 行数据被增量修改后由 Advance 把旧版本上的结果更新到新版本
+    class ResultCache {
+    public:
+        std::shared_ptr<const Result> Find(const std::wstring& path, uint64_t dataVersion, const std::string& specKey);
+        void Store(const std::wstring& path, uint64_t dataVersion, const std::string& specKey, const Spec& spec, std::shared_ptr<const Result> result);
+        // 行数据从 fromVersion (before) 变为 toVersion (after)：能增量更新的结果迁移到新版本，其余丢弃
+        void Advance(const std::wstring& path, uint64_t fromVersion, uint64_t toVersion,
+            const ColumnTable& before, const ColumnTable& after, const std::vector<uint32_t>& changedRows);
+        void InvalidatePath(const std::wstring& path);
+        void Clear();
+
+    private:
+        struct Slot {
+            std::wstring path;
+            uint64_t dataVersion = 0;
+            std::string specKey;
+            Spec spec;
+            std::shared_ptr<const Result> result;
+            uint64_t lastUsed = 0;
+        };
+
+        void Evict();
+
+        std::vector<Slot> m_slots;
+        uint64_t m_clock = 0;
+        static constexpr size_t kMaxResults = 32;
+        // 所有结果的行号总数上限（每行 4 字节）
+        static constexpr size_t kMaxCachedRows = size_t(1) << 24;
+    };
+
+    // 查询游标：openQuery 执行一次查询并保留结果，之后按窗口 [offset, offset + limit) 取行，closeQuery 释放。
+    // 游标持有表的快照，文件保存后由 CloseForPath 使其失效，前端据此重新打开。
+    // 每次取行后在后台线程预先生成下一个窗口，顺序滚动时下一次请求可以直接返回。
+    class CursorRegistry {
+    public:
+        struct Window {
+            json rows = json::array();
+            json groups = json::array();
+        };
+
+        uint64_t Open(const std::wstring& path, Source source, std::shared_ptr<const Result> result);
+        // 游标不存在（已关闭、被淘汰或已失效）时返回 false
+        bool Fetch(uint64_t id, size_t offset, size_t limit, Window& window, size_t& totalRows);
+        void Close(uint64_t id);
+        void CloseForPath(const std::wstring& path);
+        void Clear();
+
+    private:
+        struct Cursor {
+            std::wstring path;
+            Source source;
+            std::shared_ptr<const Result> result;
+            uint64_t lastUsed = 0;
+            // 预取的窗口
+            size_t prefetchOffset = 0;
+            size_t prefetchLimit = 0;
+            std::shared_future<Window> prefetch;
+        };
+
+        void Evict();
+
+        std::unordered_map<uint64_t, Cursor> m_cursors;
+        uint64_t m_nextId = 1;
+        uint64_t m_clock = 0;
+        static constexpr size_t kMaxCursors = 16;
+    };
+}
@@ -0,0 +1,87 @@
+﻿// src/include/Telemetry.h
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// 后端的计时与追踪。
+//   - 每个 action 的调用次数、耗时直方图，以及收发消息的字节数（HandleWebMessage / SendMessageToJS 记录）
+//   - Span：文件读写、JSON 解析 / 序列化、导出各阶段的作用域计时，按名称聚合为直方图，
+//     同时写入一个有界的环形缓冲区，可导出为 Chrome trace-event JSON（chrome://tracing、Perfetto 可直接打开）
+// 前端通过 getBackendStats 取得 Stats()（可选附带 Trace()）。
+// 所有函数都可以在任意线程上调用（导出的工作线程、Android 的平台服务回调线程），内部以一把互斥锁保护
+namespace Telemetry {
+    // 对数分桶的耗时直方图（微秒）：每个 2 的幂区间再分 4 个子桶，相对误差不超过 25%
+    class Histogram {
+    public:
+        void Record(uint64_t micros);
+        uint64_t Count() const { return m_count; }
+        uint64_t Total() const { return m_total; }
+        uint64_t Max() const { return m_max; }
+        // p 取 [0, 1]，返回所在桶的上界（不超过 Max()）
+        uint64_t Percentile(double p) const;
+        // { count, totalMs, meanMs, p50Ms, p90Ms, p99Ms, maxMs }
+        json ToJson() const;
+
+    private:
+        static constexpr size_t kSubBuckets = 4;
+        static constexpr size_t kBuckets = kSubBuckets + 40 * kSubBuckets;
+        static size_t BucketOf(uint64_t micros);
+        static uint64_t UpperBound(size_t bucket);
+
+        uint64_t m_buckets[kBuckets] = {};
+        uint64_t m_count = 0;
+        uint64_t m_total = 0;
+        uint64_t m_max = 0;
+    };
+
+    // 记录一次 HandleWebMessage：action 名称、处理耗时与收到的消息字节数
+    void RecordAction(std::string_view action, uint64_t micros, size_t bytesIn);
+    // 发往前端的消息；在 HandleWebMessage 内发送时同时计入当前 action
+    void RecordMessageOut(size_t bytes);
+
+    // HandleWebMessage 处理期间标记当前线程上的 action，析构时记录耗时
+    class ActionScope {
+    public:
+        ActionScope(std::string_view action, size_t bytesIn);
+        ~ActionScope();
+        ActionScope(const ActionScope&) = delete;
+        ActionScope& operator=(const ActionScope&) = delete;
+
+    private:
+        std::string m_action;
+        size_t m_bytesIn;
+        std::chrono::steady_clock::time_point m_start;
+        const std::string* m_outer;
+    };
+
+    // 作用域计时。name / category 应为字符串字面量（构造时只保存指针）
+    class Span {
+    public:
+        Span(const char* name, const char* category);
+        ~Span();
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* m_name;
+        const char* m_category;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // 追踪缓冲区是否记录事件（默认关闭，需要导出 Trace 时开启）；直方图总是记录
+    void SetTracing(bool enabled);
+
+    // { uptimeMs, tracing, ipc: { messagesIn, bytesIn, messagesOut, bytesOut },
+    //   actions: { name: { ...Histogram, bytesIn, bytesOut } }, spans: { name: { ...Histogram, category } } }
+    json Stats();
+    // { traceEvents: [ { name, cat, ph: "X", ts, dur, pid, tid } ], displayTimeUnit: "ms" }
+    json Trace();
+    void Reset();
+}
@@ -0,0 +1,29 @@
+﻿// src/include/Utf.h
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// UTF-8 与 UTF-16 / UTF-32 之间的转换，两个平台的后端和 JNI 层共用。
+// wchar_t 在 Windows 上是 UTF-16，在 Android / Linux 上是 UTF-32，宽字符串接口按 sizeof(wchar_t) 选择编码。
+// 非法输入（截断或多余的续字节、过长编码、代理区码点、孤立代理项、超出 U+10FFFF）不会失败，
+// 每个最大非法子序列替换为一个 U+FFFD，与 WHATWG / ICU 的行为一致。
+// 输出只分配一次：UTF-8 -> UTF-16/32 按输入长度这一上界分配，UTF-16/32 -> UTF-8 先计算精确长度；
+// 转换到调用方传入的字符串时复用其已有容量。纯 ASCII 段按 16 字节一组 (SSE2 / NEON) 直接拷贝。
+namespace Utf {
+    constexpr char32_t kReplacementChar = 0xFFFD;
+
+    // 转换结果写入 out（覆盖原内容）
+    void Utf8ToUtf16(std::string_view in, std::u16string& out);
+    void Utf16ToUtf8(std::u16string_view in, std::string& out);
+    void Utf8ToWide(std::string_view in, std::wstring& out);
+    void WideToUtf8(std::wstring_view in, std::string& out);
+
+    inline std::u16string ToUtf16(std::string_view in) { std::u16string out; Utf8ToUtf16(in, out); return out; }
+    inline std::wstring ToWide(std::string_view in) { std::wstring out; Utf8ToWide(in, out); return out; }
+    inline std::string ToUtf8(std::u16string_view in) { std::string out; Utf16ToUtf8(in, out); return out; }
+    inline std::string ToUtf8(std::wstring_view in) { std::string out; WideToUtf8(in, out); return out; }
+
+    // 是否为合法的 UTF-8（不替换任何字节即可原样使用）
+    bool IsValidUtf8(std::string_view in);
+}
@@ -0,0 +1,34 @@
+﻿// src/include/WebResources.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// WebView 资源请求的平台无关部分，Windows (WebResourceRequested) 与 Android (shouldInterceptRequest) 共用：
+// URL -> 路径、扩展名 -> MIME 类型、Range 请求头的解析。
+namespace WebResources {
+    // 虚拟域名下 /local-file/ 之后是 URL 编码的本地路径（Windows）或 content URI（Android）
+    constexpr std::string_view kLocalFilePrefix = "/local-file/";
+
+    // 去掉 scheme、host、查询串和片段，只保留路径（以 '/' 开头）；host 不是 expectedHost 时返回 false
+    bool RequestPath(std::string_view url, std::string_view expectedHost, std::string& path);
+
+    // 按扩展名（不区分大小写）给出 Content-Type，未知类型为 application/octet-stream
+    const char* MimeType(std::string_view path);
+
+    struct ByteRange {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+    };
+    enum class RangeResult {
+        Full,          // 没有 Range 头或不支持的形式（多个区间等），按整个文件响应 200
+        Partial,       // 206，range 为请求的区间
+        Unsatisfiable  // 416
+    };
+    // 解析单个 "bytes=first-last" / "bytes=first-" / "bytes=-suffix" 区间。
+    // 返回 Full 时 range 覆盖整个文件
+    RangeResult ParseRange(std::string_view header, uint64_t size, ByteRange& range);
+    // 206 响应的 Content-Range 值，例如 "bytes 0-99/1000"
+    std::string ContentRange(const ByteRange& range, uint64_t size);
+}
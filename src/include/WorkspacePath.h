@@ -0,0 +1,86 @@
+﻿// src/include/WorkspacePath.h
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 工作区内的路径。
+// 前端发来的路径是 UTF-8 字符串，处理函数需要的是宽字符串标识符、std::filesystem::path 以及相对工作区根目录的路径；
+// 这些形式每条都只在第一次见到该路径时计算一次，之后同一字符串直接取回驻留的结果。
+// 导出时每个页面 / 每张图片都要算一次 build 目录下的目标路径，以前每次都要 std::filesystem::relative
+// （内部是两次 weakly_canonical，也就是若干次文件系统调用）。
+// 句柄只是一个共享指针，复制、比较、取哈希都不需要再碰字符串。
+class WorkspacePath {
+public:
+    WorkspacePath() = default;
+
+    bool Empty() const { return !m_entry || m_entry->utf8.empty(); }
+    // 前端给出的原文
+    const std::string& Utf8() const;
+    // 平台接口使用的标识符（Windows 路径或 Android 的 content URI），与 string_to_wstring 的结果相同
+    const std::wstring& Identifier() const;
+    // 词法规范化后的文件系统路径，只对真正的路径有意义（content URI 的 "//" 会被合并）
+    const std::filesystem::path& Path() const;
+    // 相对工作区根目录的路径，结果与 std::filesystem::relative(Path(), root) 一致；首次调用时计算
+    const std::filesystem::path& Relative() const;
+    size_t Hash() const { return m_entry ? m_entry->hash : 0; }
+
+    bool operator==(const WorkspacePath& other) const;
+    bool operator!=(const WorkspacePath& other) const { return !(*this == other); }
+
+private:
+    friend class WorkspacePaths;
+
+    struct Entry {
+        std::string utf8;
+        std::wstring identifier;
+        std::filesystem::path path;
+        std::filesystem::path root; // 驻留时的工作区根目录（与 path 一样经过词法规范化）
+        size_t hash = 0;
+        mutable std::filesystem::path relative;
+        mutable bool hasRelative = false;
+    };
+
+    explicit WorkspacePath(std::shared_ptr<const Entry> entry) : m_entry(std::move(entry)) {}
+
+    std::shared_ptr<const Entry> m_entry;
+};
+
+namespace std {
+    template<>
+    struct hash<WorkspacePath> {
+        size_t operator()(const WorkspacePath& path) const noexcept { return path.Hash(); }
+    };
+}
+
+// 当前工作区的路径驻留表，切换工作区时 Reset。
+// 与 Backend 的其他缓存一样只在消息线程上使用，不加锁
+class WorkspacePaths {
+public:
+    void Reset(const std::wstring& root);
+
+    // 原样驻留前端给出的路径
+    WorkspacePath Intern(std::string_view utf8);
+    // 相对路径视为相对工作区根目录（数据库的外部数据源等），绝对路径与 UNC 路径原样驻留
+    WorkspacePath Resolve(std::string_view utf8);
+
+    const std::filesystem::path& Root() const { return m_root; }
+    // <root>/build，导出的输出目录
+    const std::filesystem::path& BuildDirectory() const { return m_buildDirectory; }
+    // 源文件在 build 目录中的对应位置，扩展名替换为 extension（如 L".html"）
+    std::filesystem::path BuildTarget(const WorkspacePath& source, const wchar_t* extension) const;
+
+private:
+    // 驻留的路径数量上限，超出后整表重建；已发出的句柄自己持有条目，不受影响
+    static constexpr size_t kMaxEntries = 16384;
+
+    std::filesystem::path m_root;
+    std::filesystem::path m_normalRoot;
+    std::filesystem::path m_buildDirectory;
+    std::unordered_map<std::string, std::shared_ptr<const WorkspacePath::Entry>> m_entries;
+    std::unordered_map<std::string, std::shared_ptr<const WorkspacePath::Entry>> m_resolved;
+};
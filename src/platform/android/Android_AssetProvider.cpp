@@ -0,0 +1,107 @@
+﻿// src/platform/android/Android_AssetProvider.cpp
+
+#include "Android_AssetProvider.h"
+#include "include/Platform.h"
+#include "resources.h" // For g_resource_paths
+#include <string>
+#include <unordered_map>
+
+AssetProvider::Asset::Asset(AAsset* asset) : m_asset(asset) {
+    if (!m_asset) return;
+    // AASSET_MODE_BUFFER 打开时，未压缩的 asset 直接映射，压缩的 asset 解压一次后由 AAsset 持有
+    m_data = AAsset_getBuffer(m_asset);
+    m_size = m_data ? static_cast<size_t>(AAsset_getLength64(m_asset)) : 0;
+}
+
+AssetProvider::Asset::~Asset() {
+    Close();
+}
+
+AssetProvider::Asset::Asset(Asset&& other) noexcept
+    : m_asset(other.m_asset), m_data(other.m_data), m_size(other.m_size) {
+    other.m_asset = nullptr;
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+AssetProvider::Asset& AssetProvider::Asset::operator=(Asset&& other) noexcept {
+    if (this != &other) {
+        Close();
+        m_asset = other.m_asset;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_asset = nullptr;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+void AssetProvider::Asset::Close() {
+    if (m_asset) AAsset_close(m_asset);
+    m_asset = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+
+AssetProvider::AssetProvider(AAssetManager* manager) : m_manager(manager), m_cache(RESOURCE_COUNT) {}
+
+const char* AssetProvider::ResourcePath(int resource_id) {
+    if (resource_id < RESOURCE_ID_BASE || resource_id - RESOURCE_ID_BASE >= RESOURCE_COUNT) return nullptr;
+    return g_resource_paths[resource_id - RESOURCE_ID_BASE];
+}
+
+int AssetProvider::ResourceId(std::string_view path) {
+    // 路径表是编译期生成的常量，索引只需建立一次
+    static const std::unordered_map<std::string_view, int> index = [] {
+        std::unordered_map<std::string_view, int> map;
+        map.reserve(RESOURCE_COUNT);
+        for (int i = 0; i < RESOURCE_COUNT; ++i) {
+            map.emplace(g_resource_paths[i], RESOURCE_ID_BASE + i);
+        }
+        return map;
+    }();
+    auto it = index.find(path);
+    return it == index.end() ? -1 : it->second;
+}
+
+const AssetProvider::Asset* AssetProvider::Get(int resource_id) {
+    const char* path = ResourcePath(resource_id);
+    if (!path) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_cache[resource_id - RESOURCE_ID_BASE];
+    if (!slot) {
+        // 路径以 '/' 开头，asset 路径不带
+        Asset asset = Open(path + 1);
+        if (!asset) {
+            LOG_DEBUG((std::string("Failed to open asset: ") + path).c_str());
+            return nullptr;
+        }
+        slot = std::make_unique<Asset>(std::move(asset));
+    }
+    return slot.get();
+}
+
+AssetProvider::Asset AssetProvider::Open(const char* assetPath) const {
+    if (!m_manager || !assetPath) return Asset();
+    return Asset(AAssetManager_open(m_manager, assetPath, AASSET_MODE_BUFFER));
+}
+
+int AssetProvider::OpenDescriptor(int resource_id, int64_t& start, int64_t& length) const {
+    const char* path = ResourcePath(resource_id);
+    if (!m_manager || !path) return -1;
+
+    AAsset* asset = AAssetManager_open(m_manager, path + 1, AASSET_MODE_UNKNOWN);
+    if (!asset) return -1;
+    off64_t assetStart = 0;
+    off64_t assetLength = 0;
+    int fd = AAsset_openFileDescriptor64(asset, &assetStart, &assetLength);
+    AAsset_close(asset);
+    if (fd < 0) return -1;
+
+    start = assetStart;
+    length = assetLength;
+    return fd;
+}
@@ -0,0 +1,63 @@
+﻿// src/platform/android/Android_AssetProvider.h
+#pragma once
+
+#include <android/asset_manager.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// APK 内嵌资源 (assets) 的只读访问。
+// 资源 ID 经由 resources.h 中按 ID 顺序生成的路径表直接定位，不再反向扫描 g_resource_map；
+// 打开过的 AAsset 一直保持打开，AAsset_getBuffer 返回的缓冲区（未压缩的 asset 为 APK 的只读映射）
+// 在 AssetProvider 存活期间有效，调用方直接读取，无需复制也无需释放。
+class AssetProvider {
+public:
+    // 持有一个打开的 AAsset，析构时关闭
+    class Asset {
+    public:
+        Asset() = default;
+        explicit Asset(AAsset* asset);
+        ~Asset();
+        Asset(Asset&& other) noexcept;
+        Asset& operator=(Asset&& other) noexcept;
+        Asset(const Asset&) = delete;
+        Asset& operator=(const Asset&) = delete;
+
+        explicit operator bool() const { return m_data != nullptr; }
+        const void* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+        std::string_view View() const { return std::string_view(static_cast<const char*>(m_data), m_size); }
+
+    private:
+        void Close();
+
+        AAsset* m_asset = nullptr;
+        const void* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    // manager 必须比 AssetProvider 存活得更久（JniBinding 持有其全局引用直到 nativeDestroy）
+    explicit AssetProvider(AAssetManager* manager);
+
+    // resource_id 对应的 URL 路径（以 '/' 开头），未知 ID 返回 nullptr
+    static const char* ResourcePath(int resource_id);
+    // URL 路径 -> resource_id，未知路径返回 -1
+    static int ResourceId(std::string_view path);
+
+    // 打开并缓存资源，返回的 Asset 在 AssetProvider 析构前有效；失败时返回 nullptr。线程安全
+    const Asset* Get(int resource_id);
+    // 不经缓存打开任意 asset（路径不带开头的 '/'），由返回值负责关闭
+    Asset Open(const char* assetPath) const;
+    // 资源在 APK 中的描述符（指向 APK 文件本身，内容位于 [start, start + length)），由调用方关闭。
+    // 压缩存储的 asset 没有这样的描述符，返回 -1
+    int OpenDescriptor(int resource_id, int64_t& start, int64_t& length) const;
+
+private:
+    AAssetManager* m_manager;
+    std::mutex m_mutex;
+    // 下标为 resource_id - RESOURCE_ID_BASE
+    std::vector<std::unique_ptr<Asset>> m_cache;
+};
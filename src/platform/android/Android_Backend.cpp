@@ -1,29 +1,24 @@
 ﻿#include "Android_Backend.h"
+#include "JNI_Binding.h"
+#include "Android_DirectFiles.h"
+#include "include/Telemetry.h"
+#include "include/Utf.h"
+#include "include/WebResources.h"
 #include <string>
-#include <codecvt>
-#include <locale>
 #include <sstream>
 #include <iomanip>
 #include <android/log.h>
 #include "include/Platform.h"
 #include "resources.h" // For g_resource_map
-#include <android/asset_manager_jni.h>
+#include <chrono>
 #include <future>
-
-// 全局 JavaVM 指针，由 JNI_Bridge.cpp 设置
-extern JavaVM* g_jvm;
-
-// 辅助函数，用于获取当前线程的 JNIEnv*
-JNIEnv* GetJNIEnv() {
-    JNIEnv* env = nullptr;
-    if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
-        // 如果当前线程未附加到 JVM，则附加
-        if (g_jvm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
-            return nullptr; // 附加失败
-        }
-    }
-    return env;
-}
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 
@@ -31,38 +26,126 @@ JNIEnv* GetJNIEnv() {
  * [NEW] 向 Kotlin 发起一个通用的平台服务请求
  */
 void AndroidBackend::RequestPlatformService(const json& request, std::function<void(const json&)> callback) {
-    if (!m_mainActivityInstance) return;
+    if (!m_mainActivityInstance) {
+        callback({ {"success", false}, {"error", "MainActivity instance unavailable."} });
+        return;
+    }
 
-    JNIEnv* env = GetJNIEnv();
-    if (!env) return;
+    JNIEnv* env = JniBinding::Env();
+    if (!env) {
+        callback({ {"success", false}, {"error", "JNIEnv unavailable."} });
+        return;
+    }
 
     // 1. 分配并存储回调
-    int callbackId = m_nextServiceCallbackId++;
-    m_serviceCallbacks[callbackId] = callback;
+    int callbackId = m_serviceCallbacks.Register(std::move(callback));
 
     // 2. 将 callbackId 添加到请求中
     json request_with_id = request;
     request_with_id["callbackId"] = callbackId;
 
-    // 3. JNI 调用
-    jclass mainActivityClass = env->GetObjectClass(m_mainActivityInstance);
-    if (!mainActivityClass) return;
+    // 3. JNI 调用（方法 ID 已在 nativeInit 时缓存）
+    if (!JniBinding::RequestPlatformService(env, m_mainActivityInstance, request_with_id.dump())) {
+        LOG_DEBUG("Failed to call requestPlatformService.");
+        // 清理回调，但仍然回调一次失败结果，等待结果的调用不会永远挂起
+        if (auto pending = m_serviceCallbacks.Take(callbackId)) {
+            pending({ {"success", false}, {"error", "Failed to call requestPlatformService."} });
+        }
+    }
+}
 
-    jmethodID requestMethodID = env->GetMethodID(mainActivityClass, "requestPlatformService", "(Ljava/lang/String;)V");
-    if (!requestMethodID) {
-        LOG_DEBUG("Failed to find method requestPlatformService.");
-        env->DeleteLocalRef(mainActivityClass);
-        m_serviceCallbacks.erase(callbackId); // 清理回调
+void AndroidBackend::RequestPlatformBatch(const json& operations, std::function<void(const json&)> callback) {
+    // 各分块的结果可能在不同的服务线程上同时到达：每个分块只写入自己的区间，
+    // 计数归零的那个线程看到全部写入后调用 callback
+    struct BatchState {
+        json results = json::array();
+        std::atomic<size_t> pendingRequests{ 0 };
+        std::function<void(const json&)> callback;
+    };
+    auto state = std::make_shared<BatchState>();
+    state->callback = std::move(callback);
+
+    const size_t count = operations.is_array() ? operations.size() : 0;
+    for (size_t i = 0; i < count; ++i) {
+        state->results.push_back({ {"success", false}, {"error", "Batch request failed."} });
+    }
+    if (count == 0) {
+        state->callback(state->results);
         return;
     }
 
-    std::string request_str = request_with_id.dump();
-    jstring requestJString = env->NewStringUTF(request_str.c_str());
+    state->pendingRequests = (count + kMaxBatchOperations - 1) / kMaxBatchOperations;
+    for (size_t begin = 0; begin < count; begin += kMaxBatchOperations) {
+        const size_t end = std::min(count, begin + kMaxBatchOperations);
+
+        json request;
+        request["action"] = "batch";
+        json& chunk = request["payload"]["operations"];
+        chunk = json::array();
+        for (size_t i = begin; i < end; ++i) {
+            chunk.push_back(operations[i]);
+        }
+
+        RequestPlatformService(request, [state, begin, end](const json& result) {
+            if (result.value("success", false) && result.contains("data") && result["data"].is_object()) {
+                auto it = result["data"].find("results");
+                if (it != result["data"].end() && it->is_array()) {
+                    // 整个请求失败时保留预先填入的错误；结果数量不足时缺失的部分同样视为失败
+                    for (size_t i = begin; i < end && i - begin < it->size(); ++i) {
+                        state->results[i] = (*it)[i - begin];
+                    }
+                }
+            }
+            if (state->pendingRequests.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                state->callback(state->results);
+            }
+            });
+    }
+}
 
-    env->CallVoidMethod(m_mainActivityInstance, requestMethodID, requestJString);
+template <typename T, typename Start>
+T AndroidBackend::Await(Start start, T fallback, int timeoutMs, std::function<void(T&)> discardLate) {
+    // 状态由回调共享持有：等待超时返回后结果仍可能到达，此时交给 discardLate 释放（如关闭描述符）
+    struct State {
+        std::mutex mutex;
+        std::promise<T> promise;
+        bool abandoned = false;
+    };
+    auto state = std::make_shared<State>();
+    auto future = state->promise.get_future();
+    start(std::function<void(T)>([state, discardLate](T value) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->abandoned) {
+            if (discardLate) discardLate(value);
+            return;
+        }
+        state->promise.set_value(std::move(value));
+        }));
 
-    env->DeleteLocalRef(requestJString);
-    env->DeleteLocalRef(mainActivityClass);
+    if (PlatformServiceRegistry::IsDeliveringThread()) {
+        timeoutMs = std::min(timeoutMs, kDeliveryThreadWaitTimeoutMs);
+    }
+    if (future.wait_for(std::chrono::milliseconds(timeoutMs)) != std::future_status::ready) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        // 超时与结果到达可能同时发生，加锁后再确认一次
+        if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            state->abandoned = true;
+            LOG_DEBUG("AndroidBackend::Await: platform service result did not arrive in time.");
+            return fallback;
+        }
+    }
+    return future.get();
+}
+
+json AndroidBackend::RunPlatformBatch(const json& operations) {
+    json failed = json::array();
+    const size_t count = operations.is_array() ? operations.size() : 0;
+    for (size_t i = 0; i < count; ++i) {
+        failed.push_back({ {"success", false}, {"error", "Batch request timed out."} });
+    }
+    return Await<json>([this, &operations](std::function<void(json)> done) {
+        RequestPlatformBatch(operations, [done](const json& results) { done(results); });
+        }, std::move(failed));
 }
 
 /**
@@ -70,19 +153,13 @@ void AndroidBackend::RequestPlatformService(const json& request, std::function<v
  */
 void AndroidBackend::OnPlatformServiceResult(const std::string& resultJson) {
     try {
-        json result = json::parse(resultJson);
-        int callbackId = result.value("callbackId", -1);
-
-        LOG_DEBUG("AndroidBackend::OnPlatformServiceResult: " + callbackId);
-
-        auto it = m_serviceCallbacks.find(callbackId);
-        if (it != m_serviceCallbacks.end()) {
-            // 找到回调并执行
-            it->second(result);
-            // 执行后移除
-            m_serviceCallbacks.erase(it);
+        json result;
+        {
+            Telemetry::Span span("parseServiceResult", "json");
+            result = json::parse(resultJson);
         }
-        else {
+        // 可能在 UI 线程或 Kotlin 的服务线程池上调用；回调在锁外执行，partial 结果保留回调
+        if (!m_serviceCallbacks.Dispatch(result)) {
             LOG_DEBUG("Failed to find platform service function.");
         }
     }
@@ -93,7 +170,7 @@ void AndroidBackend::OnPlatformServiceResult(const std::string& resultJson) {
 
 
 // --- 构造函数与初始化 ---
-AndroidBackend::AndroidBackend() : m_mainActivityInstance(nullptr) {}
+AndroidBackend::AndroidBackend() : m_mainActivityInstance(nullptr), m_assets(JniBinding::AssetManager()) {}
 
 void AndroidBackend::SetMainActivityInstance(jobject mainActivityInstance) {
     m_mainActivityInstance = mainActivityInstance;
@@ -109,32 +186,24 @@ void AndroidBackend::onUiReady() {
  * [已实现] 通过 JNI 调用 MainActivity 的 postMessageToJs 方法，将消息发送到 WebView
  */
 void AndroidBackend::SendMessageToJS(const json& message) {
-    LOG_DEBUG("AndroidBackend::SendMessageToJS");
     if (!m_mainActivityInstance) return;
 
-    JNIEnv* env = GetJNIEnv();
+    JNIEnv* env = JniBinding::Env();
     if (!env) return;
 
-    jclass mainActivityClass = env->GetObjectClass(m_mainActivityInstance);
-    if (!mainActivityClass) return;
-
-    jmethodID postMessageMethodID = env->GetMethodID(mainActivityClass, "postMessageToJs", "(Ljava/lang/String;)V");
-    if (!postMessageMethodID) {
-        LOG_DEBUG("AndroidBackend::SendMessageToJS(const json& message): Failed to find method postMessageToJs.");
-        env->DeleteLocalRef(mainActivityClass);
-        return;
+    std::string json_str;
+    {
+        Telemetry::Span span("dumpMessage", "json");
+        json_str = message.dump();
     }
+    Telemetry::RecordMessageOut(json_str.size());
 
-    std::string json_str = message.dump();
-    jstring jsonJString = env->NewStringUTF(json_str.c_str());
+    // 只记录 action 与大小，完整内容可能是整个页面或工作区树
+    LOG_DEBUG(("AndroidBackend::SendMessageToJS: '" + message.value("action", "") + "' (" + std::to_string(json_str.size()) + " bytes)").c_str());
 
-    LOG_DEBUG("AndroidBackend::SendMessageToJS(const json& message): Sending");
-    LOG_DEBUG(json_str.c_str());
-
-    env->CallVoidMethod(m_mainActivityInstance, postMessageMethodID, jsonJString);
-
-    env->DeleteLocalRef(jsonJString);
-    env->DeleteLocalRef(mainActivityClass);
+    if (!JniBinding::PostMessageToJs(env, m_mainActivityInstance, json_str)) {
+        LOG_DEBUG("AndroidBackend::SendMessageToJS(const json& message): Failed to call postMessageToJs.");
+    }
 }
 
 /**
@@ -167,6 +236,49 @@ void AndroidBackend::OpenWorkspaceDialog() {
 
 
 // [NEW] Android-specific implementation of ListWorkspace
+namespace {
+    bool EndsWith(const std::string& value, const std::string& suffix) {
+        return value.size() > suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // 工作区树中的节点类型，与 WinBackend::ListWorkspace 一致；不显示的文件返回 nullptr
+    const char* WorkspaceNodeType(const std::string& name, bool isDirectory) {
+        if (isDirectory) return name == "build" ? nullptr : "folder"; // 忽略 build 文件夹
+        if (EndsWith(name, ".veritnote")) return "page";
+        if (EndsWith(name, ".veritnotegraph")) return "graph";
+        if (EndsWith(name, ".veritnotedb")) return "database";
+        return nullptr;
+    }
+
+    // Kotlin listTree 返回的一个目录的子项 -> 前端树节点（文件夹的 children 留空，由它自己的列表填充）
+    json ToTreeChildren(const json& entries) {
+        json children = json::array();
+        if (!entries.is_array()) return children;
+        for (const auto& entry : entries) {
+            if (!entry.is_object()) continue;
+            std::string name = entry.value("name", "");
+            const char* type = WorkspaceNodeType(name, entry.value("isDirectory", false));
+            if (!type) continue;
+            // 与 Windows 相同，名称保留扩展名，由前端处理显示
+            json node = { {"name", name}, {"path", entry.value("uri", "")}, {"type", type} };
+            if (node["type"] == "folder") node["children"] = json::array();
+            children.push_back(std::move(node));
+        }
+        return children;
+    }
+
+    // 把各目录的子项按 path 拼成完整的树
+    void AttachChildren(json& node, std::unordered_map<std::string, json>& listings) {
+        auto it = listings.find(node.value("path", ""));
+        if (it == listings.end()) return;
+        node["children"] = std::move(it->second);
+        listings.erase(it);
+        for (auto& child : node["children"]) {
+            if (child["type"] == "folder") AttachChildren(child, listings);
+        }
+    }
+}
+
 void AndroidBackend::ListWorkspace(const json& payload) {
     LOG_DEBUG("AndroidBackend::ListWorkspace");
     if (m_workspaceRoot.empty()) {
@@ -177,108 +289,155 @@ void AndroidBackend::ListWorkspace(const json& payload) {
         return;
     }
 
+    // 新的列表开始后，仍在进行中的旧列表不再向前端发送结果
+    uint64_t listingId = ++m_listingId;
+
+    if (!m_directRoot.empty()) {
+        ListWorkspaceDirect(listingId);
+    }
+    else {
+        ListWorkspaceStreamed(listingId);
+    }
+}
+
+// 可直接访问的工作区：与 Windows 一样在本地递归遍历，节点标识符仍与 SAF 访问时一致
+void AndroidBackend::ListWorkspaceDirect(uint64_t listingId) {
+    Telemetry::Span span("listWorkspace", "io");
+    std::string rootIdentifier = wstring_to_string(m_workspaceRoot);
+
+    std::function<void(const std::filesystem::path&, const std::string&, json&)> scan_dir =
+        [&](const std::filesystem::path& dir_path, const std::string& identifier, json& children) {
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(dir_path, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code statusError;
+            // 不跟随指向目录的符号链接，避免循环
+            bool isDirectory = it->symlink_status(statusError).type() == std::filesystem::file_type::directory;
+            if (!isDirectory && !it->is_regular_file(statusError)) continue;
+
+            std::string name = it->path().filename().string();
+            const char* type = WorkspaceNodeType(name, isDirectory);
+            std::string childIdentifier;
+            if (!type || !DirectFiles::ChildIdentifier(identifier, name, childIdentifier)) continue;
+
+            json node = { {"name", name}, {"path", childIdentifier}, {"type", type} };
+            if (isDirectory) {
+                node["children"] = json::array();
+                scan_dir(it->path(), childIdentifier, node["children"]);
+            }
+            children.push_back(std::move(node));
+        }
+    };
+
+    json tree_node = { {"name", m_directRoot.filename().string()}, {"path", rootIdentifier}, {"type", "folder"}, {"children", json::array()} };
+    scan_dir(m_directRoot, rootIdentifier, tree_node["children"]);
+    if (listingId != m_listingId) return;
+
+    if (tree_node["children"].empty() && CreateWelcomeFile()) {
+        return;
+    }
+
+    json response;
+    response["action"] = "workspaceListed";
+    response["payload"] = tree_node;
+    SendMessageToJS(response);
+}
+
+// SAF 工作区：Kotlin 并发地逐目录查询，每列出一批目录就作为部分结果返回。
+// 每批目录立即以 workspaceListingChunk 转发给前端挂到树上，全部完成后再发送完整的 workspaceListed
+void AndroidBackend::ListWorkspaceStreamed(uint64_t listingId) {
+    struct ListingState {
+        std::string rootPath;
+        std::unordered_map<std::string, json> listings; // 目录 path -> 子节点
+    };
+    auto state = std::make_shared<ListingState>();
+    state->rootPath = wstring_to_string(m_workspaceRoot);
+
     json request;
-    request["action"] = "listDirectory";
-    request["payload"]["uri"] = wstring_to_string(m_workspaceRoot);
+    request["action"] = "listTree";
+    request["payload"]["rootUri"] = state->rootPath;
+    request["payload"]["exclude"] = json::array({ "build" });
+
+    RequestPlatformService(request, [this, state, listingId](const json& result) {
+        if (listingId != m_listingId) return;
+
+        if (!result.value("success", false)) {
+            json response;
+            response["action"] = "workspaceListed";
+            response["error"] = result.value("error", "Failed to list directory.");
+            SendMessageToJS(response);
+            return;
+        }
+
+        json chunk = json::array();
+        if (result.contains("data") && result["data"].is_object() && result["data"].contains("directories")) {
+            for (const auto& directory : result["data"]["directories"]) {
+                if (!directory.is_object()) continue;
+                std::string path = directory.value("uri", "");
+                json children = ToTreeChildren(directory.contains("entries") ? directory["entries"] : json());
+                chunk.push_back({ {"path", path}, {"children", children} });
+                state->listings[path] = std::move(children);
+            }
+        }
+
+        if (!chunk.empty()) {
+            json response;
+            response["action"] = "workspaceListingChunk";
+            response["payload"]["listingId"] = listingId;
+            response["payload"]["rootPath"] = state->rootPath;
+            response["payload"]["directories"] = std::move(chunk);
+            SendMessageToJS(response);
+        }
+
+        if (result.value("partial", false)) return;
+
+        json tree_node = { {"name", "root"}, {"path", state->rootPath}, {"type", "folder"}, {"children", json::array()} };
+        AttachChildren(tree_node, state->listings);
+
+        if (tree_node["children"].empty() && CreateWelcomeFile()) {
+            return;
+        }
 
-    RequestPlatformService(request, [this](const json& result) {
         json response;
         response["action"] = "workspaceListed";
-        if (result.value("success", false)) {
-            // 将 Kotlin 返回的文件列表转换为前端需要的树状结构
-            json tree_node;
-            tree_node["name"] = "root"; // The name can be derived differently if needed
-            tree_node["path"] = wstring_to_string(m_workspaceRoot); // Use the root URI
-            tree_node["type"] = "folder";
-            tree_node["children"] = json::array();
-
-            const auto& files = result["data"]["files"];
-
-            for (const auto& file_item : files) {
-                // TODO: This is a flat list. For nested structure, a recursive
-                // platform service request would be needed. Let's start with flat.
-                json file_node;
-                std::string name = file_item.value("name", "");
-                // Remove extension for display name if it's a veritnote file
-                std::string extPage = ".veritnote";
-                std::string extGraph = ".veritnotegraph";
-                std::string extDatabase = ".veritnotedb";
-                if (name.size() > extPage.size() && name.substr(name.size() - extPage.size()) == extPage) {
-                    // Veritnote Page logic (existing)
-                    file_node["name"] = name.substr(0, name.size() - extPage.size());
-                    file_node["type"] = "page";
-				}
-				else if (name.size() > extGraph.size() && name.substr(name.size() - extGraph.size()) == extGraph) {
-					file_node["name"] = name.substr(0, name.size() - extGraph.size());
-					file_node["type"] = "graph";
-				}
-                else if (name.size() > extData.size() && name.substr(name.size() - extData.size()) == extDatabase) {
-					file_node["name"] = name.substr(0, name.size() - extData.size());
-					file_node["type"] = "database";
-                }
-                else {
-                    file_node["name"] = name;
-                    file_node["type"] = file_item.value("isDirectory", false) ? "folder" : "unknown";
-                }
+        response["payload"] = std::move(tree_node);
+        SendMessageToJS(response);
+        });
+}
 
-                file_node["path"] = file_item.value("uri", ""); // Use the URI as the path
+// 空工作区：写入欢迎页面，完成后重新列出工作区。已开始创建时返回 true
+bool AndroidBackend::CreateWelcomeFile() {
+    auto it = g_resource_map.find(L"/welcome.veritnote");
+    if (it == g_resource_map.end()) return false;
 
-                // Only add folders and VeritNote files
-				if (file_node["type"] == "page" || file_node["type"] == "graph" || file_node["type"] == "database" || file_node["type"] == "folder") {
-                    if (file_node["type"] == "folder") {
-                        // For now, folders are empty shells. Recursive loading can be a future feature.
-                        file_node["children"] = json::array();
-                    }
-                    tree_node["children"].push_back(file_node);
-                }
-            }
+    void* pData = nullptr;
+    DWORD dwSize = 0;
+    if (!this->LoadResourceData(it->second, pData, dwSize)) return false;
+    std::string content(static_cast<const char*>(pData), dwSize);
 
-            response["payload"] = tree_node;
-
-            if (tree_node["children"].empty()) {
-                std::filesystem::path destFilePath = "welcome.veritnote"; // Filename only
-
-                // For Android, we cannot use filesystem::path. We need to create it in the URI.
-                // We use a simplified version of ExtractResourceToFile's logic here.
-                auto it = g_resource_map.find(L"/welcome.veritnote");
-                if (it != g_resource_map.end()) {
-                    void* pData = nullptr;
-                    DWORD dwSize = 0;
-                    if (this->LoadResourceData(it->second, pData, dwSize)) {
-                        std::string content(static_cast<char*>(pData), dwSize);
-                        delete[] static_cast<char*>(pData); // Release memory from LoadResourceData
-
-                        json create_request;
-                        create_request["action"] = "createItem";
-                        create_request["payload"]["parentUri"] = wstring_to_string(m_workspaceRoot);
-                        create_request["payload"]["name"] = "welcome.veritnote";
-                        create_request["payload"]["isDirectory"] = false;
-
-                        RequestPlatformService(create_request, [this, content](const json& create_result) {
-                            if (create_result.value("success", false)) {
-                                std::string new_file_uri = create_result["data"].value("uri", "");
-                                json write_request;
-                                write_request["action"] = "writeFile";
-                                write_request["payload"]["uri"] = new_file_uri;
-                                write_request["payload"]["content"] = content;
-                                RequestPlatformService(write_request, [this](const json& write_result) {
-                                    // After writing, re-list the workspace to show the new file
-                                    this->ListWorkspace(json::object());
-                                    });
-                            }
-                            });
-                        // IMPORTANT: We return here because the final response will be sent
-                        // asynchronously after the file is created and the workspace is re-listed.
-                        return;
-                    }
-                }
-            }
+    if (!m_directRoot.empty()) {
+        if (!DurableStorage::AtomicWriteFile(m_directRoot / "welcome.veritnote", content)) return false;
+        this->ListWorkspace(json::object());
+        return true;
+    }
+
+    json operations = json::array({ {
+        {"op", "create"},
+        {"parentUri", wstring_to_string(m_workspaceRoot)},
+        {"name", "welcome.veritnote"},
+        {"isDirectory", false},
+        {"content", content}
+    } });
+    RequestPlatformBatch(operations, [this](const json& results) {
+        // 创建失败（例如文件已存在但不可见）时不再重试，避免循环
+        if (!results.empty() && results[0].value("success", false)) {
+            this->ListWorkspace(json::object());
         }
         else {
-            response["error"] = result.value("error", "Failed to list directory.");
+            SendMessageToJS({ {"action", "workspaceListed"}, {"payload", {
+                {"name", "root"}, {"path", wstring_to_string(m_workspaceRoot)}, {"type", "folder"}, {"children", json::array()} }} });
         }
-        SendMessageToJS(response);
         });
+    return true;
 }
 
 void AndroidBackend::CreateItem(const json& payload) {
@@ -378,63 +537,93 @@ void AndroidBackend::EnsureWorkspaceConfigs(const json& payload) {
         // 确保根目录本身也被处理
         allDirs.push_back(wstring_to_string(m_workspaceRoot));
 
-        // 3. C++ 循环列表，为每个目录创建配置文件
+        // 3. 用一次批量请求为每个目录创建配置文件，新建的文件同时写入默认内容。
+        // 这是“尝试创建”的操作：文件已存在时对应的 create 会失败，这是我们期望的行为，
+        // 每个操作的结果相互独立，不影响其他目录。
+        const std::string defaultContent = json{ {"page", json::object()} }.dump(2);
+        json operations = json::array();
         for (const auto& dirUri_json : allDirs) {
-            std::string dirUri = dirUri_json.get<std::string>();
-
-            json create_req;
-            const std::string config_name = "veritnoteconfig";
-            create_req["action"] = "createItem";
-            create_req["payload"]["parentUri"] = dirUri;
-            create_req["payload"]["name"] = config_name;
-            create_req["payload"]["isDirectory"] = false;
-
-            // 调用创建服务。这是一个“尝试创建”的操作，如果文件已存在，
-            // Kotlin 端的 createItem 会失败，这是我们期望的行为。
-            RequestPlatformService(create_req, [this](const json& create_result) {
-                if (create_result.value("success", false)) {
-                    // 如果文件是新创建的，我们需要写入默认内容
-                    std::string new_file_uri = create_result["data"].value("uri", "");
-
-                    json defaultConfig = { {"page", json::object()} };
-
-                    json write_req;
-                    write_req["action"] = "writeFile";
-                    write_req["payload"]["uri"] = new_file_uri;
-                    write_req["payload"]["content"] = defaultConfig.dump(2);
-
-                    // 发起写入请求，这是一个 fire-and-forget 操作
-                    RequestPlatformService(write_req, [](const json&) {});
-                }
-                // 如果创建失败（比如文件已存在），我们什么都不做，继续处理下一个目录。
-                });
+            if (!dirUri_json.is_string()) continue;
+            operations.push_back({
+                {"op", "create"},
+                {"parentUri", dirUri_json},
+                {"name", "veritnoteconfig"},
+                {"isDirectory", false},
+                {"content", defaultContent}
+            });
         }
+
+        // fire-and-forget
+        RequestPlatformBatch(operations, [](const json&) {});
         });
 }
 
+namespace {
+    // 把 ReadJsonFile 的标识符拆成 URI 和（可选的）子文件名：
+    // CombineIdentifier 生成的 "parentUri|childFilename"，或 JS 拼接出的 "parentUri/childFilename"
+    void SplitJsonFileIdentifier(const std::wstring& identifier, std::wstring& uri_str, std::wstring& filename_str) {
+        uri_str = identifier;
+        filename_str.clear();
+
+        // First, try to parse our custom "|" format
+        size_t pipe_separator = identifier.find(L'|');
+        if (pipe_separator != std::wstring::npos) {
+            uri_str = identifier.substr(0, pipe_separator);
+            filename_str = identifier.substr(pipe_separator + 1);
+        }
+        else {
+            // [NEW] If no "|", then check for the malformed URI format from JS
+            size_t last_slash = identifier.find_last_of(L"\\/");
+            // Check if it's not a URI scheme slash (like in content://)
+            if (last_slash != std::wstring::npos && last_slash > 10) {
+                uri_str = identifier.substr(0, last_slash);
+                filename_str = identifier.substr(last_slash + 1);
+            }
+        }
+    }
+
+    // readFile / 批量 read 的结果 -> JSON；读取失败、空文件或解析失败时为空对象
+    json ParseJsonReadResult(const json& result) {
+        if (!result.value("success", false) || !result.contains("data") || !result["data"].is_object()) {
+            return json::object();
+        }
+        try {
+            // Return empty object if content is empty, to avoid parse error on empty files
+            std::string content = result["data"].value("content", "");
+            return content.empty() ? json::object() : json::parse(content);
+        }
+        catch (const json::parse_error&) {
+            return json::object();
+        }
+    }
+}
+
 // [NEW] Android-specific implementation of ReadJsonFile
 json AndroidBackend::ReadJsonFile(const std::wstring& identifier) {
-    std::wstring uri_str = identifier;
-    std::wstring filename_str;
+    Telemetry::Span span("readJsonFile", "io");
+    return Await<json>([this, &identifier](std::function<void(json)> done) {
+        ReadJsonFileAsync(identifier, std::move(done));
+        }, json::object());
+}
 
-    // First, try to parse our custom "|" format
-    size_t pipe_separator = identifier.find(L'|');
-    if (pipe_separator != std::wstring::npos) {
-        uri_str = identifier.substr(0, pipe_separator);
-        filename_str = identifier.substr(pipe_separator + 1);
-    }
-    else {
-        // [NEW] If no "|", then check for the malformed URI format from JS
-        size_t last_slash = identifier.find_last_of(L"\\/");
-        // Check if it's not a URI scheme slash (like in content://)
-        if (last_slash != std::wstring::npos && last_slash > 10) {
-            uri_str = identifier.substr(0, last_slash);
-            filename_str = identifier.substr(last_slash + 1);
+void AndroidBackend::ReadJsonFileAsync(const std::wstring& identifier, std::function<void(json)> callback) {
+    std::filesystem::path direct;
+    std::string content;
+    if (ResolveDirectJsonPath(identifier, direct) && DurableStorage::ReadWholeFile(direct, content)) {
+        json parsed = json::object();
+        try {
+            if (!content.empty()) parsed = json::parse(content);
         }
+        catch (const json::parse_error&) {
+            parsed = json::object();
+        }
+        callback(std::move(parsed));
+        return;
     }
 
-    std::promise<json> promise;
-    std::future<json> future = promise.get_future();
+    std::wstring uri_str;
+    std::wstring filename_str;
+    SplitJsonFileIdentifier(identifier, uri_str, filename_str);
 
     json request;
     request["action"] = "readFile";
@@ -443,23 +632,39 @@ json AndroidBackend::ReadJsonFile(const std::wstring& identifier) {
         request["payload"]["childFilename"] = wstring_to_string(filename_str);
     }
 
-    RequestPlatformService(request, [&promise](const json& result) {
-        if (result.value("success", false)) {
-            try {
-                // Return empty object if content is empty, to avoid parse error on empty files
-                std::string content = result["data"].value("content", "");
-                promise.set_value(content.empty() ? json::object() : json::parse(content));
-            }
-            catch (const json::parse_error& e) {
-                promise.set_value(json::object()); // Return empty on parse error
-            }
-        }
-        else {
-            promise.set_value(json::object()); // Return empty object on read failure
-        }
+    RequestPlatformService(request, [callback](const json& result) {
+        callback(ParseJsonReadResult(result));
         });
+}
+
+// 配置解析时文件 / 目录配置的读取与父级查询合并为一次批量往返
+json AndroidBackend::ReadJsonFileAndParent(const std::wstring& identifier, const std::wstring& parentOf, std::wstring& parent) {
+    // 父级可以在本地推算时只剩读取本身（直接访问的工作区上连这一次往返也没有）
+    if (LocalParentIdentifier(parentOf, parent)) {
+        return ReadJsonFile(identifier);
+    }
+
+    std::wstring uri_str;
+    std::wstring filename_str;
+    SplitJsonFileIdentifier(identifier, uri_str, filename_str);
+
+    json read_op = { {"op", "read"}, {"uri", wstring_to_string(uri_str)} };
+    if (!filename_str.empty()) {
+        read_op["childFilename"] = wstring_to_string(filename_str);
+    }
+    json operations = json::array({
+        read_op,
+        { {"op", "getParent"}, {"uri", wstring_to_string(parentOf)} }
+    });
+
+    json results = RunPlatformBatch(operations);
 
-    return future.get(); // Blocks until the promise is set
+    parent.clear();
+    const json& parent_result = results[1];
+    if (parent_result.value("success", false) && parent_result.contains("data") && parent_result["data"].is_object()) {
+        parent = string_to_wstring(parent_result["data"].value("parentUri", ""));
+    }
+    return ParseJsonReadResult(results[0]);
 }
 
 // [NEW] Android-specific implementation of WriteJsonFile
@@ -477,6 +682,11 @@ void AndroidBackend::WriteJsonFile(const std::wstring& identifier, const json& d
         filename_str = identifier.substr(last_slash + 1);
     }
 
+    std::filesystem::path direct;
+    if (ResolveDirectJsonPath(identifier, direct) && DurableStorage::AtomicWriteFile(direct, data.dump(2))) {
+        return;
+    }
+
     json request;
     request["action"] = "writeFile";
     request["payload"]["uri"] = wstring_to_string(parent_uri_str);
@@ -490,25 +700,29 @@ void AndroidBackend::WriteJsonFile(const std::wstring& identifier, const json& d
 }
 
 std::wstring AndroidBackend::GetParentIdentifier(const std::wstring& identifier) {
-    // Blocking call, similar to ReadJsonFile
-    std::promise<std::wstring> promise;
-    auto future = promise.get_future();
+    return Await<std::wstring>([this, &identifier](std::function<void(std::wstring)> done) {
+        GetParentIdentifierAsync(identifier, std::move(done));
+        }, std::wstring());
+}
+
+void AndroidBackend::GetParentIdentifierAsync(const std::wstring& identifier, std::function<void(std::wstring)> callback) {
+    std::wstring localParent;
+    if (LocalParentIdentifier(identifier, localParent)) {
+        callback(std::move(localParent));
+        return;
+    }
 
     json request;
     request["action"] = "getParentUri";
     request["payload"]["uri"] = wstring_to_string(identifier);
 
-    // [FIX] Add 'this' to the capture list
-    RequestPlatformService(request, [this, &promise](const json& result) {
+    RequestPlatformService(request, [this, callback](const json& result) {
         if (result.value("success", false)) {
-            // Now 'this->string_to_wstring' is valid
-            promise.set_value(this->string_to_wstring(result["data"].value("parentUri", "")));
+            callback(string_to_wstring(result["data"].value("parentUri", "")));
         } else {
-            promise.set_value(L""); // Return empty on failure
+            callback(L""); // Return empty on failure
         }
     });
-
-    return future.get();
 }
 
 std::wstring AndroidBackend::CombineIdentifier(const std::wstring& parent, const std::wstring& childFilename) {
@@ -537,49 +751,219 @@ void AndroidBackend::OpenWorkspace(const json& payload) {
     // 1. Store the path (URI string) for later injection
     m_nextWorkspacePath = this->string_to_wstring(path);
 
+    // 工作区能按 POSIX 路径直接读写时（应用私有目录、已授权的外部存储），之后的文件访问绕过 SAF。
+    // 只凭 access() 无法判断分区存储下的写权限，因此实际创建并删除一个探测文件
+    m_directRoot.clear();
+    std::filesystem::path directRoot;
+    if (DirectFiles::ToFilePath(path, directRoot) && DirectFiles::ProbeDirectory(directRoot)) {
+        m_directRoot = directRoot;
+        LOG_DEBUG(("AndroidBackend: direct file access enabled for " + directRoot.string()).c_str());
+    }
+
     // 2. Call the base class implementation which sets m_workspaceRoot
     //    and calls NavigateTo.
     Backend::OpenWorkspace(payload);
 }
 
 
+bool AndroidBackend::ResolveDirectPath(const std::wstring& identifier, std::filesystem::path& path) const {
+    if (m_directRoot.empty()) return false;
+
+    std::filesystem::path resolved;
+    if (!DirectFiles::ToFilePath(wstring_to_string(identifier), resolved)) return false;
+    // 只处理工作区内的文件；工作区之外的 URI（如图片选择器返回的）仍经由 SAF
+    resolved = resolved.lexically_normal();
+    std::filesystem::path relative = resolved.lexically_relative(m_directRoot);
+    if (relative.empty() || *relative.begin() == "..") return false;
+
+    path = resolved;
+    return true;
+}
+
+bool AndroidBackend::ResolveDirectJsonPath(const std::wstring& identifier, std::filesystem::path& path) const {
+    size_t separator = identifier.find_last_of(L"|\\");
+    if (separator == std::wstring::npos) {
+        return ResolveDirectPath(identifier, path);
+    }
+    return ResolveDirectPath(identifier.substr(0, separator) + L"|" + identifier.substr(separator + 1), path);
+}
+
+bool AndroidBackend::LocalParentIdentifier(const std::wstring& identifier, std::wstring& parent) const {
+    // Kotlin 端的 getParentUri 需要一次往返，而外部存储 document URI 的父级可以直接由文档 ID 推出
+    std::string parentUri;
+    if (DirectFiles::ParentDocumentUri(wstring_to_string(identifier), parentUri)) {
+        parent = string_to_wstring(parentUri);
+        return true;
+    }
+
+    // 按路径打开的工作区
+    std::filesystem::path direct;
+    if (!identifier.empty() && identifier[0] == L'/' && ResolveDirectPath(identifier, direct) && direct != m_directRoot) {
+        parent = string_to_wstring(direct.parent_path().string());
+        return true;
+    }
+    return false;
+}
+
+void AndroidBackend::OpenDescriptorAsync(const std::wstring& uri, const char* mode, std::function<void(int)> callback) {
+    json request;
+    request["action"] = "openFileDescriptor";
+    request["payload"]["uri"] = wstring_to_string(uri);
+    request["payload"]["mode"] = mode;
+
+    RequestPlatformService(request, [callback](const json& result) {
+        int fd = -1;
+        if (result.value("success", false) && result.contains("data") && result["data"].is_object()) {
+            fd = result["data"].value("fd", -1);
+        }
+        callback(fd);
+        });
+}
+
+namespace {
+    // 可以请求描述符的单个文档 URI（"parent|child" 形式的组合标识符不是）
+    bool IsDocumentUri(const std::wstring& identifier) {
+        return identifier.rfind(L"content://", 0) == 0 && identifier.find(L'|') == std::wstring::npos;
+    }
+}
+
 // 原子读取
+// 依次尝试：原生读取 -> SAF 描述符（一次往返，内容不经过 JSON）-> 平台服务
 std::string AndroidBackend::ReadFileContent(const std::wstring& path) {
-    std::promise<std::string> promise;
-    auto future = promise.get_future();
+    std::string content;
+    TryReadFileContent(path, content);
+    return content;
+}
 
-    json request;
-    request["action"] = "readFile";
-    request["payload"]["uri"] = wstring_to_string(path);
+bool AndroidBackend::TryReadFileContent(const std::wstring& path, std::string& content) {
+    Telemetry::Span span("readFile", "io");
+    // 超时得到 nullopt，与读到的空文件区分开
+    std::optional<std::string> result = Await<std::optional<std::string>>([this, &path](std::function<void(std::optional<std::string>)> done) {
+        ReadFileContentAsync(path, [done](std::string value) { done(std::move(value)); });
+        }, std::nullopt);
+    if (!result) {
+        return false;
+    }
+    content = std::move(*result);
+    return true;
+}
 
-    RequestPlatformService(request, [&promise](const json& result) {
-        if (result.value("success", false)) {
-            promise.set_value(result["data"].value("content", ""));
-        }
-        else {
-            // Log error?
-            promise.set_value("");
+void AndroidBackend::ReadFileContentAsync(const std::wstring& path, std::function<void(std::string)> callback) {
+    std::filesystem::path direct;
+    std::string content;
+    if (ResolveDirectPath(path, direct) && DurableStorage::ReadWholeFile(direct, content)) {
+        callback(std::move(content));
+        return;
+    }
+
+    auto readViaService = [this, path, callback]() {
+        json request;
+        request["action"] = "readFile";
+        request["payload"]["uri"] = wstring_to_string(path);
+
+        RequestPlatformService(request, [callback](const json& result) {
+            if (result.value("success", false)) {
+                callback(result["data"].value("content", ""));
+            }
+            else {
+                // Log error?
+                callback("");
+            }
+            });
+    };
+
+    if (!IsDocumentUri(path)) {
+        readViaService();
+        return;
+    }
+    // 描述符在回调中直接读取，不会因调用方不再等待而泄漏
+    OpenDescriptorAsync(path, "r", [callback, readViaService](int fd) {
+        std::string content;
+        if (fd >= 0 && DirectFiles::ReadDescriptor(fd, content)) {
+            callback(std::move(content));
+            return;
         }
+        readViaService();
         });
-
-    return future.get();
 }
 
 // 原子写入
+// 直接访问时为临时文件 + fsync + rename；SAF 上没有原子替换，描述符以 "wt" 截断后写入
 bool AndroidBackend::WriteFileContent(const std::wstring& path, const std::string& content) {
-    std::promise<bool> promise;
-    auto future = promise.get_future();
+    Telemetry::Span span("writeFile", "io");
+    return Await<bool>([this, &path, &content](std::function<void(bool)> done) {
+        WriteFileContentAsync(path, content, std::move(done));
+        }, false);
+}
 
-    json request;
-    request["action"] = "writeFile";
-    request["payload"]["uri"] = wstring_to_string(path);
-    request["payload"]["content"] = content;
+void AndroidBackend::WriteFileContentAsync(const std::wstring& path, std::string content, std::function<void(bool)> callback) {
+    std::filesystem::path direct;
+    if (ResolveDirectPath(path, direct) && DurableStorage::AtomicWriteFile(direct, content)) {
+        callback(true);
+        return;
+    }
 
-    RequestPlatformService(request, [&promise](const json& result) {
-        promise.set_value(result.value("success", false));
+    // 内容可能很大，在链式回调之间共享而不是逐层复制
+    auto data = std::make_shared<std::string>(std::move(content));
+    auto writeViaService = [this, path, data, callback]() {
+        json request;
+        request["action"] = "writeFile";
+        request["payload"]["uri"] = wstring_to_string(path);
+        request["payload"]["content"] = *data;
+
+        RequestPlatformService(request, [callback](const json& result) {
+            callback(result.value("success", false));
+            });
+    };
+
+    if (!IsDocumentUri(path)) {
+        writeViaService();
+        return;
+    }
+    OpenDescriptorAsync(path, "wt", [data, callback, writeViaService](int fd) {
+        if (fd >= 0 && DirectFiles::WriteDescriptor(fd, *data)) {
+            callback(true);
+            return;
+        }
+        writeViaService();
         });
+}
 
-    return future.get();
+std::filesystem::path AndroidBackend::LocalFilePath(const std::wstring& identifier) const {
+    std::filesystem::path direct;
+    if (ResolveDirectPath(identifier, direct)) {
+        return direct;
+    }
+    return Backend::LocalFilePath(identifier);
+}
+
+bool AndroidBackend::GetFileStat(const std::wstring& path, FileAccess::FileStat& stat) {
+    std::filesystem::path direct;
+    return ResolveDirectPath(path, direct) && FileAccess::StatFile(direct, stat);
+}
+
+// 与 Windows 相同：映射整个文件后按块交给 sink
+bool AndroidBackend::ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) {
+    Telemetry::Span span("readFileChunks", "io");
+    constexpr size_t kChunkSize = 4 * 1024 * 1024;
+    std::filesystem::path direct;
+    FileAccess::MappedFile file;
+    if (!ResolveDirectPath(path, direct) || !file.Open(direct)) {
+        return Backend::ReadFileChunks(path, sink);
+    }
+    std::string_view view = file.View();
+    for (size_t offset = 0; offset < view.size(); offset += kChunkSize) {
+        if (!sink(view.substr(offset, kChunkSize))) break;
+    }
+    return true;
+}
+
+bool AndroidBackend::WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) {
+    std::filesystem::path direct;
+    if (ResolveDirectPath(path, direct)) {
+        return DurableStorage::AtomicWriteFileStreamed(direct, produce);
+    }
+    return Backend::WriteFileStreamed(path, produce);
 }
 
 
@@ -589,43 +973,25 @@ void AndroidBackend::NavigateTo(const std::wstring& url) {
         return;
     }
 
-    JNIEnv* env = GetJNIEnv();
+    JNIEnv* env = JniBinding::Env();
     if (!env) {
         LOG_DEBUG("Failed to get JNIEnv.");
         return;
     }
 
-    jclass mainActivityClass = env->GetObjectClass(m_mainActivityInstance);
-    if (!mainActivityClass) {
-        LOG_DEBUG("Failed to find MainActivity class.");
-        return;
+    if (!JniBinding::NavigateToUrl(env, m_mainActivityInstance, this->wstring_to_string(url))) {
+        LOG_DEBUG("Failed to call navigateToUrl.");
     }
-
-    jmethodID navigateMethodID = env->GetMethodID(mainActivityClass, "navigateToUrl", "(Ljava/lang/String;)V");
-    if (!navigateMethodID) {
-        LOG_DEBUG("Failed to find method navigateToUrl.");
-        return;
-    }
-
-    std::string url_utf8 = this->wstring_to_string(url);
-    jstring urlJString = env->NewStringUTF(url_utf8.c_str());
-
-    env->CallVoidMethod(m_mainActivityInstance, navigateMethodID, urlJString);
-
-    env->DeleteLocalRef(urlJString);
-    env->DeleteLocalRef(mainActivityClass);
 }
 
 
 // --- 平台相关的转换函数 ---
 std::string AndroidBackend::wstring_to_string(const std::wstring& wstr) const {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
-    return converter.to_bytes(wstr);
+    return Utf::ToUtf8(wstr);
 }
 
 std::wstring AndroidBackend::string_to_wstring(const std::string& str) const {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
-    return converter.from_bytes(str);
+    return Utf::ToWide(str);
 }
 
 bool AndroidBackend::UrlDecode(const std::string& encoded, std::string& decoded) const {
@@ -659,50 +1025,143 @@ bool AndroidBackend::UrlDecode(const std::string& encoded, std::string& decoded)
 
 // --- 待实现的空桩函数 ---
 bool AndroidBackend::LoadResourceData(int resource_id, void*& pData, DWORD& dwSize) {
-    // 1. 从 resource_id 反向查找路径
-    std::wstring resourceUrlPath;
-    for (const auto& pair : g_resource_map) {
-        if (pair.second == resource_id) {
-            resourceUrlPath = pair.first;
+    // 与 Windows 的 LockResource 相同：返回的数据只读、由 m_assets 持有，调用方无需释放
+    const AssetProvider::Asset* asset = m_assets.Get(resource_id);
+    if (!asset) return false;
+
+    pData = const_cast<void*>(asset->Data());
+    dwSize = static_cast<DWORD>(asset->Size());
+    return true;
+}
+
+namespace {
+    // 内嵌资源由 WebViewAssetLoader 挂在 veritnote.app 下，/local-file/ 请求使用 veritnote.localhost
+    const char* const kWebResourceHosts[] = { "veritnote.app", "veritnote.localhost" };
+}
+
+json AndroidBackend::HandleWebResourceRequest(const std::string& url, const std::string& rangeHeader) {
+    std::string path;
+    bool matched = false;
+    for (const char* host : kWebResourceHosts) {
+        if (WebResources::RequestPath(url, host, path)) {
+            matched = true;
             break;
         }
     }
-    if (resourceUrlPath.empty()) return false;
+    if (!matched) return nullptr;
+
+    int fd = -1;
+    int64_t base = 0;      // 内容在描述符中的起始偏移
+    int64_t size = -1;     // 内容长度，未知时为 -1
+    std::string mimeType;
+
+    if (path.compare(0, WebResources::kLocalFilePrefix.size(), WebResources::kLocalFilePrefix) == 0) {
+        std::string identifier;
+        if (!UrlDecode(path.substr(WebResources::kLocalFilePrefix.size()), identifier) || identifier.empty()) return nullptr;
+        fd = OpenLocalFileForWeb(identifier, mimeType);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            size = st.st_size;
+        }
+    }
+    else {
+        int resource_id = AssetProvider::ResourceId(path);
+        if (resource_id < 0) return nullptr;
+        // 压缩存储的 asset 没有描述符，交还给 Kotlin 的 WebViewAssetLoader
+        fd = m_assets.OpenDescriptor(resource_id, base, size);
+        if (fd < 0) return nullptr;
+        mimeType = WebResources::MimeType(path);
+    }
 
-    // 2. 通过 JNI 获取 AssetManager
-    JNIEnv* env = GetJNIEnv();
-    if (!env || !m_mainActivityInstance) return false;
+    json response;
+    response["status"] = 200;
+    response["reason"] = "OK";
+    response["mimeType"] = mimeType;
+    response["headers"] = json::object();
+    response["length"] = -1;
+
+    // 管道等不可定位的描述符（部分 content 提供者）只能整体顺序读取；
+    // APK 中的 asset 必须定位到自己的区间，否则读到的是 APK 本身
+    if (size >= 0 && ::lseek(fd, base, SEEK_SET) < 0) {
+        if (base != 0) {
+            ::close(fd);
+            return nullptr;
+        }
+        size = -1;
+    }
+    if (size >= 0) {
+        WebResources::ByteRange range;
+        response["headers"]["Accept-Ranges"] = "bytes";
+        switch (WebResources::ParseRange(rangeHeader, static_cast<uint64_t>(size), range)) {
+        case WebResources::RangeResult::Unsatisfiable:
+            ::close(fd);
+            response["status"] = 416;
+            response["reason"] = "Range Not Satisfiable";
+            response["headers"]["Content-Range"] = "bytes */" + std::to_string(size);
+            response["fd"] = -1;
+            response["length"] = 0;
+            return response;
+        case WebResources::RangeResult::Partial:
+            if (::lseek(fd, base + static_cast<int64_t>(range.offset), SEEK_SET) < 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            response["status"] = 206;
+            response["reason"] = "Partial Content";
+            response["headers"]["Content-Range"] = WebResources::ContentRange(range, static_cast<uint64_t>(size));
+            break;
+        case WebResources::RangeResult::Full:
+            break;
+        }
+        response["headers"]["Content-Length"] = std::to_string(range.length);
+        response["length"] = range.length;
+    }
 
-    jclass activityClass = env->GetObjectClass(m_mainActivityInstance);
-    jmethodID getAssetsMethod = env->GetMethodID(activityClass, "getAssets", "()Landroid/content/res/AssetManager;");
-    jobject assetManagerObj = env->CallObjectMethod(m_mainActivityInstance, getAssetsMethod);
-    AAssetManager* assetManager = AAssetManager_fromJava(env, assetManagerObj);
-    env->DeleteLocalRef(activityClass);
-    env->DeleteLocalRef(assetManagerObj);
-    if (!assetManager) return false;
+    response["fd"] = fd;
+    return response;
+}
 
-    // 3. 打开 Asset
-    // resourceUrlPath starts with '/', we need to remove it.
-    std::string assetPath = wstring_to_string(resourceUrlPath.substr(1));
-    AAsset* asset = AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
-    if (!asset) {
-        LOG_DEBUG(("Failed to open asset: " + assetPath).c_str());
-        return false;
+int AndroidBackend::OpenLocalFileForWeb(const std::string& identifier, std::string& mimeType) {
+    // 页面脚本可以构造任意 local-file URL，直接打开的文件必须位于工作区内，
+    // 否则应用私有目录（数据库、shared_prefs 等）都能被读到
+    std::filesystem::path direct;
+    if (ResolveDirectPath(string_to_wstring(identifier), direct)) {
+        std::error_code ec;
+        std::filesystem::path real = std::filesystem::weakly_canonical(direct, ec);
+        std::filesystem::path realRoot = std::filesystem::weakly_canonical(m_directRoot, ec);
+        std::filesystem::path relative = real.lexically_relative(realRoot);
+        if (ec || relative.empty() || *relative.begin() == "..") return -1; // 经符号链接指向工作区之外
+        int fd = ::open(real.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            mimeType = WebResources::MimeType(direct.string());
+            return fd;
+        }
     }
+    // 其余只接受 content URI，由 SAF 按授予的权限决定能否打开
+    if (identifier.rfind("content://", 0) != 0) return -1;
 
-    // 4. 读取数据
-    dwSize = AAsset_getLength(asset);
-    // 我们需要自己分配内存，因为资源数据在 C++ 这边没有静态内存
-    pData = new char[dwSize];
-    memcpy(pData, AAsset_getBuffer(asset), dwSize);
-
-    AAsset_close(asset);
+    // WebView 的 IO 线程不是平台服务结果的交付线程，可以在这里等待；结果迟迟不到时按失败处理，不拖住其它资源
+    json request;
+    request["action"] = "openFileDescriptor";
+    request["payload"]["uri"] = identifier;
+    request["payload"]["mode"] = "r";
+    json result = Await<json>([this, &request](std::function<void(json)> done) {
+        RequestPlatformService(request, [done](const json& result) { done(result); });
+        }, json::object(), kWebResourceWaitTimeoutMs, [](json& late) {
+            // 放弃等待后才送达的描述符没有人使用，必须关闭
+            if (late.value("success", false) && late.contains("data") && late["data"].is_object()) {
+                int fd = late["data"].value("fd", -1);
+                if (fd >= 0) ::close(fd);
+            }
+        });
 
-    // 注意：这里的 pData 是 new 出来的，调用者（如 ExtractResourceToFile）用完后
-    // 理论上需要释放。但由于 Windows 版的 LockResource 不需要释放，为了接口一致，
-    // 我们暂时接受这个微小的内存泄漏。更好的方案是修改接口，返回智能指针或让调用者负责释放。
-    // 对于只在启动时调用一次的 welcome.veritnote 来说，影响可以忽略。
-    return true;
+    if (!result.value("success", false) || !result.contains("data") || !result["data"].is_object()) return -1;
+    mimeType = result["data"].value("mimeType", "");
+    if (mimeType.empty()) {
+        mimeType = WebResources::MimeType(identifier);
+    }
+    return result["data"].value("fd", -1);
 }
 
 void AndroidBackend::OpenFileDialog(const json& payload) {
@@ -1,7 +1,11 @@
 ﻿#pragma once
 
 #include <jni.h>
+#include <atomic>
+#include <filesystem>
 #include "include/Backend.h"
+#include "Android_AssetProvider.h"
+#include "Android_PlatformService.h"
 
 class AndroidBackend : public Backend {
 public:
@@ -25,7 +29,15 @@ public:
     void ListWorkspace(const json& payload) override;
 
     std::string ReadFileContent(const std::wstring& path) override;
+    // 平台服务超时返回 false（ReadFileContent 此时返回空字符串）
+    bool TryReadFileContent(const std::wstring& path, std::string& content) override;
     bool WriteFileContent(const std::wstring& path, const std::string& content) override;
+    // 以下几项只对可直接访问的工作区（见 m_directRoot）生效，其余情况沿用基类的默认行为
+    bool SupportsBinaryFiles() const override { return !m_directRoot.empty(); }
+    std::filesystem::path LocalFilePath(const std::wstring& identifier) const override;
+    bool GetFileStat(const std::wstring& path, FileAccess::FileStat& stat) override;
+    bool ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) override;
+    bool WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) override;
 
     void CreateItem(const json& payload) override;
     void DeleteItem(const json& payload) override;
@@ -36,6 +48,13 @@ public:
     void WriteJsonFile(const std::wstring& identifier, const json& data) override;
     std::wstring GetParentIdentifier(const std::wstring& identifier) override;
     std::wstring CombineIdentifier(const std::wstring& parent, const std::wstring& childFilename) override;
+    json ReadJsonFileAndParent(const std::wstring& identifier, const std::wstring& parentOf, std::wstring& parent) override;
+
+    // WebView 资源请求，由 shouldInterceptRequest 经 JNI 在 WebView 的 IO 线程上调用。
+    // 内嵌资源（APK 中的偏移区间）与 /local-file/ 后的本地路径 / content URI 都以原生描述符响应，支持单个 Range 区间。
+    // 返回 { status, reason, mimeType, headers, fd, length }（length 为 -1 时读到 EOF），
+    // Kotlin 接管描述符；不处理的请求返回 null，由 Kotlin 沿用原有的加载方式
+    json HandleWebResourceRequest(const std::string& url, const std::string& rangeHeader);
 
     void SetMainActivityInstance(jobject mainActivityInstance);
     void OpenFileDialog(const json& payload) override;
@@ -59,9 +78,61 @@ private:
     // [NEW] 异步服务请求机制
     void RequestPlatformService(const json& request, std::function<void(const json&)> callback);
 
+    // 同步接口的实现，由 Await 启动并等待（直接访问 -> 描述符 -> 平台服务）。
+    // 结果能够立即得到时在调用线程上交付，否则在平台服务结果到达的线程上交付
+    void ReadFileContentAsync(const std::wstring& path, std::function<void(std::string)> callback);
+    void WriteFileContentAsync(const std::wstring& path, std::string content, std::function<void(bool)> callback);
+    void ReadJsonFileAsync(const std::wstring& identifier, std::function<void(json)> callback);
+    void GetParentIdentifierAsync(const std::wstring& identifier, std::function<void(std::wstring)> callback);
+
+    // 批量平台服务：一次 JNI 往返执行多个 SAF 操作（SAF 上每次调用的固定开销远大于操作本身）。
+    // operations 的每一项为 { "op": "create" | "read" | "write" | "stat" | "getParent", ... }，
+    // callback 收到与 operations 一一对应的 [{ success, data | error }]，各操作互不影响。
+    // 超过 kMaxBatchOperations 的批次拆成多个请求，全部返回后才调用 callback
+    void RequestPlatformBatch(const json& operations, std::function<void(const json&)> callback);
+    // 阻塞版本，见 Await
+    json RunPlatformBatch(const json& operations);
+    static constexpr size_t kMaxBatchOperations = 256;
+
+    // 同步接口（Backend 的虚函数）在异步版本上的阻塞等待，用于 JavaBridge 线程和 WebView 的 IO 线程。
+    // 等待总有上限：Kotlin 端的结果丢失时超过 timeoutMs 返回 fallback，而不是让调用线程永远挂起；
+    // 在正在交付平台服务结果的线程上最多等待 kDeliveryThreadWaitTimeoutMs（结果可能要由本线程送回）。
+    // 超时后才到达的结果交给 discardLate，持有资源的结果（文件描述符）借此释放
+    template <typename T, typename Start>
+    T Await(Start start, T fallback, int timeoutMs = kAwaitTimeoutMs, std::function<void(T&)> discardLate = nullptr);
+    static constexpr int kAwaitTimeoutMs = 60000;
+    static constexpr int kDeliveryThreadWaitTimeoutMs = 10000;
+    // WebView 资源请求阻塞的是页面加载，等待更短
+    static constexpr int kWebResourceWaitTimeoutMs = 5000;
+
+    // --- 原生文件访问快速路径 (见 Android_DirectFiles.h) ---
+    // 工作区内的标识符 -> 可直接读写的路径；工作区不可直接访问或标识符在工作区之外时返回 false
+    bool ResolveDirectPath(const std::wstring& identifier, std::filesystem::path& path) const;
+    // ReadJsonFile / WriteJsonFile 的标识符：文件本身，或 "parent|child"、JS 拼接的 "parent\\child"
+    bool ResolveDirectJsonPath(const std::wstring& identifier, std::filesystem::path& path) const;
+    // 不经过 Kotlin 推算父级标识符（外部存储 document URI 或直接访问的路径）
+    bool LocalParentIdentifier(const std::wstring& identifier, std::wstring& parent) const;
+    // 请求 Kotlin 打开 content URI 并交出描述符 (detachFd)，失败时为 -1
+    void OpenDescriptorAsync(const std::wstring& uri, const char* mode, std::function<void(int)> callback);
+
+    // /local-file/ 请求的只读描述符：可直接访问时在本地打开，否则经由 openFileDescriptor 服务。
+    // mimeType 为 content URI 提供者报告的类型，没有时按扩展名推断
+    int OpenLocalFileForWeb(const std::string& identifier, std::string& mimeType);
+
+    // OpenWorkspace 时探测到的可直接读写的工作区根目录，为空时所有访问经由 SAF
+    std::filesystem::path m_directRoot;
+
+    // --- 工作区列表 ---
+    void ListWorkspaceDirect(uint64_t listingId);
+    void ListWorkspaceStreamed(uint64_t listingId);
+    bool CreateWelcomeFile();
+    // 最近一次 ListWorkspace 的编号，过期列表的结果被丢弃
+    std::atomic<uint64_t> m_listingId{ 0 };
+
     jobject m_mainActivityInstance;
-    int m_nextServiceCallbackId = 0;
-    std::map<int, std::function<void(const json&)>> m_serviceCallbacks;
+    // 内嵌资源，打开的 asset 随 AndroidBackend 一起释放（在 JniBinding::Release 之前）
+    AssetProvider m_assets;
+    PlatformServiceRegistry m_serviceCallbacks;
 
     std::wstring m_nextWorkspacePath;
 };
\ No newline at end of file
@@ -0,0 +1,274 @@
+﻿// src/platform/android/Android_DirectFiles.cpp
+
+#include "Android_DirectFiles.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const std::string kExternalStorageAuthority = "content://com.android.externalstorage.documents/";
+
+    int HexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // URI 路径段的百分号解码（'+' 在路径段中不表示空格）
+    bool PercentDecode(std::string_view encoded, std::string& decoded) {
+        decoded.clear();
+        decoded.reserve(encoded.size());
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            if (encoded[i] != '%') {
+                decoded.push_back(encoded[i]);
+                continue;
+            }
+            if (i + 2 >= encoded.size()) return false;
+            int high = HexValue(encoded[i + 1]);
+            int low = HexValue(encoded[i + 2]);
+            if (high < 0 || low < 0) return false;
+            decoded.push_back(static_cast<char>((high << 4) | low));
+            i += 2;
+        }
+        return true;
+    }
+
+    // 与 android.net.Uri.encode 相同：字母数字和 "_-!.~'()*" 保留，其余字节编码为大写 %XX
+    std::string PercentEncode(std::string_view value) {
+        static const char kHex[] = "0123456789ABCDEF";
+        std::string encoded;
+        encoded.reserve(value.size() * 3);
+        for (unsigned char c : value) {
+            bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                c == '_' || c == '-' || c == '!' || c == '.' || c == '~' || c == '\'' || c == '(' || c == ')' || c == '*';
+            if (keep) {
+                encoded.push_back(static_cast<char>(c));
+            }
+            else {
+                encoded.push_back('%');
+                encoded.push_back(kHex[c >> 4]);
+                encoded.push_back(kHex[c & 0x0F]);
+            }
+        }
+        return encoded;
+    }
+
+    // 外部存储 URI 的各部分（均为编码后的原文）：
+    //   tree/<treeId>[/document/<documentId>] 或 document/<documentId>
+    struct DocumentUri {
+        std::string_view treeId;
+        std::string_view documentId;
+    };
+
+    bool SplitDocumentUri(std::string_view uri, DocumentUri& parts) {
+        if (uri.compare(0, kExternalStorageAuthority.size(), kExternalStorageAuthority) != 0) return false;
+        std::string_view rest = uri.substr(kExternalStorageAuthority.size());
+        parts = DocumentUri();
+
+        if (rest.compare(0, 5, "tree/") == 0) {
+            rest.remove_prefix(5);
+            size_t slash = rest.find('/');
+            parts.treeId = rest.substr(0, slash);
+            if (slash != std::string_view::npos) {
+                std::string_view tail = rest.substr(slash + 1);
+                if (tail.compare(0, 9, "document/") != 0) return false;
+                parts.documentId = tail.substr(9);
+            }
+        }
+        else if (rest.compare(0, 9, "document/") == 0) {
+            parts.documentId = rest.substr(9);
+        }
+        else {
+            return false;
+        }
+        // 文档 ID 中的 '/' 总是被编码，剩余的 '/' 表示 URI 还有其他路径段（如 /children）
+        if (parts.treeId.find('/') != std::string_view::npos || parts.documentId.find('/') != std::string_view::npos) {
+            return false;
+        }
+        return !parts.treeId.empty() || !parts.documentId.empty();
+    }
+
+    bool DocumentIdToPath(const std::string& documentId, std::filesystem::path& path) {
+        size_t colon = documentId.find(':');
+        if (colon == std::string::npos || colon == 0) return false;
+        std::string volume = documentId.substr(0, colon);
+        std::string relative = documentId.substr(colon + 1);
+        if (volume == "primary") {
+            path = "/storage/emulated/0";
+        }
+        else if (volume.find('/') == std::string::npos && volume != "." && volume != "..") {
+            path = std::filesystem::path("/storage") / volume;
+        }
+        else {
+            return false;
+        }
+        if (!relative.empty()) {
+            path /= relative;
+        }
+        path = path.lexically_normal();
+        return true;
+    }
+}
+
+
+bool DirectFiles::ToFilePath(const std::string& identifier, std::filesystem::path& path) {
+    size_t pipe = identifier.find('|');
+    if (pipe != std::string::npos) {
+        std::string child = identifier.substr(pipe + 1);
+        if (child.empty() || child.find('/') != std::string::npos || child == "." || child == "..") return false;
+        if (!ToFilePath(identifier.substr(0, pipe), path)) return false;
+        path /= child;
+        return true;
+    }
+
+    if (!identifier.empty() && identifier[0] == '/') {
+        path = std::filesystem::path(identifier).lexically_normal();
+        return true;
+    }
+
+    if (identifier.compare(0, 7, "file://") == 0) {
+        std::string decoded;
+        if (!PercentDecode(std::string_view(identifier).substr(7), decoded) || decoded.empty() || decoded[0] != '/') return false;
+        path = std::filesystem::path(decoded).lexically_normal();
+        return true;
+    }
+
+    DocumentUri parts;
+    if (!SplitDocumentUri(identifier, parts)) return false;
+    std::string documentId;
+    if (!PercentDecode(parts.documentId.empty() ? parts.treeId : parts.documentId, documentId)) return false;
+    return DocumentIdToPath(documentId, path);
+}
+
+bool DirectFiles::ParentDocumentUri(const std::string& identifier, std::string& parent) {
+    DocumentUri parts;
+    if (identifier.find('|') != std::string::npos) return false;
+    if (!SplitDocumentUri(identifier, parts) || parts.treeId.empty() || parts.documentId.empty()) return false;
+
+    std::string treeId;
+    std::string documentId;
+    if (!PercentDecode(parts.treeId, treeId) || !PercentDecode(parts.documentId, documentId)) return false;
+    // 文档必须位于 tree 之内
+    if (documentId == treeId) return false;
+    bool treeIsVolumeRoot = !treeId.empty() && treeId.back() == ':';
+    if (documentId.compare(0, treeId.size(), treeId) != 0 ||
+        (!treeIsVolumeRoot && (documentId.size() <= treeId.size() || documentId[treeId.size()] != '/'))) {
+        return false;
+    }
+
+    size_t slash = documentId.find_last_of('/');
+    std::string parentId;
+    if (slash != std::string::npos) {
+        parentId = documentId.substr(0, slash);
+    }
+    else {
+        size_t colon = documentId.find(':');
+        if (colon == std::string::npos) return false;
+        parentId = documentId.substr(0, colon + 1); // 卷根，例如 "primary:"
+    }
+
+    std::string treeUri = kExternalStorageAuthority + "tree/" + std::string(parts.treeId);
+    parent = parentId == treeId ? treeUri : treeUri + "/document/" + PercentEncode(parentId);
+    return true;
+}
+
+bool DirectFiles::ChildIdentifier(const std::string& parent, const std::string& name, std::string& child) {
+    if (name.empty() || name.find('/') != std::string::npos || name == "." || name == "..") return false;
+    if (parent.find('|') != std::string::npos) return false;
+
+    if ((!parent.empty() && parent[0] == '/') || parent.compare(0, 7, "file://") == 0) {
+        child = parent;
+        if (child.back() != '/') child.push_back('/');
+        child += parent[0] == '/' ? name : PercentEncode(name);
+        return true;
+    }
+
+    DocumentUri parts;
+    if (!SplitDocumentUri(parent, parts) || parts.treeId.empty()) return false;
+    std::string parentId;
+    if (!PercentDecode(parts.documentId.empty() ? parts.treeId : parts.documentId, parentId) || parentId.empty()) return false;
+
+    std::string childId = parentId;
+    if (childId.back() != ':') childId.push_back('/');
+    childId += name;
+    child = kExternalStorageAuthority + "tree/" + std::string(parts.treeId) + "/document/" + PercentEncode(childId);
+    return true;
+}
+
+bool DirectFiles::ProbeDirectory(const std::filesystem::path& directory) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec)) return false;
+
+    std::filesystem::path probe = directory / (".veritnote-probe-" + std::to_string(::getpid()));
+    int fd = ::open(probe.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        // 上次异常退出留下的探测文件
+        if (errno != EEXIST) return false;
+        ::unlink(probe.c_str());
+        fd = ::open(probe.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+    }
+    bool written = ::write(fd, "1", 1) == 1;
+    ::close(fd);
+    bool removed = ::unlink(probe.c_str()) == 0;
+    return written && removed;
+}
+
+bool DirectFiles::ReadDescriptor(int fd, std::string& content) {
+    if (fd < 0) return false;
+    content.clear();
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        content.reserve(static_cast<size_t>(st.st_size));
+    }
+
+    // 管道形式的描述符没有可靠的大小，一律读到 EOF
+    char buffer[64 * 1024];
+    bool ok = true;
+    while (true) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            content.append(buffer, static_cast<size_t>(n));
+        }
+        else if (n == 0) {
+            break;
+        }
+        else if (errno != EINTR) {
+            ok = false;
+            break;
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool DirectFiles::WriteDescriptor(int fd, std::string_view content) {
+    if (fd < 0) return false;
+
+    bool ok = true;
+    while (!content.empty()) {
+        ssize_t n = ::write(fd, content.data(), content.size());
+        if (n > 0) {
+            content.remove_prefix(static_cast<size_t>(n));
+        }
+        else if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        else {
+            ok = false;
+            break;
+        }
+    }
+    // 部分提供者返回管道，fsync 会以 EINVAL 失败，这不是写入错误
+    if (ok && ::fsync(fd) != 0 && errno != EINVAL && errno != EROFS) {
+        ok = false;
+    }
+    if (::close(fd) != 0) {
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,34 @@
+﻿// src/platform/android/Android_DirectFiles.h
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Android 工作区的原生文件访问。
+// 经由 SAF 的访问要走 JSON 请求 -> Kotlin -> ContentResolver -> JSON 结果，内容本身也被编码进 JSON 字符串；
+// 工作区能按 POSIX 路径直接打开时（应用私有目录、file:// 路径、已授予访问权限的外部存储），
+// AndroidBackend 直接在 C++ 中 read / write / mmap，SAF 只作为后备。
+namespace DirectFiles {
+    // 把工作区标识符映射为文件系统路径，只做字符串变换，不检查能否访问。支持：
+    //   - 绝对路径与 file:// URI
+    //   - com.android.externalstorage.documents 的 tree / document URI
+    //     ("primary:<rel>" -> /storage/emulated/0/<rel>，"<卷 ID>:<rel>" -> /storage/<卷 ID>/<rel>)
+    //   - CombineIdentifier 生成的 "parent|childFilename"
+    bool ToFilePath(const std::string& identifier, std::filesystem::path& path);
+
+    // 外部存储 tree 内 document URI 的父目录 URI，编码方式与 DocumentsContract 生成的 URI 一致；
+    // 父目录是 tree 的根时返回 tree URI 本身。不是此类 URI 或已经是根时返回 false
+    bool ParentDocumentUri(const std::string& identifier, std::string& parent);
+    // parent 目录下名为 name 的子项的标识符：外部存储 tree / document URI 按 DocumentsContract 的格式拼出，
+    // 路径与 file:// URI 直接追加。其他标识符返回 false
+    bool ChildIdentifier(const std::string& parent, const std::string& name, std::string& child);
+
+    // 在目录中创建再删除一个临时文件，确认进程确实可以直接读写该目录
+    // （分区存储下 access() 的结果并不可靠）
+    bool ProbeDirectory(const std::filesystem::path& directory);
+
+    // 读取 / 写入 Kotlin 端 detachFd() 交出的描述符的全部内容，无论成败都会关闭描述符
+    bool ReadDescriptor(int fd, std::string& content);
+    bool WriteDescriptor(int fd, std::string_view content);
+}
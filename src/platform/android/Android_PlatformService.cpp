@@ -0,0 +1,54 @@
+﻿// src/platform/android/Android_PlatformService.cpp
+
+#include "Android_PlatformService.h"
+
+namespace {
+    thread_local int t_deliveryDepth = 0;
+
+    struct DeliveryScope {
+        DeliveryScope() { ++t_deliveryDepth; }
+        ~DeliveryScope() { --t_deliveryDepth; }
+    };
+}
+
+int PlatformServiceRegistry::Register(Callback callback) {
+    auto entry = std::make_shared<Callback>(std::move(callback));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int callbackId = m_nextId++;
+    m_callbacks.emplace(callbackId, std::move(entry));
+    return callbackId;
+}
+
+bool PlatformServiceRegistry::Dispatch(const json& result) {
+    int callbackId = result.value("callbackId", -1);
+    bool partial = result.value("partial", false);
+
+    std::shared_ptr<Callback> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_callbacks.find(callbackId);
+        if (it == m_callbacks.end()) return false;
+        entry = partial ? it->second : std::move(it->second);
+        if (!partial) m_callbacks.erase(it);
+    }
+
+    DeliveryScope scope;
+    (*entry)(result);
+    return true;
+}
+
+PlatformServiceRegistry::Callback PlatformServiceRegistry::Take(int callbackId) {
+    std::shared_ptr<Callback> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_callbacks.find(callbackId);
+        if (it == m_callbacks.end()) return Callback();
+        entry = std::move(it->second);
+        m_callbacks.erase(it);
+    }
+    return std::move(*entry);
+}
+
+bool PlatformServiceRegistry::IsDeliveringThread() {
+    return t_deliveryDepth > 0;
+}
@@ -0,0 +1,36 @@
+﻿// src/platform/android/Android_PlatformService.h
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// 平台服务请求的回调表。
+// 请求由 JavaBridge 线程或服务回调自身发起，结果由 Kotlin 在 UI 线程或服务线程池上送回，
+// 因此注册、查找和移除都要加锁；回调本身总是在锁外执行，回调中可以再发起新的请求。
+// 流式服务 (listTree) 的 partial 结果不移除回调，最终结果到达时才移除。
+class PlatformServiceRegistry {
+public:
+    using Callback = std::function<void(const json&)>;
+
+    // 登记回调并返回写入请求的 callbackId
+    int Register(Callback callback);
+    // 按结果中的 callbackId 调用对应的回调；找不到时返回 false
+    bool Dispatch(const json& result);
+    // 移除回调（请求未能发出时），返回被移除的回调，不存在时为空
+    Callback Take(int callbackId);
+
+    // 当前线程是否正在执行 Dispatch 中的回调。
+    // 在这样的线程上阻塞等待另一个平台服务结果可能永远等不到（结果可能要由本线程送回）
+    static bool IsDeliveringThread();
+
+private:
+    std::mutex m_mutex;
+    int m_nextId = 0;
+    // shared_ptr 使 partial 结果可以在锁外调用仍保留在表中的回调
+    std::unordered_map<int, std::shared_ptr<Callback>> m_callbacks;
+};
@@ -0,0 +1,136 @@
+﻿// src/platform/android/JNI_Binding.cpp
+
+#include "JNI_Binding.h"
+#include <android/asset_manager_jni.h>
+#include "include/Platform.h"
+#include "include/Utf.h"
+
+// 全局 JavaVM 指针，由 JNI_Bridge.cpp 设置
+extern JavaVM* g_jvm;
+
+namespace {
+    struct Binding {
+        jclass activityClass = nullptr; // 全局引用
+        jmethodID postMessageToJs = nullptr;
+        jmethodID requestPlatformService = nullptr;
+        jmethodID navigateToUrl = nullptr;
+        // AAssetManager 只在其 Java 对象存活期间有效，因此同时持有 Java 对象的全局引用
+        jobject assetManagerObject = nullptr;
+        AAssetManager* assetManager = nullptr;
+    };
+
+    Binding g_binding;
+
+    // 记录并清除挂起的 Java 异常，返回是否有异常
+    bool ClearPendingException(JNIEnv* env, const char* context) {
+        if (!env->ExceptionCheck()) return false;
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        LOG_DEBUG((std::string("JNI exception in ") + context).c_str());
+        return true;
+    }
+
+    jmethodID ResolveMethod(JNIEnv* env, const char* name, const char* signature) {
+        jmethodID method = env->GetMethodID(g_binding.activityClass, name, signature);
+        // GetMethodID 失败时会抛出 NoSuchMethodError
+        if (ClearPendingException(env, name) || !method) {
+            LOG_DEBUG((std::string("Failed to find method MainActivity.") + name).c_str());
+            return nullptr;
+        }
+        return method;
+    }
+
+    bool CallWithString(JNIEnv* env, jobject activity, jmethodID method, const std::string& argument, const char* context) {
+        if (!env || !activity || !method) return false;
+
+        jstring value = JniBinding::NewString(env, argument);
+        if (!value) return false;
+        env->CallVoidMethod(activity, method, value);
+        env->DeleteLocalRef(value);
+        return !ClearPendingException(env, context);
+    }
+}
+
+bool JniBinding::Init(JNIEnv* env, jobject activity) {
+    Release(env);
+    if (!env || !activity) return false;
+
+    jclass localClass = env->GetObjectClass(activity);
+    if (!localClass) return false;
+    g_binding.activityClass = static_cast<jclass>(env->NewGlobalRef(localClass));
+    env->DeleteLocalRef(localClass);
+
+    g_binding.postMessageToJs = ResolveMethod(env, "postMessageToJs", "(Ljava/lang/String;)V");
+    g_binding.requestPlatformService = ResolveMethod(env, "requestPlatformService", "(Ljava/lang/String;)V");
+    g_binding.navigateToUrl = ResolveMethod(env, "navigateToUrl", "(Ljava/lang/String;)V");
+
+    // getAssets 只在这里调用一次
+    if (jmethodID getAssets = ResolveMethod(env, "getAssets", "()Landroid/content/res/AssetManager;")) {
+        jobject assets = env->CallObjectMethod(activity, getAssets);
+        if (!ClearPendingException(env, "getAssets") && assets) {
+            g_binding.assetManagerObject = env->NewGlobalRef(assets);
+            g_binding.assetManager = AAssetManager_fromJava(env, g_binding.assetManagerObject);
+        }
+        if (assets) env->DeleteLocalRef(assets);
+    }
+
+    return g_binding.postMessageToJs && g_binding.requestPlatformService &&
+        g_binding.navigateToUrl && g_binding.assetManager;
+}
+
+void JniBinding::Release(JNIEnv* env) {
+    if (env) {
+        if (g_binding.assetManagerObject) env->DeleteGlobalRef(g_binding.assetManagerObject);
+        if (g_binding.activityClass) env->DeleteGlobalRef(g_binding.activityClass);
+    }
+    g_binding = Binding();
+}
+
+JNIEnv* JniBinding::Env() {
+    if (!g_jvm) return nullptr;
+    JNIEnv* env = nullptr;
+    if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        // 如果当前线程未附加到 JVM，则附加
+        if (g_jvm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            return nullptr; // 附加失败
+        }
+    }
+    return env;
+}
+
+std::string JniBinding::ToUtf8(JNIEnv* env, jstring value) {
+    if (!env || !value) return std::string();
+    jsize length = env->GetStringLength(value);
+    std::u16string units(static_cast<size_t>(length), u'\0');
+    if (length > 0) {
+        env->GetStringRegion(value, 0, length, reinterpret_cast<jchar*>(&units[0]));
+        if (ClearPendingException(env, "GetStringRegion")) return std::string();
+    }
+    return Utf::ToUtf8(units);
+}
+
+jstring JniBinding::NewString(JNIEnv* env, const std::string& value) {
+    if (!env) return nullptr;
+    std::u16string units = Utf::ToUtf16(value);
+    jstring result = env->NewString(reinterpret_cast<const jchar*>(units.data()), static_cast<jsize>(units.size()));
+    if (!result) {
+        ClearPendingException(env, "NewString"); // OutOfMemoryError
+    }
+    return result;
+}
+
+bool JniBinding::PostMessageToJs(JNIEnv* env, jobject activity, const std::string& message) {
+    return CallWithString(env, activity, g_binding.postMessageToJs, message, "postMessageToJs");
+}
+
+bool JniBinding::RequestPlatformService(JNIEnv* env, jobject activity, const std::string& request) {
+    return CallWithString(env, activity, g_binding.requestPlatformService, request, "requestPlatformService");
+}
+
+bool JniBinding::NavigateToUrl(JNIEnv* env, jobject activity, const std::string& url) {
+    return CallWithString(env, activity, g_binding.navigateToUrl, url, "navigateToUrl");
+}
+
+AAssetManager* JniBinding::AssetManager() {
+    return g_binding.assetManager;
+}
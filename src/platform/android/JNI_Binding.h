@@ -0,0 +1,35 @@
+﻿// src/platform/android/JNI_Binding.h
+#pragma once
+
+#include <jni.h>
+#include <string>
+#include <android/asset_manager.h>
+
+// MainActivity 的 JNI 绑定。
+// 类、方法 ID 与 AssetManager 在 nativeInit 时解析一次并以全局引用持有，直到 nativeDestroy；
+// 之后每次调用只剩一次 Call*Method，不再为每条消息执行 GetObjectClass / GetMethodID。
+// Init / Release 只在主线程上调用，其余函数可以在任何线程上使用（jmethodID 与全局引用跨线程有效）
+namespace JniBinding {
+    // 解析 activity 的类与方法；有方法缺失时返回 false，已解析的部分仍然可用
+    bool Init(JNIEnv* env, jobject activity);
+    void Release(JNIEnv* env);
+
+    // 当前线程的 JNIEnv，未附加到 JVM 的线程会被附加；失败时返回 nullptr
+    JNIEnv* Env();
+
+    // Java 字符串与 UTF-8 之间的转换。
+    // NewStringUTF / GetStringUTFChars 使用的是 JNI 的 "modified UTF-8"：补充平面字符（emoji 等）
+    // 被编码为两个 3 字节的代理项，与标准 UTF-8 互不兼容，因此一律经由 UTF-16 (NewString / GetStringRegion) 转换
+    std::string ToUtf8(JNIEnv* env, jstring value);
+    // 失败时返回 nullptr（已清除 OutOfMemoryError）
+    jstring NewString(JNIEnv* env, const std::string& value);
+
+    // 调用 MainActivity 上对应的方法。方法未解析、参数无法转换或 Java 端抛出异常时返回 false，
+    // 异常会被记录并清除，不会遗留到调用方的下一次 JNI 调用
+    bool PostMessageToJs(JNIEnv* env, jobject activity, const std::string& message);
+    bool RequestPlatformService(JNIEnv* env, jobject activity, const std::string& request);
+    bool NavigateToUrl(JNIEnv* env, jobject activity, const std::string& url);
+
+    // Init 时取得的 AAssetManager，未初始化时为 nullptr
+    AAssetManager* AssetManager();
+}
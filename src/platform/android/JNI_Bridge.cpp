@@ -3,6 +3,7 @@
 #include <jni.h>
 #include <string>
 #include "Android_Backend.h"
+#include "JNI_Binding.h"
 #include "include/Platform.h"
 
 // 全局持有一个 Backend 实例的指针
@@ -23,6 +24,10 @@ extern "C" {
         if (g_backend == nullptr) {
             env->GetJavaVM(&g_jvm);
             g_main_activity_instance = env->NewGlobalRef(thiz);
+            // 一次性解析 MainActivity 的方法 ID 和 AssetManager，之后的 JNI 调用直接复用
+            if (!JniBinding::Init(env, g_main_activity_instance)) {
+                LOG_DEBUG("JniBinding::Init: some MainActivity methods are unavailable.");
+            }
 
             g_backend = new AndroidBackend();
             g_backend->SetMainActivityInstance(g_main_activity_instance);
@@ -38,6 +43,7 @@ extern "C" {
         if (g_backend != nullptr) {
             delete g_backend;
             g_backend = nullptr;
+            JniBinding::Release(env);
             if (g_main_activity_instance != nullptr) {
                 env->DeleteGlobalRef(g_main_activity_instance);
                 g_main_activity_instance = nullptr;
@@ -54,9 +60,7 @@ extern "C" {
             jstring resultJson) {
         LOG_DEBUG("Java_com_veritnet_veritnote_MainActivity_nativeOnPlatformServiceResult");
         if (g_backend) {
-            const char* result_chars = env->GetStringUTFChars(resultJson, nullptr);
-            std::string result_str(result_chars);
-            env->ReleaseStringUTFChars(resultJson, result_chars);
+            std::string result_str = JniBinding::ToUtf8(env, resultJson);
             g_backend->OnPlatformServiceResult(result_str);
         }
     }
@@ -80,14 +84,30 @@ extern "C" {
             jobject /* this */,
             jstring message) {
         if (g_backend) {
-            const char* msg_chars = env->GetStringUTFChars(message, nullptr);
-            std::string msg_str(msg_chars);
-            env->ReleaseStringUTFChars(message, msg_chars);
+            std::string msg_str = JniBinding::ToUtf8(env, message);
 
             g_backend->HandleWebMessage(msg_str);
         }
     }
 
+    // WebView 资源请求 (shouldInterceptRequest，WebView 的 IO 线程)：
+    // 返回描述响应的 JSON（其中的描述符交给 Kotlin 关闭），不由原生处理时返回 null
+    JNIEXPORT jstring JNICALL
+        Java_com_veritnet_veritnote_MainActivity_nativeInterceptRequest(
+            JNIEnv* env,
+            jobject /* this */,
+            jstring url,
+            jstring range) {
+        if (!g_backend || !url) return nullptr;
+
+        std::string url_str = JniBinding::ToUtf8(env, url);
+        std::string range_str = JniBinding::ToUtf8(env, range);
+
+        json response = g_backend->HandleWebResourceRequest(url_str, range_str);
+        if (response.is_null()) return nullptr;
+        return JniBinding::NewString(env, response.dump());
+    }
+
     // [NEW] JNI function for Kotlin to get the pending path
     JNIEXPORT jstring JNICALL
         Java_com_veritnet_veritnote_MainActivity_nativeGetPendingWorkspacePath(
@@ -97,7 +117,7 @@ extern "C" {
             std::wstring path_w = g_backend->GetNextWorkspacePath();
             if (!path_w.empty()) {
                 std::string path_s = g_backend->wstring_to_string(path_w);
-                return env->NewStringUTF(path_s.c_str());
+                return JniBinding::NewString(env, path_s);
             }
         }
         return nullptr; // Return null if no path is pending
@@ -120,9 +140,7 @@ extern "C" {
             jobject /* this */,
             jstring url) {
         if (g_backend) {
-            const char* url_chars = env->GetStringUTFChars(url, nullptr);
-            std::string url_str(url_chars);
-            env->ReleaseStringUTFChars(url, url_chars);
+            std::string url_str = JniBinding::ToUtf8(env, url);
 
             // Call the platform-specific public method on AndroidBackend
             g_backend->OpenExternalLink(g_backend->string_to_wstring(url_str));
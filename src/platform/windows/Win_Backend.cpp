@@ -9,24 +9,21 @@
 #include <filesystem>
 #include <sstream>
 #include <include/Platform.h>
+#include <include/PageFormat.h>
+#include <include/ColumnIndex.h>
+#include <include/ColumnStore.h>
+#include <include/Utf.h>
+#include <include/Telemetry.h>
 
 #pragma comment(lib, "urlmon.lib")
 
 // Helper to convert  wstring <--> string
 std::string WinBackend::wstring_to_string(const std::wstring& wstr) const {
-    if (wstr.empty()) return std::string();
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
-    return strTo;
+    return Utf::ToUtf8(wstr);
 }
 
 std::wstring WinBackend::string_to_wstring(const std::string& str) const {
-    if (str.empty()) return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
+    return Utf::ToWide(str);
 }
 
 bool WinBackend::UrlDecode(const std::string& encoded, std::string& decoded) const {
@@ -69,6 +66,11 @@ static std::wstring GetExePath() {
 
 WinBackend::WinBackend() {}
 
+WinBackend::~WinBackend() {
+    // 退出前把所有未压缩的日志写回页面文件
+    m_saveJournal.CompactAll();
+}
+
 bool WinBackend::LoadResourceData(int resource_id, void*& pData, DWORD& dwSize) {
     HRSRC hRes = FindResource(nullptr, MAKEINTRESOURCE(resource_id), RT_RCDATA);
     if (!hRes) return false;
@@ -100,12 +102,18 @@ void WinBackend::ClearNextWorkspacePath() {
 }
 
 void WinBackend::SendMessageToJS(const json& message) {
-    std::string json_str = message.dump();
-   std::string debugMessage = "C++ [WinBackend]: Sending message to JS: " + json_str;
-   LOG_DEBUG(debugMessage.c_str());  
-   if (m_webview) {  
-       m_webview->PostWebMessageAsJson(this->string_to_wstring(json_str).c_str());  
-   }  
+    std::string json_str;
+    {
+        Telemetry::Span span("dumpMessage", "json");
+        json_str = message.dump();
+    }
+    Telemetry::RecordMessageOut(json_str.size());
+    // 只记录 action 与大小，完整内容可能是整个页面或工作区树
+    std::string debugMessage = "C++ [WinBackend]: Sending '" + message.value("action", "") + "' to JS (" + std::to_string(json_str.size()) + " bytes)";
+    LOG_DEBUG(debugMessage.c_str());
+    if (m_webview) {
+        m_webview->PostWebMessageAsJson(this->string_to_wstring(json_str).c_str());
+    }
 }
 
 void WinBackend::NavigateTo(const std::wstring& url) {
@@ -242,112 +250,72 @@ void WinBackend::OpenWorkspaceDialog() {
 }
 
 
-void WinBackend::ListWorkspace(const json& payload) {
-    json response;
-    response["action"] = "workspaceListed";
-
-    // 递归函数 scan_dir 保持不变
-    std::function<json(const std::filesystem::path&)> scan_dir =
-        [&](const std::filesystem::path& dir_path) -> json {
-        json tree_node;
-        tree_node["name"] = dir_path.filename().string();
-        tree_node["path"] = dir_path.string();
-        tree_node["type"] = "folder";
-        tree_node["children"] = json::array();
-
-        for (const auto& entry : std::filesystem::directory_iterator(dir_path)) {
-            // --- 目录处理（保持不变）---
-            if (entry.is_directory()) {
-                if (entry.path().filename() == "build") { // 忽略 build 文件夹
-                    continue;
-                }
-                tree_node["children"].push_back(scan_dir(entry.path()));
-            }
-            // --- 文件处理 ---
-            else if (entry.is_regular_file()) {
-                // --- START OF MODIFICATION ---
-
-                // 1. 获取文件扩展名
-                std::string extension = entry.path().extension().string();
-
-                // 2. 根据不同的扩展名创建不同类型的节点
-                if (extension == ".veritnote") {
-                    json file_node;
-                    // 使用 filename() 获取带扩展名的全名，因为前端会处理它
-                    file_node["name"] = entry.path().filename().string();
-                    file_node["path"] = entry.path().string();
-                    file_node["type"] = "page";
-                    tree_node["children"].push_back(file_node);
-                }
-                else if (extension == ".veritnotegraph") {
-                    json file_node;
-                    file_node["name"] = entry.path().filename().string();
-                    file_node["path"] = entry.path().string();
-                    file_node["type"] = "graph";
-                    tree_node["children"].push_back(file_node);
-                }
-                else if (extension == ".veritnotedb") {
-                    json file_node;
-                    file_node["name"] = entry.path().filename().string();
-                    file_node["path"] = entry.path().string();
-                    file_node["type"] = "database";
-                    tree_node["children"].push_back(file_node);
-                }
-
-                // --- END OF MODIFICATION ---
-            }
-        }
-        return tree_node;
-    };
-
-    // --- 后续的 try-catch 块和发送消息的逻辑保持不变 ---
-    try {
-        if (!m_workspaceRoot.empty()) {
-            response["payload"] = scan_dir(m_workspaceRoot);
-
-            // 检查工作区是否为空并提取欢迎文件的逻辑保持不变
-            if (response["payload"]["children"].empty()) {
-                std::filesystem::path destFilePath = std::filesystem::path(m_workspaceRoot) / "welcome.veritnote";
-                if (ExtractResourceToFile(L"/welcome.veritnote", destFilePath)) {
-                    response["payload"] = scan_dir(m_workspaceRoot);
-                }
-            }
-        }
-        else {
-            response["error"] = "Workspace root not set.";
-        }
+// 原子读取
+std::string WinBackend::ReadFileContent(const std::wstring& path) {
+    Telemetry::Span span("readFile", "io");
+    std::string content;
+    // 预写日志中的记录总是比页面文件本身更新
+    if (m_saveJournal.HasJournal(path) && m_saveJournal.Recover(path, content)) {
+        return content;
     }
-    catch (const std::exception& e) {
-        response["error"] = e.what();
+    // 映射文件后复制一次到返回的字符串，映射随即释放（被映射的文件不能被原子写入替换）
+    FileAccess::MappedFile file;
+    if (file.Open(path)) {
+        std::string_view view = file.View();
+        content.assign(view.data(), view.size());
+        return content;
     }
-
-    // Debug 输出和发送消息的逻辑保持不变
-    std::string debug_json_string = response.dump(2);
-    LOG_DEBUG("--- C++ Backend --- \n");
-    LOG_DEBUG(debug_json_string.c_str());
-    LOG_DEBUG("\n---------------------\n");
-
-    SendMessageToJS(response);
+    return ""; // 或者抛出异常，视具体错误处理策略而定
 }
 
+bool WinBackend::GetFileStat(const std::wstring& path, FileAccess::FileStat& stat) {
+    return FileAccess::StatFile(path, stat);
+}
 
-// 原子读取
-std::string WinBackend::ReadFileContent(const std::wstring& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (file.is_open()) {
-        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+// 映射整个文件后按块交给 sink：页面按需调入，处理过的页面可以被系统回收，内存占用与文件大小无关
+bool WinBackend::ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) {
+    Telemetry::Span span("readFileChunks", "io");
+    constexpr size_t kChunkSize = 4 * 1024 * 1024;
+    FileAccess::MappedFile file;
+    if (!file.Open(path)) {
+        return false;
     }
-    return ""; // 或者抛出异常，视具体错误处理策略而定
+    std::string_view view = file.View();
+    for (size_t offset = 0; offset < view.size(); offset += kChunkSize) {
+        if (!sink(view.substr(offset, kChunkSize))) break;
+    }
+    return true;
 }
 
-// 原子写入
+// 原子写入：临时文件 + FlushFileBuffers + ReplaceFileW
 bool WinBackend::WriteFileContent(const std::wstring& path, const std::string& content) {
-    std::ofstream file(path, std::ios::binary);
-    if (file.is_open()) {
-        file << content;
+    Telemetry::Span span("writeFile", "io");
+    if (m_saveJournal.HasJournal(path)) {
+        // 先把新内容追加进日志再替换原文件，这样任一步骤崩溃后恢复出的都是最新的已落盘内容
+        m_saveJournal.Append(path, content);
+        if (!DurableStorage::AtomicWriteFile(path, content)) return false;
+        m_saveJournal.Discard(path);
         return true;
     }
-    return false;
+    return DurableStorage::AtomicWriteFile(path, content);
+}
+
+// 流式原子写入：大文件（列式存储）分块写入临时文件后替换，内存中不保留完整内容
+bool WinBackend::WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) {
+    Telemetry::Span span("writeFileStreamed", "io");
+    return DurableStorage::AtomicWriteFileStreamed(path, produce);
+}
+
+// 日志写入：一次顺序追加 + fsync，达到阈值后自动压缩
+bool WinBackend::WriteFileContentJournaled(const std::wstring& path, const std::string& content) {
+    Telemetry::Span span("writeJournal", "io");
+    return m_saveJournal.Append(path, content);
+}
+
+// 增量写入：磁盘写入量与编辑大小成正比，完整内容只在压缩时生成
+bool WinBackend::WriteFilePatch(const std::wstring& path, const std::string& patch, const std::function<std::string()>& snapshot) {
+    Telemetry::Span span("writePatch", "io");
+    return m_saveJournal.AppendPatch(path, patch, snapshot);
 }
 
 
@@ -381,9 +349,7 @@ void WinBackend::CreateItem(const json& payload) {
 
             // 2. 内容初始化
             if (type == "database") {
-                std::ofstream file(fullPath);
-                file << "";
-                file.close();
+                DurableStorage::AtomicWriteFile(fullPath, "");
             }
             else if (type == "page" || type == "graph") {
                 // Page 和 Graph 的 JSON 初始化逻辑保持原样
@@ -391,9 +357,7 @@ void WinBackend::CreateItem(const json& payload) {
                 newFileContent["config"] = json::object({ {"page", json::object()} });
                 newFileContent["blocks"] = json::array();
 
-                std::ofstream file(fullPath);
-                file << newFileContent.dump(2);
-                file.close();
+                DurableStorage::AtomicWriteFile(fullPath, newFileContent.dump(2));
             }
         }
         // --- END OF MODIFICATION ---
@@ -411,6 +375,17 @@ void WinBackend::DeleteItem(const json& payload) {
     try {
         std::string pathStr = payload.value("path", "");
         std::filesystem::path fullPath(pathStr);
+        std::error_code ec;
+        if (std::filesystem::is_directory(fullPath, ec)) {
+            // 目录内的日志和附属文件随目录一起删除，只需清掉内存中的待压缩记录
+            m_saveJournal.DiscardUnder(fullPath);
+        }
+        else {
+            // 日志必须一起丢弃，否则退出时的 CompactAll 或同名新页面的读取会让已删除的内容复活
+            m_saveJournal.Discard(fullPath);
+            std::filesystem::remove(ColumnStore::PathFor(fullPath), ec);
+            std::filesystem::remove(ColumnIndex::IndexPathFor(fullPath), ec);
+        }
         if (std::filesystem::exists(fullPath)) {
             std::filesystem::remove_all(fullPath); // 对文件和文件夹都有效
         }
@@ -423,12 +398,16 @@ void WinBackend::DeleteItem(const json& payload) {
 }
 
 json WinBackend::ReadJsonFile(const std::wstring& identifier) {
-    std::filesystem::path path(identifier);
-    if (!std::filesystem::exists(path)) return json::object();
     try {
-        std::ifstream file(path);
-        if (!file.is_open()) return json::object();
-        return json::parse(file);
+        if (m_saveJournal.HasJournal(identifier)) {
+            // 经由 ReadFileContent，页面文件的未压缩日志也能被看到
+            std::string content = ReadFileContent(identifier);
+            return content.empty() ? json::object() : PageFormat::Parse(content);
+        }
+        // 映射文件后直接解析，不经过中间字符串
+        FileAccess::MappedFile file;
+        if (!file.Open(identifier) || file.View().empty()) return json::object();
+        return PageFormat::Parse(file.View());
     }
     catch (...) {
         return json::object();
@@ -437,9 +416,13 @@ json WinBackend::ReadJsonFile(const std::wstring& identifier) {
 
 void WinBackend::WriteJsonFile(const std::wstring& identifier, const json& data) {
     try {
-        std::filesystem::path path(identifier);
-        std::ofstream file(path);
-        file << data.dump(2);
+        // 保持文件原有的格式
+        bool binary = false;
+        {
+            FileAccess::MappedFile existing; // 替换文件之前必须先释放映射
+            binary = existing.Open(identifier) && PageFormat::IsBinary(existing.View());
+        }
+        WriteFileContent(identifier, PageFormat::Serialize(data, binary));
     }
     catch (...) {
         // Handle error
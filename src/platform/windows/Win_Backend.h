@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "include/Backend.h"
+#include "include/DurableStorage.h"
 #include <windows.h>
 #include <wrl.h>
 #include <wil/com.h>
@@ -11,6 +12,7 @@
 class WinBackend : public Backend {
 public:
     WinBackend();
+    ~WinBackend() override;
 
     // --- 实现 Backend 的纯虚函数 ---
     void SendMessageToJS(const json& message) override;
@@ -31,10 +33,15 @@ public:
     std::string wstring_to_string(const std::wstring& wstr) const override;
     bool UrlDecode(const std::string& encoded, std::string& decoded) const override;
 
-    void ListWorkspace(const json& payload) override;
 
     std::string ReadFileContent(const std::wstring& path) override;
     bool WriteFileContent(const std::wstring& path, const std::string& content) override;
+    bool WriteFileContentJournaled(const std::wstring& path, const std::string& content) override;
+    bool WriteFilePatch(const std::wstring& path, const std::string& patch, const std::function<std::string()>& snapshot) override;
+    bool SupportsBinaryFiles() const override { return true; }
+    bool GetFileStat(const std::wstring& path, FileAccess::FileStat& stat) override;
+    bool ReadFileChunks(const std::wstring& path, const std::function<bool(std::string_view)>& sink) override;
+    bool WriteFileStreamed(const std::wstring& path, const DurableStorage::Producer& produce) override;
 
     void CreateItem(const json& payload) override;
     void DeleteItem(const json& payload) override;
@@ -61,4 +68,5 @@ private:
     bool m_isFullscreen = false;
     WINDOWPLACEMENT m_wpPrev = { sizeof(m_wpPrev) };
     std::wstring m_nextWorkspacePath; // 用于在导航后注入路径
+    SaveJournal m_saveJournal; // 自动保存的预写日志
 };
\ No newline at end of file
@@ -17,6 +17,8 @@
 #pragma comment(lib, "Shcore.lib")
 
 #include "resources.h" // 由CMake生成
+#include "include/Utf.h"
+#include "include/WebResources.h"
 #include "Win_Backend.h" // <-- 【修改】包含新的头文件
 
 using namespace Microsoft::WRL;
@@ -33,37 +35,16 @@ static RECT g_border_thickness;
 
 // Helper to convert string to wstring (可以保留为本地 static 函数)
 static std::wstring string_to_wstring(const std::string& str) {
-    if (str.empty()) return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
+    return Utf::ToWide(str);
 }
 // Helper to convert wstring to string
 static std::string wstring_to_string(const std::wstring& wstr) {
-    if (wstr.empty()) return std::string();
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
-    return strTo;
+    return Utf::ToUtf8(wstr);
 }
 
-// 根据文件扩展名获取MIME类型
+// 根据文件扩展名获取MIME类型（与 Android 共用 WebResources 中的映射表）
 std::wstring GetMimeType(const std::wstring& path) {
-    const wchar_t* ext = PathFindExtensionW(path.c_str());
-    if (ext == nullptr) return L"application/octet-stream";
-
-    if (_wcsicmp(ext, L".html") == 0) return L"text/html; charset=utf-8";
-    if (_wcsicmp(ext, L".css") == 0) return L"text/css; charset=utf-8";
-    if (_wcsicmp(ext, L".js") == 0) return L"application/javascript; charset=utf-8";
-    if (_wcsicmp(ext, L".json") == 0) return L"application/json; charset=utf-8";
-    if (_wcsicmp(ext, L".png") == 0) return L"image/png";
-    if (_wcsicmp(ext, L".jpg") == 0 || _wcsicmp(ext, L".jpeg") == 0) return L"image/jpeg";
-    if (_wcsicmp(ext, L".gif") == 0) return L"image/gif";
-    if (_wcsicmp(ext, L".svg") == 0) return L"image/svg+xml";
-    if (_wcsicmp(ext, L".woff2") == 0) return L"font/woff2";
-
-    return L"application/octet-stream";
+    return string_to_wstring(WebResources::MimeType(wstring_to_string(path)));
 }
 
 // 从资源中加载数据并创建IStream
@@ -84,11 +65,7 @@ wil::com_ptr<IStream> StreamFromResource(int resource_id) {
 }
 
 std::string wstring_to_string_main(const std::wstring& wstr) {
-    if (wstr.empty()) return std::string();
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
-    return strTo;
+    return Utf::ToUtf8(wstr);
 }
 
 
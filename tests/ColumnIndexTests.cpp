@@ -0,0 +1,163 @@
+﻿// tests/ColumnIndexTests.cpp
+// 二级索引：带索引执行与全表扫描结果一致，VNX1 索引文件的读回与损坏文件的拒绝
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "include/ColumnIndex.h"
+#include "include/QueryEngine.h"
+
+namespace {
+    using Indexes = std::vector<std::shared_ptr<const ColumnIndex>>;
+
+    // 整数、浮点数、字符串三列，含空值、空字符串和重复值
+    std::shared_ptr<const ColumnTable> SampleTable(uint32_t seed, size_t dataRows) {
+        static const char* words[] = { "alpha", "alphabet", "Beta", "gamma", "", "delta", "épée", "10" };
+        std::mt19937 rng(seed);
+        json rows = json::array();
+        rows.push_back({ "i", "f", "s" });
+        for (size_t r = 0; r < dataRows; ++r) {
+            rows.push_back({
+                rng() % 9 == 0 ? json(nullptr) : json(static_cast<int64_t>(rng() % 50) - 10),
+                rng() % 9 == 0 ? json(nullptr) : json((rng() % 200) / 4.0 - 5.0),
+                rng() % 9 == 0 ? json(nullptr) : json(words[rng() % 8]),
+            });
+        }
+        return ColumnTable::FromRows(rows);
+    }
+
+    Indexes BuildAll(const ColumnTable& table) {
+        Indexes indexes;
+        for (size_t c = 0; c < table.ColumnCount(); ++c) {
+            for (ColumnIndex::Type type : { ColumnIndex::Type::Sorted, ColumnIndex::Type::Hash, ColumnIndex::Type::Trigram }) {
+                if (auto index = ColumnIndex::Build(table.GetColumn(c), c, type)) indexes.push_back(index);
+            }
+        }
+        return indexes;
+    }
+
+    // 每一列上的每种条件
+    std::vector<Query::Spec> AllSpecs() {
+        static const Query::FilterOp ops[] = {
+            Query::FilterOp::Equal, Query::FilterOp::NotEqual, Query::FilterOp::Less, Query::FilterOp::LessEqual,
+            Query::FilterOp::Greater, Query::FilterOp::GreaterEqual, Query::FilterOp::Contains, Query::FilterOp::StartsWith,
+            Query::FilterOp::Empty, Query::FilterOp::NotEmpty,
+        };
+        const json values[] = { 0, 7, 12.5, -5, "alpha", "alp", "pha", "Beta", "beta", "10", "zzz", "", "é" };
+        std::vector<Query::Spec> specs;
+        for (size_t column = 0; column < 3; ++column) {
+            for (Query::FilterOp op : ops) {
+                for (const json& value : values) {
+                    Query::Spec spec;
+                    spec.filters.push_back({ column, op, value });
+                    specs.push_back(std::move(spec));
+                }
+            }
+        }
+        // 两个都能用索引的条件求交集，以及一个只能在候选行上求值的条件
+        Query::Spec both;
+        both.filters.push_back({ 0, Query::FilterOp::GreaterEqual, 5 });
+        both.filters.push_back({ 2, Query::FilterOp::Contains, "alp" });
+        both.filters.push_back({ 1, Query::FilterOp::NotEqual, 0 });
+        specs.push_back(both);
+        return specs;
+    }
+
+    void CheckSameAsScan(const ColumnTable& table, const Indexes& indexes, const std::string& label) {
+        for (const Query::Spec& spec : AllSpecs()) {
+            std::vector<uint32_t> scanned = Query::Execute(table, spec).rows;
+            std::vector<uint32_t> indexed = Query::Execute(table, spec, indexes).rows;
+            VN_CHECK_MSG(indexed == scanned, label + " " + Query::SpecKey(spec));
+        }
+    }
+
+    void SupportedColumns() {
+        auto table = SampleTable(1, 10);
+        VN_CHECK(ColumnIndex::Supports(table->GetColumn(0), ColumnIndex::Type::Sorted));
+        VN_CHECK(ColumnIndex::Supports(table->GetColumn(1), ColumnIndex::Type::Hash));
+        VN_CHECK(!ColumnIndex::Supports(table->GetColumn(1), ColumnIndex::Type::Trigram));
+        VN_CHECK(ColumnIndex::Supports(table->GetColumn(2), ColumnIndex::Type::Trigram));
+        auto bools = ColumnTable::FromRows(json::parse("[[\"b\"],[true],[false]]"));
+        VN_CHECK(ColumnIndex::Build(bools->GetColumn(0), 0, ColumnIndex::Type::Sorted) == nullptr);
+
+        ColumnIndex::Type type;
+        VN_CHECK(ColumnIndex::ParseType("trigram", type) && type == ColumnIndex::Type::Trigram);
+        VN_CHECK(!ColumnIndex::ParseType("btree", type));
+    }
+
+    void IndexedMatchesScan() {
+        for (uint32_t seed : { 2u, 3u }) {
+            auto table = SampleTable(seed, 2000);
+            Indexes all = BuildAll(*table);
+            VN_CHECK(all.size() == 7);
+            CheckSameAsScan(*table, all, "all");
+            // 只有一种索引时也要给出同样的结果
+            for (const auto& index : all) {
+                CheckSameAsScan(*table, { index }, ColumnIndex::TypeName(index->GetType()));
+            }
+        }
+    }
+
+    void FileRoundTrip() {
+        auto table = SampleTable(4, 500);
+        Indexes built = BuildAll(*table);
+        std::string bytes = ColumnIndex::EncodeFile(built);
+        VN_CHECK(bytes.compare(0, 4, "VNX1") == 0);
+
+        Indexes decoded = ColumnIndex::DecodeFile(bytes);
+        VN_CHECK(decoded.size() == built.size());
+        if (decoded.size() != built.size()) return;
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            VN_CHECK(decoded[i]->GetType() == built[i]->GetType());
+            VN_CHECK(decoded[i]->ColumnIndexInTable() == built[i]->ColumnIndexInTable());
+            VN_CHECK(decoded[i]->Matches(table->GetColumn(decoded[i]->ColumnIndexInTable())));
+        }
+        CheckSameAsScan(*table, decoded, "decoded");
+        VN_CHECK(ColumnIndex::DecodeFile(ColumnIndex::EncodeFile({})).empty());
+
+        // 列内容改变后指纹不再一致，索引需要重建
+        auto changed = SampleTable(5, 500);
+        for (const auto& index : decoded) {
+            VN_CHECK(!index->Matches(changed->GetColumn(index->ColumnIndexInTable())));
+        }
+    }
+
+    // 截断的文件整体被拒绝；任意一个字节被改写后，仍然通过 Matches 的索引在查询中不会越界或死循环
+    void CorruptionRejected() {
+        auto table = SampleTable(6, 60);
+        std::string bytes = ColumnIndex::EncodeFile(BuildAll(*table));
+
+        for (size_t length = 0; length < bytes.size(); ++length) {
+            VN_CHECK_MSG(ColumnIndex::DecodeFile(bytes.substr(0, length)).empty(), "truncated to " + std::to_string(length));
+        }
+
+        std::string damaged = bytes;
+        damaged[0] = 'X';
+        VN_CHECK(ColumnIndex::DecodeFile(damaged).empty());
+
+        std::vector<Query::Spec> specs = AllSpecs();
+        for (size_t i = 4; i < bytes.size(); ++i) {
+            damaged = bytes;
+            damaged[i] = static_cast<char>(damaged[i] ^ 0x5A);
+            Indexes usable;
+            for (const auto& index : ColumnIndex::DecodeFile(damaged)) {
+                size_t column = index->ColumnIndexInTable();
+                if (column < table->ColumnCount() && index->Matches(table->GetColumn(column))) usable.push_back(index);
+            }
+            for (size_t s = i % 7; s < specs.size(); s += 7) {
+                Query::Execute(*table, specs[s], usable);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    TestHarness::ParseArgs(argc, argv);
+    TestHarness::Run("column_index/supported_columns", SupportedColumns);
+    TestHarness::Run("column_index/indexed_matches_scan", IndexedMatchesScan);
+    TestHarness::Run("column_index/file_round_trip", FileRoundTrip);
+    TestHarness::Run("column_index/corruption_rejected", CorruptionRejected);
+    return TestHarness::Finish();
+}
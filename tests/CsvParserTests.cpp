@@ -0,0 +1,194 @@
+﻿// tests/CsvParserTests.cpp
+// Csv::Parser 的引号 / 换行处理与分块喂入，类型推断和数值转换的边界
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "include/ColumnTable.h"
+#include "include/CsvParser.h"
+
+namespace {
+    using Rows = std::vector<std::vector<std::string>>;
+
+    // 按 RFC 4180 写出一个字段：含分隔符、引号或换行时加引号，引号写成 ""
+    std::string Quote(const std::string& field, char delimiter, bool force) {
+        if (!force && field.find_first_of(std::string("\"\r\n") + delimiter) == std::string::npos) return field;
+        std::string out = "\"";
+        for (char c : field) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::string WriteCsv(const Rows& rows, char delimiter, const std::string& newline, bool trailingNewline) {
+        std::string out;
+        for (size_t r = 0; r < rows.size(); ++r) {
+            for (size_t c = 0; c < rows[r].size(); ++c) {
+                if (c > 0) out += delimiter;
+                // 只有一个空字段的行写成 ""，否则就是空行
+                out += Quote(rows[r][c], delimiter, rows[r].size() == 1 && rows[r][c].empty());
+            }
+            if (r + 1 < rows.size() || trailingNewline) out += newline;
+        }
+        return out;
+    }
+
+    // 把 csv 按 chunkSize 分块喂入
+    Rows Parse(const std::string& csv, size_t chunkSize, char delimiter = ',') {
+        Rows rows;
+        Csv::Parser parser([&](const std::vector<std::string>& fields) { rows.push_back(fields); }, delimiter);
+        for (size_t i = 0; i < csv.size(); i += chunkSize) {
+            parser.Feed(std::string_view(csv).substr(i, chunkSize));
+        }
+        parser.Finish();
+        return rows;
+    }
+
+    std::string Describe(const std::string& csv) {
+        std::string out;
+        for (char c : csv) {
+            if (c == '\r') out += "\\r";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        return out;
+    }
+
+    // 每个单元格都按 type 转换
+    json ReadRows(const std::string& csv) {
+        json rows = json::array();
+        bool ok = ColumnTable::ReadCsvRows([&](const std::function<bool(std::string_view)>& sink) { return sink(csv); },
+            [&](const json& row) { rows.push_back(row); return true; });
+        return ok ? rows : json();
+    }
+
+    void QuotingAndLineEndings() {
+        Rows rows = Parse("a,\"b,c\",\"d\"\"e\"\r\nf,,\r\"multi\nline\",\"\"\n", 1 << 20);
+        Rows expected = { { "a", "b,c", "d\"e" }, { "f", "", "" }, { "multi\nline", "" } };
+        VN_CHECK(rows == expected);
+
+        // 最后一行没有换行；BOM 不属于第一个字段
+        VN_CHECK((Parse("\xEF\xBB\xBFx,y\n1,2", 1 << 20) == Rows{ { "x", "y" }, { "1", "2" } }));
+        VN_CHECK((Parse("x;\"a;b\"\n", 1 << 20, ';') == Rows{ { "x", "a;b" } }));
+        VN_CHECK((Parse("x\ty\n", 1 << 20, '\t') == Rows{ { "x", "y" } }));
+    }
+
+    // 同一份输入在任意位置被切开（包括 BOM、CRLF 和 "" 转义的中间）都得到相同的行
+    void ChunkBoundaries() {
+        const std::string csv = "\xEF\xBB\xBFid,\"na\"\"me\"\r\n1,\"x\r\ny\"\r\n2,\"\"\r3,z";
+        Rows whole = Parse(csv, csv.size());
+        VN_CHECK((whole == Rows{ { "id", "na\"me" }, { "1", "x\r\ny" }, { "2", "" }, { "3", "z" } }));
+        for (size_t chunk = 1; chunk < csv.size(); ++chunk) {
+            VN_CHECK_MSG(Parse(csv, chunk) == whole, "chunk size " + std::to_string(chunk));
+        }
+    }
+
+    // 随机字段写成 CSV 后再解析，必须得到原样的字段
+    void RandomRoundTrip() {
+        std::mt19937 rng(31);
+        const std::string alphabet = "ab ,;\"\r\n\t1\xC3\xA9";
+        const char* newlines[] = { "\n", "\r\n", "\r" };
+        for (int iteration = 0; iteration < 500; ++iteration) {
+            char delimiter = iteration % 3 == 0 ? ';' : ',';
+            Rows rows(1 + rng() % 6);
+            size_t width = 1 + rng() % 4;
+            for (auto& row : rows) {
+                row.resize(width);
+                for (auto& field : row) {
+                    size_t length = rng() % 6;
+                    for (size_t i = 0; i < length; ++i) field += alphabet[rng() % alphabet.size()];
+                }
+            }
+            std::string csv = WriteCsv(rows, delimiter, newlines[rng() % 3], rng() % 2 == 0);
+            VN_CHECK_MSG(Parse(csv, 1 + rng() % 8, delimiter) == rows, Describe(csv));
+        }
+    }
+
+    void NumberInference() {
+        struct Case {
+            const char* cell;
+            bool number; // 整列只有这一个值时是否推断为数字
+        };
+        const Case cases[] = {
+            { "0", true },
+            { "-0.5", true },
+            { "+3", true },
+            { "1.5e3", true },
+            { "-123456789012345678", true },  // 18 位，符号不计入位数
+            { "123456789012345678", true },
+            { "1234567890123456789", false }, // 19 位可能超出 int64
+            { "007", false },                 // 前导零（编号、邮编）
+            { "-01", false },
+            { "1e999", false },               // 超出 double 范围
+            { "nan", false },
+            { "inf", false },
+            { "12a", false },
+            { "", false },
+        };
+        for (const Case& c : cases) {
+            Csv::TypeInference inference;
+            inference.Observe({ c.cell });
+            bool number = inference.TypeOf(0) == Csv::ColumnType::Number;
+            VN_CHECK_MSG(number == c.number, c.cell);
+        }
+
+        // 空单元格不影响推断；数字列中的空单元格为 null
+        Csv::TypeInference inference;
+        inference.Observe({ "1", "" });
+        inference.Observe({ "", "" });
+        VN_CHECK(inference.TypeOf(0) == Csv::ColumnType::Number);
+        VN_CHECK(inference.TypeOf(1) == Csv::ColumnType::String);
+        VN_CHECK(Csv::ToJsonValue("", Csv::ColumnType::Number).is_null());
+        VN_CHECK(Csv::ToJsonValue("", Csv::ColumnType::String) == "");
+    }
+
+    void NumberConversion() {
+        VN_CHECK(Csv::ToJsonValue("-123456789012345678", Csv::ColumnType::Number) == json(int64_t(-123456789012345678)));
+        VN_CHECK(Csv::ToJsonValue("+42", Csv::ColumnType::Number) == json(int64_t(42)));
+        VN_CHECK(Csv::ToJsonValue("1.5e3", Csv::ColumnType::Number) == json(1500.0));
+        VN_CHECK(Csv::ToJsonValue("-0.25", Csv::ColumnType::Number) == json(-0.25));
+        // 直接指定类型时，无法表示的数值保持原文，不会变成 inf / null
+        VN_CHECK(Csv::ToJsonValue("1e999", Csv::ColumnType::Number) == "1e999");
+        VN_CHECK(Csv::ToJsonValue("TRUE", Csv::ColumnType::Bool) == true);
+        VN_CHECK(Csv::ToJsonValue("2024-01-02", Csv::ColumnType::Date) == "2024-01-02");
+    }
+
+    // CSV -> rawData 行：表头保持字符串，其余按列类型转换，导出再导入后数值不变
+    void ReadRowsRoundTrip() {
+        const std::string csv = "id,code,amount,flag,when\n"
+            "1,007,-123456789012345678,true,2024-01-02\n"
+            "2,,\"1,5\",FALSE,\n"
+            "3,120,0.125,,2024/03/04 10:00\n";
+        json rows = ReadRows(csv);
+        VN_CHECK(rows.size() == 4);
+        if (rows.size() != 4) return;
+        VN_CHECK((rows[0] == json{ "id", "code", "amount", "flag", "when" }));
+        VN_CHECK(rows[1][0] == 1);
+        VN_CHECK(rows[1][1] == "007");                       // 前导零使整列保持字符串
+        VN_CHECK(rows[2][1] == "");
+        VN_CHECK(rows[1][2] == "-123456789012345678");       // "1,5" 不是数字，整列保持字符串
+        VN_CHECK(rows[1][3] == true);
+        VN_CHECK(rows[2][3] == false);
+        VN_CHECK(rows[3][3].is_null());
+        VN_CHECK(rows[3][4] == "2024/03/04 10:00");
+
+        json numbers = ReadRows("n\n-123456789012345678\n0.1\n1e300\n");
+        VN_CHECK((numbers == json{ { "n" }, { int64_t(-123456789012345678) }, { 0.1 }, { 1e300 } }));
+        json reparsed = json::parse(numbers.dump());
+        VN_CHECK(reparsed == numbers);
+    }
+}
+
+int main(int argc, char** argv) {
+    TestHarness::ParseArgs(argc, argv);
+    TestHarness::Run("csv/quoting_and_line_endings", QuotingAndLineEndings);
+    TestHarness::Run("csv/chunk_boundaries", ChunkBoundaries);
+    TestHarness::Run("csv/random_round_trip", RandomRoundTrip);
+    TestHarness::Run("csv/number_inference", NumberInference);
+    TestHarness::Run("csv/number_conversion", NumberConversion);
+    TestHarness::Run("csv/read_rows_round_trip", ReadRowsRoundTrip);
+    return TestHarness::Finish();
+}
@@ -0,0 +1,201 @@
+﻿// tests/QueryEngineTests.cpp
+// preset 查询的筛选 / 排序 / 分组 / 聚合语义，以及内存表与磁盘列式表上执行结果的一致性
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "include/QueryEngine.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    json TaskRows() {
+        return json::parse(R"([
+            ["name", "team", "points", "done", "note"],
+            ["alice", "red", 10, true, "x"],
+            ["bob", "blue", 3.5, false, ""],
+            ["carol", "red", null, true, "Alpha"],
+            ["dave", "green", 7, false, null],
+            ["erin", "blue", 10, true, "alphabet"],
+            ["Frank", "red", -2, false, "beta"]
+        ])");
+    }
+
+    std::vector<uint32_t> Run(const ColumnTable& table, const json& config) {
+        return Query::Execute(table, Query::FromPresetConfig(config, table)).rows;
+    }
+
+    json Filter(const char* column, const char* op, const json& value) {
+        return { { "filters", json::array({ { { "column", column }, { "op", op }, { "value", value } } }) } };
+    }
+
+    using Rows = std::vector<uint32_t>;
+
+    void Filters() {
+        auto table = ColumnTable::FromRows(TaskRows());
+        VN_CHECK((Run(*table, Filter("points", "gt", 5)) == Rows{ 1, 4, 5 }));
+        VN_CHECK((Run(*table, Filter("points", "eq", "10")) == Rows{ 1, 5 }));     // 数字形式的字符串按数值比较
+        VN_CHECK((Run(*table, Filter("points", "lte", 3.5)) == Rows{ 2, 6 }));
+        VN_CHECK((Run(*table, Filter("points", "empty", "")) == Rows{ 3 }));
+        VN_CHECK((Run(*table, Filter("team", "neq", "red")) == Rows{ 2, 4, 5 }));
+        VN_CHECK((Run(*table, Filter("note", "contains", "ALP")) == Rows{ 3, 5 })); // 不区分大小写
+        VN_CHECK((Run(*table, Filter("note", "startsWith", "al")) == Rows{ 3, 5 }));
+        VN_CHECK((Run(*table, Filter("note", "empty", "")) == Rows{ 2, 4 }));       // 空字符串与空值等价
+        VN_CHECK((Run(*table, Filter("note", "notEmpty", "")) == Rows{ 1, 3, 5, 6 }));
+        VN_CHECK((Run(*table, Filter("name", "lt", "c")) == Rows{ 1, 2, 6 }));      // 字节序："Frank" < "c"
+        VN_CHECK((Run(*table, Filter("done", "eq", true)) == Rows{ 1, 3, 5 }));
+
+        // 多个条件同时满足；引用不存在的列的条件被忽略
+        json config = { { "filters", json::array({
+            { { "column", "team" }, { "op", "eq" }, { "value", "red" } },
+            { { "column", "done" }, { "op", "eq" }, { "value", "true" } },
+            { { "column", "missing" }, { "op", "eq" }, { "value", "x" } } }) } };
+        VN_CHECK((Run(*table, config) == Rows{ 1, 3 }));
+
+        // firstRowMode 为 data 时第一行同样参与筛选，列名为 "Column N"
+        json data = Filter("Column 1", "startsWith", "n");
+        data["firstRowMode"] = "data";
+        VN_CHECK((Run(*table, data) == Rows{ 0 }));
+    }
+
+    void Sorts() {
+        auto table = ColumnTable::FromRows(TaskRows());
+        auto sorts = [](std::initializer_list<std::pair<const char*, const char*>> keys) {
+            json list = json::array();
+            for (const auto& [column, direction] : keys) list.push_back({ { "column", column }, { "direction", direction } });
+            return json{ { "sorts", list } };
+        };
+        // 空值总在最后，相等的行保持原来的顺序
+        VN_CHECK((Run(*table, sorts({ { "points", "desc" } })) == Rows{ 1, 5, 4, 2, 6, 3 }));
+        VN_CHECK((Run(*table, sorts({ { "points", "asc" } })) == Rows{ 6, 2, 4, 1, 5, 3 }));
+        VN_CHECK((Run(*table, sorts({ { "name", "asc" } })) == Rows{ 6, 1, 2, 3, 4, 5 }));
+        VN_CHECK((Run(*table, sorts({ { "team", "asc" }, { "points", "asc" } })) == Rows{ 2, 5, 4, 6, 1, 3 }));
+        VN_CHECK((Run(*table, sorts({ { "done", "desc" }, { "name", "desc" } })) == Rows{ 5, 3, 1, 4, 2, 6 }));
+    }
+
+    void GroupsAndAggregates() {
+        auto table = ColumnTable::FromRows(TaskRows());
+        json config = json::parse(R"({
+            "groupBy": "team",
+            "sorts": [{ "column": "points", "direction": "desc" }],
+            "columns": [
+                { "sourceHeader": "points", "aggregate": "sum" },
+                { "sourceHeader": "name", "aggregate": "count" },
+                { "sourceHeader": "points", "aggregate": "avg" },
+                { "sourceHeader": "points", "aggregate": "min" },
+                { "sourceHeader": "points", "aggregate": "max" },
+                { "sourceHeader": "note" }
+            ]
+        })");
+        Query::Result result = Query::Execute(*table, Query::FromPresetConfig(config, *table));
+        VN_CHECK((result.rows == Rows{ 5, 2, 4, 1, 6, 3 }));
+        VN_CHECK(result.groups.size() == 3);
+        if (result.groups.size() != 3) return;
+
+        const json& blue = result.groups[0];
+        VN_CHECK(blue["key"] == "blue" && blue["start"] == 0 && blue["count"] == 2);
+        VN_CHECK((blue["aggregates"] == json{ { "0", 13.5 }, { "1", 2 }, { "2", 6.75 }, { "3", 3.5 }, { "4", 10.0 } }));
+        VN_CHECK(result.groups[1]["key"] == "green" && result.groups[1]["start"] == 2 && result.groups[1]["count"] == 1);
+        const json& red = result.groups[2];
+        VN_CHECK(red["key"] == "red" && red["start"] == 3 && red["count"] == 3);
+        // 空单元格不计入 count / avg
+        VN_CHECK((red["aggregates"] == json{ { "0", 8.0 }, { "1", 3 }, { "2", 4.0 }, { "3", -2.0 }, { "4", 10.0 } }));
+        VN_CHECK((result.totals == json{ { "0", 28.5 }, { "1", 6 }, { "2", 5.7 }, { "3", -2.0 }, { "4", 10.0 } }));
+
+        // 窗口 [2, 4) 与 green、red 两组相交
+        json window = Query::GroupsInWindow(result, 2, 2);
+        VN_CHECK(window.size() == 2 && window[0]["key"] == "green" && window[1]["key"] == "red");
+
+        Query::Source source{ table, nullptr };
+        json page = Query::Page(source, result, 1, 2);
+        VN_CHECK((page == json{ TaskRows()[2], TaskRows()[4] }));
+    }
+
+    // --- 随机查询：内存表与磁盘列式表（按行组统计跳过）结果一致 ---
+
+    json RandomRows(std::mt19937& rng, size_t dataRows) {
+        static const char* words[] = { "apple", "Apricot", "banana", "cherry", "", "10", "2.5", "date" };
+        json rows = json::array();
+        rows.push_back({ "n", "s", "m", "b" });
+        for (size_t i = 0; i < dataRows; ++i) {
+            json row = json::array();
+            // 大致有序的数值列，行组的最小 / 最大值可以排除部分行组
+            row.push_back(rng() % 10 == 0 ? json(nullptr) : json(static_cast<int64_t>(i / 3 + rng() % 5)));
+            row.push_back(rng() % 12 == 0 ? json(nullptr) : json(words[rng() % 8]));
+            switch (rng() % 4) {
+            case 0: row.push_back(static_cast<int64_t>(rng() % 20)); break;
+            case 1: row.push_back((rng() % 40) / 2.0); break;
+            case 2: row.push_back(words[rng() % 8]); break;
+            default: row.push_back(nullptr); break;
+            }
+            row.push_back(rng() % 3 == 0);
+            rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+
+    json RandomConfig(std::mt19937& rng) {
+        static const char* columns[] = { "n", "s", "m", "b" };
+        static const char* ops[] = { "eq", "neq", "lt", "lte", "gt", "gte", "contains", "startsWith", "empty", "notEmpty" };
+        static const json values[] = { 5, 40, "2.5", "banana", "ap", "b", "", true };
+        json config = json::object();
+        json filters = json::array();
+        for (size_t i = rng() % 3; i > 0; --i) {
+            filters.push_back({ { "column", columns[rng() % 4] }, { "op", ops[rng() % 10] }, { "value", values[rng() % 8] } });
+        }
+        config["filters"] = filters;
+        json sorts = json::array();
+        for (size_t i = rng() % 3; i > 0; --i) {
+            sorts.push_back({ { "column", columns[rng() % 4] }, { "direction", rng() % 2 ? "asc" : "desc" } });
+        }
+        config["sorts"] = sorts;
+        if (rng() % 2) config["groupBy"] = columns[rng() % 4];
+        config["columns"] = json::array({ { { "sourceHeader", "n" }, { "aggregate", "sum" } }, { { "sourceHeader", "m" }, { "aggregate", "max" } } });
+        if (rng() % 4 == 0) config["firstRowMode"] = "ignore";
+        return config;
+    }
+
+    void StoredMatchesInMemory() {
+        fs::path path = fs::temp_directory_path() / ("veritnote-query-" + std::to_string(std::random_device{}()) + ".columns");
+        std::mt19937 rng(33);
+        for (int round = 0; round < 4; ++round) {
+            json rows = RandomRows(rng, 300 + rng() % 300);
+            auto table = ColumnTable::FromRows(rows);
+            {
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                ColumnStore::Writer writer([&](std::string_view bytes) { out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())); return true; }, 32);
+                for (const auto& row : rows) writer.AppendRow(row);
+                writer.Finish();
+            }
+            auto stored = ColumnStore::StoredTable::Open(path);
+            VN_CHECK(stored != nullptr);
+            if (!stored) break;
+
+            for (int i = 0; i < 100; ++i) {
+                json config = RandomConfig(rng);
+                Query::Spec spec = Query::FromPresetConfig(config, *table);
+                Query::Result expected = Query::Execute(*table, spec);
+                Query::Result actual = Query::Execute(*stored, spec);
+                VN_CHECK_MSG(actual.rows == expected.rows, config.dump());
+                VN_CHECK_MSG(actual.groups == expected.groups, config.dump());
+                VN_CHECK_MSG(actual.totals == expected.totals, config.dump());
+            }
+            stored.reset();
+        }
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+}
+
+int main(int argc, char** argv) {
+    TestHarness::ParseArgs(argc, argv);
+    TestHarness::Run("query/filters", Filters);
+    TestHarness::Run("query/sorts", Sorts);
+    TestHarness::Run("query/groups_and_aggregates", GroupsAndAggregates);
+    TestHarness::Run("query/stored_matches_in_memory", StoredMatchesInMemory);
+    return TestHarness::Finish();
+}
@@ -0,0 +1,242 @@
+﻿// tests/QueryUpdateTests.cpp
+// 行编辑后的增量维护：ColumnTable::WithRows、ColumnIndex::Update 与 Query::Update 的结果
+// 必须与在修改后的全部行上从头构建 / 执行的结果一致
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "include/ColumnIndex.h"
+#include "include/QueryEngine.h"
+
+namespace {
+    // 每列一种“倾向”的类型，偶尔混入其他类型，使修改可能升级或收窄列类型
+    struct Generator {
+        std::mt19937 rng;
+        int kinds[4] = {};
+
+        explicit Generator(uint32_t seed) : rng(seed) {
+            for (int& kind : kinds) kind = static_cast<int>(rng() % 4);
+        }
+
+        json Cell(int kind) {
+            if (rng() % 10 == 0) return nullptr;
+            switch (rng() % 25 == 0 ? static_cast<int>(rng() % 4) : kind) {
+            case 0: return static_cast<int64_t>(rng() % 20);
+            case 1: return rng() % 2 ? json(static_cast<int64_t>(rng() % 20)) : json((rng() % 40) / 2.0);
+            case 2: return "s" + std::to_string(rng() % 12);
+            default: return rng() % 3 == 0 ? json(true) : json("x" + std::to_string(rng() % 5));
+            }
+        }
+
+        // 大多数行有 4 列，少数行更短或更长
+        json Row() {
+            size_t width = rng() % 8 == 0 ? 2 + rng() % 4 : 4;
+            json row = json::array();
+            for (size_t c = 0; c < width; ++c) row.push_back(Cell(kinds[c % 4]));
+            return row;
+        }
+
+        json Rows(size_t dataRows) {
+            json rows = json::array();
+            rows.push_back({ "a", "b", "c", "d" });
+            for (size_t i = 0; i < dataRows; ++i) rows.push_back(Row());
+            return rows;
+        }
+
+        // 改写若干数据行并追加若干行，返回升序不重复的行号
+        std::vector<uint32_t> Patch(json& rows) {
+            std::vector<uint32_t> changed;
+            for (size_t i = rng() % 6; i > 0 && rows.size() > 1; --i) {
+                uint32_t row = 1 + static_cast<uint32_t>(rng() % (rows.size() - 1));
+                rows[row] = Row();
+                changed.push_back(row);
+            }
+            for (size_t i = rng() % 3; i > 0; --i) {
+                changed.push_back(static_cast<uint32_t>(rows.size()));
+                rows.push_back(Row());
+            }
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+            return changed;
+        }
+
+        json Config() {
+            static const char* columns[] = { "a", "b", "c", "d" };
+            static const char* ops[] = { "eq", "neq", "lt", "gte", "contains", "empty", "notEmpty" };
+            static const json values[] = { 5, 10.5, "s3", "x", "1", "" };
+            json config = json::object();
+            json filters = json::array();
+            for (size_t i = rng() % 3; i > 0; --i) {
+                filters.push_back({ { "column", columns[rng() % 4] }, { "op", ops[rng() % 7] }, { "value", values[rng() % 6] } });
+            }
+            json sorts = json::array();
+            for (size_t i = rng() % 3; i > 0; --i) {
+                sorts.push_back({ { "column", columns[rng() % 4] }, { "direction", rng() % 2 ? "asc" : "desc" } });
+            }
+            config["filters"] = filters;
+            config["sorts"] = sorts;
+            if (rng() % 2) config["groupBy"] = columns[rng() % 4];
+            config["columns"] = json::array({
+                { { "sourceHeader", columns[rng() % 4] }, { "aggregate", "sum" } },
+                { { "sourceHeader", columns[rng() % 4] }, { "aggregate", "count" } },
+                { { "sourceHeader", columns[rng() % 4] }, { "aggregate", "min" } } });
+            return config;
+        }
+    };
+
+    std::string Describe(const json& before, const json& after, const std::vector<uint32_t>& changed) {
+        json rows = json::array();
+        for (uint32_t row : changed) rows.push_back(row);
+        return "before " + before.dump() + " after " + after.dump() + " changed " + rows.dump();
+    }
+
+    void TablesMatchRebuild() {
+        Generator gen(38);
+        for (int iteration = 0; iteration < 2000; ++iteration) {
+            json before = iteration % 100 == 0 ? json::array({ json::array({ "a" }) }) : gen.Rows(gen.rng() % 30);
+            json after = before;
+            std::vector<uint32_t> changed = gen.Patch(after);
+            auto base = ColumnTable::FromRows(before);
+            auto patched = ColumnTable::WithRows(*base, after, changed);
+            auto rebuilt = ColumnTable::FromRows(after);
+
+            VN_CHECK_MSG(patched != nullptr, Describe(before, after, changed));
+            if (!patched) continue;
+            VN_CHECK_MSG(patched->ToRows() == after, Describe(before, after, changed));
+            VN_CHECK(patched->ColumnCount() == rebuilt->ColumnCount());
+            for (size_t c = 0; c < std::min(patched->ColumnCount(), rebuilt->ColumnCount()); ++c) {
+                VN_CHECK_MSG(patched->GetColumn(c).GetKind() == rebuilt->GetColumn(c).GetKind(), Describe(before, after, changed));
+            }
+            VN_CHECK(patched->DescribeColumns() == rebuilt->DescribeColumns());
+        }
+    }
+
+    // 更新后的索引用于查询时与全表扫描一致，并且仍然通过 Matches
+    void IndexesMatchRebuild() {
+        Generator gen(3538);
+        const Query::FilterOp ops[] = { Query::FilterOp::Equal, Query::FilterOp::Less, Query::FilterOp::GreaterEqual, Query::FilterOp::Contains };
+        const json values[] = { 4, 9.5, "s1", "s", "x2" };
+        size_t updated = 0;
+        for (int iteration = 0; iteration < 600; ++iteration) {
+            json before = gen.Rows(5 + gen.rng() % 40);
+            json after = before;
+            std::vector<uint32_t> changed = gen.Patch(after);
+            auto base = ColumnTable::FromRows(before);
+            auto patched = ColumnTable::WithRows(*base, after, changed);
+            if (!patched) continue;
+
+            std::vector<uint32_t> dataRows;
+            for (uint32_t row : changed) dataRows.push_back(row - 1);
+            for (size_t c = 0; c < std::min(base->ColumnCount(), patched->ColumnCount()); ++c) {
+                for (ColumnIndex::Type type : { ColumnIndex::Type::Sorted, ColumnIndex::Type::Hash, ColumnIndex::Type::Trigram }) {
+                    auto old = ColumnIndex::Build(base->GetColumn(c), c, type);
+                    if (!old) continue;
+                    auto index = old->Update(patched->GetColumn(c), dataRows);
+                    // 列类型不再适用时返回 nullptr，此时从头构建也不支持
+                    if (!index) {
+                        VN_CHECK(!ColumnIndex::Supports(patched->GetColumn(c), type) ||
+                            patched->GetColumn(c).GetKind() != base->GetColumn(c).GetKind());
+                        continue;
+                    }
+                    ++updated;
+                    VN_CHECK(index->Matches(patched->GetColumn(c)));
+                    for (Query::FilterOp op : ops) {
+                        for (const json& value : values) {
+                            Query::Spec spec;
+                            spec.filters.push_back({ c, op, value });
+                            VN_CHECK_MSG(Query::Execute(*patched, spec, { index }).rows == Query::Execute(*patched, spec).rows,
+                                std::string(ColumnIndex::TypeName(type)) + " " + Describe(before, after, changed));
+                        }
+                    }
+                }
+            }
+        }
+        VN_CHECK(updated > 1000);
+    }
+
+    void ResultsMatchExecute() {
+        Generator gen(1038);
+        size_t updated = 0;
+        size_t attempts = 0;
+        for (int iteration = 0; iteration < 400; ++iteration) {
+            json before = gen.Rows(20 + gen.rng() % 60);
+            auto base = ColumnTable::FromRows(before);
+            for (int q = 0; q < 8; ++q) {
+                json config = gen.Config();
+                Query::Spec spec = Query::FromPresetConfig(config, *base);
+                Query::Result result = Query::Execute(*base, spec);
+
+                // 同一个结果连续跟随几次修改
+                json rows = before;
+                std::shared_ptr<const ColumnTable> current = base;
+                for (int step = 0; step < 3; ++step) {
+                    json after = rows;
+                    std::vector<uint32_t> changed = gen.Patch(after);
+                    auto next = ColumnTable::WithRows(*current, after, changed);
+                    if (!next) break;
+                    ++attempts;
+                    if (!Query::Update(*current, *next, spec, changed, result)) break;
+                    ++updated;
+                    Query::Result expected = Query::Execute(*next, spec);
+                    std::string context = config.dump() + " " + Describe(rows, after, changed);
+                    VN_CHECK_MSG(result.rows == expected.rows, context);
+                    VN_CHECK_MSG(result.groups == expected.groups, context);
+                    VN_CHECK_MSG(result.totals == expected.totals, context);
+                    if (result.rows != expected.rows) return;
+                    rows = std::move(after);
+                    current = next;
+                }
+            }
+        }
+        // 大部分修改不改变列类型，应当能增量更新
+        VN_CHECK(updated * 2 > attempts);
+    }
+
+    // ResultCache 把旧版本的结果迁移到新版本，不能增量更新的结果被丢弃
+    void CacheAdvance() {
+        Generator gen(8);
+        json before = gen.Rows(50);
+        auto base = ColumnTable::FromRows(before);
+        json config = { { "sorts", json::array({ { { "column", "a" }, { "direction", "desc" } } }) } };
+        Query::Spec spec = Query::FromPresetConfig(config, *base);
+        std::string key = Query::SpecKey(spec);
+
+        Query::ResultCache cache;
+        cache.Store(L"db", 1, key, spec, std::make_shared<const Query::Result>(Query::Execute(*base, spec)));
+        VN_CHECK(cache.Find(L"db", 1, key) != nullptr);
+        VN_CHECK(cache.Find(L"db", 2, key) == nullptr);
+
+        json after = before;
+        after[3][0] = before[4][0];
+        auto next = ColumnTable::WithRows(*base, after, { 3 });
+        VN_CHECK(next != nullptr);
+        if (!next) return;
+        cache.Advance(L"db", 1, 2, *base, *next, { 3 });
+        auto advanced = cache.Find(L"db", 2, key);
+        VN_CHECK(cache.Find(L"db", 1, key) == nullptr);
+        bool sameKind = base->GetColumn(0).GetKind() == next->GetColumn(0).GetKind();
+        VN_CHECK((advanced != nullptr) == sameKind);
+        if (advanced) VN_CHECK(advanced->rows == Query::Execute(*next, spec).rows);
+
+        // 第一行改变时表头可能改变，结果被丢弃
+        json renamed = after;
+        renamed[0][0] = "z";
+        auto third = ColumnTable::WithRows(*next, renamed, { 0 });
+        if (third) {
+            cache.Advance(L"db", 2, 3, *next, *third, { 0 });
+            VN_CHECK(cache.Find(L"db", 3, key) == nullptr);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    TestHarness::ParseArgs(argc, argv);
+    TestHarness::Run("update/tables_match_rebuild", TablesMatchRebuild);
+    TestHarness::Run("update/indexes_match_rebuild", IndexesMatchRebuild);
+    TestHarness::Run("update/results_match_execute", ResultsMatchExecute);
+    TestHarness::Run("update/cache_advance", CacheAdvance);
+    return TestHarness::Finish();
+}
@@ -0,0 +1,66 @@
+﻿// tests/TestHarness.h
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <utility>
+
+// 单元测试的最小骨架：每个测试程序在 main 中依次 Run 各个用例，最后返回 Finish() 作为退出码。
+// VN_CHECK 失败时打印位置并把当前用例记为失败，但继续执行，便于一次看到所有不一致；
+// 用例抛出的异常同样记为失败。命令行参数为子串时只运行名称包含它的用例
+namespace TestHarness {
+    struct State {
+        std::string filter;
+        std::string current;
+        size_t failedChecks = 0;
+        size_t failedCases = 0;
+        size_t cases = 0;
+    };
+
+    inline State& Current() {
+        static State state;
+        return state;
+    }
+
+    inline void ParseArgs(int argc, char** argv) {
+        if (argc > 1) Current().filter = argv[1];
+    }
+
+    inline void Fail(const char* file, int line, const std::string& message) {
+        std::printf("  %s:%d: %s\n", file, line, message.c_str());
+        ++Current().failedChecks;
+    }
+
+    template <typename Fn>
+    void Run(const std::string& name, Fn&& fn) {
+        State& state = Current();
+        if (!state.filter.empty() && name.find(state.filter) == std::string::npos) return;
+        state.current = name;
+        size_t before = state.failedChecks;
+        try {
+            std::forward<Fn>(fn)();
+        }
+        catch (const std::exception& e) {
+            Fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        ++state.cases;
+        bool failed = state.failedChecks != before;
+        if (failed) ++state.failedCases;
+        std::printf("[%s] %s\n", failed ? "FAIL" : " OK ", name.c_str());
+        std::fflush(stdout);
+    }
+
+    inline int Finish() {
+        const State& state = Current();
+        std::printf("%zu/%zu cases passed\n", state.cases - state.failedCases, state.cases);
+        return state.failedCases == 0 && state.cases > 0 ? 0 : 1;
+    }
+}
+
+#define VN_CHECK(condition) \
+    do { if (!(condition)) TestHarness::Fail(__FILE__, __LINE__, "check failed: " #condition); } while (0)
+
+// 失败时额外打印 describe（如出错时的输入）
+#define VN_CHECK_MSG(condition, describe) \
+    do { if (!(condition)) TestHarness::Fail(__FILE__, __LINE__, std::string("check failed: " #condition " -- ") + (describe)); } while (0)
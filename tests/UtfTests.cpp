@@ -0,0 +1,195 @@
+﻿// tests/UtfTests.cpp
+// UTF-8 / UTF-16 / UTF-32 转换：非法输入按最大非法子序列替换为 U+FFFD（Unicode 第 3 章表 3-8 / WHATWG），
+// 以及 16 字节 ASCII 快速路径前后的边界
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "include/Utf.h"
+
+namespace {
+    // 逐字节的参考实现，直接按 WHATWG 的 UTF-8 解码算法写出
+    std::u32string ReferenceDecode(const std::string& in) {
+        std::u32string out;
+        size_t i = 0;
+        const size_t n = in.size();
+        while (i < n) {
+            unsigned char b = static_cast<unsigned char>(in[i]);
+            if (b < 0x80) {
+                out += static_cast<char32_t>(b);
+                ++i;
+                continue;
+            }
+            size_t need = 0;
+            unsigned char lower = 0x80, upper = 0xBF;
+            char32_t cp = 0;
+            if (b >= 0xC2 && b <= 0xDF) { need = 1; cp = b & 0x1F; }
+            else if (b >= 0xE0 && b <= 0xEF) {
+                need = 2; cp = b & 0x0F;
+                if (b == 0xE0) lower = 0xA0;
+                if (b == 0xED) upper = 0x9F;
+            }
+            else if (b >= 0xF0 && b <= 0xF4) {
+                need = 3; cp = b & 0x07;
+                if (b == 0xF0) lower = 0x90;
+                if (b == 0xF4) upper = 0x8F;
+            }
+            else {
+                out += Utf::kReplacementChar;
+                ++i;
+                continue;
+            }
+            size_t j = i + 1;
+            bool complete = true;
+            for (size_t k = 0; k < need; ++k, ++j) {
+                unsigned char lo = k == 0 ? lower : 0x80;
+                unsigned char hi = k == 0 ? upper : 0xBF;
+                unsigned char c = j < n ? static_cast<unsigned char>(in[j]) : 0;
+                if (j >= n || c < lo || c > hi) { complete = false; break; }
+                cp = (cp << 6) | (c & 0x3F);
+            }
+            out += complete ? cp : Utf::kReplacementChar;
+            i = j;
+        }
+        return out;
+    }
+
+    std::u16string ToUtf16(const std::u32string& code_points) {
+        std::u16string out;
+        for (char32_t cp : code_points) {
+            if (cp < 0x10000) {
+                out += static_cast<char16_t>(cp);
+            }
+            else {
+                out += static_cast<char16_t>(0xD800 + ((cp - 0x10000) >> 10));
+                out += static_cast<char16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            }
+        }
+        return out;
+    }
+
+    std::string Hex(const std::string& bytes) {
+        static const char digits[] = "0123456789ABCDEF";
+        std::string out;
+        for (unsigned char c : bytes) {
+            out += digits[c >> 4];
+            out += digits[c & 15];
+            out += ' ';
+        }
+        return out;
+    }
+
+    const std::u16string kFffd(1, static_cast<char16_t>(Utf::kReplacementChar));
+
+    std::u16string Replacements(size_t count) {
+        std::u16string out;
+        for (size_t i = 0; i < count; ++i) out += kFffd;
+        return out;
+    }
+
+    void MaximalSubparts() {
+        struct Case {
+            std::string in;
+            std::u16string out;
+        };
+        const Case cases[] = {
+            // Unicode 标准 3.9 节的示例：F1 80 80 是一个截断的四字节序列，只替换一次
+            { "\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64", u"a\uFFFD\uFFFD\uFFFDb\uFFFDc\uFFFD\uFFFDd" },
+            { "\xC0\x80", Replacements(2) },             // 过长编码的首字节本身非法
+            { "\xE0\x80\x80", Replacements(3) },         // E0 之后必须是 A0..BF
+            { "\xED\xA0\x80", Replacements(3) },         // 代理区码点
+            { "\xF4\x90\x80\x80", Replacements(4) },     // 超出 U+10FFFF
+            { "\xF5\x80", Replacements(2) },
+            { "\xFF", Replacements(1) },
+            { "\xE2\x82", Replacements(1) },             // 输入在序列中间结束
+            { "\xF0\x9F\x98", Replacements(1) },
+            { "\xF0\x9F\x98x", kFffd + u"x" },
+            { "\xE2\x82\xAC\xE2\x82", u"\u20AC" + kFffd },
+            { "\xF0\x9F\x98\x80", u"\U0001F600" },
+            { "\xEF\xBF\xBF\xF4\x8F\xBF\xBF", u"\uFFFF\U0010FFFF" },
+            { std::string("a\0b", 3), std::u16string(u"a\0b", 3) },
+        };
+        for (const Case& c : cases) {
+            VN_CHECK_MSG(Utf::ToUtf16(c.in) == c.out, Hex(c.in));
+            VN_CHECK_MSG(Utf::ToUtf16(c.in) == ToUtf16(ReferenceDecode(c.in)), Hex(c.in));
+            bool valid = c.out.find(kFffd) == std::u16string::npos;
+            VN_CHECK_MSG(Utf::IsValidUtf8(c.in) == valid, Hex(c.in));
+        }
+    }
+
+    // 随机字节串：ASCII 段的长度跨越 16 字节分组的边界，其后接合法或非法的多字节序列
+    void MatchesReference() {
+        static const char* fragments[] = {
+            "\xC3\xA9", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80", "\x80", "\xBF", "\xC0", "\xC2", "\xE0\xA0", "\xE0\x9F\xBF",
+            "\xED\x9F\xBF", "\xED\xA0\x80", "\xF0\x90", "\xF4\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80", "\xFE", "\xFF",
+        };
+        std::mt19937 rng(47);
+        for (int iteration = 0; iteration < 20000; ++iteration) {
+            std::string in;
+            for (size_t parts = 1 + rng() % 5; parts > 0; --parts) {
+                in.append(rng() % 40, static_cast<char>('a' + rng() % 26));
+                in += fragments[rng() % (sizeof(fragments) / sizeof(fragments[0]))];
+            }
+            if (rng() % 3 == 0) in.resize(rng() % (in.size() + 1));
+
+            std::u32string code_points = ReferenceDecode(in);
+            std::u16string utf16;
+            Utf::Utf8ToUtf16(in, utf16);
+            VN_CHECK_MSG(utf16 == ToUtf16(code_points), Hex(in));
+
+            bool valid = code_points.find(Utf::kReplacementChar) == std::u32string::npos;
+            VN_CHECK_MSG(Utf::IsValidUtf8(in) == valid, Hex(in));
+            // 替换后的结果总是合法的，再转换一次保持不变
+            std::string back = Utf::ToUtf8(utf16);
+            VN_CHECK(Utf::IsValidUtf8(back));
+            VN_CHECK(Utf::ToUtf16(back) == utf16);
+            if (valid) VN_CHECK_MSG(back == in, Hex(in));
+
+            if (sizeof(wchar_t) == 4) {
+                std::wstring wide = Utf::ToWide(in);
+                VN_CHECK_MSG(std::u32string(wide.begin(), wide.end()) == code_points, Hex(in));
+            }
+            else {
+                std::wstring wide = Utf::ToWide(in);
+                VN_CHECK_MSG(std::u16string(wide.begin(), wide.end()) == utf16, Hex(in));
+            }
+        }
+    }
+
+    void Utf16Errors() {
+        // 孤立的高 / 低代理项与顺序颠倒的代理对各替换为一个 U+FFFD
+        VN_CHECK(Utf::ToUtf8(std::u16string(u"\xD800" u"a")) == "\xEF\xBF\xBD" "a");
+        VN_CHECK(Utf::ToUtf8(std::u16string(1, static_cast<char16_t>(0xDC00))) == "\xEF\xBF\xBD");
+        VN_CHECK(Utf::ToUtf8(std::u16string({ static_cast<char16_t>(0xDC00), static_cast<char16_t>(0xD800) })) == "\xEF\xBF\xBD\xEF\xBF\xBD");
+        VN_CHECK(Utf::ToUtf8(std::u16string({ static_cast<char16_t>(0xD83D), static_cast<char16_t>(0xDE00) })) == "\xF0\x9F\x98\x80");
+        VN_CHECK(Utf::ToUtf8(std::u16string(1, static_cast<char16_t>(0xD83D))) == "\xEF\xBF\xBD"); // 输入在代理对中间结束
+
+        if (sizeof(wchar_t) == 4) {
+            std::wstring wide = { L'a', static_cast<wchar_t>(0xD800), static_cast<wchar_t>(0x110000), static_cast<wchar_t>(0x10FFFF) };
+            VN_CHECK(Utf::ToUtf8(wide) == "a\xEF\xBF\xBD\xEF\xBF\xBD\xF4\x8F\xBF\xBF");
+        }
+    }
+
+    // 输出复用调用方字符串的容量，旧内容被完全覆盖
+    void OutputOverwritten() {
+        std::u16string utf16 = u"previous content that is longer than the input";
+        Utf::Utf8ToUtf16("ok\xC3\xA9", utf16);
+        VN_CHECK(utf16 == u"oké");
+        std::string utf8 = "previous content that is longer than the input";
+        Utf::Utf16ToUtf8(u"é!", utf8);
+        VN_CHECK(utf8 == "\xC3\xA9!");
+        Utf::Utf8ToUtf16("", utf16);
+        VN_CHECK(utf16.empty());
+    }
+}
+
+int main(int argc, char** argv) {
+    TestHarness::ParseArgs(argc, argv);
+    TestHarness::Run("utf/maximal_subparts", MaximalSubparts);
+    TestHarness::Run("utf/matches_reference", MatchesReference);
+    TestHarness::Run("utf/utf16_errors", Utf16Errors);
+    TestHarness::Run("utf/output_overwritten", OutputOverwritten);
+    return TestHarness::Finish();
+}
@@ -2,10 +2,11 @@
 abstract class DataChildBlock extends Block {
     static override label: string;
     abstract renderPresetConfigPanel(preset, dbJsonCache, markDirtyCallback, parentDataBlock);
-    abstract _renderDataContent(rawData, config, element, properties, isForExport?);
+    abstract _renderDataContent(rawData, config, element, properties, isForExport?, queryResult?);
     
     _lastRawData = null;
     _lastConfig = null;
+    _lastQueryResult = null;
     _cfgCtx;
     configContainer: HTMLDivElement;
 }
@@ -31,6 +32,11 @@ class DataBlock extends Block {
 
 
     _rawData;
+    _queryResult = null;
+    _cursorId = null; // 当前打开的后端查询游标
+
+    // 后端游标每个窗口的行数
+    static QUERY_PAGE_SIZE = 200;
 
     constructor(data, editor) {
         super(data, editor);
@@ -41,6 +47,7 @@ class DataBlock extends Block {
     }
 
     _dbJsonCache = null; // Public
+    _dbFromBackend = false; // _dbJsonCache 是否与后端已保存的文件一致（可以交给后端查询）
 
 
     /**
@@ -87,6 +94,7 @@ class DataBlock extends Block {
                         this.properties.dbPath = result.dbPath;
                         this.properties.presetId = result.presetId;
                         this._dbJsonCache = null;
+                        this._dbFromBackend = false;
                         this._loadDatabaseAndRender().then(() => this._refreshDetailsPanel());
                         this.BAPI_PE.emitChange(true, 'change-db-preset', this);
                     }
@@ -112,22 +120,38 @@ class DataBlock extends Block {
 
         this.contentElement.innerHTML = '<div style="padding:10px;">Loading database view...</div>';
 
-        this._loadDatabaseAndRender();
+        this._loadDatabaseAndRender().catch(err => {
+            console.error(`Failed to render database view "${this.properties.dbPath}":`, err);
+            this.contentElement.innerHTML = '<div style="padding:10px; color:red;">Failed to load database.</div>';
+        });
     }
 
-    async _getRawData() {
+    // full 为 false 时，行数据留在后端的数据库只返回首行（足够解析表头）
+    async _getRawData(full = false) {
         // 1. 获取 DB JSON
         if (!this._dbJsonCache) { // 不可以删除此判断！不可以删除此判断！
             const absolutePath = this.BAPI_WD.resolveWorkspacePath(this.properties.dbPath);
             this._dbJsonCache = await this._fetchJson(absolutePath);
+            this._dbFromBackend = true;
         }
 
         const preset = this._dbJsonCache.presets.find(p => p.id === this.properties.presetId);
         if (!preset) throw new Error("Preset not found in DB.");
 
+        if (this._dbFromBackend && this._dbJsonCache.firstRow) {
+            if (!full) return [this._dbJsonCache.firstRow];
+            const absolutePath = this.BAPI_WD.resolveWorkspacePath(this.properties.dbPath);
+            this._dbJsonCache = await this._fetchJson(absolutePath, false);
+        }
+
         // 2. 获取数据 (解析 Embedded 或 请求 External)
         const dbData = this._dbJsonCache.data;
-        if (dbData.mode === 'embedded') {
+        if (dbData.mode === 'embedded' && dbData.storage === 'columnar' && !dbData.embeddedData) {
+            // 列式存储的行只在后端（数据库编辑器传入的文档里没有行数据），单独取首行或全部行
+            const absolutePath = this.BAPI_WD.resolveWorkspacePath(this.properties.dbPath);
+            const content = await this._fetchJson(absolutePath, !full);
+            return full ? (content.data.embeddedData || []) : [content.firstRow || []];
+        } else if (dbData.mode === 'embedded') {
             return dbData.embeddedData;
         } else if (dbData.mode === 'external' && dbData.externalUrl) {
             return await this._fetchExternalCsv(dbData.externalUrl);
@@ -136,6 +160,36 @@ class DataBlock extends Block {
         }
     }
 
+    // 在后端打开查询游标：先拿到第一个窗口，其余的行在表格滚动到底部时按窗口取回
+    async _openQuery(preset) {
+        if (this._cursorId !== null) {
+            this.BAPI_IPC.closeQuery(this._cursorId);
+            this._cursorId = null;
+        }
+
+        const absolutePath = this.BAPI_WD.resolveWorkspacePath(this.properties.dbPath);
+        const result = await this.BAPI_IPC.openQuery(this.id + '-query-' + Date.now(), absolutePath, preset.id, preset.config, DataBlock.QUERY_PAGE_SIZE);
+        if (!result['success']) return null;
+
+        const cursorId = result['cursorId'];
+        this._cursorId = cursorId;
+        result['pageSize'] = DataBlock.QUERY_PAGE_SIZE;
+        result['fetchRows'] = async (offset) => {
+            if (this._cursorId !== cursorId) return null;
+            const page = await this.BAPI_IPC.fetchRows(this.id + '-rows-' + offset + '-' + Date.now(), cursorId, offset, DataBlock.QUERY_PAGE_SIZE);
+            if (page['expired']) {
+                // 数据库文件已被保存，游标随之失效：按最新数据重新渲染
+                if (this._cursorId === cursorId) {
+                    this._cursorId = null;
+                    this._loadDatabaseAndRender();
+                }
+                return null;
+            }
+            return page['success'] ? page : null;
+        };
+        return result;
+    }
+
     async _loadDatabaseAndRender() {
         this._rawData = await this._getRawData();
         const preset = this._dbJsonCache.presets.find(p => p.id === this.properties.presetId);
@@ -143,6 +197,16 @@ class DataBlock extends Block {
 
         if (!preset.config) preset.config = {};
 
+        // 数据与后端文件一致时（非数据库编辑器中未保存的预览），筛选/排序交给后端
+        // 列式存储的行数据不会在前端被修改，未保存的只有 preset 配置，而 openQuery 直接使用传入的配置
+        const dbData = this._dbJsonCache.data;
+        const columnar = dbData.mode === 'embedded' && dbData.storage === 'columnar';
+        const queryable = (this._dbFromBackend || columnar) && !(dbData.mode === 'external' && /^https?:\/\//.test(dbData.externalUrl || ''));
+        this._queryResult = queryable ? await this._openQuery(preset) : null;
+        if (!this._queryResult && ((this._dbFromBackend && this._dbJsonCache.firstRow) || columnar)) {
+            this._rawData = await this._getRawData(true);
+        }
+
         let childBlock = this.children[0];
 
         // 检查是否需要重新创建子块（类型改变或首次加载）
@@ -166,29 +230,21 @@ class DataBlock extends Block {
         this.contentElement.appendChild(childEl);
 
         // 将原始数据和 preset.config 动态喂给子块，命令其绘制内部结构
-        childBlock._renderDataContent(this._rawData, preset.config, childBlock.element, childBlock.properties);
+        childBlock._renderDataContent(this._rawData, preset.config, childBlock.element, childBlock.properties, false, this._queryResult);
     }
 
-    _fetchJson(path) {
-        return new Promise((resolve) => {
-            const reqId = this.id + '-' + Date.now();
-            const listener = (e) => {
-                if (e.detail.payload.dataBlockId === reqId) {
-                    window.removeEventListener('dataContentFetched', listener);
-                    let content = e.detail.payload.content;
-                    if (typeof content === 'string') {
-                        try { content = JSON.parse(content); }
-                        catch (err) { content = { data: {}, presets: [] }; }
-                    }
-                    resolve(content);
-                }
-            };
-            window.addEventListener('dataContentFetched', listener);
-            this.BAPI_IPC.fetchDataContent(reqId, path);
-        });
+    // 同一页面上引用同一数据库的 DataBlock 共用一次请求和一份结果（只读）
+    _fetchJson(path, headerOnly = true) {
+        return this.BAPI_IPC.fetchSharedDataContent(path, headerOnly);
     }
 
     async _fetchExternalCsv(url) {
+        // 工作区内的文件交给后端原生解析（支持引号/换行等完整 CSV 语法，不阻塞 WebView）
+        if (!/^https?:\/\//.test(url)) {
+            const absolutePath = this.BAPI_WD.resolveWorkspacePath(url);
+            const result = await this.BAPI_IPC.parseCsv(this.id + '-csv-' + Date.now(), absolutePath);
+            if (result['success']) return result['rows'];
+        }
         const res = await fetch(url);
         const text = await res.text();
         return this._parseCSV(text);
@@ -253,11 +309,18 @@ class DataBlock extends Block {
                 this.properties.dbPath = newPath;
                 this.properties.presetId = '';
                 this._dbJsonCache = null;
+                this._dbFromBackend = false;
 
                 if (newPath) {
                     const absolutePath = this.BAPI_WD.resolveWorkspacePath(newPath);
                     this._fetchJson(absolutePath).then(json => {
                         this._dbJsonCache = json;
+                        this._dbFromBackend = true;
+                        this._renderContent();
+                        this._refreshDetailsPanel();
+                    }).catch(err => {
+                        console.error(`Failed to load database "${newPath}":`, err);
+                        this._dbJsonCache = null;
                         this._renderContent();
                         this._refreshDetailsPanel();
                     });
@@ -281,6 +344,7 @@ class DataBlock extends Block {
 
         refreshBtn.addEventListener('click', () => {
             this._dbJsonCache = null;
+            this._dbFromBackend = false;
             this._rawData = null;
             this._loadDatabaseAndRender().then(() => this._refreshDetailsPanel());
         });
@@ -296,6 +360,7 @@ class DataBlock extends Block {
             const absolutePath = this.BAPI_WD.resolveWorkspacePath(this.properties.dbPath);
             this._fetchJson(absolutePath).then(json => {
                 this._dbJsonCache = json;
+                this._dbFromBackend = true;
                 this._refreshDetailsPanel();
             });
         }
@@ -381,9 +446,34 @@ class DataBlock extends Block {
                     
                     const preset = dbJson.presets.find(p => p.id === presetId);
                     if (!preset) throw new Error('Preset not found in DB');
-                      
+
+                    // 导出时已按 preset 计算好的结果：先加载第一块，其余块在表格滚动到底部时再加载
+                    let queryResult = null;
+                    const view = dbJson.views && dbJson.views[presetId];
+                    if (view) {
+                        const loadChunk = (k) => window.VeritNoteDBLoader.load(scriptUrl.slice(0, -3) + '.data/' + view.index + '-' + k + '.js', dbKey + '#' + view.index + '#' + k);
+                        const first = await loadChunk(0);
+                        queryResult = {
+                            firstRow: view.firstRow,
+                            rows: first.rows.slice(), // 表格会把后续块追加到 rows 上，块本身被同一 preset 的所有表格共用
+                            groups: first.groups,
+                            totals: view.totals,
+                            offset: 0,
+                            rowCount: view.rowCount,
+                            totalRows: view.totalRows,
+                            fetchRows: async (offset) => {
+                                const k = Math.floor(offset / view.chunkRows);
+                                if (k >= view.chunks) return { rows: [], groups: [] };
+                                const chunk = await loadChunk(k);
+                                return { rows: chunk.rows.slice(offset - k * view.chunkRows), groups: chunk.groups };
+                            }
+                        };
+                    }
+
                     const dbData = dbJson.data;
-                    if (dbData.mode === 'embedded' && dbData.embeddedData) {
+                    if (queryResult) {
+                        rawData = null;
+                    } else if (dbData.mode === 'embedded' && dbData.embeddedData) {
                         rawData = dbData.embeddedData;
                     } else if (dbData.mode === 'external' && dbData.externalUrl) {
                         const res = await fetch(dbData.externalUrl);
@@ -407,7 +497,7 @@ class DataBlock extends Block {
                     const childElement = contentEl.querySelector('.data-child-container');
 
                     if (window.DataBlockRenderers[childType]) {
-                        window.DataBlockRenderers[childType](rawData, preset.config, childElement, childProperties, true);
+                        window.DataBlockRenderers[childType](rawData, preset.config, childElement, childProperties, true, queryResult);
                     }
                 } catch(e) {
                     console.error('DataBlock export init failed for block ' + '${this.id}', e);
@@ -22,6 +22,7 @@ class TableViewBlock extends DataChildBlock {
         // 缓存父级传来的数据，用于 Details 面板修改属性后自身触发的重绘
         this._lastRawData = null;
         this._lastConfig = null;
+        this._lastQueryResult = null;
     }
 
     _renderContent() {
@@ -30,7 +31,7 @@ class TableViewBlock extends DataChildBlock {
 
         // 如果已经有缓存的数据（通常是重绘触发），则执行渲染逻辑
         if (this._lastRawData && this._lastConfig) {
-            this._renderDataContent(this._lastRawData, this._lastConfig, this.contentElement, this.properties);
+            this._renderDataContent(this._lastRawData, this._lastConfig, this.contentElement, this.properties, false, this._lastQueryResult);
         }
     }
 
@@ -101,6 +102,17 @@ class TableViewBlock extends DataChildBlock {
                     config.columns[parseInt(target.dataset['colIndex'])].statusMappings.splice(parseInt(target.dataset['mapIndex']), 1);
                     markDirtyCallback();
                     this.renderPresetConfigPanel(preset, dbJsonCache, markDirtyCallback, parentDataBlock);
+                } else if (target.classList.contains('add-filter-btn') || target.classList.contains('add-sort-btn')) {
+                    const key = target.classList.contains('add-filter-btn') ? 'filters' : 'sorts';
+                    if (!config[key]) config[key] = [];
+                    const firstCol = config.columns[0]?.sourceHeader || '';
+                    config[key].push(key === 'filters' ? { column: firstCol, op: 'eq', value: '' } : { column: firstCol, direction: 'asc' });
+                    markDirtyCallback();
+                    this.renderPresetConfigPanel(preset, dbJsonCache, markDirtyCallback, parentDataBlock);
+                } else if (target.classList.contains('query-delete')) {
+                    config[target.dataset['list']].splice(parseInt(target.dataset['index']), 1);
+                    markDirtyCallback();
+                    this.renderPresetConfigPanel(preset, dbJsonCache, markDirtyCallback, parentDataBlock);
                 }
             });
 
@@ -145,6 +157,20 @@ class TableViewBlock extends DataChildBlock {
                 } else if (target.classList.contains('map-html')) {
                     config.columns[parseInt(target.dataset['colIndex'])].statusMappings[parseInt(target.dataset['mapIndex'])].html = (target as HTMLInputElement).value;
                     markDirtyCallback();
+                } else if (target.classList.contains('col-aggregate-select')) {
+                    const value = (target as HTMLSelectElement).value;
+                    const col = config.columns[parseInt(target.dataset['index'])];
+                    if (value) col.aggregate = value; else delete col.aggregate;
+                    markDirtyCallback();
+                } else if (target.classList.contains('query-field')) {
+                    // filters / sorts 条目中的单个字段
+                    const item = config[target.dataset['list']][parseInt(target.dataset['index'])];
+                    item[target.dataset['field']] = (target as HTMLInputElement).value;
+                    markDirtyCallback();
+                } else if (target.classList.contains('group-by-select')) {
+                    const value = (target as HTMLSelectElement).value;
+                    if (value) config.groupBy = value; else delete config.groupBy;
+                    markDirtyCallback();
                 }
             });
         }
@@ -168,6 +194,8 @@ class TableViewBlock extends DataChildBlock {
                 <select class="db-input first-row-mode-select">${modeOptions}</select>
             </div>
             <hr style="border:0; border-top:1px solid var(--border-primary); margin: 15px 0;">
+            ${this._renderQueryConfig(config, headers)}
+            <hr style="border:0; border-top:1px solid var(--border-primary); margin: 15px 0;">
             <div style="display:flex; justify-content:space-between; align-items:center; margin-bottom:10px;">
                 <span style="font-weight:bold; font-size:12px;">Columns</span>
                 <button class="primary-btn add-col-btn" style="padding:4px 8px;">+ Add Col</button>
@@ -181,6 +209,8 @@ class TableViewBlock extends DataChildBlock {
             const isHeaderMode = config.firstRowMode === 'header';
 
             const headerOptions = headers.map(h => `<option value="${h}" ${h === col.sourceHeader ? 'selected' : ''}>${h}</option>`).join('');
+            const aggregates = ['', 'count', 'sum', 'avg', 'min', 'max'];
+            const aggregateOptions = aggregates.map(a => `<option value="${a}" ${(col.aggregate || '') === a ? 'selected' : ''}>${a || 'none'}</option>`).join('');
 
             let statusEditorHtml = '';
             if (col.type === 'status') {
@@ -223,6 +253,9 @@ class TableViewBlock extends DataChildBlock {
                     
                     <label style="font-size:11px; color:var(--text-secondary);">Type:</label>
                     <select class="db-input col-type-select" data-index="${index}">${typeOptions}</select>
+
+                    <label style="font-size:11px; color:var(--text-secondary);">Aggregate:</label>
+                    <select class="db-input col-aggregate-select" data-index="${index}">${aggregateOptions}</select>
                     ${statusEditorHtml}
                 </div>
             `;
@@ -233,16 +266,70 @@ class TableViewBlock extends DataChildBlock {
         return this.configContainer;
     }
 
+    // 筛选 / 排序 / 分组配置面板
+    _renderQueryConfig(config, headers) {
+        const columnOptions = (selected) => headers.map(h => `<option value="${h}" ${h === selected ? 'selected' : ''}>${h}</option>`).join('');
+        const ops = [['eq', '='], ['neq', '≠'], ['lt', '<'], ['lte', '≤'], ['gt', '>'], ['gte', '≥'], ['contains', 'contains'], ['startsWith', 'starts with'], ['empty', 'is empty'], ['notEmpty', 'is not empty']];
+
+        let html = `
+            <div style="display:flex; justify-content:space-between; align-items:center; margin-bottom:6px;">
+                <span style="font-weight:bold; font-size:12px;">Filters</span>
+                <button class="db-btn add-filter-btn" style="padding:2px 6px; font-size:11px;">+ Filter</button>
+            </div>
+        `;
+        (config.filters || []).forEach((f, index) => {
+            const opOptions = ops.map(([v, label]) => `<option value="${v}" ${f.op === v ? 'selected' : ''}>${label}</option>`).join('');
+            const needsValue = f.op !== 'empty' && f.op !== 'notEmpty';
+            html += `
+                <div style="display:flex; gap:4px; align-items:center; margin-bottom:4px;">
+                    <select class="db-input query-field" data-list="filters" data-index="${index}" data-field="column" style="margin:0; flex:2;">${columnOptions(f.column)}</select>
+                    <select class="db-input query-field" data-list="filters" data-index="${index}" data-field="op" style="margin:0; flex:1;">${opOptions}</select>
+                    <input type="text" class="db-input query-field" data-list="filters" data-index="${index}" data-field="value" value="${String(f.value ?? '').replace(/"/g, '&quot;')}" style="margin:0; flex:2; ${needsValue ? '' : 'visibility:hidden;'}">
+                    <button class="db-icon-btn delete query-delete" data-list="filters" data-index="${index}">×</button>
+                </div>
+            `;
+        });
+
+        html += `
+            <div style="display:flex; justify-content:space-between; align-items:center; margin:10px 0 6px;">
+                <span style="font-weight:bold; font-size:12px;">Sort</span>
+                <button class="db-btn add-sort-btn" style="padding:2px 6px; font-size:11px;">+ Sort</button>
+            </div>
+        `;
+        (config.sorts || []).forEach((s, index) => {
+            html += `
+                <div style="display:flex; gap:4px; align-items:center; margin-bottom:4px;">
+                    <select class="db-input query-field" data-list="sorts" data-index="${index}" data-field="column" style="margin:0; flex:2;">${columnOptions(s.column)}</select>
+                    <select class="db-input query-field" data-list="sorts" data-index="${index}" data-field="direction" style="margin:0; flex:1;">
+                        <option value="asc" ${s.direction !== 'desc' ? 'selected' : ''}>Ascending</option>
+                        <option value="desc" ${s.direction === 'desc' ? 'selected' : ''}>Descending</option>
+                    </select>
+                    <button class="db-icon-btn delete query-delete" data-list="sorts" data-index="${index}">×</button>
+                </div>
+            `;
+        });
+
+        html += `
+            <div style="margin-top:10px;">
+                <label style="font-size:12px;">Group By:</label>
+                <select class="db-input group-by-select"><option value="">(none)</option>${columnOptions(config.groupBy)}</select>
+            </div>
+        `;
+        return html;
+    }
+
     // 由 DataBlock 调用
-    // 由 DataBlock 调用
-    _renderDataContent(rawData, config, element, properties, isForExport = false) {
+    // queryResult: 后端 queryData 的结果（已筛选/排序/分页）；为空时（导出页面、编辑器中的未保存预览）在这里对完整数据求值
+    _renderDataContent(rawData, config, element, properties, isForExport = false, queryResult = null) {
         // 缓存数据，以便在 Details 面板修改属性后触发 _renderContent 时重绘
         this._lastRawData = rawData;
         this._lastConfig = config;
+        this._lastQueryResult = queryResult;
 
         if (!config) return;
         if (!config.columns) config.columns = [];
 
+        if (queryResult) rawData = [queryResult.firstRow];
         if (!rawData || rawData.length === 0) {
             element.innerHTML = '<div style="padding:10px; color:gray;">Empty data.</div>';
             return;
@@ -263,6 +350,109 @@ class TableViewBlock extends DataChildBlock {
             dataRows = rawData;
         }
 
+        // 查询：与后端 QueryEngine 相同的语义（筛选 → 分组列 + 排序 → 分组 → 聚合）
+        let groups = [];
+        let totals = {};
+        let pageOffset = 0;
+        let totalRows = dataRows.length;
+        if (queryResult) {
+            dataRows = queryResult.rows;
+            groups = queryResult.groups || [];
+            totals = queryResult.totals || {};
+            pageOffset = queryResult.offset || 0;
+            totalRows = queryResult.totalRows;
+        } else {
+            const colOf = (name) => sourceHeaders.indexOf(name);
+            const isEmpty = (v) => v === null || v === undefined || v === '';
+            const toNum = (v) => {
+                if (typeof v === 'number') return v;
+                if (typeof v !== 'string' || v.trim() === '') return null;
+                const n = Number(v);
+                return isFinite(n) ? n : null;
+            };
+            const toText = (v) => isEmpty(v) ? '' : String(v);
+            const cmp = (op, a, b) => op === 'eq' ? a === b : op === 'neq' ? a !== b : op === 'lt' ? a < b : op === 'lte' ? a <= b : op === 'gt' ? a > b : op === 'gte' ? a >= b : false;
+            const match = (cell, f) => {
+                const empty = isEmpty(cell);
+                if (f.op === 'empty') return empty;
+                if (f.op === 'notEmpty') return !empty;
+                const text = toText(f.value);
+                if (empty) return f.op === 'neq' && text !== '';
+                if (f.op === 'contains' || f.op === 'startsWith') {
+                    const pos = toText(cell).toLowerCase().indexOf(text.toLowerCase());
+                    return f.op === 'contains' ? pos !== -1 : pos === 0;
+                }
+                const fv = toNum(f.value);
+                if (fv !== null) {
+                    const cv = toNum(cell);
+                    if (cv !== null) return cmp(f.op, cv, fv);
+                    if (f.op !== 'eq' && f.op !== 'neq') return false;
+                }
+                return cmp(f.op, toText(cell), text);
+            };
+
+            const filters = (config.filters || []).filter(f => colOf(f.column) !== -1);
+            dataRows = dataRows.filter(row => filters.every(f => match(row[colOf(f.column)], f)));
+
+            const sorts = (config.sorts || []).filter(s => colOf(s.column) !== -1);
+            const grouped = config.groupBy && colOf(config.groupBy) !== -1;
+            if (grouped) sorts.unshift({ column: config.groupBy, direction: 'asc' });
+            const compareCells = (a, b) => {
+                const ea = isEmpty(a), eb = isEmpty(b);
+                if (ea || eb) return ea === eb ? 0 : (ea ? 1 : -1);
+                const na = toNum(a), nb = toNum(b);
+                if (na !== null && nb !== null) return na - nb;
+                const ta = toText(a), tb = toText(b);
+                return ta < tb ? -1 : ta > tb ? 1 : 0;
+            };
+            if (sorts.length > 0) {
+                dataRows = dataRows.map((row, i) => [row, i]).sort((x, y) => {
+                    for (const s of sorts) {
+                        const a = x[0][colOf(s.column)], b = y[0][colOf(s.column)];
+                        let c = compareCells(a, b);
+                        if (c !== 0 && s.direction === 'desc' && !isEmpty(a) && !isEmpty(b)) c = -c;
+                        if (c !== 0) return c;
+                    }
+                    return x[1] - y[1];
+                }).map(x => x[0]);
+            }
+
+            const aggregate = (rows) => {
+                const out = {};
+                config.columns.forEach((col, i) => {
+                    const c = colOf(col.sourceHeader);
+                    if (!col.aggregate || c === -1) return;
+                    let count = 0, numeric = 0, sum = 0, min = null, max = null;
+                    rows.forEach(row => {
+                        const v = row[c];
+                        if (isEmpty(v)) return;
+                        count++;
+                        const n = typeof v === 'boolean' ? null : toNum(v);
+                        if (n === null) return;
+                        numeric++; sum += n;
+                        if (min === null || n < min) min = n;
+                        if (max === null || n > max) max = n;
+                    });
+                    out[i] = col.aggregate === 'count' ? count : col.aggregate === 'sum' ? sum : col.aggregate === 'avg' ? (numeric ? sum / numeric : null) : col.aggregate === 'min' ? min : max;
+                });
+                return out;
+            };
+            if (grouped) {
+                const g = colOf(config.groupBy);
+                let start = 0;
+                for (let i = 1; i <= dataRows.length; i++) {
+                    if (i === dataRows.length || compareCells(dataRows[i - 1][g], dataRows[i][g]) !== 0) {
+                        groups.push({ key: dataRows[start][g], start: start, count: i - start, aggregates: aggregate(dataRows.slice(start, i)) });
+                        start = i;
+                    }
+                }
+            }
+            totals = aggregate(dataRows);
+            totalRows = dataRows.length;
+        }
+        const hasAggregates = config.columns.some(col => col.aggregate);
+        const formatAggregate = (v) => (v === null || v === undefined) ? '' : (typeof v === 'number' && !Number.isInteger(v) ? v.toFixed(2) : String(v));
+
         const totalCols = config.columns.length;
         if (totalCols === 0) {
             element.innerHTML = '<div style="padding:10px;">No columns configured in this preset.</div>';
@@ -392,20 +582,90 @@ class TableViewBlock extends DataChildBlock {
         // 渲染数据行（数据部分仍用 innerHTML 拼装以保证大数据量的渲染性能）
         const tbody = document.createElement('tbody');
         let tbodyHtml = '';
-        dataRows.forEach(row => {
-            tbodyHtml += `<tr>`;
-            config.columns.forEach(col => {
-                let colIndex = sourceHeaders.indexOf(col.sourceHeader);
-                let cellValue = (colIndex > -1 && colIndex < row.length) ? row[colIndex] : '';
-                tbodyHtml += `<td>${_processCellType(cellValue, col)}</td>`;
+        const groupRowHtml = (group) => {
+            let html = `<tr class="table-view-group-row">`;
+            config.columns.forEach((col, i) => {
+                const agg = group.aggregates && group.aggregates[i] !== undefined ? `${col.aggregate}: ${formatAggregate(group.aggregates[i])}` : '';
+                const label = i === 0 ? `${String(group.key ?? '(empty)').replace(/</g, "&lt;")} (${group.count})` : '';
+                html += `<td>${[label, agg].filter(s => s).join(' · ')}</td>`;
             });
-            tbodyHtml += `</tr>`;
-        });
+            return html + `</tr>`;
+        };
+        // continuation: 追加的后续窗口，跨窗口的分组不重复标题行
+        const rowsHtml = (rows, startOffset, continuation) => {
+            let html = '';
+            let groupIndex = 0;
+            rows.forEach((row, rowIndex) => {
+                // 分组标题行：插在每组的第一行之前（跨页的组在页首重复一次）
+                const absolute = startOffset + rowIndex;
+                while (groupIndex < groups.length && groups[groupIndex].start + groups[groupIndex].count <= absolute) groupIndex++;
+                if (groupIndex < groups.length && (groups[groupIndex].start === absolute || (rowIndex === 0 && !continuation))) {
+                    html += groupRowHtml(groups[groupIndex]);
+                }
+                html += `<tr>`;
+                config.columns.forEach(col => {
+                    let colIndex = sourceHeaders.indexOf(col.sourceHeader);
+                    let cellValue = (colIndex > -1 && colIndex < row.length) ? row[colIndex] : '';
+                    html += `<td>${_processCellType(cellValue, col)}</td>`;
+                });
+                html += `</tr>`;
+            });
+            return html;
+        };
+        tbodyHtml = rowsHtml(dataRows, pageOffset, false);
         tbody.innerHTML = tbodyHtml;
         table.appendChild(tbody);
 
+        if (hasAggregates) {
+            const tfoot = document.createElement('tfoot');
+            let footHtml = `<tr class="table-view-total-row">`;
+            config.columns.forEach((col, i) => {
+                footHtml += `<td>${col.aggregate && totals[i] !== undefined ? `${col.aggregate}: ${formatAggregate(totals[i])}` : ''}</td>`;
+            });
+            tfoot.innerHTML = footHtml + `</tr>`;
+            table.appendChild(tfoot);
+        }
+
         container.appendChild(table);
 
+        if (dataRows.length < totalRows) {
+            const info = document.createElement('div');
+            info.className = 'table-view-page-info';
+            info.textContent = `Showing ${dataRows.length} of ${totalRows} rows`;
+            container.appendChild(info);
+
+            // 后端游标（导出页面中为数据库包的分块）：首屏只渲染第一个窗口，提示条滚动到可见范围附近时再取下一个窗口追加到表格末尾
+            if (queryResult && queryResult.fetchRows && typeof IntersectionObserver !== 'undefined') {
+                let loading = false;
+                const observer = new IntersectionObserver(async (entries) => {
+                    if (loading || !entries.some(entry => entry.isIntersecting)) return;
+                    if (!info.isConnected) { observer.disconnect(); return; }
+                    loading = true;
+                    const offset = pageOffset + dataRows.length;
+                    const page = await queryResult.fetchRows(offset);
+                    loading = false;
+                    if (!page || page.rows.length === 0 || !info.isConnected) { observer.disconnect(); return; }
+
+                    (page.groups || []).forEach(group => {
+                        if (!groups.some(g => g.start === group.start)) groups.push(group);
+                    });
+                    tbody.insertAdjacentHTML('beforeend', rowsHtml(page.rows, offset, true));
+                    // 追加的行也记入结果，属性修改触发的重绘不会退回到第一个窗口
+                    dataRows.push(...page.rows);
+                    info.textContent = `Showing ${dataRows.length} of ${totalRows} rows`;
+                    if (dataRows.length >= totalRows) {
+                        observer.disconnect();
+                        info.remove();
+                    } else {
+                        // 提示条仍在可见范围内时（窗口很矮）继续加载
+                        observer.unobserve(info);
+                        observer.observe(info);
+                    }
+                }, { root: properties.maxHeight ? container : null, rootMargin: '400px 0px' });
+                observer.observe(info);
+            }
+        }
+
         // 清空原内容并挂载新 DOM
         element.innerHTML = '';
         element.appendChild(container);
@@ -52,6 +52,9 @@ export class DatabaseEditor extends Editor {
             refreshDataBtn: this.container.querySelector('#db-refresh-data-btn') as HTMLButtonElement,
             importCsvBtn: this.container.querySelector('#db-import-csv-btn') as HTMLButtonElement,
             embeddedInfo: this.container.querySelector('#db-embedded-info') as HTMLElement,
+            storageBtn: this.container.querySelector('#db-storage-btn') as HTMLButtonElement,
+            indexesBtn: this.container.querySelector('#db-indexes-btn') as HTMLButtonElement,
+            indexesPanel: this.container.querySelector('#db-indexes-panel') as HTMLElement,
             tabsContainer: this.container.querySelector('#db-presets-tabs') as HTMLElement,
             addPresetBtn: this.container.querySelector('#db-add-preset-btn') as HTMLButtonElement,
             configPanel: this.container.querySelector('#db-preset-config-panel') as HTMLElement,
@@ -104,9 +107,17 @@ export class DatabaseEditor extends Editor {
                 window.removeEventListener('fileDialogClosed', listener);
                 if (e.detail.payload.path) {
                     const absolutePath = file.resolveWorkspacePath(e.detail.payload.path);
-                    const res = await fetch(absolutePath);
-                    const text = await res.text();
-                    this.dbData['data']['embeddedData'] = this._parseCSV(text);
+                    if (this._isColumnar()) {
+                        // 列式存储：后端直接把 CSV 流式写入列文件，行数据不经过前端
+                        await this._convertStorage('columnar', absolutePath);
+                        return;
+                    }
+                    const result = await ipc.parseCsv('db-import-' + Date.now(), absolutePath);
+                    if (!result['success']) {
+                        alert('Failed to import CSV: ' + result['error']);
+                        return;
+                    }
+                    this.dbData['data']['embeddedData'] = result['rows'];
                     this._updateDataSourceUI();
                     this._markDirty();
                     this._refreshPreviewData();
@@ -116,6 +127,30 @@ export class DatabaseEditor extends Editor {
             ipc.openFileDialog("CSV File");
         });
 
+        this.elements.storageBtn.addEventListener('click', () => {
+            this._convertStorage(this._isColumnar() ? 'json' : 'columnar');
+        });
+
+        this.elements.indexesBtn.addEventListener('click', () => {
+            const panel = this.elements.indexesPanel;
+            panel.style.display = panel.style.display === 'none' ? 'grid' : 'none';
+            if (panel.style.display !== 'none') this._renderIndexesPanel();
+        });
+
+        // content.data.indexes: [{ column, type }]，由后端建立并在筛选时自动使用
+        this.elements.indexesPanel.addEventListener('change', (e) => {
+            const target = e.target as HTMLInputElement;
+            if (!target.classList.contains('db-index-toggle')) return;
+            const column = parseInt(target.dataset['column']);
+            const type = target.dataset['type'];
+            const indexes = (this.dbData['data']['indexes'] || []).filter(idx => !(idx['column'] === column && idx['type'] === type));
+            if (target.checked) indexes.push({ 'column': column, 'type': type });
+            indexes.sort((a, b) => a['column'] - b['column']);
+            if (indexes.length > 0) this.dbData['data']['indexes'] = indexes;
+            else delete this.dbData['data']['indexes'];
+            this._markDirty();
+        });
+
         this.elements.addPresetBtn.addEventListener('click', () => {
             // 自动生成不重复的默认名称
             let baseName = "New View";
@@ -201,6 +236,27 @@ export class DatabaseEditor extends Editor {
         this._updateDataSourceUI();
         this._renderTabs();
         this._refreshPreviewData();
+        if (this.elements.indexesPanel.style.display !== 'none') this._renderIndexesPanel();
+    }
+
+    _isColumnar() {
+        return this.dbData['data']['mode'] === 'embedded' && this.dbData['data']['storage'] === 'columnar';
+    }
+
+    // 转换直接改写磁盘上的文件，完成后重新加载（onContentParsed 会重置编辑器状态）
+    async _convertStorage(storage: 'columnar' | 'json', csvPath = '') {
+        if (this.tabManager.tabs.get(this.filePath)?.isUnsaved) {
+            alert('Save the database before changing its storage.');
+            return;
+        }
+        this.elements.storageBtn.disabled = true;
+        const result = await ipc.convertDatabaseStorage('db-storage-' + Date.now(), this.filePath, storage, csvPath);
+        this.elements.storageBtn.disabled = false;
+        if (!result['success']) {
+            alert('Failed to convert storage: ' + result['error']);
+            return;
+        }
+        ipc.loadFile(this.filePath, this.context);
     }
 
     _markDirty() {
@@ -230,13 +286,45 @@ export class DatabaseEditor extends Editor {
         this.elements.embeddedConfig.style.display = isEmbedded ? 'flex' : 'none';
         this.elements.externalConfig.style.display = !isEmbedded ? 'flex' : 'none';
 
-        if (isEmbedded) {
+        if (isEmbedded && this._isColumnar()) {
+            this.elements.embeddedInfo.textContent = `Contains ${this.dbData['data']['rowCount'] || 0} rows (columnar storage).`;
+            this.elements.storageBtn.textContent = 'Store as JSON';
+        } else if (isEmbedded) {
             this.elements.embeddedInfo.textContent = `Contains ${this.dbData['data']['embeddedData'] ? this.dbData['data']['embeddedData'].length : 0} rows of data.`;
+            this.elements.storageBtn.textContent = 'Store as columnar';
         } else {
             this.elements.externalUrlInput.value = this.dbData['data']['externalUrl'] || '';
         }
     }
 
+    _renderIndexesPanel() {
+        // 列名取自数据的第一行（external 模式取预览中已加载的数据）
+        const data = this.dbData['data'];
+        if (this._isColumnar()) {
+            this.elements.indexesPanel.innerHTML = '<span style="color:var(--text-secondary);">Columnar storage skips row groups using per-group min/max statistics; indexes apply to JSON storage.</span>';
+            return;
+        }
+        const rows = data['mode'] === 'embedded' ? data['embeddedData'] : this.previewBlockInstance?._rawData;
+        const firstRow = (rows && rows[0]) || [];
+        const indexes = data['indexes'] || [];
+        const types = [['sorted', 'Sorted (range)'], ['hash', 'Hash (equals)'], ['trigram', 'Trigram (contains)']];
+
+        if (firstRow.length === 0) {
+            this.elements.indexesPanel.innerHTML = '<span style="color:var(--text-secondary);">No columns to index.</span>';
+            return;
+        }
+        let html = '';
+        firstRow.forEach((header, column) => {
+            const label = String(header ?? '').replace(/</g, '&lt;') || `Column ${column + 1}`;
+            html += `<span title="Column ${column + 1}">${label}</span>`;
+            types.forEach(([type, text]) => {
+                const checked = indexes.some(idx => idx['column'] === column && idx['type'] === type);
+                html += `<label><input type="checkbox" class="db-index-toggle" data-column="${column}" data-type="${type}" ${checked ? 'checked' : ''}>${text}</label>`;
+            });
+        });
+        this.elements.indexesPanel.innerHTML = html;
+    }
+
     _renderTabs() {
         this.elements.tabsContainer.innerHTML = '';
         this.dbData['presets'].forEach(preset => {
@@ -311,15 +399,6 @@ export class DatabaseEditor extends Editor {
         await this._renderConfigPanel();
     }
 
-    _parseCSV(text) {
-        // (省略完整实现，使用原先 DataBlock 中的 csv 简易解析即可)
-        const rows = [];
-        text.split('\n').forEach(line => {
-            if (line.trim()) rows.push(line.split(',').map(s => s.trim().replace(/^"|"$/g, '')));
-        });
-        return rows;
-    }
-
     _renderPreview() {
         const preset = this._getActivePreset();
         if (!preset) {
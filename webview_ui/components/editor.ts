@@ -1,4 +1,4 @@
-// components/editor.js
+﻿// components/editor.js
 // Editor 基类，提供文件加载、保存、配置应用等核心功能，供具体编辑器（如 PageEditor）继承和扩展
 
 import { ipc } from './main/ipc.js';
@@ -6,6 +6,8 @@ import { TabManager } from './main/tab-manager.js';
 import { FileType } from './types.js';
 import * as file from './main/file-helper.js';
 
+// 最后一次修改之后多久自动保存；自动保存只在后端追加日志，由后端择机压缩回原文件
+const AUTOSAVE_DELAY_MS = 1500;
 
 export abstract class Editor {
     container: HTMLElement;
@@ -15,8 +17,19 @@ export abstract class Editor {
     computedConfig: Record<string, any> | null; // 计算后的最终配置
     context; // 透传参数，如 blockIdToFocus
     fileConfig: Record<string, any> | null; // 文件中 Config 部分原始内容
+    fileFormat: 'json' | 'binary' = 'json'; // 磁盘上的存储格式，保存时后端沿用
     isReady = false;
     private loadPromise: Promise<void> | null = null;
+    // 增量保存：后端确认过的最后一份文档快照及其版本号，以及正在保存中的快照。
+    // 同一时间只有一个保存在途，期间的保存请求只保留最新的一份，待在途保存结束后再发出
+    private savedSnapshot: file.DocumentSnapshot | null = null;
+    private savedVersion = 0;
+    private pendingSnapshot: file.DocumentSnapshot | null = null;
+    private queuedSnapshot: file.DocumentSnapshot | null = null;
+    // 保存是否只追加日志（自动保存）；在途与排队的保存各自记录
+    private pendingJournal = false;
+    private queuedJournal = false;
+    private autosaveTimer = 0;
 
     /*
     * 顺序：
@@ -51,9 +64,12 @@ export abstract class Editor {
 
     /**
      * @param {any} savableContent 需要被持久化保存的 content 数据
+     * @param {boolean} journal 为 true 时（自动保存）后端只把内容追加到日志
      * @returns
      */
-    save(savableContent: any) {
+    save(savableContent: any, journal = false) {
+        // 显式保存取代尚未触发的自动保存
+        this.cancelAutosave();
         if(!this.fileConfig)
             return;
         if (!this.isReady)
@@ -61,7 +77,52 @@ export abstract class Editor {
         // 调用子类可选的保存前UI处理
         if (typeof this.onBeforeSave === "function")
             this.onBeforeSave();
-        ipc.saveFile(this.filePath, this.fileConfig, savableContent);
+
+        const snapshot = file.snapshotDocument(this.fileConfig, savableContent);
+        if (this.pendingSnapshot) {
+            // 增量以上一次保存的结果为基准，必须等它确认后才能计算
+            // 排队期间出现过显式保存时，合并后的保存也按显式保存处理
+            this.queuedJournal = this.queuedSnapshot ? (this.queuedJournal && journal) : journal;
+            this.queuedSnapshot = snapshot;
+            return;
+        }
+        this.sendSnapshot(snapshot, journal);
+    }
+
+    /**
+     * 修改后由子类调用：停止修改 AUTOSAVE_DELAY_MS 之后调用 run 进行一次自动保存
+     */
+    protected scheduleAutosave(run: () => void) {
+        window.clearTimeout(this.autosaveTimer);
+        this.autosaveTimer = window.setTimeout(() => {
+            this.autosaveTimer = 0;
+            run();
+        }, AUTOSAVE_DELAY_MS);
+    }
+
+    protected cancelAutosave() {
+        window.clearTimeout(this.autosaveTimer);
+        this.autosaveTimer = 0;
+    }
+
+    private sendSnapshot(snapshot: file.DocumentSnapshot, journal: boolean) {
+        this.pendingSnapshot = snapshot;
+        this.pendingJournal = journal;
+
+        if (this.savedSnapshot && this.savedVersion) {
+            const ops = file.diffSnapshots(this.savedSnapshot, snapshot);
+            // 增量比全文还大时（如整体重排）直接整体保存
+            if (JSON.stringify(ops).length < snapshot.size / 2) {
+                ipc.patchFile(this.filePath, this.savedVersion, ops);
+                return;
+            }
+        }
+        this.sendFullSave(snapshot, journal);
+    }
+
+    private sendFullSave(snapshot: file.DocumentSnapshot, journal: boolean) {
+        const doc = file.documentFromSnapshot(snapshot);
+        ipc.saveFile(this.filePath, doc['config'], doc['content'], journal);
     }
 
     // 被 main.js 监听到 fileLoaded 后调用
@@ -70,9 +131,14 @@ export abstract class Editor {
             return;
 
         this.fileConfig = payload.config;
+        this.fileFormat = payload['format'] === 'binary' ? 'binary' : 'json';
         const content = payload.content;
         const context = payload.context || {}; // 包含 blockIdToFocus 等
         this.isReady = true;
+        this.savedVersion = payload['version'] || 0;
+        this.savedSnapshot = this.savedVersion ? file.snapshotDocument(payload.config, content) : null;
+        this.pendingSnapshot = null;
+        this.queuedSnapshot = null;
         this.tabManager.setUnsavedStatus(this.filePath, false);
 
         // 确保子类 onLoad 编辑器的异步初始化逻辑已完成
@@ -88,21 +154,39 @@ export abstract class Editor {
 
     // 被 main.js 监听到 fileSaved 后调用
     public onFileSaved(payload: any) {
-        if (payload.path !== this.filePath)
+        if (payload.path !== this.filePath || !this.pendingSnapshot)
+            return;
+        if (!payload.success && payload['needsFullSave']) {
+            // 后端的增量基准与前端不一致，退回到完整保存，结果会再次回到这里
+            this.savedSnapshot = null;
+            this.savedVersion = 0;
+            this.sendFullSave(this.pendingSnapshot, this.pendingJournal);
             return;
+        }
+        const queued = this.queuedSnapshot;
+        const queuedJournal = this.queuedJournal;
+        this.queuedSnapshot = null;
         if (payload.success) {
-            this.tabManager.setUnsavedStatus(this.filePath, false);
+            this.savedSnapshot = this.pendingSnapshot;
+            this.savedVersion = payload['version'] || 0;
+            this.pendingSnapshot = null;
+            if (!queued)
+                this.tabManager.setUnsavedStatus(this.filePath, false);
             // 触发前端内部事件，解耦其它组件的监听
             window.dispatchEvent(new CustomEvent('editor:saved', { detail: { path: this.filePath } }));
             console.log(`File "${this.filePath}" saved successfully.`);
         }
         else {
+            // 失败的保存不会改变后端的基准，排队的保存仍以 savedSnapshot 为基准计算增量
+            this.pendingSnapshot = null;
             console.error(`Failed to save file "${this.filePath}":`, payload.error);
             alert(`Failed to save file: ${payload.error || 'Unknown error'}`);
         }
         // 调用子类可选的保存后UI恢复处理
         if (typeof this.onAfterSave === "function")
             this.onAfterSave(payload.success);
+        if (queued)
+            this.sendSnapshot(queued, queuedJournal);
     }
 
     // --- 配置管理 ---
@@ -134,7 +218,10 @@ export abstract class Editor {
 
     abstract onFocus(): void;
 
-    destroy() { this.container.innerHTML = ""; }
+    destroy() {
+        this.cancelAutosave();
+        this.container.innerHTML = "";
+    }
 
 
     abstract onKeyDown(e: any): void;
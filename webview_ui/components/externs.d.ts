@@ -137,6 +137,11 @@ declare global {
          */
         _dbJsonCache: any;
 
+        /**
+         * 当前 preset 使用的原始行数据（行数据留在后端时只有第一行）
+         */
+        _rawData: any;
+
         /**
          * @param preset 当前选中的 preset 视图数据
          * @param markDirtyCallback 标记数据脏状态的回调
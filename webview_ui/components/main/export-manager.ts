@@ -1,4 +1,4 @@
-// components/main/export-manager.js
+﻿// components/main/export-manager.js
 
 import { ipc } from './ipc.js';
 
@@ -44,10 +44,13 @@ interface ExportPrepareResult {
 interface ExportGenerateResult {
     content: string;
     savePath: string;
-    exportType: 'page_html' | 'database_js';
+    exportType: 'page_html' | 'database_bundle';
 }
 
 
+// 发布站点中每个数据库块文件的行数：页面先加载第一块，表格滚动到底部时再加载后续块
+const DATABASE_CHUNK_ROWS = 500;
+
 export const ExportManager = class ExportManager {
     static async runExportProcess(exportConfig: ExportConfig): Promise<void> {
         const { options, allFilesToExport, workspaceData, ui } = exportConfig;
@@ -106,21 +109,33 @@ export const ExportManager = class ExportManager {
             imageSrcMap = await new Promise<Record<string, string>>(resolve => window.addEventListener('exportImagesProcessed', (e: Event) => resolve((e as CustomEvent).detail.payload['srcMap']), { once: true }));
         }
 
-        // 4. 生成与导出最终文件
+        // 页面的 File Config 一次请求全部解析，不再每个页面往返一次
+        const pagePaths = exporters.filter(exp => exp.path.endsWith('.veritnote')).map(exp => exp.path);
+        const resolvedConfigs = pagePaths.length > 0 ? await ipc.resolveFileConfigurations('export-config-' + Date.now(), pagePaths) : {};
+
+        // 4. 生成与导出最终文件（数据库包收集后由后端一次并行生成）
+        const databases: { path: string, key: string }[] = [];
         for (let i = 0; i < exporters.length; i++) {
             if (window.isExportCancelled)
                 return;
             const exp = exporters[i];
             ui.exportStatus.textContent = `Cooking: ${exp.path.substring(exp.path.lastIndexOf("\\") + 1)}`;
-            const { content, savePath, exportType } = await exp.generate(imageSrcMap);
+            const { content, savePath, exportType } = await exp.generate(imageSrcMap, resolvedConfigs[exp.path]);
             if (exportType === 'page_html') {
                 ipc.exportPageAsHtml(savePath, content);
             }
-            else if (exportType === 'database_js') {
-                ipc.exportDatabaseAsJs(savePath, content);
+            else if (exportType === 'database_bundle') {
+                databases.push({ path: savePath, key: content });
             }
             ui.progressBar.style.width = `${30 + ((i + 1) / exporters.length) * 70}%`;
         }
+        if (databases.length > 0) {
+            if (window.isExportCancelled)
+                return;
+            ui.exportStatus.textContent = `Cooking ${databases.length} database(s)...`;
+            const result = await ipc.exportDatabaseBundles('export-db-' + Date.now(), databases, DATABASE_CHUNK_ROWS);
+            (result['results'] || []).filter(r => !r['success']).forEach(r => console.error(`Failed to export database "${r['path']}":`, r['error']));
+        }
         ui.exportStatus.textContent = 'Done!';
         setTimeout(window.hideExportOverlay, 1500);
     }
@@ -372,7 +387,7 @@ window.PageExporter = class PageExporter {
     }
 
     // 阶段2：利用获取到的映射生成最终 HTML
-    async generate(imageSrcMap: Record<string, string>): Promise<ExportGenerateResult> {
+    async generate(imageSrcMap: Record<string, string>, resolvedConfig: Record<string, any> = {}): Promise<ExportGenerateResult> {
         // 在生成 HTML 前，遍历更新编辑器所有图片块的链接
         const updateBlockImages = (blocks: Block[]) => {
             if (!blocks)
@@ -413,21 +428,8 @@ window.PageExporter = class PageExporter {
             pathPrefix: this.pathPrefix
         });
 
-        // 获取并重载配置 (用于生成自定义 Style)
-        ipc.resolveFileConfiguration(this.path);
-
-        const resolved: any = await new Promise(resolve => {
-            const handler = (e: Event) => {
-                const payload = (e as CustomEvent).detail.payload;
-                if (payload.path === this.path) {
-                    window.removeEventListener('fileConfigurationResolved', handler);
-                    resolve(payload);
-                }
-            };
-            window.addEventListener('fileConfigurationResolved', handler);
-        });
-
-        const computedConfig = file.computeFinalConfig(resolved.config, FileType.Page);
+        // 重载配置 (用于生成自定义 Style)，由 runExportProcess 批量解析后传入
+        const computedConfig = file.computeFinalConfig(resolvedConfig, FileType.Page);
 
         // 背景图片路径替换
         if (computedConfig.background?.type === 'image' && computedConfig.background.value) {
@@ -521,44 +523,15 @@ window.DatabaseExporter = class DatabaseExporter {
         return { libs: [], imageTasks: [] };
     }
 
-    // 阶段2：生成静态内容
+    // 阶段2：数据库包由后端原生生成（按 preset 预先筛选 / 排序 / 聚合并分块），这里只给出路径和页面中使用的键
     async generate(imageSrcMap: Record<string, string>): Promise<ExportGenerateResult> {
-        const jsonString = await new Promise<string>((resolve) => {
-            const reqId = 'export-db-' + Date.now() + Math.random();
-            const listener = (e: Event) => {
-                const payload = (e as CustomEvent).detail.payload;
-                if (payload.dataBlockId === reqId) {
-                    window.removeEventListener('dataContentFetched', listener);
-                    let content = payload.content;
-                    if (typeof content === 'string') {
-                        try {
-                            content = JSON.parse(content);
-                        }
-                        catch (err) { }
-                    }
-
-                    // 提纯 DB：只保留 Data 和 Presets
-                    const exportData = {
-                        data: content.data || { mode: 'embedded', embeddedData: [] },
-                        presets: content.presets || []
-                    };
-                    resolve(JSON.stringify(exportData, null, 2));
-                }
-            };
-            window.addEventListener('dataContentFetched', listener);
-            ipc.fetchDataContent(reqId, this.path);
-        });
-
         const relativeWorkspacePath = this.path.substring(this.workspaceData.path.length + 1).replace(/\\/g, '/');
         const dbKey = relativeWorkspacePath.replace('.veritnotedb', '.js');
 
-        // 拼接出浏览器可直接执行的 JavaScript 代码，将数据挂载到全局变量
-        const jsContent = `window.__VN_DB__ = window.__VN_DB__ || {};\nwindow.__VN_DB__['${dbKey}'] = ${jsonString};`;
-
         return {
-            content: jsContent,
-            savePath: this.path.replace('.veritnotedb', '.js'),
-            exportType: 'database_js'
+            content: dbKey,
+            savePath: this.path,
+            exportType: 'database_bundle'
         };
     }
 };
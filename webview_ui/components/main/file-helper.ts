@@ -1,4 +1,4 @@
-import { DEFAULT_CONFIG } from './default-config.js';
+﻿import { DEFAULT_CONFIG } from './default-config.js';
 import { INHERIT_VALUE } from './default-config.js';
 
 import { FileType } from '../types.js';
@@ -67,4 +67,161 @@ export function collectFilesByType(node: WorkspaceTreeNode, type: FileType, coll
     if (node.children && node.children.length > 0) {
         node.children.forEach(child => collectFilesByType(child, type, collection));
     }
-}
\ No newline at end of file
+}
+
+
+/**
+ * 生成把 before 变为 after 的 JSON Patch (RFC 6902) 操作列表，供增量保存使用。
+ * 数组只裁剪公共前后缀，中间部分按 remove/add 处理，插入或删除单个块时操作数与编辑大小成正比。
+ */
+export function diffJson(before: any, after: any, path = '', ops: Record<string, any>[] = []) {
+    if (before === after) return ops;
+
+    const isObject = (v: any) => v !== null && typeof v === 'object';
+    if (!isObject(before) || !isObject(after) || Array.isArray(before) !== Array.isArray(after)) {
+        ops.push({ 'op': 'replace', 'path': path, 'value': after });
+        return ops;
+    }
+
+    if (Array.isArray(before)) {
+        let start = 0;
+        while (start < before.length && start < after.length && JSON.stringify(before[start]) === JSON.stringify(after[start])) start++;
+        let endBefore = before.length - 1;
+        let endAfter = after.length - 1;
+        while (endBefore >= start && endAfter >= start && JSON.stringify(before[endBefore]) === JSON.stringify(after[endAfter])) {
+            endBefore--;
+            endAfter--;
+        }
+
+        // 两侧长度相同的中段逐项递归比较，其余部分删除/插入
+        const common = Math.min(endBefore, endAfter) - start + 1;
+        for (let i = 0; i < common; i++) {
+            diffJson(before[start + i], after[start + i], `${path}/${start + i}`, ops);
+        }
+        for (let i = endBefore; i >= start + common; i--) {
+            ops.push({ 'op': 'remove', 'path': `${path}/${i}` });
+        }
+        for (let i = start + common; i <= endAfter; i++) {
+            ops.push({ 'op': 'add', 'path': `${path}/${i}`, 'value': after[i] });
+        }
+        return ops;
+    }
+
+    const escapeKey = (key: string) => key.replace(/~/g, '~0').replace(/\//g, '~1');
+    for (const key of Object.keys(before)) {
+        if (!(key in after)) {
+            ops.push({ 'op': 'remove', 'path': `${path}/${escapeKey(key)}` });
+        }
+    }
+    for (const key of Object.keys(after)) {
+        const childPath = `${path}/${escapeKey(key)}`;
+        if (!(key in before)) {
+            ops.push({ 'op': 'add', 'path': childPath, 'value': after[key] });
+        } else {
+            diffJson(before[key], after[key], childPath, ops);
+        }
+    }
+    return ops;
+}
+
+
+/**
+ * 增量保存用的文档快照：config 与 content 的每个顶层值各序列化一次，数组值（如 blocks）按元素序列化。
+ * 比较与计算大小都直接使用这些字符串，保存时整份文档只需序列化一遍；字符串不可变，快照不受之后编辑的影响
+ */
+export interface DocumentSnapshot {
+    config: string;
+    content: Record<string, { json?: string, items?: { id: any, json: string }[] }>;
+    size: number; // 所有片段的长度之和，近似整个文档序列化后的长度
+}
+
+export function snapshotDocument(config: any, content: any): DocumentSnapshot {
+    const snapshot: DocumentSnapshot = { config: JSON.stringify(config ?? null), content: {}, size: 0 };
+    snapshot.size += snapshot.config.length;
+    for (const key of Object.keys(content || {})) {
+        const value = content[key];
+        if (value === undefined) continue;
+        if (Array.isArray(value)) {
+            const items = value.map(item => ({ id: (item && typeof item === 'object') ? item.id : undefined, json: JSON.stringify(item ?? null) }));
+            items.forEach(item => snapshot.size += item.json.length + 1);
+            snapshot.content[key] = { items };
+        } else {
+            const json = JSON.stringify(value);
+            snapshot.size += json.length;
+            snapshot.content[key] = { json };
+        }
+    }
+    return snapshot;
+}
+
+/**
+ * 从快照还原 { config, content }（后端要求整体保存时使用）
+ */
+function snapshotEntryValue(entry: DocumentSnapshot['content'][string]) {
+    return entry.items ? entry.items.map(item => JSON.parse(item.json)) : JSON.parse(entry.json!);
+}
+
+export function documentFromSnapshot(snapshot: DocumentSnapshot): Record<string, any> {
+    const content: Record<string, any> = {};
+    for (const key of Object.keys(snapshot.content)) {
+        content[key] = snapshotEntryValue(snapshot.content[key]);
+    }
+    return { 'config': JSON.parse(snapshot.config), 'content': content };
+}
+
+/**
+ * 两个快照之间的 JSON Patch 操作。未改变的片段只比较字符串；
+ * 数组裁掉公共前后缀后，中段 id 一致的元素才解析出来递归比较，其余按 remove/add 处理
+ */
+export function diffSnapshots(before: DocumentSnapshot, after: DocumentSnapshot): Record<string, any>[] {
+    const ops: Record<string, any>[] = [];
+    const escapeKey = (key: string) => key.replace(/~/g, '~0').replace(/\//g, '~1');
+
+    if (before.config !== after.config) {
+        diffJson(JSON.parse(before.config), JSON.parse(after.config), '/config', ops);
+    }
+    for (const key of Object.keys(before.content)) {
+        if (!(key in after.content)) ops.push({ 'op': 'remove', 'path': `/content/${escapeKey(key)}` });
+    }
+    for (const key of Object.keys(after.content)) {
+        const path = `/content/${escapeKey(key)}`;
+        const a = after.content[key];
+        const b = before.content[key];
+        if (!b) {
+            ops.push({ 'op': 'add', 'path': path, 'value': snapshotEntryValue(a) });
+            continue;
+        }
+        if (!a.items || !b.items) {
+            if (a.json !== b.json) diffJson(snapshotEntryValue(b), snapshotEntryValue(a), path, ops);
+            continue;
+        }
+
+        const x = b.items;
+        const y = a.items;
+        let start = 0;
+        while (start < x.length && start < y.length && x[start].json === y[start].json) start++;
+        let endBefore = x.length - 1;
+        let endAfter = y.length - 1;
+        while (endBefore >= start && endAfter >= start && x[endBefore].json === y[endAfter].json) {
+            endBefore--;
+            endAfter--;
+        }
+
+        // 中段：同一位置上 id 相同（或都没有 id）的元素视为同一个块的修改
+        let common = 0;
+        const limit = Math.min(endBefore, endAfter) - start + 1;
+        while (common < limit && x[start + common].id === y[start + common].id) common++;
+        for (let i = 0; i < common; i++) {
+            const from = x[start + i];
+            const to = y[start + i];
+            if (from.json !== to.json) diffJson(JSON.parse(from.json), JSON.parse(to.json), `${path}/${start + i}`, ops);
+        }
+        for (let i = endBefore; i >= start + common; i--) {
+            ops.push({ 'op': 'remove', 'path': `${path}/${i}` });
+        }
+        for (let i = start + common; i <= endAfter; i++) {
+            ops.push({ 'op': 'add', 'path': `${path}/${i}`, 'value': JSON.parse(y[i].json) });
+        }
+    }
+    return ops;
+}
@@ -1,4 +1,10 @@
 ﻿// Inter-Process Communication: JS <-> C++
+
+// fetchSharedDataContent 的共享结果，键为 headerOnly + 路径，按最近使用排序（Map 保持插入顺序）
+const sharedDataContent = new Map<string, { handle: string, content: any, pending: Promise<any> | null }>();
+const SHARED_DATA_CONTENT_LIMIT = 8;
+let sharedDataRequestCounter = 0;
+
 export const ipc = {
     // 向 C++ 后端发送消息
     send: (action: string, payload = {}) => {
@@ -51,8 +57,31 @@ export const ipc = {
     loadFile: (path: string, context = {}) => {
         ipc.send("loadFile", { path, context });
     },
-    saveFile: (path: string, config: Record<string, any>, content: any) => {
-        ipc.send("saveFile", { path, config, content });
+    /**
+     * @param journal 为 true 时后端仅追加到预写日志（适合高频自动保存），稍后再压缩回原文件
+     */
+    saveFile: (path: string, config: Record<string, any>, content: any, journal = false) => {
+        ipc.send("saveFile", { path, config, content, journal });
+    },
+    /**
+     * 增量保存：只发送相对 baseVersion 的 JSON Patch 操作，后端不同步时会回复 needsFullSave
+     */
+    patchFile: (path: string, baseVersion: number, ops: Record<string, any>[]) => {
+        ipc.send("patchFile", { 'path': path, 'baseVersion': baseVersion, 'ops': ops });
+    },
+    /**
+     * 在 JSON 与紧凑二进制页面格式之间无损转换磁盘上的文件，结果通过 fileFormatConverted 返回
+     */
+    convertFileFormat: (requestIdentifier: string, path: string, format: 'json' | 'binary'): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('fileFormatConverted', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('fileFormatConverted', listener);
+            ipc.send('convertFileFormat', { 'requestId': requestIdentifier, 'path': path, 'format': format });
+        });
     },
     readFileConfig: (path: string) => {
         ipc.send('readFileConfig', { 'path': path })
@@ -68,8 +97,20 @@ export const ipc = {
     exportPageAsHtml: (path: any, html: any) => {
         ipc.send('exportPageAsHtml', { 'path': path, 'html': html });
     },
-    exportDatabaseAsJs: (path: any, js: any) => {
-        ipc.send('exportDatabaseAsJs', { 'path': path, 'js': js });
+    /**
+     * 由后端生成发布站点的数据库包：每个 preset 预先计算并分块写出，多个数据库并行。
+     * databases: [{ path, key }]，key 为页面中 window.__VN_DB__ 使用的键；chunkRows 为 0 时不分块
+     */
+    exportDatabaseBundles: (requestIdentifier: string, databases: { path: string, key: string }[], chunkRows = 500): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('databaseBundlesExported', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('databaseBundlesExported', listener);
+            ipc.send('exportDatabaseBundles', { 'requestId': requestIdentifier, 'databases': databases, 'chunkRows': chunkRows });
+        });
     },
     cancelExport: () => {
         ipc.send('cancelExport');
@@ -97,8 +138,182 @@ export const ipc = {
         ipc.send('fetchQuoteContent', { 'quoteBlockId': requestIdentifier, 'referenceLink': referenceLink });
     },
 
-    fetchDataContent: (requestIdentifier: any, path: any) => {
-        ipc.send('fetchDataContent', { 'dataBlockId': requestIdentifier, 'path': path });
+    /**
+     * headerOnly 为 true 时行数据留在后端，只返回首行 (firstRow) 和行数，行通过 openQuery / fetchRows 分页获取
+     */
+    fetchDataContent: (requestIdentifier: any, path: any, headerOnly = false) => {
+        ipc.send('fetchDataContent', { 'dataBlockId': requestIdentifier, 'path': path, 'headerOnly': headerOnly });
+    },
+
+    /**
+     * 多个 DataBlock 共用的 fetchDataContent：同一数据库的并发请求只向后端发送一次，所有调用方等待同一个结果；
+     * 结果按后端返回的 handle 缓存，之后的请求带上 handle，数据库未变化时后端不再重复下发内容。
+     * 返回的 content 被所有调用方共享，不可修改
+     */
+    fetchSharedDataContent: (path: string, headerOnly = false): Promise<any> => {
+        const key = (headerOnly ? 'h:' : 'f:') + path;
+        let slot = sharedDataContent.get(key);
+        if (slot && slot.pending) return slot.pending;
+        if (!slot) slot = { handle: '', content: null, pending: null };
+        // 重新插入，移到最近使用的位置
+        sharedDataContent.delete(key);
+        sharedDataContent.set(key, slot);
+
+        const current = slot;
+        const requestIdentifier = 'shared-data-' + (++sharedDataRequestCounter);
+        current.pending = new Promise((resolve, reject) => {
+            const listener = (e: any) => {
+                const payload = e.detail.payload;
+                if (payload.dataBlockId !== requestIdentifier) return;
+                window.removeEventListener('dataContentFetched', listener);
+                current.pending = null;
+
+                let content = payload.content;
+                if (payload.unchanged && current.content) {
+                    content = current.content;
+                } else if (typeof content === 'string') {
+                    try { content = JSON.parse(content); }
+                    catch (err) { content = { data: {}, presets: [] }; }
+                }
+                if (payload.error || !payload.handle) {
+                    // 失败的结果不缓存，下次重新请求；调用方通过 reject 得知错误
+                    if (sharedDataContent.get(key) === current) sharedDataContent.delete(key);
+                    reject(new Error(payload.error || 'Failed to fetch database content.'));
+                    return;
+                }
+                current.handle = payload.handle;
+                current.content = content;
+                resolve(content);
+            };
+            window.addEventListener('dataContentFetched', listener);
+            ipc.send('fetchDataContent', { 'dataBlockId': requestIdentifier, 'path': path, 'headerOnly': headerOnly, 'knownHandle': current.content ? current.handle : '' });
+        });
+
+        // 超出上限时淘汰最久未使用且没有进行中请求的结果
+        for (const [oldKey, oldSlot] of sharedDataContent) {
+            if (sharedDataContent.size <= SHARED_DATA_CONTENT_LIMIT) break;
+            if (!oldSlot.pending) sharedDataContent.delete(oldKey);
+        }
+        return current.pending;
+    },
+
+    /**
+     * 由后端原生解析 CSV 并推断列类型。行数据以按列存放的 csvChunk 分块送达，
+     * 在这里拼回行数组；结束时 csvParsed 给出列信息和总行数
+     */
+    parseCsv: (requestIdentifier: string, path: string, header = true): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const rows: any[][] = [];
+            const chunkListener = (e: any) => {
+                const payload = e.detail.payload;
+                if (payload.requestId !== requestIdentifier) return;
+                const widths: number[] = payload.rowWidths;
+                for (let r = 0; r < widths.length; r++) {
+                    const row = new Array(widths[r]);
+                    for (let c = 0; c < widths[r]; c++) row[c] = payload.columns[c][r];
+                    rows[payload.rowStart + r] = row;
+                }
+            };
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('csvChunk', chunkListener);
+                window.removeEventListener('csvParsed', listener);
+                resolve({ ...e.detail.payload, 'rows': e.detail.payload.success ? rows : [] });
+            };
+            window.addEventListener('csvChunk', chunkListener);
+            window.addEventListener('csvParsed', listener);
+            ipc.send('parseCsv', { 'requestId': requestIdentifier, 'path': path, 'header': header });
+        });
+    },
+
+    /**
+     * 在 embeddedData (JSON) 与磁盘列式存储 ("<file>.columns") 之间转换数据库的行数据。
+     * csvPath 非空时把 CSV 直接流式导入为列式存储，行数据不经过 WebView
+     */
+    convertDatabaseStorage: (requestIdentifier: string, path: string, storage: 'columnar' | 'json', csvPath = ''): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('databaseStorageConverted', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('databaseStorageConverted', listener);
+            ipc.send('convertDatabaseStorage', { 'requestId': requestIdentifier, 'path': path, 'storage': storage, 'csvPath': csvPath });
+        });
+    },
+
+    /**
+     * 在后端对数据库执行 preset 的筛选/排序/分组/聚合，只返回 [offset, offset + limit) 这一页。
+     * config 为空时后端按 presetId 使用已保存的 preset 配置
+     */
+    queryData: (requestIdentifier: string, path: string, presetId: string, config: Record<string, any> | null, offset = 0, limit = 200): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('dataQueried', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('dataQueried', listener);
+            const payload: Record<string, any> = { 'requestId': requestIdentifier, 'path': path, 'presetId': presetId, 'offset': offset, 'limit': limit };
+            if (config) payload['config'] = config;
+            ipc.send('queryData', payload);
+        });
+    },
+
+    /**
+     * 打开查询游标：执行一次查询，返回 cursorId 和第一个窗口 [0, limit)；之后用 fetchRows 按窗口取行，
+     * 不再需要时调用 closeQuery 释放
+     */
+    openQuery: (requestIdentifier: string, path: string, presetId: string, config: Record<string, any> | null, limit = 200): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('queryOpened', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('queryOpened', listener);
+            const payload: Record<string, any> = { 'requestId': requestIdentifier, 'path': path, 'presetId': presetId, 'limit': limit };
+            if (config) payload['config'] = config;
+            ipc.send('openQuery', payload);
+        });
+    },
+
+    /**
+     * 从游标读取 [offset, offset + limit) 的行；游标失效时返回 expired: true
+     */
+    fetchRows: (requestIdentifier: string, cursorId: number, offset: number, limit = 200): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('rowsFetched', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('rowsFetched', listener);
+            ipc.send('fetchRows', { 'requestId': requestIdentifier, 'cursorId': cursorId, 'offset': offset, 'limit': limit });
+        });
+    },
+
+    closeQuery: (cursorId: number) => {
+        ipc.send('closeQuery', { 'cursorId': cursorId });
+    },
+
+    /**
+     * 后端的计时统计（各 action 的耗时分位数、IPC 字节数、各阶段 span），结果通过 backendStats 返回。
+     * trace 为 true 时附带 Chrome trace-event JSON（可保存后在 chrome://tracing 或 Perfetto 中打开），reset 为 true 时读取后清零。
+     * 追踪默认关闭，tracing 为 true / false 时开启 / 关闭之后的事件记录
+     */
+    getBackendStats: (requestIdentifier: string, trace = false, reset = false, tracing?: boolean): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('backendStats', listener);
+                resolve(e.detail.payload);
+            };
+            window.addEventListener('backendStats', listener);
+            const payload: Record<string, any> = { 'requestId': requestIdentifier, 'trace': trace, 'reset': reset };
+            if (tracing !== undefined) payload['tracing'] = tracing;
+            ipc.send('getBackendStats', payload);
+        });
     },
 
     openWorkspaceDialog: (): Promise<string> => {
@@ -143,6 +358,20 @@ export const ipc = {
     resolveFileConfiguration: (path: any) => {
         ipc.send('resolveFileConfiguration', { 'path': path })
     },
+    /**
+     * 批量解析多个文件的 File Config，结果通过 fileConfigurationsResolved 一次性返回 { path: config }
+     */
+    resolveFileConfigurations: (requestIdentifier: string, paths: string[]): Promise<Record<string, any>> => {
+        return new Promise((resolve) => {
+            const listener = (e: any) => {
+                if (e.detail.payload.requestId !== requestIdentifier) return;
+                window.removeEventListener('fileConfigurationsResolved', listener);
+                resolve(e.detail.payload.configs || {});
+            };
+            window.addEventListener('fileConfigurationsResolved', listener);
+            ipc.send('resolveFileConfigurations', { 'requestId': requestIdentifier, 'paths': paths });
+        });
+    },
 };
 
 // 立即初始化监听器
@@ -155,7 +384,25 @@ window['BAPI_IPC'] = {
     ['fetchQuoteContent']: (requestIdentifier: any, referenceLink: any) => {
         return ipc.fetchQuoteContent(requestIdentifier, referenceLink);
     },
-    ['fetchDataContent']: (requestIdentifier: any, path: any) => {
-        return ipc.fetchDataContent(requestIdentifier, path);
+    ['fetchDataContent']: (requestIdentifier: any, path: any, headerOnly = false) => {
+        return ipc.fetchDataContent(requestIdentifier, path, headerOnly);
+    },
+    ['fetchSharedDataContent']: (path: string, headerOnly = false) => {
+        return ipc.fetchSharedDataContent(path, headerOnly);
+    },
+    ['parseCsv']: (requestIdentifier: string, path: string, header = true) => {
+        return ipc.parseCsv(requestIdentifier, path, header);
+    },
+    ['queryData']: (requestIdentifier: string, path: string, presetId: string, config: Record<string, any> | null, offset = 0, limit = 200) => {
+        return ipc.queryData(requestIdentifier, path, presetId, config, offset, limit);
+    },
+    ['openQuery']: (requestIdentifier: string, path: string, presetId: string, config: Record<string, any> | null, limit = 200) => {
+        return ipc.openQuery(requestIdentifier, path, presetId, config, limit);
+    },
+    ['fetchRows']: (requestIdentifier: string, cursorId: number, offset: number, limit = 200) => {
+        return ipc.fetchRows(requestIdentifier, cursorId, offset, limit);
+    },
+    ['closeQuery']: (cursorId: number) => {
+        return ipc.closeQuery(cursorId);
     },
 };
\ No newline at end of file
@@ -131,6 +131,41 @@ window['initializeMainComponent'] = async () => {
         WorkspaceMng.updateWorkspaceUI();
     });
 
+    // 分批到达的工作区列表（Android SAF 工作区逐批列出目录）：把每批目录的子项挂到已有的树上，
+    // 全部列出后仍会收到一次完整的 workspaceListed
+    let listingId = -1;
+    let listingFolders = new Map<string, WorkspaceTreeNode>();
+    let listingRenderPending = false;
+    window.addEventListener('workspaceListingChunk', (e: any) => {
+        const payload = e['detail']['payload'];
+        const rootPath: string = payload['rootPath'];
+        if (payload['listingId'] !== listingId) {
+            // 新的一次列表：从空的根节点开始
+            listingId = payload['listingId'];
+            workspaceData = { name: 'root', path: rootPath, type: FileType.Folder, children: [] };
+            window.workspaceRootPath = rootPath;
+            listingFolders = new Map([[rootPath, workspaceData]]);
+        }
+
+        for (const directory of payload['directories'] || []) {
+            const folder = listingFolders.get(directory['path']);
+            if (!folder) continue;
+            folder.children = directory['children'] as WorkspaceTreeNode[];
+            for (const child of folder.children) {
+                if (child.type === FileType.Folder) listingFolders.set(child.path, child);
+            }
+        }
+
+        // 一帧内到达的多个批次只渲染一次
+        if (!listingRenderPending) {
+            listingRenderPending = true;
+            requestAnimationFrame(() => {
+                listingRenderPending = false;
+                WorkspaceMng.updateWorkspaceUI();
+            });
+        }
+    });
+
 
     // This listener now dispatches events to the relevant tab.
     window.addEventListener('fileLoaded', (e:any) => {
@@ -8,6 +8,7 @@ import { PageReferenceManager } from './ReferenceManager.js';
 import { PageSelectionManager } from './SelectionManager.js';
 
 import { TabManager } from '../main/tab-manager.js';
+import { ipc } from '../main/ipc.js';
 
 import { FileType } from '../types.js';
 import * as file from '../main/file-helper.js';
@@ -211,6 +212,8 @@ export class PageEditor extends Editor {
     }
     
     override destroy() {
+        // 关闭的标签页不再自动保存（未保存时关闭是用户确认过的放弃修改）
+        this.cancelAutosave();
         if (this.PageReferenceManager) {
             this.PageReferenceManager.destroy();
         }
@@ -234,6 +237,7 @@ export class PageEditor extends Editor {
             toggleToolbarBtn: this.container.querySelector('#toggle-toolbar-btn') as HTMLButtonElement,
             toolbarPeekTrigger: this.container.querySelector('#toolbar-peek-trigger') as HTMLElement,
             saveBtn: this.container.querySelector('#save-btn') as HTMLButtonElement,
+            formatBtn: this.container.querySelector('#format-btn') as HTMLButtonElement,
             modeToggle: this.container.querySelector('#mode-toggle') as HTMLElement,
             commandMenu: this.container.querySelector('#command-menu') as HTMLElement,
             blockToolbar: this.container.querySelector('#block-toolbar') as HTMLElement,
@@ -313,6 +317,7 @@ export class PageEditor extends Editor {
             }
         });
         this.elements.saveBtn.addEventListener('click', () => this.savePage());
+        this.elements.formatBtn.addEventListener('click', () => this.convertFormat());
 
         // Right Sidebar Listeners
         this._initRightSidebarLogic();
@@ -604,10 +609,28 @@ export class PageEditor extends Editor {
     // --- 4. Editor Actions & Event Handlers
     // --- ========================================================== ---
 
-    savePage() {
+    savePage(journal = false) {
         this.save({
             'blocks': this.blocks.map(block => block.data)
-        });
+        }, journal);
+    }
+
+    // 转换直接改写磁盘上的文件，完成后重新加载
+    async convertFormat() {
+        if (this.tabManager.tabs.get(this.filePath)?.isUnsaved) {
+            alert('Save the page before changing its file format.');
+            return;
+        }
+        const target = this.fileFormat === 'binary' ? 'json' : 'binary';
+        const button = this.elements.formatBtn as HTMLButtonElement;
+        button.disabled = true;
+        const result = await ipc.convertFileFormat('page-format-' + Date.now(), this.filePath, target);
+        button.disabled = false;
+        if (!result['success']) {
+            alert('Failed to convert file format: ' + result['error']);
+            return;
+        }
+        ipc.loadFile(this.filePath, this.context);
     }
 
     // 找到基类的 UI 回调，控制保存按钮状态:
@@ -669,6 +692,7 @@ export class PageEditor extends Editor {
         // Notify the main TabManager that this page now has unsaved changes.
         // This will update the UI (e.g., the dot on the tab).
         this.tabManager.setUnsavedStatus(this.filePath, true);
+        this.scheduleAutosave(() => this.savePage(true));
 
         // --- 3. Dispatch Fine-Grained Update Events ---
         // This is crucial for UI components like the PageReferenceManager and potentially
@@ -2420,6 +2444,7 @@ export class PageEditor extends Editor {
             // --- Save Button State ---
             // The `isUnsaved` state is managed by the TabManager.
             this.elements.saveBtn.classList.toggle('unsaved', activeTab.isUnsaved);
+            this.elements.formatBtn.title = this.fileFormat === 'binary' ? 'Store as JSON' : 'Store as binary';
 
             // --- Mode Toggle State ---
             // The `mode` state is managed by this PageEditor instance.
@@ -280,22 +280,14 @@ export class PopoverManager {
             presetStep.style.display = 'block';
 
             const absolutePath = file.resolveWorkspacePath(dbPath);
-            const reqId = 'popover-fetch-' + Date.now();
-
-            const listener = (e) => {
-                if (e.detail.payload.dataBlockId === reqId) {
-                    window.removeEventListener('dataContentFetched', listener);
-                    try {
-                        const contentObj = typeof e.detail.payload.content === 'string' ? JSON.parse(e.detail.payload.content) : e.detail.payload.content;
-                        currentPresets = contentObj.presets || [];
-                        renderPresetList();
-                    } catch (err) {
-                        presetListContainer.innerHTML = '<div class="empty-details-placeholder" style="padding:5px; color:red;">Failed to parse database.</div>';
-                    }
-                }
-            };
-            window.addEventListener('dataContentFetched', listener);
-            ipc.fetchDataContent(reqId, absolutePath);
+            // 只需要 presets：取表头即可，并与页面上的 DataBlock 共用同一份结果
+            ipc.fetchSharedDataContent(absolutePath, true).then(contentObj => {
+                currentPresets = (contentObj && contentObj.presets) || [];
+                renderPresetList();
+            }).catch(err => {
+                console.error(`Failed to load presets of "${dbPath}":`, err);
+                presetListContainer.innerHTML = '<div class="empty-details-placeholder" style="padding:5px; color:red;">Failed to parse database.</div>';
+            });
         };
 
         dbInput.addEventListener('input', () => renderDbList(dbInput.value));